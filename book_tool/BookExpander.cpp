@@ -0,0 +1,284 @@
+//-----------------------------------------------------------------------------
+/** @file book_tool/BookExpander.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "BookExpander.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include "libboardgame_base/Log.h"
+#include "libboardgame_base/WallTimeSource.h"
+#include "libpentobi_base/BoardUtil.h"
+#include "libpentobi_base/NodeUtil.h"
+
+using libboardgame_base::SgfTree;
+using libboardgame_base::WallTimeSource;
+using libpentobi_base::get_transformed;
+using libpentobi_base::has_setup;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+bool get_value(const SgfNode& node, Float& value)
+{
+    if (! node.has_property("V"))
+        return false;
+    try
+    {
+        value = node.parse_property<Float>("V");
+        return true;
+    }
+    catch (const runtime_error&)
+    {
+        return false;
+    }
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+BookExpander::BookExpander(PentobiTree& tree, unsigned nu_threads,
+                           size_t memory)
+    : m_tree(tree),
+      m_hash(tree.get_variant())
+{
+    for (unsigned i = 0; i < max(nu_threads, 1u); ++i)
+        m_searches.push_back(make_unique<Search>(tree.get_variant(), 1,
+                                                 memory));
+}
+
+BookExpander::~BookExpander() = default; // Non-inline to avoid GCC -Winline warning
+
+void BookExpander::add_move(const SgfNode& node, ColorMove mv, Float value)
+{
+    auto child = m_tree.find_child_with_move(node, mv);
+    if (child == nullptr)
+    {
+        child = &m_tree.create_new_child(node);
+        m_tree.set_move(*child, mv);
+    }
+    m_tree.set_good_move(*child);
+    ostringstream s;
+    s << fixed << setprecision(3) << value;
+    m_tree.set_property(*child, "V", s.str());
+}
+
+void BookExpander::collect(const SgfNode& node, Float priority)
+{
+    if (has_setup(node))
+        throw runtime_error("book contains setup properties");
+    auto mv = m_tree.get_move(node);
+    if (! mv.is_null())
+        m_moves.push_back(mv);
+    const SgfNode* first_good_child = nullptr;
+    Float best_value = -numeric_limits<Float>::max();
+    for (auto& child : node.get_children())
+        if (SgfTree::get_good_move(child) > 0
+                && ! m_tree.get_move(child).is_null())
+        {
+            if (first_good_child == nullptr)
+                first_good_child = &child;
+            Float value;
+            if (get_value(child, value))
+                best_value = max(best_value, value);
+        }
+    if (first_good_child == nullptr)
+    {
+        if (m_moves.size() < m_max_depth && m_finished.count(&node) == 0)
+            m_leaves.push_back({&node, priority, m_moves});
+    }
+    else
+    {
+        auto begin = m_moves.data();
+        auto end = begin + m_moves.size();
+        auto to_play = m_tree.get_move(*first_good_child).color;
+        unsigned transform;
+        auto hash = m_hash.get_canonical(begin, end, to_play, transform);
+        m_expanded.insert({hash, {&node, transform}});
+        for (auto& child : node.get_children())
+            if (SgfTree::get_good_move(child) > 0
+                    && ! m_tree.get_move(child).is_null())
+            {
+                Float drop = 0;
+                Float value;
+                if (get_value(child, value))
+                    drop = best_value - value;
+                collect(child, priority + 1 + m_drop_weight * drop);
+            }
+    }
+    if (! mv.is_null())
+        m_moves.pop_back();
+}
+
+bool BookExpander::copy_moves(const Board& bd, const SgfNode& node,
+                              Color to_play, unsigned transform,
+                              const Expanded& expanded)
+{
+    auto& to_canonical = m_hash.get_transform(expanded.transform);
+    auto& from_canonical = m_hash.get_inv_transform(transform);
+    bool result = false;
+    for (auto& child : expanded.node->get_children())
+    {
+        auto color_mv = m_tree.get_move(child);
+        if (SgfTree::get_good_move(child) <= 0 || color_mv.is_null()
+                || color_mv.color != to_play)
+            continue;
+        auto mv = get_transformed(bd, color_mv.move, to_canonical);
+        mv = get_transformed(bd, mv, from_canonical);
+        if (! bd.is_legal(to_play, mv))
+            continue;
+        Float value = 0.5;
+        get_value(child, value);
+        add_move(node, ColorMove(to_play, mv), value);
+        result = true;
+    }
+    return result;
+}
+
+unsigned BookExpander::expand(unsigned max_leaves)
+{
+    m_leaves.clear();
+    m_expanded.clear();
+    m_moves.clear();
+    collect(m_tree.get_root(), 0);
+    stable_sort(m_leaves.begin(), m_leaves.end(),
+                [](const Leaf& l1, const Leaf& l2) {
+                    return l1.priority < l2.priority; });
+    unsigned nu_copied = 0;
+    vector<Job> jobs;
+    set<PositionHash::IntType> searched;
+    auto variant = m_tree.get_variant();
+    for (auto& leaf : m_leaves)
+    {
+        if (jobs.size() >= max_leaves)
+            break;
+        auto bd = make_unique<Board>(variant);
+        for (auto& mv : leaf.moves)
+            bd->play(mv);
+        if (bd->is_game_over())
+        {
+            m_finished.insert(leaf.node);
+            continue;
+        }
+        auto to_play = bd->get_effective_to_play();
+        auto begin = leaf.moves.data();
+        auto end = begin + leaf.moves.size();
+        unsigned transform;
+        auto hash = m_hash.get_canonical(begin, end, to_play, transform);
+        auto pos = m_expanded.find(hash);
+        if (pos != m_expanded.end())
+        {
+            if (! copy_moves(*bd, *leaf.node, to_play, transform,
+                             pos->second))
+                m_finished.insert(leaf.node);
+            ++nu_copied;
+            continue;
+        }
+        // Transpositions within the same batch are expanded by copying in
+        // the next call
+        if (! searched.insert(hash).second)
+            continue;
+        jobs.push_back({leaf.node, to_play, std::move(bd), {}});
+    }
+    if (jobs.empty())
+        return nu_copied;
+    LIBBOARDGAME_LOG("Searching ", jobs.size(), " of ", m_leaves.size(),
+                     " leaves (priority ", m_leaves.front().priority, ")");
+    atomic<size_t> next(0);
+    vector<thread> threads;
+    auto nu_threads = min(m_searches.size(), jobs.size());
+    for (size_t i = 0; i < nu_threads; ++i)
+        threads.emplace_back([&, i] {
+            size_t j;
+            while ((j = next++) < jobs.size())
+                search(*m_searches[i], jobs[j]);
+        });
+    for (auto& t : threads)
+        t.join();
+    for (auto& job : jobs)
+    {
+        if (job.result.empty())
+            m_finished.insert(job.node);
+        for (auto& i : job.result)
+            add_move(*job.node, ColorMove(job.to_play, i.first), i.second);
+    }
+    return nu_copied + static_cast<unsigned>(jobs.size());
+}
+
+void BookExpander::read_finished(istream& in)
+{
+    string line;
+    while (getline(in, line))
+    {
+        istringstream s(line);
+        auto node = &m_tree.get_root();
+        unsigned i;
+        while (node != nullptr && s >> i)
+            node = (i < node->get_nu_children() ? &node->get_child(i)
+                                                : nullptr);
+        if (node != nullptr && s.eof())
+            m_finished.insert(node);
+    }
+}
+
+void BookExpander::search(Search& search, Job& job)
+{
+    WallTimeSource time_source;
+    Move mv;
+    if (! search.search(mv, *job.bd, job.to_play, m_simulations, 0, 0,
+                        time_source))
+        return;
+    auto& tree = search.get_tree();
+    Float best_value = 0;
+    Float max_count = 0;
+    for (auto& child : tree.get_root_children())
+        if (child.get_move() == mv)
+        {
+            best_value = child.get_value();
+            max_count = child.get_visit_count();
+            job.result.emplace_back(mv, best_value);
+        }
+    if (job.result.empty())
+        // Move was not generated by the tree search (e.g. only one legal
+        // move)
+        job.result.emplace_back(mv, Float(0.5));
+    vector<pair<Move, Float>> candidates;
+    for (auto& child : tree.get_root_children())
+        // Ignore moves with few visits because their value is unreliable
+        if (child.get_move() != mv
+                && child.get_visit_count() >= 0.1f * max_count
+                && child.get_value() >= best_value - m_max_drop)
+            candidates.emplace_back(child.get_move(), child.get_value());
+    sort(candidates.begin(), candidates.end(),
+         [](const pair<Move, Float>& c1, const pair<Move, Float>& c2) {
+             return c1.second > c2.second; });
+    for (auto& i : candidates)
+    {
+        if (job.result.size() >= m_max_moves)
+            break;
+        job.result.push_back(i);
+    }
+}
+
+void BookExpander::write_finished(ostream& out) const
+{
+    vector<unsigned> path;
+    for (auto node : m_finished)
+    {
+        path.clear();
+        for ( ; node->has_parent(); node = &node->get_parent())
+            path.push_back(node->get_parent().get_child_index(*node));
+        for (auto i = path.rbegin(); i != path.rend(); ++i)
+            out << (i == path.rbegin() ? "" : " ") << *i;
+        out << '\n';
+    }
+}
+
+//-----------------------------------------------------------------------------
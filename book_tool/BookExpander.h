@@ -0,0 +1,156 @@
+//-----------------------------------------------------------------------------
+/** @file book_tool/BookExpander.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef BOOK_TOOL_BOOK_EXPANDER_H
+#define BOOK_TOOL_BOOK_EXPANDER_H
+
+#include <map>
+#include <set>
+#include "libpentobi_base/PentobiTree.h"
+#include "libpentobi_base/PositionHash.h"
+#include "libpentobi_mcts/Search.h"
+
+using namespace std;
+using libboardgame_base::SgfNode;
+using libpentobi_base::Board;
+using libpentobi_base::Color;
+using libpentobi_base::ColorMove;
+using libpentobi_base::Move;
+using libpentobi_base::PentobiTree;
+using libpentobi_base::PositionHash;
+using libpentobi_mcts::Float;
+using libpentobi_mcts::Search;
+
+//-----------------------------------------------------------------------------
+
+/** Expands an opening book by searching its leaf positions.
+
+    The leaves are the positions reached by the good moves of the book that
+    have no good moves yet. They are expanded in the order of their priority
+    as in dropout expansion: each move leading to a leaf adds 1 plus the
+    difference between the value of the best sibling and the value of the
+    move, multiplied by a weight. Leaves behind the best moves are expanded
+    first, leaves behind slightly weaker moves are expanded when the main
+    lines are deep enough.
+
+    Several leaves are searched in parallel, each by its own single-threaded
+    search. The moves of a search whose value is not lower than the value of
+    the best move by more than a maximum drop are added as good moves (TE[1])
+    and their values are stored in the SGF property V (value for the color
+    that played the move). Leaves that are transpositions of an expanded
+    position or equivalent to it by symmetry get the moves of that position
+    without a search. */
+class BookExpander
+{
+public:
+    BookExpander(PentobiTree& tree, unsigned nu_threads, size_t memory);
+
+    ~BookExpander();
+
+    /** Don't expand leaves with this number of moves or more. */
+    void set_max_depth(unsigned max_depth) { m_max_depth = max_depth; }
+
+    /** Maximum number of good moves added in a leaf. */
+    void set_max_moves(unsigned max_moves) { m_max_moves = max_moves; }
+
+    /** Maximum difference to the value of the best move for adding a move. */
+    void set_max_drop(Float max_drop) { m_max_drop = max_drop; }
+
+    /** Weight of the value drops in the expansion priority. */
+    void set_drop_weight(Float drop_weight) { m_drop_weight = drop_weight; }
+
+    /** Number of simulations of the search in a leaf. */
+    void set_simulations(Float simulations) { m_simulations = simulations; }
+
+    /** Expand the leaves with the highest priority.
+        @param max_leaves The maximum number of leaves to search.
+        @return The number of processed leaves including leaves expanded
+        without a search, 0 if there are no more leaves to expand. */
+    unsigned expand(unsigned max_leaves);
+
+    /** Write the leaves that were found to be not expandable.
+        Each leaf is written as a line with the child indices of the nodes
+        on the path from the root. Together with the book, this is the state
+        needed to resume an expansion. */
+    void write_finished(ostream& out) const;
+
+    /** Read leaves written by write_finished().
+        Lines that do not match a node of the book are ignored. */
+    void read_finished(istream& in);
+
+private:
+    struct Leaf
+    {
+        const SgfNode* node;
+
+        Float priority;
+
+        vector<ColorMove> moves;
+    };
+
+    struct Job
+    {
+        const SgfNode* node;
+
+        Color to_play;
+
+        unique_ptr<Board> bd;
+
+        /** The moves to add and their values. */
+        vector<pair<Move, Float>> result;
+    };
+
+    /** An expanded position with the transformation of its canonical
+        hash. */
+    struct Expanded
+    {
+        const SgfNode* node;
+
+        unsigned transform;
+    };
+
+
+    PentobiTree& m_tree;
+
+    PositionHash m_hash;
+
+    unsigned m_max_depth = 20;
+
+    unsigned m_max_moves = 3;
+
+    Float m_max_drop = 0.02f;
+
+    Float m_drop_weight = 20;
+
+    Float m_simulations = 100000;
+
+    vector<unique_ptr<Search>> m_searches;
+
+    /** Leaves without legal moves or without legal moves to copy. */
+    set<const SgfNode*> m_finished;
+
+    /** Local variable reused for efficiency. */
+    vector<ColorMove> m_moves;
+
+    /** Local variable reused for efficiency. */
+    vector<Leaf> m_leaves;
+
+    /** Local variable reused for efficiency. */
+    map<PositionHash::IntType, Expanded> m_expanded;
+
+    void add_move(const SgfNode& node, ColorMove mv, Float value);
+
+    void collect(const SgfNode& node, Float priority);
+
+    bool copy_moves(const Board& bd, const SgfNode& node, Color to_play,
+                    unsigned transform, const Expanded& expanded);
+
+    void search(Search& search, Job& job);
+};
+
+//-----------------------------------------------------------------------------
+
+#endif // BOOK_TOOL_BOOK_EXPANDER_H
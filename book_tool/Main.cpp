@@ -0,0 +1,191 @@
+//-----------------------------------------------------------------------------
+/** @file book_tool/Main.cpp
+    Tool for processing the opening books in opening_books.
+
+    With --compile, converts an opening book in SGF format into the binary
+    format of libpentobi_base::CompiledBook.
+
+    With --expand, expands an opening book with parallel searches at its
+    leaf positions (see BookExpander). The expanded book is written to the
+    output file after each batch of searches. If the output file already
+    exists, the expansion resumes from it instead of the input book, so an
+    interrupted run can be continued by running the same command again.
+    The leaves that cannot be expanded are written to the output file with
+    the extension .finished, such that they are not searched again after
+    resuming.
+
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include "BookExpander.h"
+#include "libboardgame_base/Log.h"
+#include "libboardgame_base/Options.h"
+#include "libboardgame_base/TreeReader.h"
+#include "libpentobi_base/CompiledBook.h"
+#include "libpentobi_base/PentobiTreeWriter.h"
+
+using namespace std;
+using libboardgame_base::Options;
+using libboardgame_base::SgfNode;
+using libboardgame_base::TreeReader;
+using libpentobi_base::CompiledBook;
+using libpentobi_base::PentobiTree;
+using libpentobi_base::PentobiTreeWriter;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+unique_ptr<SgfNode> read_tree(const string& file)
+{
+    TreeReader reader;
+    reader.read(file);
+    return reader.get_tree_transfer_ownership();
+}
+
+void compile(const string& in_file, const string& out_file)
+{
+    unique_ptr<SgfNode> root = read_tree(in_file);
+    PentobiTree tree(root);
+    ofstream out(out_file, ios::binary);
+    if (! out)
+        throw runtime_error("Could not create " + out_file);
+    CompiledBook::compile(tree, out);
+    out.close();
+    if (! out)
+        throw runtime_error("Could not write " + out_file);
+    CompiledBook book;
+    book.load(out_file);
+    LIBBOARDGAME_LOG("Wrote ", out_file, " (", book.get_nu_positions(),
+                     " positions)");
+}
+
+/** Write to a temporary file and rename it, such that the file always has
+    a complete content if the tool is interrupted. */
+void save(const string& file, const function<void(ostream&)>& write)
+{
+    auto tmp_file = file + ".tmp";
+    {
+        ofstream out(tmp_file);
+        write(out);
+        if (! out)
+            throw runtime_error("Could not write " + tmp_file);
+    }
+    if (rename(tmp_file.c_str(), file.c_str()) != 0)
+        throw runtime_error("Could not rename " + tmp_file);
+}
+
+void expand(const string& in_file, const string& out_file,
+            const Options& opt)
+{
+    auto nu_leaves = opt.get<unsigned>("nuleaves", 100);
+    auto nu_threads = opt.get<unsigned>("threads", 1);
+    auto memory = opt.get<size_t>("memory", 256);
+    auto finished_file = out_file + ".finished";
+    string file = in_file;
+    bool resume = static_cast<bool>(ifstream(out_file));
+    if (resume)
+    {
+        LIBBOARDGAME_LOG("Resuming from ", out_file);
+        file = out_file;
+    }
+    unique_ptr<SgfNode> root = read_tree(file);
+    PentobiTree tree(root);
+    BookExpander expander(tree, nu_threads, memory * 1000000);
+    if (resume)
+    {
+        ifstream in(finished_file);
+        expander.read_finished(in);
+    }
+    expander.set_max_depth(opt.get<unsigned>("maxdepth", 20));
+    expander.set_max_moves(opt.get<unsigned>("maxmoves", 3));
+    expander.set_max_drop(opt.get<Float>("maxdrop", 0.02f));
+    expander.set_drop_weight(opt.get<Float>("dropweight", 20));
+    expander.set_simulations(opt.get<Float>("simulations", 100000));
+    unsigned nu_expanded = 0;
+    while (nu_expanded < nu_leaves)
+    {
+        auto n = expander.expand(min(4 * nu_threads, nu_leaves - nu_expanded));
+        if (n == 0)
+        {
+            LIBBOARDGAME_LOG("No more leaves to expand");
+            break;
+        }
+        nu_expanded += n;
+        // The finished leaves are saved first because they already existed
+        // in the previously saved book.
+        save(finished_file, [&](ostream& out) {
+            expander.write_finished(out);
+        });
+        save(out_file, [&](ostream& out) {
+            PentobiTreeWriter writer(out, tree);
+            writer.set_indent(1);
+            writer.write();
+        });
+        LIBBOARDGAME_LOG("Expanded ", nu_expanded, " leaves");
+    }
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    libboardgame_base::LogInitializer log_initializer;
+    try
+    {
+        vector<string> specs = {
+            "compile|c:",
+            "dropweight:",
+            "expand|e:",
+            "help|h",
+            "maxdepth:",
+            "maxdrop:",
+            "maxmoves:",
+            "memory:",
+            "nuleaves|n:",
+            "simulations:",
+            "threads:"
+        };
+        Options opt(argc, argv, specs);
+        auto& args = opt.get_args();
+        if (opt.contains("help")
+                || opt.contains("compile") == opt.contains("expand")
+                || args.size() != 1)
+        {
+            cout <<
+                "Usage: book-tool --compile out.blkbook book.blksgf\n"
+                "       book-tool --expand out.blksgf [options] book.blksgf\n"
+                "--compile,-c compile book into binary format\n"
+                "--expand,-e  expand book with searches at leaf positions\n"
+                "--help,-h    print help message and exit\n"
+                "Options for --expand:\n"
+                "--dropweight weight of value drops in leaf priority (20)\n"
+                "--maxdepth   max. number of moves of expanded leaves (20)\n"
+                "--maxdrop    max. value drop of added moves (0.02)\n"
+                "--maxmoves   max. number of added moves per leaf (3)\n"
+                "--memory     memory per search in MB (256)\n"
+                "--nuleaves,-n number of leaves to expand (100)\n"
+                "--simulations number of simulations per search (100000)\n"
+                "--threads    number of parallel searches (1)\n";
+            return opt.contains("help") ? 0 : 1;
+        }
+        if (opt.contains("compile"))
+            compile(args[0], opt.get("compile"));
+        else
+            expand(args[0], opt.get("expand"), opt);
+    }
+    catch (const exception& e)
+    {
+        LIBBOARDGAME_LOG("Error: ", e.what());
+        return 1;
+    }
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
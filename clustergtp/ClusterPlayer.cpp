@@ -0,0 +1,223 @@
+//-----------------------------------------------------------------------------
+/** @file clustergtp/ClusterPlayer.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "ClusterPlayer.h"
+
+#include <map>
+#include <sstream>
+#include <thread>
+#include "libboardgame_base/Log.h"
+#include "libboardgame_gtp/Failure.h"
+#include "libpentobi_base/PentobiSgfUtil.h"
+
+using libboardgame_gtp::Failure;
+using libpentobi_base::get_color_id;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+/** Merged statistics of a root child. */
+struct MoveStat
+{
+    double visit_count = 0;
+
+    double value_count = 0;
+
+    double value_sum = 0;
+};
+
+/** Parse a move as written by move_values.
+    Strips the piece name in brackets. */
+bool parse_move(const Board& bd, string s, Move& mv)
+{
+    auto pos = s.find(']');
+    if (pos != string::npos)
+        s = s.substr(pos + 1);
+    return bd.from_string(mv, s);
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+ClusterPlayer::ClusterPlayer(const vector<string>& workers, bool log)
+{
+    if (workers.empty())
+        throw runtime_error("no workers");
+    m_workers.resize(workers.size());
+    for (size_t i = 0; i < workers.size(); ++i)
+    {
+        auto& worker = m_workers[i];
+        worker.connection = make_unique<GtpConnection>(workers[i]);
+        if (log)
+            worker.connection->enable_log(to_string(i + 1));
+    }
+}
+
+ClusterPlayer::~ClusterPlayer()
+{
+    for (auto& i : m_workers)
+        try
+        {
+            i.connection->send("quit");
+        }
+        catch (const GtpConnection::Failure&)
+        {
+        }
+}
+
+Move ClusterPlayer::genmove(const Board& bd, Color c)
+{
+    if (bd.has_setup())
+        throw Failure("positions with setup stones not supported");
+    if (! bd.has_moves(c))
+        return Move::null();
+    vector<thread> threads;
+    threads.reserve(m_workers.size());
+    for (auto& i : m_workers)
+    {
+        auto worker = &i;
+        threads.emplace_back([this, worker, &bd, c]() {
+            search(*worker, bd, c); });
+    }
+    for (auto& t : threads)
+        t.join();
+    map<Move, MoveStat> stats;
+    map<Move, unsigned> votes;
+    unsigned nu_failed = 0;
+    for (size_t i = 0; i < m_workers.size(); ++i)
+    {
+        auto& worker = m_workers[i];
+        if (! worker.error.empty())
+        {
+            LIBBOARDGAME_LOG("Worker ", i + 1, " failed: ", worker.error);
+            worker.is_synced = false;
+            ++nu_failed;
+            continue;
+        }
+        bool has_move = false;
+        for (auto& [mv, visit_count, value_count, value] : worker.stats)
+        {
+            auto& stat = stats[mv];
+            stat.visit_count += visit_count;
+            stat.value_count += value_count;
+            stat.value_sum += value_count * value;
+            if (mv == worker.mv)
+                has_move = true;
+        }
+        // If the move was not generated by a search (e.g. by the opening
+        // book or the endgame solver), the worker only votes for its move
+        if (! has_move)
+            ++votes[worker.mv];
+    }
+    if (nu_failed == m_workers.size())
+        throw Failure("all workers failed");
+    if (! votes.empty())
+    {
+        auto best = votes.begin();
+        for (auto i = votes.begin(); i != votes.end(); ++i)
+            if (i->second > best->second)
+                best = i;
+        LIBBOARDGAME_LOG("Move from ", best->second, " of ", votes.size(),
+                         " non-search votes: ", bd.to_string(best->first));
+        return best->first;
+    }
+    if (stats.empty())
+        return Move::null();
+    auto best = stats.begin();
+    for (auto i = stats.begin(); i != stats.end(); ++i)
+        if (i->second.visit_count > best->second.visit_count)
+            best = i;
+    auto& stat = best->second;
+    LIBBOARDGAME_LOG("Merged ", m_workers.size() - nu_failed, " workers: ",
+                     bd.to_string(best->first), " Vst ", stat.visit_count,
+                     " Val ",
+                     stat.value_count > 0 ?
+                         stat.value_sum / stat.value_count : 0);
+    return best->first;
+}
+
+/** Let a worker search a position and get its root statistics.
+    Runs in its own thread, errors are stored in Worker::error. */
+void ClusterPlayer::search(Worker& worker, const Board& bd, Color c)
+{
+    worker.error.clear();
+    worker.stats.clear();
+    try
+    {
+        sync(worker, bd);
+        auto color = get_color_id(bd.get_variant(), c);
+        auto response =
+                worker.connection->send(string("reg_genmove ") + color);
+        if (! bd.from_string(worker.mv, response))
+            throw runtime_error("invalid move '" + response + "'");
+        istringstream in(worker.connection->send("move_values"));
+        string line;
+        while (getline(in, line))
+        {
+            istringstream line_in(line);
+            double visit_count, value_count, value;
+            string s;
+            Move mv;
+            line_in >> visit_count >> value_count >> value >> s;
+            if (! line_in || ! parse_move(bd, s, mv))
+                throw runtime_error("invalid move_values line '" + line
+                                    + "'");
+            worker.stats.emplace_back(mv, visit_count, value_count, value);
+        }
+    }
+    catch (const exception& e)
+    {
+        worker.error = e.what();
+        if (worker.error.empty())
+            worker.error = "unknown error";
+    }
+}
+
+void ClusterPlayer::set_seed(unsigned seed)
+{
+    for (auto& i : m_workers)
+        i.connection->send("set_random_seed " + to_string(seed++));
+}
+
+/** Bring the position of the worker up to date.
+    Sends only the moves that changed since the last genmove if the game
+    variant did not change. */
+void ClusterPlayer::sync(Worker& worker, const Board& bd)
+{
+    auto variant = bd.get_variant();
+    auto nu_moves = bd.get_nu_moves();
+    auto& connection = *worker.connection;
+    if (! worker.is_synced || worker.variant != variant)
+    {
+        connection.send(string("set_game ") + to_string(variant));
+        worker.variant = variant;
+        worker.moves.clear();
+    }
+    auto& moves = worker.moves;
+    unsigned n = 0;
+    while (n < moves.size() && n < nu_moves && moves[n] == bd.get_move(n))
+        ++n;
+    // Keep worker.is_synced false until the position is fully updated, such
+    // that a failed command causes a complete resync in the next genmove
+    worker.is_synced = false;
+    for (auto i = moves.size(); i > n; --i)
+    {
+        connection.send("undo");
+        moves.pop_back();
+    }
+    for (auto i = n; i < nu_moves; ++i)
+    {
+        auto mv = bd.get_move(i);
+        connection.send(string("play ") + get_color_id(variant, mv.color)
+                        + ' ' + bd.to_string(mv.move));
+        moves.push_back(mv);
+    }
+    worker.is_synced = true;
+}
+
+//-----------------------------------------------------------------------------
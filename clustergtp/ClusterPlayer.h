@@ -0,0 +1,83 @@
+//-----------------------------------------------------------------------------
+/** @file clustergtp/ClusterPlayer.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef CLUSTERGTP_CLUSTER_PLAYER_H
+#define CLUSTERGTP_CLUSTER_PLAYER_H
+
+#include <vector>
+#include "libpentobi_base/PlayerBase.h"
+#include "twogtp/GtpConnection.h"
+
+using namespace std;
+using libpentobi_base::Board;
+using libpentobi_base::Color;
+using libpentobi_base::ColorMove;
+using libpentobi_base::Move;
+using libpentobi_base::PlayerBase;
+using libpentobi_base::Variant;
+
+//-----------------------------------------------------------------------------
+
+/** Player that distributes the search over several GTP engines.
+    Uses root parallelization: each worker engine (usually pentobi-gtp)
+    searches the position independently with reg_genmove, the statistics
+    of the root children are queried with move_values and the move with the
+    highest sum of the visit counts of all workers is played.
+    The workers run in external processes and communicate with GTP over
+    pipes, so they can also run on other hosts by using a remote shell
+    in the command of the worker. The workers should not use an opening
+    book and should use different random seeds. */
+class ClusterPlayer final
+    : public PlayerBase
+{
+public:
+    /** Constructor.
+        @param workers The command lines for starting the workers.
+        @param log Log the GTP streams of the workers. */
+    ClusterPlayer(const vector<string>& workers, bool log);
+
+    ~ClusterPlayer() override;
+
+    Move genmove(const Board& bd, Color c) override;
+
+    /** Set the random seeds of the workers to seed, seed + 1, ... */
+    void set_seed(unsigned seed);
+
+private:
+    struct Worker
+    {
+        unique_ptr<GtpConnection> connection;
+
+        /** Is the position of the worker known? */
+        bool is_synced = false;
+
+        /** Game variant of the position of the worker. */
+        Variant variant;
+
+        /** Moves played in the position of the worker. */
+        vector<ColorMove> moves;
+
+        /** Move generated by the worker in the last genmove. */
+        Move mv;
+
+        /** Root statistics of the last genmove as (move, visit count,
+            value count, value). */
+        vector<tuple<Move, double, double, double>> stats;
+
+        /** Error message if the last genmove failed. */
+        string error;
+    };
+
+    vector<Worker> m_workers;
+
+    void search(Worker& worker, const Board& bd, Color c);
+
+    void sync(Worker& worker, const Board& bd);
+};
+
+//-----------------------------------------------------------------------------
+
+#endif // CLUSTERGTP_CLUSTER_PLAYER_H
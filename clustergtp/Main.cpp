@@ -0,0 +1,69 @@
+//-----------------------------------------------------------------------------
+/** @file clustergtp/Main.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include <iostream>
+#include "ClusterPlayer.h"
+#include "libboardgame_base/Log.h"
+#include "libboardgame_base/Options.h"
+#include "libpentobi_gtp/GtpEngine.h"
+
+using namespace std;
+using libboardgame_base::Options;
+using libpentobi_base::parse_variant_id;
+
+//-----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    libboardgame_base::LogInitializer log_initializer;
+    try
+    {
+        vector<string> specs = {
+            "game|g:",
+            "help|h",
+            "log",
+            "quiet|q",
+            "seed|r:",
+        };
+        Options opt(argc, argv, specs);
+        if (opt.contains("help"))
+        {
+            cout <<
+                "Usage: clustergtp [options] worker...\n"
+                "Each worker is the command line of a GTP engine, e.g.\n"
+                "\"pentobi-gtp --nobook\" or\n"
+                "\"ssh host pentobi-gtp --nobook\"\n"
+                "--game,-g   game variant (classic, classic_2, classic_3,\n"
+                "            duo, trigon, trigon_2, trigon_3, junior)\n"
+                "--help,-h   print help message and exit\n"
+                "--log       log the GTP streams of the workers\n"
+                "--quiet,-q  do not print logging messages\n"
+                "--seed,-r   set random seeds of the workers to seed,\n"
+                "            seed + 1, ...\n";
+            return 0;
+        }
+        if (opt.contains("quiet"))
+            libboardgame_base::disable_logging();
+        string variant_string = opt.get("game", "classic");
+        Variant variant;
+        if (! parse_variant_id(variant_string, variant))
+            throw runtime_error("invalid game variant " + variant_string);
+        ClusterPlayer player(opt.get_args(), opt.contains("log"));
+        if (opt.contains("seed"))
+            player.set_seed(opt.get<unsigned>("seed"));
+        libpentobi_gtp::GtpEngine engine(variant);
+        engine.set_player(player);
+        engine.exec_main_loop(cin, cout);
+        return 0;
+    }
+    catch (const exception& e)
+    {
+        LIBBOARDGAME_LOG("Error: ", e.what());
+        return 1;
+    }
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,477 @@
+//-----------------------------------------------------------------------------
+/** @file db_tool/Main.cpp
+    Tool for creating and querying game databases (see
+    libpentobi_base::GameDatabase).
+
+    With --create, indexes all positions of the games in a list of SGF files
+    using multiple threads. The files can contain multiple games. All games
+    must have the same game variant as the first game, other games and games
+    with errors are skipped.
+
+    The queries use the position at the end of the main variation of the
+    file given with --position, or the starting position if no file is
+    given. With --query, the number of games reaching the position and the
+    moves played in it are printed. With --games, the games are listed. With
+    --extract, the games are written to an SGF file, which can be used as
+    input for learn_tool. With --tree, a tree of the moves played at least
+    --mingames times is written, which can be used as an input book for
+    book_tool.
+
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include "libboardgame_base/CompactTreeReader.h"
+#include "libboardgame_base/Log.h"
+#include "libboardgame_base/Options.h"
+#include "libboardgame_base/SgfUtil.h"
+#include "libboardgame_base/TreeReader.h"
+#include "libboardgame_base/TreeWriter.h"
+#include "libpentobi_base/BoardUpdater.h"
+#include "libpentobi_base/GameDatabase.h"
+#include "libpentobi_base/PentobiTreeWriter.h"
+
+using namespace std;
+using libboardgame_base::CompactTreeReader;
+using libboardgame_base::get_last_node;
+using libboardgame_base::MappedFile;
+using libboardgame_base::Options;
+using libboardgame_base::SgfError;
+using libboardgame_base::SgfNode;
+using libboardgame_base::TreeReader;
+using libboardgame_base::TreeWriter;
+using libpentobi_base::Board;
+using libpentobi_base::BoardUpdater;
+using libpentobi_base::Color;
+using libpentobi_base::GameDatabase;
+using libpentobi_base::PentobiTree;
+using libpentobi_base::PentobiTreeWriter;
+using libpentobi_base::Variant;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+mutex log_mutex;
+
+/** Reads the games of a list of files in order.
+    Can be used by multiple threads. Files that cannot be read are skipped,
+    a file with a syntax error is skipped from the game with the error. */
+class GameSource
+{
+public:
+    explicit GameSource(const vector<string>& files);
+
+    /** Get the next game.
+        @param[out] root The game.
+        @param[out] file The index of the file of the game.
+        @param[out] index The index of the game in the file.
+        @param[out] order The number of games read before the game.
+        @return false if there are no more games. */
+    bool next(unique_ptr<SgfNode>& root, unsigned& file, unsigned& index,
+              uint64_t& order);
+
+private:
+    mutex m_mutex;
+
+    const vector<string>& m_files;
+
+    unsigned m_file = 0;
+
+    unsigned m_index = 0;
+
+    uint64_t m_order = 0;
+
+    unique_ptr<MappedFile> m_mapped_file;
+
+    const char* m_pos = nullptr;
+
+    TreeReader m_reader;
+};
+
+GameSource::GameSource(const vector<string>& files)
+    : m_files(files)
+{
+}
+
+bool GameSource::next(unique_ptr<SgfNode>& root, unsigned& file,
+                      unsigned& index, uint64_t& order)
+{
+    lock_guard<mutex> lock(m_mutex);
+    while (m_file < m_files.size())
+    {
+        auto& name = m_files[m_file];
+        if (m_mapped_file == nullptr)
+        {
+            try
+            {
+                m_mapped_file = make_unique<MappedFile>(name);
+            }
+            catch (const MappedFile::Error& e)
+            {
+                lock_guard<mutex> log_lock(log_mutex);
+                LIBBOARDGAME_LOG("Skipping ", name, ": ", e.what());
+                ++m_file;
+                continue;
+            }
+            m_pos = m_mapped_file->begin();
+            m_index = 0;
+        }
+        bool has_more;
+        try
+        {
+            if (m_pos == m_mapped_file->end())
+                has_more = false;
+            else
+            {
+                has_more = m_reader.read(m_pos, m_mapped_file->end(), false);
+                root = m_reader.get_tree_transfer_ownership();
+            }
+        }
+        catch (const TreeReader::ReadError& e)
+        {
+            lock_guard<mutex> log_lock(log_mutex);
+            LIBBOARDGAME_LOG("Skipping ", name, " from game ", m_index + 1,
+                             ": ", e.what());
+            root.reset();
+            has_more = false;
+        }
+        file = m_file;
+        index = m_index++;
+        if (! has_more)
+        {
+            m_mapped_file.reset();
+            ++m_file;
+        }
+        if (root != nullptr)
+        {
+            order = m_order++;
+            return true;
+        }
+    }
+    return false;
+}
+
+/** Get the position at the end of the main variation of a file. */
+unique_ptr<Board> get_position(const Options& opt, Variant variant)
+{
+    auto bd = make_unique<Board>(variant);
+    if (! opt.contains("position"))
+        return bd;
+    TreeReader reader;
+    reader.read(opt.get("position"));
+    auto root = reader.get_tree_transfer_ownership();
+    PentobiTree tree(root);
+    if (tree.get_variant() != variant)
+        throw runtime_error("position has wrong game variant");
+    BoardUpdater updater;
+    updater.update(*bd, tree, get_last_node(tree.get_root()));
+    return bd;
+}
+
+void create(const vector<string>& files, const string& out_file,
+            unsigned nu_threads)
+{
+    GameSource source(files);
+    unique_ptr<SgfNode> root;
+    unsigned file;
+    unsigned index;
+    uint64_t order;
+    Variant variant;
+    atomic<uint64_t> nu_skipped(0);
+    // Use the variant of the first game that has a valid variant
+    while (true)
+    {
+        if (! source.next(root, file, index, order))
+            throw runtime_error("no games found");
+        try
+        {
+            variant = PentobiTree::get_variant(*root);
+            break;
+        }
+        catch (const SgfError&)
+        {
+            ++nu_skipped;
+        }
+    }
+    if (nu_threads == 0)
+        nu_threads = 1;
+    vector<unique_ptr<GameDatabase::Indexer>> indexers;
+    for (unsigned i = 0; i < nu_threads; ++i)
+        indexers.push_back(make_unique<GameDatabase::Indexer>(variant));
+    mutex error_mutex;
+    string error;
+    auto worker = [&](GameDatabase::Indexer& indexer,
+                      unique_ptr<SgfNode> root, unsigned file,
+                      unsigned index, uint64_t order)
+    {
+        try
+        {
+            while (root != nullptr || source.next(root, file, index, order))
+            {
+                try
+                {
+                    PentobiTree tree(root);
+                    if (tree.get_variant() == variant)
+                        indexer.add(tree, file, index, order);
+                    else
+                        ++nu_skipped;
+                }
+                catch (const SgfError& e)
+                {
+                    ++nu_skipped;
+                    lock_guard<mutex> lock(log_mutex);
+                    LIBBOARDGAME_LOG("Skipping ", files[file], " game ",
+                                     index + 1, ": ", e.what());
+                }
+                root.reset();
+            }
+        }
+        catch (const exception& e)
+        {
+            lock_guard<mutex> lock(error_mutex);
+            if (error.empty())
+                error = e.what();
+        }
+    };
+    vector<thread> threads;
+    for (unsigned i = 1; i < nu_threads; ++i)
+        threads.emplace_back(worker, ref(*indexers[i]), nullptr, 0, 0, 0);
+    worker(*indexers[0], std::move(root), file, index, order);
+    for (auto& t : threads)
+        t.join();
+    if (! error.empty())
+        throw runtime_error(error);
+    vector<const GameDatabase::Indexer*> indexer_ptrs;
+    unsigned nu_games = 0;
+    for (auto& indexer : indexers)
+    {
+        indexer_ptrs.push_back(indexer.get());
+        nu_games += indexer->get_nu_games();
+    }
+    ofstream out(out_file, ios::binary);
+    if (! out)
+        throw runtime_error("Could not create " + out_file);
+    GameDatabase::write(out, variant, files, indexer_ptrs);
+    out.close();
+    if (! out)
+        throw runtime_error("Could not write " + out_file);
+    GameDatabase db;
+    db.load(out_file);
+    LIBBOARDGAME_LOG("Wrote ", out_file, " (", db.get_nu_games(), " games, ",
+                     db.get_nu_positions(), " positions, ", nu_skipped,
+                     " games skipped)");
+}
+
+/** Write the games that reach a position. */
+void extract(const GameDatabase& db, const Board& bd, const string& out_file)
+{
+    vector<GameDatabase::GameRef> games;
+    db.get_games(bd, bd.get_effective_to_play(), games);
+    // Read each file only once
+    vector<pair<string, unsigned>> sorted;
+    for (auto& game : games)
+        sorted.emplace_back(db.get_file(game.game), db.get_index(game.game));
+    sort(sorted.begin(), sorted.end());
+    sorted.erase(unique(sorted.begin(), sorted.end()), sorted.end());
+    ofstream out(out_file);
+    if (! out)
+        throw runtime_error("Could not create " + out_file);
+    unsigned nu_written = 0;
+    for (auto i = sorted.begin(); i != sorted.end(); )
+    {
+        auto& file = i->first;
+        MappedFile mapped_file(file);
+        auto pos = mapped_file.begin();
+        // Most games of a file are usually skipped, CompactTreeReader reads
+        // them faster than TreeReader and reuses its memory
+        CompactTreeReader reader;
+        unsigned index = 0;
+        bool has_more = (pos != mapped_file.end());
+        while (has_more && i != sorted.end() && i->first == file)
+        {
+            has_more = reader.read(pos, mapped_file.end(), false);
+            if (index++ != i->second)
+                continue;
+            auto root = reader.get_tree().to_sgf_node();
+            TreeWriter writer(out, *root);
+            writer.write();
+            ++nu_written;
+            ++i;
+        }
+        // Skip games that no longer exist in a modified file
+        while (i != sorted.end() && i->first == file)
+            ++i;
+    }
+    if (! out)
+        throw runtime_error("Could not write " + out_file);
+    LIBBOARDGAME_LOG("Wrote ", nu_written, " games to ", out_file);
+}
+
+void print_games(const GameDatabase& db, const Board& bd)
+{
+    vector<GameDatabase::GameRef> games;
+    auto c = bd.get_effective_to_play();
+    db.get_games(bd, c, games);
+    for (auto& game : games)
+        cout << db.get_file(game.game) << ' ' << db.get_index(game.game) + 1
+             << ' ' << game.move_number << ' '
+             << db.get_result(game.game, c) << '\n';
+}
+
+void query(const GameDatabase& db, const Board& bd)
+{
+    vector<GameDatabase::GameRef> games;
+    auto c = bd.get_effective_to_play();
+    db.get_games(bd, c, games);
+    float value = 0;
+    for (auto& game : games)
+        value += db.get_result(game.game, c);
+    cout << "Games: " << games.size() << '\n';
+    if (games.empty())
+        return;
+    cout << fixed << setprecision(3) << "Value: "
+         << value / static_cast<float>(games.size()) << '\n';
+    vector<GameDatabase::Continuation> continuations;
+    db.get_continuations(bd, c, continuations);
+    for (auto& continuation : continuations)
+        cout << setw(8) << continuation.count << ' ' << continuation.value
+             << ' ' << bd.to_string(continuation.mv) << '\n';
+}
+
+void add_continuations(const GameDatabase& db, PentobiTree& tree,
+                       const SgfNode& node, const Board& bd, unsigned depth,
+                       unsigned max_depth, unsigned min_games)
+{
+    if (depth >= max_depth)
+        return;
+    auto c = bd.get_effective_to_play();
+    vector<GameDatabase::Continuation> continuations;
+    db.get_continuations(bd, c, continuations);
+    auto child_bd = make_unique<Board>(bd.get_variant());
+    for (auto& continuation : continuations)
+    {
+        if (continuation.count < min_games)
+            break;
+        auto& child = tree.create_new_child(node);
+        tree.set_move(child, c, continuation.mv);
+        ostringstream comment;
+        comment << fixed << setprecision(3) << "Games: "
+                << continuation.count << "\nValue: " << continuation.value;
+        tree.set_comment(child, comment.str());
+        child_bd->copy_from(bd);
+        child_bd->play(c, continuation.mv);
+        add_continuations(db, tree, child, *child_bd, depth + 1, max_depth,
+                          min_games);
+    }
+}
+
+/** Write a tree of the moves played in the games. */
+void write_tree(const GameDatabase& db, const Board& bd,
+                const string& out_file, unsigned max_depth,
+                unsigned min_games)
+{
+    if (bd.has_setup())
+        throw runtime_error("position with setup not supported");
+    PentobiTree tree(bd.get_variant());
+    auto node = &tree.get_root();
+    for (auto mv : bd.get_moves())
+    {
+        node = &tree.create_new_child(*node);
+        tree.set_move(*node, mv);
+    }
+    add_continuations(db, tree, *node, bd, 0, max_depth, min_games);
+    ofstream out(out_file);
+    PentobiTreeWriter writer(out, tree);
+    writer.set_indent(1);
+    writer.write();
+    if (! out)
+        throw runtime_error("Could not write " + out_file);
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    libboardgame_base::LogInitializer log_initializer;
+    try
+    {
+        vector<string> specs = {
+            "create|c:",
+            "extract|e:",
+            "games|g",
+            "help|h",
+            "maxdepth:",
+            "mingames:",
+            "position|p:",
+            "query|q",
+            "threads:",
+            "tree|t:"
+        };
+        Options opt(argc, argv, specs);
+        auto& args = opt.get_args();
+        unsigned nu_commands = 0;
+        for (auto command : { "create", "extract", "games", "query", "tree" })
+            if (opt.contains(command))
+                ++nu_commands;
+        if (opt.contains("help") || nu_commands != 1 || args.empty()
+                || (! opt.contains("create") && args.size() != 1))
+        {
+            cout <<
+                "Usage: db-tool --create out.blkdb [options] games.blksgf...\n"
+                "       db-tool --query|--games [options] db.blkdb\n"
+                "       db-tool --extract out.blksgf [options] db.blkdb\n"
+                "       db-tool --tree out.blksgf [options] db.blkdb\n"
+                "--create,-c  create database from games\n"
+                "--extract,-e write games reaching the position\n"
+                "--games,-g   list games reaching the position\n"
+                "--help,-h    print help message and exit\n"
+                "--query,-q   print statistics of the position\n"
+                "--tree,-t    write tree of moves played from the position\n"
+                "Options:\n"
+                "--maxdepth   max. depth of the tree (20)\n"
+                "--mingames   min. number of games of moves in the tree (2)\n"
+                "--position,-p SGF file with position (starting position)\n"
+                "--threads    number of threads for --create\n";
+            return opt.contains("help") ? 0 : 1;
+        }
+        if (opt.contains("create"))
+        {
+            create(args, opt.get("create"),
+                   opt.get<unsigned>("threads",
+                                     thread::hardware_concurrency()));
+            return 0;
+        }
+        GameDatabase db;
+        db.load(args[0]);
+        auto bd = get_position(opt, db.get_variant());
+        if (opt.contains("query"))
+            query(db, *bd);
+        else if (opt.contains("games"))
+            print_games(db, *bd);
+        else if (opt.contains("extract"))
+            extract(db, *bd, opt.get("extract"));
+        else
+            write_tree(db, *bd, opt.get("tree"),
+                       opt.get<unsigned>("maxdepth", 20),
+                       opt.get<unsigned>("mingames", 2));
+    }
+    catch (const exception& e)
+    {
+        LIBBOARDGAME_LOG("Error: ", e.what());
+        return 1;
+    }
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
@@ -1,25 +1,47 @@
 //-----------------------------------------------------------------------------
 /** @file learn_tool/Main.cpp
-    Learn the parameters used in libpentobi_mcts/PriorKnowledge from existing
-    games with softmax training.
+    Learn the parameters used in libpentobi_mcts/PriorKnowledge and the
+    playout gammas used in libpentobi_mcts/State from existing games with
+    softmax training.
+
+    The learned weights are written in the format of libpentobi_mcts/Weights
+    and can be loaded by pentobi-gtp without recompiling.
+
+    Training samples can be extracted once with --extract into a binary
+    feature file, which can be used for training with --features without
+    parsing the games again. The feature file is memory-mapped and streamed in
+    each training step, so it can be larger than the available memory.
+
+    With --evaluator, the weights of libpentobi_mcts/StaticEvaluator used for
+    the playout cutoff are learned instead with a least-squares regression.
 
     @author Markus Enzenberger
     @copyright GNU General Public License version 3 or later */
 //-----------------------------------------------------------------------------
 
+#include <atomic>
+#include <cmath>
+#include <cstring>
 #include <fstream>
+#include <mutex>
 #include <random>
+#include <sstream>
+#include <thread>
 #include "libboardgame_base/FmtSaver.h"
 #include "libboardgame_base/Log.h"
+#include "libboardgame_base/MappedFile.h"
 #include "libboardgame_base/Options.h"
 #include "libboardgame_base/TreeReader.h"
 #include "libpentobi_base/Game.h"
 #include "libpentobi_base/MoveMarker.h"
 #include "libpentobi_mcts/LocalPoints.h"
+#include "libpentobi_mcts/PlayoutFeatures.h"
+#include "libpentobi_mcts/StaticEvaluator.h"
 
 using namespace std;
 using libboardgame_base::split;
 using libboardgame_base::FmtSaver;
+using libboardgame_base::MappedFile;
 using libboardgame_base::Options;
 using libboardgame_base::TreeReader;
 using libpentobi_base::Board;
@@ -34,6 +56,8 @@ using libpentobi_base::MoveMarker;
 using libpentobi_base::PointList;
 using libpentobi_base::Variant;
 using libpentobi_mcts::LocalPoints;
+using libpentobi_mcts::PlayoutFeatures;
+using libpentobi_mcts::StaticEvaluator;
 
 //-----------------------------------------------------------------------------
 
@@ -70,6 +94,23 @@ enum {
     _nu_features
 };
 
+/** Features of the playout policy, see State::init_gamma() */
+enum {
+    /** PlayoutFeatures::Compute::get_nu_local() */
+    playout_nu_local,
+
+    /** Score points of the piece multiplied by 4 (score points are a
+        multiple of 0.25 in GembloQ). */
+    playout_score_quarters,
+
+    /** Number of attach points of the piece. */
+    playout_nu_attach,
+
+    _nu_playout_features
+};
+
+const unsigned nu_playout_local = PlayoutFeatures::max_local + 1;
+
 struct Features
 {
     using IntType = uint_least8_t;
@@ -93,23 +134,58 @@ struct Features
     }
 };
 
-struct Sample
+/** Binary format of a training sample.
+    A sample is stored as the index of the played move and the number of
+    legal moves (both as uint32_t in host byte order), followed by the
+    features of each legal move (_nu_features values of type
+    Features::IntType for the move prior, then _nu_playout_features values of
+    the same type for the playout policy). The same format is used for the
+    in-memory samples and the samples in a feature file. */
+const size_t sample_header_size = 2 * sizeof(uint32_t);
+
+const size_t move_record_size = _nu_features + _nu_playout_features;
+
+/** Header of a feature file written with --extract.
+    The file is a cache on the machine that generated it and uses the host
+    byte order. The header is followed by the samples. */
+struct FeatureFileHeader
 {
-    unsigned played_move;
+    static constexpr uint32_t current_version = 2;
+
+
+    array<char, 8> magic;
+
+    uint32_t version;
+
+    uint32_t nu_features;
+
+    /** Variant as returned by libpentobi_base::to_string_id() */
+    array<char, 24> variant;
+
+    uint64_t nu_games;
+
+    uint64_t nu_positions;
+
+    uint64_t nu_moves;
+
+    uint64_t nu_samples;
+
+    Features feature_occured_globally;
 
-    vector<Features> features;
+    array<uint8_t, nu_playout_local> playout_local_occured_globally;
 };
 
+const array<char, 8> feature_file_magic = {
+    'P', 'B', 'L', 'F', 'E', 'A', 'T', '\0' };
+
 
 using Float = double;
 
 const Float step_size = 0.05;
 
-MoveMarker marker;
-
-MoveList moves;
-
-MoveList tmp_moves;
+/** Flush generated samples to the output after a game if the sample buffer
+    of a thread is larger than this size. */
+const size_t max_buffer_size = 16 * 1024 * 1024;
 
 long nu_games;
 
@@ -117,6 +193,8 @@ long nu_positions;
 
 long nu_moves;
 
+long nu_samples;
+
 random_device rand_dev;
 
 mt19937 rand_gen(rand_dev());
@@ -127,29 +205,102 @@ array<Float, _nu_features> weights;
 
 array<Float, _nu_features> grad_weights;
 
-GridExt<Features> feature_grid_point;
+Features feature_occured_globally;
 
-GridExt<Features> feature_grid_adj;
+/** Weights of the playout policy.
+    The log-gamma of a move is playout_weights[nu_local]
+    + score * playout_weights[playout_size_weight]
+    + (nu_attach - 1) * playout_weights[playout_nu_attach_weight]. */
+array<Float, nu_playout_local + 2> playout_weights;
 
-GridExt<Features> feature_grid_attach;
+array<Float, nu_playout_local + 2> grad_playout_weights;
 
-vector<Sample> samples;
+const unsigned playout_size_weight = nu_playout_local;
 
-LocalPoints local_points;
+const unsigned playout_nu_attach_weight = nu_playout_local + 1;
 
-Features feature_occured_globally;
+array<uint8_t, nu_playout_local> playout_local_occured_globally;
+
+/** Protects the variables that are shared between the sample generation
+    threads. */
+mutex output_mutex;
+
+bool has_variant;
+
+Variant variant;
+
+/** In-memory samples if the samples are not written to a feature file. */
+string sample_data;
+
+/** Feature file if the samples are written to a feature file. */
+ofstream* sample_out;
+
+
+/** Generates training samples from games.
+    Each thread uses its own instance, the results are merged into the
+    global variables protected by output_mutex. */
+class SampleGenerator
+{
+public:
+    /** Generate the samples for all games in a file. */
+    void gen_train_data(const string& file);
+
+    /** Write the remaining samples and add the statistics to the global
+        variables. */
+    void finish();
+
+private:
+    long nu_games = 0;
+
+    long nu_positions = 0;
+
+    long nu_moves = 0;
+
+    long nu_samples = 0;
+
+    MoveMarker marker;
+
+    MoveList moves;
 
+    GridExt<Features> feature_grid_point;
+
+    GridExt<Features> feature_grid_adj;
+
+    GridExt<Features> feature_grid_attach;
+
+    LocalPoints local_points;
+
+    PlayoutFeatures playout_features;
+
+    Features feature_occured_globally;
+
+    array<uint8_t, nu_playout_local> playout_local_occured_globally{};
+
+    string buffer;
+
+
+    template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH, bool IS_CALLISTO>
+    void add_sample(const Board& bd, Color to_play, Move played_mv);
+
+    void check_variant(Variant v);
+
+    void flush();
+};
 
 /** This function mirrors what is happening in PriorKnowledge::gen_children,
     but produces feature vectors instead of a gamma value for each move. */
 template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH, bool IS_CALLISTO>
-void add_sample(const Board& bd, Color to_play, Move played_mv)
+void SampleGenerator::add_sample(const Board& bd, Color to_play,
+                                 Move played_mv)
 {
     marker.clear();
     bd.gen_moves(to_play, marker, moves);
-    nu_moves += moves.size();
+    nu_moves += static_cast<long>(moves.size());
 
     local_points.init<MAX_SIZE, MAX_ADJ_ATTACH>(bd);
+    playout_features.init_snapshot(bd, to_play);
+    playout_features.restore_snapshot(bd);
+    playout_features.set_local<MAX_SIZE, MAX_ADJ_ATTACH, IS_CALLISTO>(bd);
     auto& geo = bd.get_geometry();
     auto variant = bd.get_variant();
     auto& is_forbidden = bd.is_forbidden(to_play);
@@ -249,9 +400,11 @@ void add_sample(const Board& bd, Color to_play, Move played_mv)
             }
     }
 
-    Sample sample;
-    sample.played_move = moves.size() + 1;
-    sample.features.reserve(moves.size());
+
+    auto nu_legal = static_cast<uint32_t>(moves.size());
+    auto played_move = nu_legal + 1;
+    auto header_pos = buffer.size();
+    buffer.resize(header_pos + sample_header_size);
     auto& bc = bd.get_board_const();
     auto move_info_array = bc.get_move_info_array();
     auto move_info_ext_array = bc.get_move_info_ext_array();
@@ -259,18 +412,20 @@ void add_sample(const Board& bd, Color to_play, Move played_mv)
     {
         auto mv = moves[i];
         if (mv == played_mv)
-            sample.played_move = i;
+            played_move = i;
         auto& info_ext = BoardConst::get_move_info_ext<MAX_ADJ_ATTACH>(
                     mv, move_info_ext_array);
         auto& info = BoardConst::get_move_info<MAX_SIZE>(mv, move_info_array);
         auto j = info.begin();
         Features features = feature_grid_point[*j];
         bool local = local_points.contains(*j);
+        PlayoutFeatures::Compute playout(*j, playout_features);
         for (unsigned k = 1; k < MAX_SIZE; ++k)
         {
             ++j;
             features += feature_grid_point[*j];
             local |= local_points.contains(*j);
+            playout.add(*j, playout_features);
         }
         if (local)
             features.feature[local_move] = 1;
@@ -297,7 +452,9 @@ void add_sample(const Board& bd, Color to_play, Move played_mv)
             for ( ; j != end; ++j)
                 features += feature_grid_adj[*j];
         }
-        switch (static_cast<unsigned>(bd.get_piece_info(info.get_piece()).get_score_points()))
+        auto piece = info.get_piece();
+        auto score_points = bd.get_piece_info(piece).get_score_points();
+        switch (static_cast<unsigned>(score_points))
         {
         case 0: features.feature[piece_score_0] = 1; break;
         case 1: features.feature[piece_score_1] = 1; break;
@@ -307,32 +464,91 @@ void add_sample(const Board& bd, Color to_play, Move played_mv)
         case 5: features.feature[piece_score_5] = 1; break;
         default: features.feature[piece_score_6] = 1; break;
         }
-        sample.features.push_back(features);
+        buffer.append(reinterpret_cast<const char*>(features.feature.data()),
+                      _nu_features);
         feature_occured_globally |= features;
+        array<Features::IntType, _nu_playout_features> playout_feature;
+        auto nu_local = playout.get_nu_local();
+        playout_feature[playout_nu_local] =
+                static_cast<Features::IntType>(nu_local);
+        playout_feature[playout_score_quarters] =
+                static_cast<Features::IntType>(4 * score_points);
+        playout_feature[playout_nu_attach] =
+                static_cast<Features::IntType>(
+                    bc.get_nu_attach_points(piece));
+        buffer.append(reinterpret_cast<const char*>(playout_feature.data()),
+                      _nu_playout_features);
+        playout_local_occured_globally[nu_local] = 1;
     }
-    if (sample.played_move == moves.size() + 1)
+    if (played_move == nu_legal + 1)
         throw runtime_error("game contains illegal move");
-    samples.push_back(sample);
+    memcpy(&buffer[header_pos], &played_move, sizeof(uint32_t));
+    memcpy(&buffer[header_pos + sizeof(uint32_t)], &nu_legal,
+           sizeof(uint32_t));
+    ++nu_samples;
+}
+
+void SampleGenerator::check_variant(Variant v)
+{
+    lock_guard<mutex> lock(output_mutex);
+    if (has_variant && v != variant)
+        throw runtime_error("Files have inconsistent game variants");
+    has_variant = true;
+    variant = v;
+}
+
+void SampleGenerator::finish()
+{
+    flush();
+    lock_guard<mutex> lock(output_mutex);
+    ::nu_games += nu_games;
+    ::nu_positions += nu_positions;
+    ::nu_moves += nu_moves;
+    ::nu_samples += nu_samples;
+    ::feature_occured_globally |= feature_occured_globally;
+    for (unsigned i = 0; i < nu_playout_local; ++i)
+        ::playout_local_occured_globally[i] |=
+                playout_local_occured_globally[i];
+}
+
+void SampleGenerator::flush()
+{
+    lock_guard<mutex> lock(output_mutex);
+    if (sample_out != nullptr)
+    {
+        sample_out->write(buffer.data(),
+                          static_cast<streamsize>(buffer.size()));
+        if (! *sample_out)
+            throw runtime_error("Could not write feature file");
+    }
+    else
+        sample_data.append(buffer);
+    buffer.clear();
 }
 
-void gen_train_data(const string& file, Variant& variant)
+void SampleGenerator::gen_train_data(const string& file)
 {
-    ifstream in(file);
-    if (! in)
+    unique_ptr<MappedFile> mapped_file;
+    try
+    {
+        mapped_file = make_unique<MappedFile>(file);
+    }
+    catch (const MappedFile::Error&)
+    {
         throw runtime_error("could not open " + file);
-    Game game(variant);
+    }
+    auto pos = mapped_file->begin();
+    Game game(Variant::classic_2);
     auto& bd = game.get_board();
     TreeReader reader;
     bool has_more;
     do
     {
-        has_more = reader.read(in, false);
+        has_more = reader.read(pos, mapped_file->end(), false);
         auto tree = reader.get_tree_transfer_ownership();
         game.init(tree);
-        if (nu_games > 0 && game.get_variant() != variant)
-            throw runtime_error("Files have inconsistent game variants");
+        check_variant(game.get_variant());
         ++nu_games;
-        variant = game.get_variant();
         auto max_piece_size = bd.get_board_const().get_max_piece_size();
         auto node = &game.get_root();
         do
@@ -357,6 +573,8 @@ void gen_train_data(const string& file, Variant& variant)
             node = node->get_first_child_or_null();
         }
         while (node != nullptr);
+        if (buffer.size() > max_buffer_size)
+            flush();
         cerr << '.';
         if (nu_games % 79 == 0)
             cerr << '\n';
@@ -364,47 +582,138 @@ void gen_train_data(const string& file, Variant& variant)
     while (has_more);
 }
 
-void print_weight(unsigned i, const char* name, bool is_member = true)
+/** Generate samples from a list of files using multiple threads.
+    The samples are written to sample_out if not null, otherwise they are
+    stored in sample_data. */
+void gen_train_data(const vector<string>& files, unsigned nu_threads)
+{
+    nu_games = 0;
+    nu_positions = 0;
+    nu_moves = 0;
+    nu_samples = 0;
+    has_variant = false;
+    feature_occured_globally = Features();
+    playout_local_occured_globally.fill(0);
+    sample_data.clear();
+    if (nu_threads == 0)
+        nu_threads = 1;
+    atomic<size_t> next_file(0);
+    mutex error_mutex;
+    string error;
+    auto worker = [&]
+    {
+        try
+        {
+            SampleGenerator generator;
+            size_t i;
+            while ((i = next_file++) < files.size())
+                generator.gen_train_data(files[i]);
+            generator.finish();
+        }
+        catch (const exception& e)
+        {
+            lock_guard<mutex> lock(error_mutex);
+            if (error.empty())
+                error = e.what();
+            next_file = files.size();
+        }
+    };
+    vector<thread> threads;
+    for (unsigned i = 1; i < nu_threads; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& t : threads)
+        t.join();
+    cerr << '\n';
+    if (! error.empty())
+        throw runtime_error(error);
+}
+
+/** Call a function for each sample in the binary sample format.
+    The function is called with the index of the played move, the number of
+    moves and a pointer to the features of the first move. The features of
+    the moves are move_record_size values apart. */
+template<class FUNCTION>
+void for_each_sample(const char* begin, const char* end, FUNCTION f)
 {
-    if (is_member)
-        cout << "m_";
-    cout << "gamma_" << name << " = ";
+    auto p = begin;
+    while (p != end)
+    {
+        if (static_cast<size_t>(end - p) < sample_header_size)
+            throw runtime_error("Truncated sample data");
+        uint32_t played_move;
+        uint32_t nu_moves;
+        memcpy(&played_move, p, sizeof(uint32_t));
+        memcpy(&nu_moves, p + sizeof(uint32_t), sizeof(uint32_t));
+        p += sample_header_size;
+        auto size = static_cast<size_t>(nu_moves) * move_record_size;
+        if (static_cast<size_t>(end - p) < size || played_move >= nu_moves)
+            throw runtime_error("Invalid sample data");
+        f(played_move, nu_moves,
+          reinterpret_cast<const Features::IntType*>(p));
+        p += size;
+    }
+}
+
+void print_weight(ostream& out, unsigned i, const char* name)
+{
+    out << name << ' ';
     if (feature_occured_globally.feature[i] == 0u)
-        cout << "1; // unused\n";
+        out << "0\n"; // unused
     else
-        cout << "exp(" << weights[i] << "f / temperature);\n";
+        out << weights[i] << '\n';
 }
 
-void print_weights()
+/** Write the weights in the format of libpentobi_mcts::Weights.
+    The temperature is not written, the move prior weights are used with the
+    default temperature of the game variant. Playout gammas for numbers of
+    local points that did not occur in the games are not written and keep
+    their default value. */
+void print_weights(ostream& out)
 {
-    FmtSaver saver(cout);
-    cout << std::fixed << setprecision(3);
-    print_weight(point_other, "point_other");
-    print_weight(point_opp_attach_or_nb, "point_opp_attach_or_nb");
-    print_weight(point_second_color_attach, "point_second_color_attach");
-    print_weight(adj_connect, "adj_connect");
-    print_weight(adj_occupied_other, "adj_occupied_other");
-    print_weight(adj_forbidden_other, "adj_forbidden_other");
-    print_weight(adj_own_attach, "adj_own_attach");
-    print_weight(adj_nonforbidden, "adj_nonforbidden");
-    print_weight(attach_to_play, "attach_to_play");
-    print_weight(attach_forbidden_other, "attach_forbidden_other");
-    print_weight(attach_nonforbidden_0, "attach_nonforbidden[0]");
-    print_weight(attach_nonforbidden_1, "attach_nonforbidden[1]");
-    print_weight(attach_nonforbidden_2, "attach_nonforbidden[2]");
-    print_weight(attach_nonforbidden_3, "attach_nonforbidden[3]");
-    print_weight(attach_nonforbidden_4, "attach_nonforbidden[4]");
-    print_weight(attach_nonforbidden_5, "attach_nonforbidden[5]");
-    print_weight(attach_nonforbidden_6, "attach_nonforbidden[6]");
-    print_weight(attach_second_color, "attach_second_color");
-    print_weight(local_move, "local");
-    print_weight(piece_score_0, "piece_score_0", false);
-    print_weight(piece_score_1, "piece_score_1", false);
-    print_weight(piece_score_2, "piece_score_2", false);
-    print_weight(piece_score_3, "piece_score_3", false);
-    print_weight(piece_score_4, "piece_score_4", false);
-    print_weight(piece_score_5, "piece_score_5", false);
-    print_weight(piece_score_6, "piece_score_6", false);
+    FmtSaver saver(out);
+    out << std::fixed << setprecision(3);
+    if (has_variant)
+        out << "variant " << to_string_id(variant) << '\n';
+    print_weight(out, point_other, "point_other");
+    print_weight(out, point_opp_attach_or_nb, "point_opp_attach_or_nb");
+    print_weight(out, point_second_color_attach, "point_second_color_attach");
+    print_weight(out, adj_connect, "adj_connect");
+    print_weight(out, adj_occupied_other, "adj_occupied_other");
+    print_weight(out, adj_forbidden_other, "adj_forbidden_other");
+    print_weight(out, adj_own_attach, "adj_own_attach");
+    print_weight(out, adj_nonforbidden, "adj_nonforbidden");
+    print_weight(out, attach_to_play, "attach_to_play");
+    print_weight(out, attach_forbidden_other, "attach_forbidden_other");
+    print_weight(out, attach_nonforbidden_0, "attach_nonforbidden[0]");
+    print_weight(out, attach_nonforbidden_1, "attach_nonforbidden[1]");
+    print_weight(out, attach_nonforbidden_2, "attach_nonforbidden[2]");
+    print_weight(out, attach_nonforbidden_3, "attach_nonforbidden[3]");
+    print_weight(out, attach_nonforbidden_4, "attach_nonforbidden[4]");
+    print_weight(out, attach_nonforbidden_5, "attach_nonforbidden[5]");
+    print_weight(out, attach_nonforbidden_6, "attach_nonforbidden[6]");
+    print_weight(out, attach_second_color, "attach_second_color");
+    print_weight(out, local_move, "local");
+    print_weight(out, piece_score_0, "piece_score[0]");
+    print_weight(out, piece_score_1, "piece_score[1]");
+    print_weight(out, piece_score_2, "piece_score[2]");
+    print_weight(out, piece_score_3, "piece_score[3]");
+    print_weight(out, piece_score_4, "piece_score[4]");
+    print_weight(out, piece_score_5, "piece_score[5]");
+    print_weight(out, piece_score_6, "piece_score[6]");
+    // Playout gammas are relative to the gamma for no local points
+    out << setprecision(6) << defaultfloat;
+    for (unsigned i = 0; i < nu_playout_local; ++i)
+        if (playout_local_occured_globally[i] != 0)
+        {
+            auto gamma = exp(playout_weights[i] - playout_weights[0]);
+            gamma = min(gamma, Float(numeric_limits<float>::max()));
+            out << "playout_local[" << i << "] " << gamma << '\n';
+        }
+    out << "playout_size_factor "
+        << exp(playout_weights[playout_size_weight]) << '\n'
+        << "playout_nu_attach_factor "
+        << exp(playout_weights[playout_nu_attach_weight]) << '\n';
 }
 
 void init_weights()
@@ -412,23 +721,35 @@ void init_weights()
     normal_distribution<Float> distribution(0, 0.01);
     for (auto& w : weights)
         w = distribution(rand_gen);
+    for (auto& w : playout_weights)
+        w = distribution(rand_gen);
 }
 
-/** Gradient descent step using softmax training. */
-void train_step(unsigned step, bool print)
+/** Gradient descent step using softmax training.
+    The move prior and the playout policy are trained as two independent
+    softmax models on the same samples.
+    @param step
+    @param print
+    @param begin Start of the samples in the binary sample format.
+    @param end End of the samples. */
+void train_step(unsigned step, bool print, const char* begin,
+                const char* end)
 {
     for (auto& w : grad_weights)
         w = 0;
+    for (auto& w : grad_playout_weights)
+        w = 0;
 
     Float cost = 0;
-    for (auto& sample : samples)
+    Float playout_cost = 0;
+    for_each_sample(begin, end, [&](uint32_t played_move, uint32_t nu_moves,
+                                    const Features::IntType* features)
     {
-        auto nu_moves = sample.features.size();
         probs.resize(nu_moves);
         Float sum = 0;
         for (size_t i = 0; i < nu_moves; ++i)
         {
-            auto& feature = sample.features[i].feature;
+            auto feature = features + i * move_record_size;
             probs[i] = 0;
             for (unsigned j = 0; j < _nu_features; ++j)
                 probs[i] += weights[j] * feature[j];
@@ -440,8 +761,8 @@ void train_step(unsigned step, bool print)
         for (size_t i = 0; i < nu_moves; ++i)
         {
             auto p = probs[i];
-            auto& feature = sample.features[i].feature;
-            if (i == sample.played_move)
+            auto feature = features + i * move_record_size;
+            if (i == played_move)
             {
                 for (unsigned j = 0; j < _nu_features; ++j)
                     grad_weights[j] -= (1 - p) * feature[j];
@@ -452,10 +773,43 @@ void train_step(unsigned step, bool print)
                     grad_weights[j] -= (-p) * feature[j];
             }
         }
-        cost += -log(probs[sample.played_move]);
-    }
+        cost += -log(probs[played_move]);
+
+        // Playout policy. Log-gammas are shifted by their maximum to avoid
+        // overflows.
+        Float max_log_gamma = -numeric_limits<Float>::max();
+        for (size_t i = 0; i < nu_moves; ++i)
+        {
+            auto feature = features + i * move_record_size + _nu_features;
+            probs[i] =
+                playout_weights[feature[playout_nu_local]]
+                + 0.25 * feature[playout_score_quarters]
+                  * playout_weights[playout_size_weight]
+                + (feature[playout_nu_attach] - 1)
+                  * playout_weights[playout_nu_attach_weight];
+            max_log_gamma = max(max_log_gamma, probs[i]);
+        }
+        sum = 0;
+        for (size_t i = 0; i < nu_moves; ++i)
+        {
+            probs[i] = exp(probs[i] - max_log_gamma);
+            sum += probs[i];
+        }
+        for (size_t i = 0; i < nu_moves; ++i)
+        {
+            auto p = probs[i] / sum;
+            auto feature = features + i * move_record_size + _nu_features;
+            auto g = (i == played_move ? 1 - p : -p);
+            grad_playout_weights[feature[playout_nu_local]] -= g;
+            grad_playout_weights[playout_size_weight] -=
+                    g * 0.25 * feature[playout_score_quarters];
+            grad_playout_weights[playout_nu_attach_weight] -=
+                    g * (feature[playout_nu_attach] - 1);
+        }
+        playout_cost += -log(probs[played_move] / sum);
+    });
 
-    auto nu_samples = static_cast<Float>(samples.size());
+    auto nu_samples = static_cast<Float>(::nu_samples);
     Float decay = 1e-3;
     for (unsigned i = 0; i < _nu_features; ++i)
     {
@@ -463,36 +817,251 @@ void train_step(unsigned step, bool print)
         auto dw = grad_weights[i] / nu_samples + decay * w;
         w += -step_size * dw;
     }
+    for (unsigned i = 0; i < playout_weights.size(); ++i)
+    {
+        auto& w = playout_weights[i];
+        auto dw = grad_playout_weights[i] / nu_samples + decay * w;
+        w += -step_size * dw;
+    }
 
     cost /= nu_samples;
+    playout_cost /= nu_samples;
 
     if (print)
     {
         LIBBOARDGAME_LOG("Step ", step);
         LIBBOARDGAME_LOG("Cost ", cost);
-        print_weights();
+        LIBBOARDGAME_LOG("Playout cost ", playout_cost);
+        print_weights(cout);
+    }
+}
+
+void log_statistics()
+{
+    LIBBOARDGAME_LOG(nu_games, " games");
+    LIBBOARDGAME_LOG(nu_positions, " positions");
+    if (nu_positions > 0)
+        LIBBOARDGAME_LOG(double(nu_moves) / double(nu_positions),
+                         " moves/pos");
+}
+
+void train(const char* begin, const char* end, unsigned steps)
+{
+    if (nu_samples == 0)
+        return;
+    init_weights();
+    for (unsigned i = 1; i <= steps; ++i)
+        train_step(i, i % 100 == 0 || i == steps, begin, end);
+}
+
+void train(const string& file_list, unsigned steps, unsigned nu_threads)
+{
+    sample_out = nullptr;
+    gen_train_data(split(file_list, ','), nu_threads);
+    LIBBOARDGAME_LOG("Files: ", file_list);
+    log_statistics();
+    train(sample_data.data(), sample_data.data() + sample_data.size(),
+          steps);
+}
+
+/** Write the samples of a list of files to a feature file. */
+void extract(const string& file_list, const string& feature_file,
+             unsigned nu_threads)
+{
+    ofstream out(feature_file, ios::binary);
+    if (! out)
+        throw runtime_error("Could not create " + feature_file);
+    FeatureFileHeader header{};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    sample_out = &out;
+    gen_train_data(split(file_list, ','), nu_threads);
+    sample_out = nullptr;
+    header.magic = feature_file_magic;
+    header.version = FeatureFileHeader::current_version;
+    header.nu_features = _nu_features;
+    if (has_variant)
+        strncpy(header.variant.data(), to_string_id(variant),
+                header.variant.size() - 1);
+    header.nu_games = static_cast<uint64_t>(nu_games);
+    header.nu_positions = static_cast<uint64_t>(nu_positions);
+    header.nu_moves = static_cast<uint64_t>(nu_moves);
+    header.nu_samples = static_cast<uint64_t>(nu_samples);
+    header.feature_occured_globally = feature_occured_globally;
+    header.playout_local_occured_globally = playout_local_occured_globally;
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if (! out)
+        throw runtime_error("Could not write " + feature_file);
+    LIBBOARDGAME_LOG("Files: ", file_list);
+    log_statistics();
+    LIBBOARDGAME_LOG("Wrote ", feature_file);
+}
+
+/** Train with the samples from a feature file written by extract(). */
+void train_features(const string& feature_file, unsigned steps)
+{
+    MappedFile file(feature_file);
+    FeatureFileHeader header;
+    if (file.size() < sizeof(header))
+        throw runtime_error(feature_file + " is not a feature file");
+    memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != feature_file_magic)
+        throw runtime_error(feature_file + " is not a feature file");
+    if (header.version != FeatureFileHeader::current_version
+            || header.nu_features != _nu_features)
+        throw runtime_error(feature_file + " has an incompatible version");
+    header.variant.back() = '\0';
+    LIBBOARDGAME_LOG("Features: ", feature_file);
+    LIBBOARDGAME_LOG("Variant: ", header.variant.data());
+    has_variant = parse_variant_id(header.variant.data(), variant);
+    nu_games = static_cast<long>(header.nu_games);
+    nu_positions = static_cast<long>(header.nu_positions);
+    nu_moves = static_cast<long>(header.nu_moves);
+    nu_samples = static_cast<long>(header.nu_samples);
+    feature_occured_globally = header.feature_occured_globally;
+    playout_local_occured_globally = header.playout_local_occured_globally;
+    log_statistics();
+    train(file.data() + sizeof(header), file.end(), steps);
+}
+
+/** Solve a system of linear equations a * x = b with Gaussian elimination.
+    @throws runtime_error if the system is singular. */
+template<size_t N>
+array<Float, N> solve(array<array<Float, N>, N> a, array<Float, N> b)
+{
+    for (size_t i = 0; i < N; ++i)
+    {
+        auto pivot = i;
+        for (auto j = i + 1; j < N; ++j)
+            if (fabs(a[j][i]) > fabs(a[pivot][i]))
+                pivot = j;
+        if (fabs(a[pivot][i]) < 1e-9)
+            throw runtime_error("Features are linearly dependent");
+        swap(a[i], a[pivot]);
+        swap(b[i], b[pivot]);
+        for (auto j = i + 1; j < N; ++j)
+        {
+            auto f = a[j][i] / a[i][i];
+            for (auto k = i; k < N; ++k)
+                a[j][k] -= f * a[i][k];
+            b[j] -= f * b[i];
+        }
     }
+    array<Float, N> x;
+    for (auto i = N; i-- > 0; )
+    {
+        x[i] = b[i];
+        for (auto j = i + 1; j < N; ++j)
+            x[i] -= a[i][j] * x[j];
+        x[i] /= a[i][i];
+    }
+    return x;
 }
 
-void train(const string& file_list, unsigned steps)
+/** Learn the weights of the static evaluator used for the playout cutoff.
+    The points gained by a color until the end of the game are regressed on
+    the features of StaticEvaluator in all positions of the games with a
+    least-squares fit without intercept. The standard deviation of the
+    residual is used as the standard deviation of the error of the
+    estimate. */
+void train_evaluator(const string& file_list, ostream& out)
 {
+    const size_t n = 3;
+    array<array<Float, n>, n> xx{};
+    array<Float, n> xy{};
+    Float yy = 0;
+    long nu_obs = 0;
+    StaticEvaluator evaluator;
+    unique_ptr<Game> game_ptr;
+    has_variant = false;
     nu_games = 0;
     nu_positions = 0;
-    nu_moves = 0;
-        auto files = split(file_list, ',');
-    Variant variant = Variant::classic_2;
-    for (auto& file : files)
-        gen_train_data(file, variant);
-    cerr << '\n';
+    for (auto& file : split(file_list, ','))
+    {
+        unique_ptr<MappedFile> mapped_file;
+        try
+        {
+            mapped_file = make_unique<MappedFile>(file);
+        }
+        catch (const MappedFile::Error&)
+        {
+            throw runtime_error("could not open " + file);
+        }
+        auto pos = mapped_file->begin();
+        TreeReader reader;
+        bool has_more;
+        do
+        {
+            has_more = reader.read(pos, mapped_file->end(), false);
+            auto tree = reader.get_tree_transfer_ownership();
+            if (! game_ptr)
+                game_ptr = make_unique<Game>(Variant::classic_2);
+            auto& game = *game_ptr;
+            game.init(tree);
+            if (has_variant && game.get_variant() != variant)
+                throw runtime_error("Files have inconsistent game variants");
+            has_variant = true;
+            variant = game.get_variant();
+            ++nu_games;
+            auto& bd = game.get_board();
+            auto nu_colors = bd.get_nu_colors();
+            auto node = &game.get_root();
+            while (node->has_children())
+                node = &node->get_first_child();
+            game.goto_node(*node);
+            array<Float, Color::range> final_points;
+            for (Color c : Color::Range(nu_colors))
+                final_points[c.to_int()] =
+                        static_cast<Float>(bd.get_points(c));
+            node = &game.get_root();
+            do
+            {
+                game.goto_node(*node);
+                ++nu_positions;
+                for (Color c : Color::Range(nu_colors))
+                {
+                    StaticEvaluator::Features f;
+                    evaluator.get_features(bd, c, f);
+                    array<Float, n> x = {f.attach, f.area, f.points_left};
+                    auto y = final_points[c.to_int()]
+                            - static_cast<Float>(bd.get_points(c));
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        for (size_t j = 0; j < n; ++j)
+                            xx[i][j] += x[i] * x[j];
+                        xy[i] += x[i] * y;
+                    }
+                    yy += y * y;
+                    ++nu_obs;
+                }
+                node = node->get_first_child_or_null();
+            }
+            while (node != nullptr);
+        }
+        while (has_more);
+    }
     LIBBOARDGAME_LOG("Files: ", file_list);
     LIBBOARDGAME_LOG(nu_games, " games");
     LIBBOARDGAME_LOG(nu_positions, " positions");
-    if (nu_positions == 0)
+    if (nu_obs == 0)
         return;
-    LIBBOARDGAME_LOG(double(nu_moves) / double(nu_positions), " moves/pos");
-    init_weights();
-    for (unsigned i = 1; i <= steps; ++i)
-        train_step(i, i % 100 == 0 || i == steps);
+    auto w = solve(xx, xy);
+    auto rss = yy;
+    for (size_t i = 0; i < n; ++i)
+    {
+        rss -= 2 * w[i] * xy[i];
+        for (size_t j = 0; j < n; ++j)
+            rss += w[i] * w[j] * xx[i][j];
+    }
+    auto sigma = sqrt(max(rss, Float(0)) / static_cast<Float>(nu_obs));
+    FmtSaver saver(out);
+    out << std::fixed << setprecision(3);
+    out << "variant " << to_string_id(variant) << '\n'
+        << "cutoff_attach " << w[0] << '\n'
+        << "cutoff_area " << w[1] << '\n'
+        << "cutoff_pieces_left " << w[2] << '\n'
+        << "cutoff_sigma " << sigma << '\n';
 }
 
 } // namespace
@@ -505,11 +1074,49 @@ int main(int argc, char** argv)
     try
     {
         vector<string> specs = {
+            "evaluator",
+            "extract:",
+            "features:",
             "sgffiles:",
-            "steps:"
+            "steps:",
+            "threads:",
+            "weights:"
         };
         Options opt(argc, argv, specs);
-        train(opt.get("sgffiles"), opt.get<unsigned>("steps", 3000));
+        auto steps = opt.get<unsigned>("steps", 3000);
+        auto nu_threads =
+                opt.get<unsigned>("threads", thread::hardware_concurrency());
+        if (opt.contains("evaluator"))
+        {
+            ostringstream weights;
+            train_evaluator(opt.get("sgffiles"), weights);
+            cout << weights.str();
+            if (opt.contains("weights"))
+            {
+                ofstream out(opt.get("weights"));
+                out << weights.str();
+                if (! out)
+                    throw runtime_error("Could not write "
+                                        + opt.get("weights"));
+            }
+            return 0;
+        }
+        if (opt.contains("features"))
+            train_features(opt.get("features"), steps);
+        else if (opt.contains("extract"))
+        {
+            extract(opt.get("sgffiles"), opt.get("extract"), nu_threads);
+            return 0;
+        }
+        else
+            train(opt.get("sgffiles"), steps, nu_threads);
+        if (opt.contains("weights"))
+        {
+            ofstream out(opt.get("weights"));
+            print_weights(out);
+            if (! out)
+                throw runtime_error("Could not write " + opt.get("weights"));
+        }
     }
     catch (const exception& e)
     {
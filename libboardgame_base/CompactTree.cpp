@@ -0,0 +1,281 @@
+//-----------------------------------------------------------------------------
+/** @file libboardgame_base/CompactTree.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "CompactTree.h"
+
+#include <algorithm>
+
+namespace libboardgame_base {
+
+//-----------------------------------------------------------------------------
+
+CompactTree::CompactTree()
+{
+    clear();
+}
+
+CompactTree::CompactTree(const SgfNode& root)
+{
+    clear();
+    append(null_node, root);
+}
+
+CompactTree::~CompactTree() = default; // Non-inline to avoid GCC -Winline warning
+
+void CompactTree::add_property(string_view id,
+                               const vector<string_view>& values)
+{
+    LIBBOARDGAME_ASSERT(! empty());
+    LIBBOARDGAME_ASSERT(! values.empty());
+    auto property_id = intern(id);
+    auto node = static_cast<NodeIndex>(m_nodes.size() - 1);
+    auto property = find_property(node, property_id);
+    if (property != get_properties_end(node))
+    {
+        replace_property(property, values);
+        return;
+    }
+    // Overwrite the sentinel and add a new one
+    m_properties.back().id = property_id;
+    for (auto& v : values)
+        add_value(v);
+    m_properties.push_back(
+                {static_cast<uint32_t>(m_values.size() - 1), null_id});
+}
+
+void CompactTree::add_value(string_view value)
+{
+    if (m_pool.size() + value.size() >= numeric_limits<uint32_t>::max()
+            || m_values.size() >= numeric_limits<uint32_t>::max())
+        throw runtime_error("SGF tree too large");
+    m_pool.append(value);
+    m_values.push_back(static_cast<uint32_t>(m_pool.size()));
+}
+
+auto CompactTree::append(NodeIndex parent, const SgfNode& node) -> NodeIndex
+{
+    auto result = create_node(parent);
+    append_properties(node);
+    // Iterative pre-order traversal, the main variation of a game can be too
+    // deep for recursion
+    auto current = &node;
+    auto current_index = result;
+    while (true)
+    {
+        if (current->has_children())
+        {
+            current = &current->get_first_child();
+            current_index = create_node(current_index);
+        }
+        else
+        {
+            while (current != &node && current->get_sibling() == nullptr)
+            {
+                current = &current->get_parent();
+                current_index = get_parent(current_index);
+            }
+            if (current == &node)
+                break;
+            current = current->get_sibling();
+            current_index = create_node(get_parent(current_index));
+        }
+        append_properties(*current);
+    }
+    return result;
+}
+
+void CompactTree::append_properties(const SgfNode& node)
+{
+    vector<string_view> values;
+    for (auto& p : node.get_properties())
+    {
+        values.assign(p.values.begin(), p.values.end());
+        add_property(p.id, values);
+    }
+}
+
+void CompactTree::clear()
+{
+    m_nodes.clear();
+    m_pool.clear();
+    m_values.assign(1, 0);
+    m_properties.assign(1, {0, null_id});
+}
+
+auto CompactTree::create_node(NodeIndex parent) -> NodeIndex
+{
+    LIBBOARDGAME_ASSERT(parent != null_node || empty());
+    LIBBOARDGAME_ASSERT(parent == null_node || parent < m_nodes.size());
+    LIBBOARDGAME_ASSERT(parent == null_node || is_last_or_ancestor(parent));
+    if (m_nodes.size() >= null_node)
+        throw runtime_error("SGF tree too large");
+    auto node = static_cast<NodeIndex>(m_nodes.size());
+    m_nodes.push_back({parent, null_node, null_node,
+                       static_cast<PropertyIndex>(m_properties.size() - 1)});
+    if (parent != null_node)
+    {
+        auto child = m_nodes[parent].first_child;
+        if (child == null_node)
+            m_nodes[parent].first_child = node;
+        else
+        {
+            while (m_nodes[child].sibling != null_node)
+                child = m_nodes[child].sibling;
+            m_nodes[child].sibling = node;
+        }
+    }
+    return node;
+}
+
+auto CompactTree::find_id(string_view id) const -> PropertyId
+{
+    // The number of different identifiers is small, a linear search is
+    // faster than a hash table
+    for (size_t i = 0; i < m_ids.size(); ++i)
+        if (m_ids[i] == id)
+            return static_cast<PropertyId>(i);
+    return null_id;
+}
+
+auto CompactTree::find_property(NodeIndex node, PropertyId id) const
+    -> PropertyIndex
+{
+    auto end = get_properties_end(node);
+    for (auto i = get_properties_begin(node); i != end; ++i)
+        if (m_properties[i].id == id)
+            return i;
+    return end;
+}
+
+const string& CompactTree::get_id(PropertyId id) const
+{
+    LIBBOARDGAME_ASSERT(id < m_ids.size());
+    return m_ids[id];
+}
+
+size_t CompactTree::get_memory() const
+{
+    return m_nodes.capacity() * sizeof(Node)
+            + m_properties.capacity() * sizeof(PropertyEntry)
+            + m_values.capacity() * sizeof(uint32_t) + m_pool.capacity();
+}
+
+unsigned CompactTree::get_nu_children(NodeIndex node) const
+{
+    unsigned n = 0;
+    for (auto i = get_first_child(node); i != null_node; i = get_sibling(i))
+        ++n;
+    return n;
+}
+
+string_view CompactTree::get_property(NodeIndex node, PropertyId id) const
+{
+    auto property = find_property(node, id);
+    if (property == get_properties_end(node))
+        throw MissingProperty(id < m_ids.size() ? m_ids[id] : string());
+    return get_value(property);
+}
+
+string_view CompactTree::get_property(NodeIndex node, string_view id) const
+{
+    auto property = find_property(node, find_id(id));
+    if (property == get_properties_end(node))
+        throw MissingProperty(string(id));
+    return get_value(property);
+}
+
+auto CompactTree::intern(string_view id) -> PropertyId
+{
+    auto result = find_id(id);
+    if (result != null_id)
+        return result;
+    if (m_ids.size() >= null_id)
+        throw runtime_error("Too many SGF property identifiers");
+    m_ids.emplace_back(id);
+    return static_cast<PropertyId>(m_ids.size() - 1);
+}
+
+bool CompactTree::is_last_or_ancestor(NodeIndex node) const
+{
+    for (auto i = static_cast<NodeIndex>(m_nodes.size() - 1); i != null_node;
+         i = m_nodes[i].parent)
+        if (i == node)
+            return true;
+    return false;
+}
+
+void CompactTree::replace_property(PropertyIndex property,
+                                   const vector<string_view>& values)
+{
+    // Only happens for duplicate properties in a node, so it is sufficient
+    // to remove the properties of the last node and add them again.
+    auto node = static_cast<NodeIndex>(m_nodes.size() - 1);
+    vector<pair<PropertyId, vector<string>>> properties;
+    for (auto i = get_properties_begin(node); i != get_properties_end(node);
+         ++i)
+    {
+        properties.emplace_back(m_properties[i].id, vector<string>());
+        if (i == property)
+            properties.back().second.assign(values.begin(), values.end());
+        else
+            for (unsigned j = 0; j < get_nu_values(i); ++j)
+                properties.back().second.emplace_back(get_value(i, j));
+    }
+    auto first = get_properties_begin(node);
+    auto first_value = m_properties[first].first_value;
+    m_pool.resize(m_values[first_value]);
+    m_values.resize(first_value + 1);
+    m_properties.resize(first + 1);
+    m_properties.back().id = null_id;
+    vector<string_view> views;
+    for (auto& p : properties)
+    {
+        views.assign(p.second.begin(), p.second.end());
+        add_property(m_ids[p.first], views);
+    }
+}
+
+void CompactTree::shrink_to_fit()
+{
+    m_nodes.shrink_to_fit();
+    m_properties.shrink_to_fit();
+    m_values.shrink_to_fit();
+    m_pool.shrink_to_fit();
+}
+
+unique_ptr<SgfNode> CompactTree::to_sgf_node(NodeIndex node) const
+{
+    LIBBOARDGAME_ASSERT(node < m_nodes.size());
+    // The nodes are stored in pre-order, so the subtree of a node is a
+    // contiguous range of indices starting at the node, which ends at the
+    // first node whose parent is not in the subtree.
+    vector<SgfNode*> nodes;
+    auto result = make_unique<SgfNode>();
+    vector<string> values;
+    for (NodeIndex i = node; i < m_nodes.size(); ++i)
+    {
+        SgfNode* sgf_node;
+        if (i == node)
+            sgf_node = result.get();
+        else if (m_nodes[i].parent != null_node && m_nodes[i].parent >= node)
+            sgf_node = &nodes[m_nodes[i].parent - node]->create_new_child();
+        else
+            break;
+        nodes.push_back(sgf_node);
+        for (auto j = get_properties_begin(i); j != get_properties_end(i); ++j)
+        {
+            values.clear();
+            for (unsigned k = 0; k < get_nu_values(j); ++k)
+                values.emplace_back(get_value(j, k));
+            sgf_node->set_property(m_ids[m_properties[j].id], values);
+        }
+    }
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libboardgame_base
@@ -0,0 +1,317 @@
+//-----------------------------------------------------------------------------
+/** @file libboardgame_base/CompactTree.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBBOARDGAME_BASE_COMPACT_TREE_H
+#define LIBBOARDGAME_BASE_COMPACT_TREE_H
+
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include "SgfNode.h"
+
+namespace libboardgame_base {
+
+//-----------------------------------------------------------------------------
+
+/** Compact representation of an SGF game tree for read-mostly use.
+    SgfNode allocates every node, property and value separately, which
+    uses several hundred bytes for a node with a single move property and
+    makes loading large trees (e.g. opening books or collections of games)
+    slow. CompactTree stores the nodes, properties and values in a few
+    arrays that grow like an arena. Property identifiers are interned to
+    small integers, so a lookup of a property compares integers instead of
+    strings, and the values are offsets into a shared string pool.
+
+    Nodes are referenced by their index, the root has index 0. The tree can
+    only grow in pre-order (see create_node()), which is the order in which
+    nodes are read from SGF files or visited during the conversion of an
+    SgfNode. For editing, the tree can be converted into an SgfNode with
+    to_sgf_node(). */
+class CompactTree
+{
+public:
+    using NodeIndex = uint32_t;
+
+    using PropertyIndex = uint32_t;
+
+    using PropertyId = uint16_t;
+
+    static constexpr NodeIndex null_node = numeric_limits<NodeIndex>::max();
+
+    static constexpr PropertyId null_id = numeric_limits<PropertyId>::max();
+
+
+    /** Construct an empty tree. */
+    CompactTree();
+
+    /** Construct a tree from a copy of an SgfNode and its subtree. */
+    explicit CompactTree(const SgfNode& root);
+
+    ~CompactTree();
+
+
+    /** Remove all nodes.
+        Keeps the allocated memory and the interned property identifiers, so
+        that the tree can be reused efficiently for reading many trees. */
+    void clear();
+
+    bool empty() const { return m_nodes.empty(); }
+
+    unsigned get_nu_nodes() const {
+        return static_cast<unsigned>(m_nodes.size());
+    }
+
+    /** @pre ! empty() */
+    NodeIndex get_root() const;
+
+    NodeIndex get_parent(NodeIndex node) const;
+
+    NodeIndex get_first_child(NodeIndex node) const;
+
+    NodeIndex get_sibling(NodeIndex node) const;
+
+    bool has_children(NodeIndex node) const;
+
+    unsigned get_nu_children(NodeIndex node) const;
+
+
+    /** @name Property identifiers */
+    /** @{ */
+
+    /** Get the interned integer for a property identifier.
+        @return The interned identifier or null_id if no property with this
+        identifier was ever added to the tree. */
+    PropertyId find_id(string_view id) const;
+
+    /** Get the identifier string for an interned identifier. */
+    const string& get_id(PropertyId id) const;
+
+    unsigned get_nu_ids() const { return static_cast<unsigned>(m_ids.size()); }
+
+    /** @} */ // @name
+
+
+    /** @name Properties
+        The properties of a node are the range [get_properties_begin(),
+        get_properties_end()) of property indices in the order in which they
+        were added. */
+    /** @{ */
+
+    PropertyIndex get_properties_begin(NodeIndex node) const;
+
+    PropertyIndex get_properties_end(NodeIndex node) const;
+
+    PropertyId get_property_id(PropertyIndex property) const;
+
+    unsigned get_nu_values(PropertyIndex property) const;
+
+    /** Get a value of a property.
+        The view is valid until the tree is modified.
+        @pre i < get_nu_values(property) */
+    string_view get_value(PropertyIndex property, unsigned i = 0) const;
+
+    /** Find a property of a node.
+        @return The property index or get_properties_end(node) if the node has
+        no such property. */
+    PropertyIndex find_property(NodeIndex node, PropertyId id) const;
+
+    bool has_property(NodeIndex node, PropertyId id) const;
+
+    bool has_property(NodeIndex node, string_view id) const;
+
+    /** Get the first value of a property.
+        @throws MissingProperty */
+    string_view get_property(NodeIndex node, PropertyId id) const;
+
+    /** Get the first value of a property.
+        @throws MissingProperty */
+    string_view get_property(NodeIndex node, string_view id) const;
+
+    /** @} */ // @name
+
+
+    /** @name Building the tree */
+    /** @{ */
+
+    /** Create a new node as the last child of a node.
+        Properties can only be added to the node that was created last, so
+        the tree must be built in pre-order. to_sgf_node() relies on this
+        order, in which the subtree of a node is a contiguous range of
+        indices.
+        @param parent The parent or null_node to create the root.
+        @pre parent != null_node || empty()
+        @pre parent == null_node || parent is the node that was created last
+        or one of its ancestors
+        @throws runtime_error if the tree exceeds the maximum size */
+    NodeIndex create_node(NodeIndex parent);
+
+    /** Intern a property identifier.
+        @throws runtime_error if the maximum number of identifiers is
+        exceeded */
+    PropertyId intern(string_view id);
+
+    /** Add a property to the node that was created last.
+        If the node already has a property with this identifier, its values
+        are replaced like in SgfNode::set_property().
+        @pre ! empty()
+        @pre ! values.empty() */
+    void add_property(string_view id, const vector<string_view>& values);
+
+    /** Append a copy of an SgfNode and its subtree.
+        @param parent The parent or null_node to create the root.
+        @pre Same as for create_node()
+        @return The index of the copied node. */
+    NodeIndex append(NodeIndex parent, const SgfNode& node);
+
+    /** Release memory that was reserved for growing the tree. */
+    void shrink_to_fit();
+
+    /** @} */ // @name
+
+
+    /** Convert a node and its subtree into an SgfNode. */
+    unique_ptr<SgfNode> to_sgf_node(NodeIndex node) const;
+
+    /** Convert the whole tree into an SgfNode.
+        @pre ! empty() */
+    unique_ptr<SgfNode> to_sgf_node() const { return to_sgf_node(get_root()); }
+
+    /** Get the allocated memory in bytes (without the identifiers). */
+    size_t get_memory() const;
+
+private:
+    struct Node
+    {
+        NodeIndex parent;
+
+        NodeIndex first_child;
+
+        NodeIndex sibling;
+
+        /** Index of the first property.
+            The properties of a node end at the first property of the next
+            node, or at the end of the property array for the last node. */
+        PropertyIndex first_property;
+    };
+
+    struct PropertyEntry
+    {
+        /** Index of the first value in m_values.
+            The values end at the first value of the next property. The last
+            entry in m_properties is a sentinel that marks the end of the
+            values of the last property. */
+        uint32_t first_value;
+
+        PropertyId id;
+    };
+
+    vector<Node> m_nodes;
+
+    vector<PropertyEntry> m_properties;
+
+    /** Offsets of the values in m_pool.
+        A value ends at the offset of the next value. The last entry is a
+        sentinel containing the size of m_pool. */
+    vector<uint32_t> m_values;
+
+    string m_pool;
+
+    vector<string> m_ids;
+
+
+    void add_value(string_view value);
+
+    void append_properties(const SgfNode& node);
+
+    bool is_last_or_ancestor(NodeIndex node) const;
+
+    void replace_property(PropertyIndex property,
+                          const vector<string_view>& values);
+};
+
+inline auto CompactTree::get_first_child(NodeIndex node) const -> NodeIndex
+{
+    LIBBOARDGAME_ASSERT(node < m_nodes.size());
+    return m_nodes[node].first_child;
+}
+
+inline auto CompactTree::get_parent(NodeIndex node) const -> NodeIndex
+{
+    LIBBOARDGAME_ASSERT(node < m_nodes.size());
+    return m_nodes[node].parent;
+}
+
+inline auto CompactTree::get_properties_begin(NodeIndex node) const
+    -> PropertyIndex
+{
+    LIBBOARDGAME_ASSERT(node < m_nodes.size());
+    return m_nodes[node].first_property;
+}
+
+inline auto CompactTree::get_properties_end(NodeIndex node) const
+    -> PropertyIndex
+{
+    LIBBOARDGAME_ASSERT(node < m_nodes.size());
+    if (node + 1 < m_nodes.size())
+        return m_nodes[node + 1].first_property;
+    return static_cast<PropertyIndex>(m_properties.size() - 1);
+}
+
+inline auto CompactTree::get_property_id(PropertyIndex property) const
+    -> PropertyId
+{
+    LIBBOARDGAME_ASSERT(property + 1 < m_properties.size());
+    return m_properties[property].id;
+}
+
+inline auto CompactTree::get_root() const -> NodeIndex
+{
+    LIBBOARDGAME_ASSERT(! empty());
+    return 0;
+}
+
+inline auto CompactTree::get_sibling(NodeIndex node) const -> NodeIndex
+{
+    LIBBOARDGAME_ASSERT(node < m_nodes.size());
+    return m_nodes[node].sibling;
+}
+
+inline unsigned CompactTree::get_nu_values(PropertyIndex property) const
+{
+    LIBBOARDGAME_ASSERT(property + 1 < m_properties.size());
+    return m_properties[property + 1].first_value
+            - m_properties[property].first_value;
+}
+
+inline string_view CompactTree::get_value(PropertyIndex property,
+                                          unsigned i) const
+{
+    LIBBOARDGAME_ASSERT(i < get_nu_values(property));
+    auto value = m_properties[property].first_value + i;
+    return string_view(m_pool.data() + m_values[value],
+                       m_values[value + 1] - m_values[value]);
+}
+
+inline bool CompactTree::has_children(NodeIndex node) const
+{
+    return get_first_child(node) != null_node;
+}
+
+inline bool CompactTree::has_property(NodeIndex node, PropertyId id) const
+{
+    return find_property(node, id) != get_properties_end(node);
+}
+
+inline bool CompactTree::has_property(NodeIndex node, string_view id) const
+{
+    return has_property(node, find_id(id));
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libboardgame_base
+
+#endif // LIBBOARDGAME_BASE_COMPACT_TREE_H
@@ -0,0 +1,53 @@
+//-----------------------------------------------------------------------------
+/** @file libboardgame_base/CompactTreeReader.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "CompactTreeReader.h"
+
+namespace libboardgame_base {
+
+//-----------------------------------------------------------------------------
+
+CompactTreeReader::CompactTreeReader() = default; // Non-inline to avoid GCC -Winline warning
+
+CompactTreeReader::~CompactTreeReader() = default; // Non-inline to avoid GCC -Winline warning
+
+void CompactTreeReader::on_begin_tree(bool is_root)
+{
+    if (is_root)
+    {
+        m_tree.clear();
+        m_stack.clear();
+        m_current = CompactTree::null_node;
+    }
+    else
+        m_stack.push_back(m_current);
+}
+
+void CompactTreeReader::on_end_tree(bool is_root)
+{
+    if (! is_root)
+    {
+        LIBBOARDGAME_ASSERT(! m_stack.empty());
+        m_current = m_stack.back();
+        m_stack.pop_back();
+    }
+}
+
+void CompactTreeReader::on_begin_node([[maybe_unused]] bool is_root)
+{
+    LIBBOARDGAME_ASSERT(is_root == (m_current == CompactTree::null_node));
+    m_current = m_tree.create_node(m_current);
+}
+
+void CompactTreeReader::on_property_view(string_view id,
+                                         const vector<string_view>& values)
+{
+    m_tree.add_property(id, values);
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libboardgame_base
@@ -0,0 +1,54 @@
+//-----------------------------------------------------------------------------
+/** @file libboardgame_base/CompactTreeReader.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBBOARDGAME_BASE_COMPACT_TREE_READER_H
+#define LIBBOARDGAME_BASE_COMPACT_TREE_READER_H
+
+#include "CompactTree.h"
+#include "Reader.h"
+
+namespace libboardgame_base {
+
+//-----------------------------------------------------------------------------
+
+/** Reader that reads a game tree into a CompactTree.
+    Each call of a read function replaces the tree of the previous call but
+    reuses its memory, which makes it efficient for iterating over the trees
+    of a multi-tree file. */
+class CompactTreeReader
+    : public Reader
+{
+public:
+    CompactTreeReader();
+
+    ~CompactTreeReader() override;
+
+    void on_begin_tree(bool is_root) override;
+
+    void on_end_tree(bool is_root) override;
+
+    void on_begin_node(bool is_root) override;
+
+    void on_property_view(string_view id,
+                          const vector<string_view>& values) override;
+
+    const CompactTree& get_tree() const { return m_tree; }
+
+    CompactTree& get_tree() { return m_tree; }
+
+private:
+    CompactTree::NodeIndex m_current = CompactTree::null_node;
+
+    CompactTree m_tree;
+
+    vector<CompactTree::NodeIndex> m_stack;
+};
+
+//-----------------------------------------------------------------------------
+
+} // namespace libboardgame_base
+
+#endif // LIBBOARDGAME_BASE_COMPACT_TREE_READER_H
@@ -0,0 +1,104 @@
+//-----------------------------------------------------------------------------
+/** @file libboardgame_base/MappedFile.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace libboardgame_base {
+
+//-----------------------------------------------------------------------------
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const string& file)
+{
+    auto handle = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+        throw Error("Could not open '" + file + "'");
+    m_file_handle = handle;
+    LARGE_INTEGER size;
+    if (! GetFileSizeEx(handle, &size))
+    {
+        CloseHandle(handle);
+        throw Error("Could not get size of '" + file + "'");
+    }
+    m_size = static_cast<size_t>(size.QuadPart);
+    if (m_size == 0)
+        return;
+    m_mapping_handle = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0,
+                                          nullptr);
+    if (m_mapping_handle == nullptr)
+    {
+        CloseHandle(handle);
+        throw Error("Could not map '" + file + "'");
+    }
+    m_data = static_cast<const char*>(
+                MapViewOfFile(m_mapping_handle, FILE_MAP_READ, 0, 0, 0));
+    if (m_data == nullptr)
+    {
+        CloseHandle(m_mapping_handle);
+        CloseHandle(handle);
+        throw Error("Could not map '" + file + "'");
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data != nullptr)
+        UnmapViewOfFile(m_data);
+    if (m_mapping_handle != nullptr)
+        CloseHandle(m_mapping_handle);
+    CloseHandle(m_file_handle);
+}
+
+#else
+
+MappedFile::MappedFile(const string& file)
+{
+    int fd = open(file.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw Error("Could not open '" + file + "'");
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        throw Error("Could not get size of '" + file + "'");
+    }
+    m_size = static_cast<size_t>(st.st_size);
+    if (m_size == 0)
+    {
+        close(fd);
+        return;
+    }
+    void* data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping stays valid after closing the file descriptor
+    close(fd);
+    if (data == MAP_FAILED)
+        throw Error("Could not map '" + file + "'");
+    m_data = static_cast<const char*>(data);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data != nullptr)
+        munmap(const_cast<char*>(m_data), m_size);
+}
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+} // namespace libboardgame_base
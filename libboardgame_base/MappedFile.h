@@ -0,0 +1,68 @@
+//-----------------------------------------------------------------------------
+/** @file libboardgame_base/MappedFile.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBBOARDGAME_BASE_MAPPED_FILE_H
+#define LIBBOARDGAME_BASE_MAPPED_FILE_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+namespace libboardgame_base {
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+
+/** Read-only memory-mapped file.
+    The pages are shared between all processes that map the same file and are
+    only loaded by the operating system when they are accessed. */
+class MappedFile
+{
+public:
+    class Error
+        : public runtime_error
+    {
+        using runtime_error::runtime_error;
+    };
+
+
+    /** @throws Error if the file cannot be opened or mapped. */
+    explicit MappedFile(const string& file);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /** Start of the file content.
+        May be null if the file is empty. */
+    const char* data() const { return m_data; }
+
+    size_t size() const { return m_size; }
+
+    const char* begin() const { return m_data; }
+
+    const char* end() const { return m_data + m_size; }
+
+private:
+    const char* m_data = nullptr;
+
+    size_t m_size = 0;
+
+#ifdef _WIN32
+    void* m_file_handle = nullptr;
+
+    void* m_mapping_handle = nullptr;
+#endif
+};
+
+//-----------------------------------------------------------------------------
+
+} // namespace libboardgame_base
+
+#endif // LIBBOARDGAME_BASE_MAPPED_FILE_H
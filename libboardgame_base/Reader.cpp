@@ -10,6 +10,16 @@
 #include <cstdio>
 #include <fstream>
 #include "Assert.h"
+#include "MappedFile.h"
+
+#if defined __SSE2__ || defined _M_X64 \
+    || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#define LIBBOARDGAME_BASE_READER_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
 
 namespace libboardgame_base {
 
@@ -24,6 +34,75 @@ bool is_ascii_space(int c)
     return c >= 0 && c < 128 && isspace(c) != 0;
 }
 
+/** Append a value with escape characters and CR line endings to a
+    string with the same conversions as Reader::read_property(). */
+void convert_value(const char* begin, const char* end, string& value)
+{
+    value.clear();
+    bool escape = false;
+    for (auto i = begin; i != end; ++i)
+    {
+        char c = *i;
+        if (c == '\r')
+        {
+            // Convert CR+LF or single CR into LF
+            if (i + 1 != end && *(i + 1) == '\n')
+                ++i;
+            c = '\n';
+        }
+        if (c == '\\' && ! escape)
+        {
+            escape = true;
+            continue;
+        }
+        escape = false;
+        value += c;
+    }
+}
+
+#ifdef LIBBOARDGAME_BASE_READER_SSE2
+
+inline unsigned get_lowest_bit(unsigned mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+#endif
+
+/** Find the first character in a property value that needs special
+    handling (']', '\\' or '\r').
+    @return The position of the character or end if there is none. */
+const char* find_value_delimiter(const char* begin, const char* end)
+{
+#ifdef LIBBOARDGAME_BASE_READER_SSE2
+    const auto bracket = _mm_set1_epi8(']');
+    const auto backslash = _mm_set1_epi8('\\');
+    const auto cr = _mm_set1_epi8('\r');
+    while (end - begin >= 16)
+    {
+        auto chars =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        auto is_delimiter =
+                _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chars, bracket),
+                                          _mm_cmpeq_epi8(chars, backslash)),
+                             _mm_cmpeq_epi8(chars, cr));
+        auto mask = static_cast<unsigned>(_mm_movemask_epi8(is_delimiter));
+        if (mask != 0)
+            return begin + get_lowest_bit(mask);
+        begin += 16;
+    }
+#endif
+    while (begin != end && *begin != ']' && *begin != '\\' && *begin != '\r')
+        ++begin;
+    return begin;
+}
+
 } // namespace
 
 //-----------------------------------------------------------------------------
@@ -36,6 +115,12 @@ void Reader::consume_char([[maybe_unused]] char expected)
 
 void Reader::consume_whitespace()
 {
+    if (m_in == nullptr)
+    {
+        while (m_pos != m_end && is_ascii_space(*m_pos))
+            ++m_pos;
+        return;
+    }
     while (is_ascii_space(peek()))
         m_in->get();
 }
@@ -66,8 +151,32 @@ void Reader::on_property([[maybe_unused]] const string& id,
     // Default implementation does nothing
 }
 
+void Reader::on_property_view(string_view id,
+                              const vector<string_view>& values)
+{
+    if (m_in != nullptr)
+    {
+        // Reading from a stream, the arguments are views of m_id and
+        // m_values
+        on_property(m_id, m_values);
+        return;
+    }
+    if (id.data() != m_id.data())
+        m_id = id;
+    m_values.resize(values.size());
+    for (size_t i = 0; i < values.size(); ++i)
+        m_values[i] = values[i];
+    on_property(m_id, m_values);
+}
+
 char Reader::peek()
 {
+    if (m_in == nullptr)
+    {
+        if (m_pos == m_end)
+            throw ReadError("Unexpected end of input");
+        return *m_pos;
+    }
     int c = m_in->peek();
     if (c == EOF)
         throw ReadError("Unexpected end of input");
@@ -98,14 +207,36 @@ bool Reader::read(istream& in, bool check_single_tree)
     }
 }
 
+bool Reader::read(const char*& begin, const char* end, bool check_single_tree)
+{
+    m_in = nullptr;
+    m_pos = begin;
+    m_end = end;
+    m_is_in_main_variation = true;
+    consume_whitespace();
+    read_tree(true);
+    consume_whitespace();
+    begin = m_pos;
+    if (m_pos == m_end)
+        return false;
+    if (*m_pos != '(')
+        throw ReadError("Extra characters after end of tree.");
+    if (check_single_tree)
+        throw ReadError("Input has multiple game trees");
+    return true;
+}
+
 void Reader::read(const string& file)
 {
-    ifstream in(file);
-    if (! in)
-        throw ReadError("Could not open '" + file + "'");
     try
     {
-        read(in);
+        MappedFile mapped_file(file);
+        auto begin = mapped_file.begin();
+        read(begin, mapped_file.end());
+    }
+    catch (const MappedFile::Error&)
+    {
+        throw ReadError("Could not open '" + file + "'");
     }
     catch (const ReadError& e)
     {
@@ -115,6 +246,20 @@ void Reader::read(const string& file)
 
 char Reader::read_char()
 {
+    if (m_in == nullptr)
+    {
+        if (m_pos == m_end)
+            throw ReadError("Unexpected end of SGF stream");
+        char c = *(m_pos++);
+        if (c == '\r')
+        {
+            // Convert CR+LF or single CR into LF
+            if (m_pos != m_end && *m_pos == '\n')
+                ++m_pos;
+            return '\n';
+        }
+        return c;
+    }
     int c = m_in->get();
     if (c == EOF)
         throw ReadError("Unexpected end of SGF stream");
@@ -153,6 +298,11 @@ void Reader::read_node(bool is_root)
 
 void Reader::read_property()
 {
+    if (m_in == nullptr)
+    {
+        read_property_buffer();
+        return;
+    }
     if (m_read_only_main_variation && ! m_is_in_main_variation)
     {
         while (peek() != '[')
@@ -205,10 +355,72 @@ void Reader::read_property()
             consume_whitespace();
             m_values.push_back(m_value);
         }
-        on_property(m_id, m_values);
+        m_value_views.assign(m_values.begin(), m_values.end());
+        on_property_view(m_id, m_value_views);
     }
 }
 
+void Reader::read_property_buffer()
+{
+    auto id_begin = m_pos;
+    while (m_pos != m_end && *m_pos != '[')
+        ++m_pos;
+    if (m_pos == m_end)
+        throw ReadError("Unexpected end of input");
+    string_view id(id_begin, static_cast<size_t>(m_pos - id_begin));
+    m_value_spans.clear();
+    size_t nu_converted = 0;
+    while (m_pos != m_end && *m_pos == '[')
+    {
+        ++m_pos;
+        ValueSpan span{m_pos, nullptr, false};
+        while (true)
+        {
+            m_pos = find_value_delimiter(m_pos, m_end);
+            if (m_pos == m_end)
+                throw ReadError("Unexpected end of input");
+            if (*m_pos == ']')
+                break;
+            span.needs_conversion = true;
+            // Skip the escaped character (or the CR)
+            if (*m_pos == '\\' && ++m_pos == m_end)
+                throw ReadError("Unexpected end of input");
+            ++m_pos;
+        }
+        span.end = m_pos;
+        if (span.needs_conversion)
+            ++nu_converted;
+        m_value_spans.push_back(span);
+        ++m_pos;
+        consume_whitespace();
+    }
+    if (m_read_only_main_variation && ! m_is_in_main_variation)
+        return;
+    if (id.find_first_of(" \t\n\v\f\r") != string_view::npos)
+    {
+        m_id.clear();
+        for (char c : id)
+            if (! is_ascii_space(c))
+                m_id += c;
+        id = m_id;
+    }
+    if (m_converted_values.size() < nu_converted)
+        m_converted_values.resize(nu_converted);
+    m_value_views.clear();
+    size_t i = 0;
+    for (auto& span : m_value_spans)
+        if (span.needs_conversion)
+        {
+            auto& value = m_converted_values[i++];
+            convert_value(span.begin, span.end, value);
+            m_value_views.push_back(value);
+        }
+        else
+            m_value_views.emplace_back(
+                        span.begin, static_cast<size_t>(span.end - span.begin));
+    on_property_view(id, m_value_views);
+}
+
 void Reader::read_tree(bool is_root)
 {
     read_expected('(');
@@ -10,6 +10,7 @@
 #include <iosfwd>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace libboardgame_base {
@@ -18,6 +19,17 @@ using namespace std;
 
 //-----------------------------------------------------------------------------
 
+/** Reader for SGF game trees.
+    The reader calls virtual functions for the parts of the tree, which can
+    be overridden by subclasses.
+
+    Trees can be read from a stream or from a contiguous buffer. When reading
+    from a buffer or a file (which is memory-mapped), the reader scans for
+    the delimiters of property values in blocks with SIMD instructions if
+    available and passes the identifiers and values to on_property_view() as
+    views into the buffer without copying them. Only values that contain
+    escape characters or CR line endings are converted into a temporary
+    string. */
 class Reader
 {
 public:
@@ -41,6 +53,14 @@ public:
 
     virtual void on_property(const string& id, const vector<string>& values);
 
+    /** Handle a property.
+        The views are only valid during the call. Escape characters are
+        already removed and line endings are converted to LF. The default
+        implementation copies the arguments and calls on_property(), so
+        subclasses only need to override one of the two functions. */
+    virtual void on_property_view(string_view id,
+                                  const vector<string_view>& values);
+
     /** Read only the main variation.
         Reduces CPU time and memory if only the main variation is needed. */
     void set_read_only_main_variation(bool enable);
@@ -55,15 +75,47 @@ public:
         @throws ReadError */
     bool read(istream& in, bool check_single_tree = true);
 
+    /** Read a game tree from a buffer.
+        @param[in,out] begin The start of the buffer. On return, the position
+        after the tree and any whitespace following it.
+        @param end The end of the buffer.
+        @param check_single_tree See read(istream&, bool)
+        @return true, if there are more trees to read in the buffer.
+        @throws ReadError */
+    bool read(const char*& begin, const char* end,
+              bool check_single_tree = true);
+
+    /** Read a game tree from a file.
+        The file is memory-mapped and read with
+        read(const char*&, const char*, bool).
+        @throws ReadError */
     void read(const string& file);
 
 private:
+    /** A value in the input buffer. */
+    struct ValueSpan
+    {
+        const char* begin;
+
+        const char* end;
+
+        /** Value contains escape characters or CR. */
+        bool needs_conversion;
+    };
+
     bool m_read_only_main_variation = false;
 
     bool m_is_in_main_variation;
 
+    /** Input stream or null if reading from a buffer. */
     istream* m_in;
 
+    /** Current position if reading from a buffer. */
+    const char* m_pos;
+
+    /** End of the buffer if reading from a buffer. */
+    const char* m_end;
+
     /** Local variable in read_property().
         Reused for efficiency. */
     string m_id;
@@ -76,6 +128,18 @@ private:
         Reused for efficiency. */
     vector<string> m_values;
 
+    /** Local variable in read_property_buffer().
+        Reused for efficiency. */
+    vector<ValueSpan> m_value_spans;
+
+    /** Local variable in read_property_buffer().
+        Reused for efficiency. */
+    vector<string_view> m_value_views;
+
+    /** Local variable in read_property_buffer().
+        Reused for efficiency. */
+    vector<string> m_converted_values;
+
     void consume_char(char expected);
 
     void consume_whitespace();
@@ -90,6 +154,8 @@ private:
 
     void read_property();
 
+    void read_property_buffer();
+
     void read_tree(bool is_root);
 };
 
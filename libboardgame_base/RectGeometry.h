@@ -9,6 +9,7 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include "Geometry.h"
 
 namespace libboardgame_base {
@@ -31,7 +32,8 @@ public:
     using DiagCoordList = typename Geometry<P>::DiagCoordList;
 
 
-    /** Create or reuse an already created geometry with a given size. */
+    /** Create or reuse an already created geometry with a given size.
+        This function is thread-safe. */
     static const RectGeometry& get(unsigned width, unsigned height);
 
 
@@ -61,7 +63,9 @@ template<class P>
 const RectGeometry<P>& RectGeometry<P>::get(unsigned width, unsigned height)
 {
     static map<pair<unsigned, unsigned>, shared_ptr<RectGeometry>> s_geometry;
+    static mutex s_mutex;
 
+    lock_guard<mutex> lock(s_mutex);
     pair key(width, height);
     auto pos = s_geometry.find(key);
     if (pos != s_geometry.end())
@@ -0,0 +1,224 @@
+//-----------------------------------------------------------------------------
+/** @file libboardgame_base/SgfJournal.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "SgfJournal.h"
+
+#include "SgfTree.h"
+
+namespace libboardgame_base {
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+/** Reader for the records.
+    Each record is a line starting with the operation character followed by
+    space-separated fields. Strings are written as their length followed by a
+    colon and the bytes, so they need no escaping. */
+class RecordReader
+{
+public:
+    explicit RecordReader(const string& records)
+        : m_records(records)
+    { }
+
+    bool at_end() const { return m_pos >= m_records.size(); }
+
+    char read_char();
+
+    unsigned read_uint();
+
+    string read_string();
+
+    void read_end();
+
+private:
+    const string& m_records;
+
+    size_t m_pos = 0;
+
+    void read_space();
+};
+
+char RecordReader::read_char()
+{
+    if (at_end())
+        throw SgfJournal::Error("Unexpected end of journal");
+    return m_records[m_pos++];
+}
+
+void RecordReader::read_end()
+{
+    if (read_char() != '\n')
+        throw SgfJournal::Error("Expected end of journal record");
+}
+
+void RecordReader::read_space()
+{
+    if (read_char() != ' ')
+        throw SgfJournal::Error("Expected space in journal record");
+}
+
+string RecordReader::read_string()
+{
+    auto len = read_uint();
+    if (read_char() != ':' || len > m_records.size() - m_pos)
+        throw SgfJournal::Error("Invalid string in journal record");
+    auto result = m_records.substr(m_pos, len);
+    m_pos += len;
+    return result;
+}
+
+unsigned RecordReader::read_uint()
+{
+    read_space();
+    unsigned result = 0;
+    unsigned nu_digits = 0;
+    while (! at_end() && m_records[m_pos] >= '0' && m_records[m_pos] <= '9')
+    {
+        if (++nu_digits > 9)
+            throw SgfJournal::Error("Invalid number in journal record");
+        result = 10 * result + static_cast<unsigned>(m_records[m_pos] - '0');
+        ++m_pos;
+    }
+    if (nu_digits == 0)
+        throw SgfJournal::Error("Expected number in journal record");
+    return result;
+}
+
+void write_uint(string& s, size_t n)
+{
+    s += ' ';
+    s += to_string(n);
+}
+
+void write_string(string& s, const string& value)
+{
+    write_uint(s, value.size());
+    s += ':';
+    s += value;
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+void SgfJournal::add(Op op, const SgfNode& node, const string& id)
+{
+    if (! m_is_valid)
+        return;
+    m_records += static_cast<char>(op);
+    // Path from the root, written as its length followed by the child indices
+    vector<unsigned> path;
+    auto current = &node;
+    while (current->has_parent())
+    {
+        auto& parent = current->get_parent();
+        path.push_back(parent.get_child_index(*current));
+        current = &parent;
+    }
+    write_uint(m_records, path.size());
+    for (auto i = path.rbegin(); i != path.rend(); ++i)
+        write_uint(m_records, *i);
+    switch (op)
+    {
+    case Op::set_property:
+    {
+        write_string(m_records, id);
+        auto& values = node.get_multi_property(id);
+        write_uint(m_records, values.size());
+        for (auto& v : values)
+            write_string(m_records, v);
+        break;
+    }
+    case Op::move_property_to_front:
+    case Op::remove_property:
+        write_string(m_records, id);
+        break;
+    default:
+        break;
+    }
+    m_records += '\n';
+}
+
+void SgfJournal::clear()
+{
+    m_is_valid = true;
+    m_records.clear();
+}
+
+void SgfJournal::invalidate()
+{
+    m_is_valid = false;
+    m_records.clear();
+}
+
+void SgfJournal::replay(SgfTree& tree, const string& records)
+{
+    RecordReader reader(records);
+    vector<string> values;
+    while (! reader.at_end())
+    {
+        auto op = static_cast<Op>(reader.read_char());
+        auto depth = reader.read_uint();
+        auto node = &tree.get_root();
+        for (unsigned i = 0; i < depth; ++i)
+        {
+            auto index = reader.read_uint();
+            if (index >= node->get_nu_children())
+                throw Error("Journal does not match tree");
+            node = &node->get_child(index);
+        }
+        switch (op)
+        {
+        case Op::create_new_child:
+            tree.create_new_child(*node);
+            break;
+        case Op::delete_variations:
+            tree.delete_variations(*node);
+            break;
+        case Op::make_first_child:
+            tree.make_first_child(*node);
+            break;
+        case Op::move_down:
+            tree.move_down(*node);
+            break;
+        case Op::move_property_to_front:
+            tree.move_property_to_front(*node, reader.read_string());
+            break;
+        case Op::move_up:
+            tree.move_up(*node);
+            break;
+        case Op::remove_children:
+            tree.remove_children(*node);
+            break;
+        case Op::remove_property:
+            tree.remove_property(*node, reader.read_string());
+            break;
+        case Op::set_property:
+        {
+            auto id = reader.read_string();
+            values.resize(reader.read_uint());
+            for (auto& v : values)
+                v = reader.read_string();
+            tree.set_property(*node, id, values);
+            break;
+        }
+        case Op::truncate:
+            if (! node->has_parent())
+                throw Error("Journal does not match tree");
+            tree.truncate(*node);
+            break;
+        default:
+            throw Error("Invalid journal record");
+        }
+        reader.read_end();
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libboardgame_base
@@ -0,0 +1,108 @@
+//-----------------------------------------------------------------------------
+/** @file libboardgame_base/SgfJournal.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBBOARDGAME_BASE_SGF_JOURNAL_H
+#define LIBBOARDGAME_BASE_SGF_JOURNAL_H
+
+#include "SgfError.h"
+#include "SgfNode.h"
+
+namespace libboardgame_base {
+
+class SgfTree;
+
+//-----------------------------------------------------------------------------
+
+/** Journal of the modifications of an SgfTree.
+    If a journal is attached to a tree with SgfTree::set_journal(), the tree
+    adds a record for each modification. The records can be stored
+    incrementally (e.g. appended to a file) after saving a snapshot of the
+    tree and replayed on the snapshot to restore the tree, which is much
+    faster than saving the whole tree after each modification if the tree is
+    large.
+
+    Nodes are identified by the child indices on the path from the root.
+    Modifications that replace the root or insert subtrees are not recorded
+    but make the journal invalid, in which case a new snapshot is needed. */
+class SgfJournal
+{
+public:
+    class Error
+        : public SgfError
+    {
+        using SgfError::SgfError;
+    };
+
+    enum class Op : char
+    {
+        create_new_child = 'c',
+
+        delete_variations = 'v',
+
+        make_first_child = 'm',
+
+        move_down = 'd',
+
+        move_property_to_front = 'f',
+
+        move_up = 'u',
+
+        remove_children = 'x',
+
+        remove_property = 'r',
+
+        set_property = 'p',
+
+        truncate = 't'
+    };
+
+
+    /** Apply records to a tree.
+        @param tree The tree in the state of the snapshot that the records
+        belong to.
+        @param records The records.
+        @throws Error if the records are invalid or don't match the tree. */
+    static void replay(SgfTree& tree, const string& records);
+
+
+    /** Check if the records since the last clear() contain all
+        modifications. */
+    bool is_valid() const { return m_is_valid; }
+
+    /** Get the records added since the last clear() or clear_records(). */
+    const string& get_records() const { return m_records; }
+
+    /** Start a new journal.
+        Should be called after a snapshot of the tree was saved. */
+    void clear();
+
+    /** Remove the records but keep the validity.
+        Should be called after the records were saved. */
+    void clear_records() { m_records.clear(); }
+
+    /** Mark the journal as invalid. */
+    void invalidate();
+
+    /** Add a record for a modification of a node.
+        @param op The modification.
+        @param node The node, which must still be in the tree. For
+        Op::create_new_child, the parent of the new node, which is the last
+        child. For Op::truncate, the node before it is removed.
+        @param id The property for operations on properties, the values of
+        Op::set_property are taken from the node. */
+    void add(Op op, const SgfNode& node, const string& id = "");
+
+private:
+    bool m_is_valid = false;
+
+    string m_records;
+};
+
+//-----------------------------------------------------------------------------
+
+} // namespace libboardgame_base
+
+#endif // LIBBOARDGAME_BASE_SGF_JOURNAL_H
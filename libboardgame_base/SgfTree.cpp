@@ -29,7 +29,9 @@ bool SgfTree::contains(const SgfNode& node) const
 const SgfNode& SgfTree::create_new_child(const SgfNode& node)
 {
     m_modified = true;
-    return non_const(node).create_new_child();
+    auto& child = non_const(node).create_new_child();
+    journal_add(SgfJournal::Op::create_new_child, node);
+    return child;
 }
 
 void SgfTree::delete_all_variations()
@@ -47,8 +49,10 @@ void SgfTree::delete_variations(const SgfNode& node)
 {
     if (node.get_nu_children() <= 1)
         return;
+    journal_add(SgfJournal::Op::delete_variations, node);
     non_const(node).delete_variations();
     m_modified = true;
+    node_changed(nullptr);
 }
 
 double SgfTree::get_bad_move(const SgfNode& node)
@@ -100,12 +104,16 @@ void SgfTree::init()
     auto root = make_unique<SgfNode>();
     m_root = move(root);
     m_modified = false;
+    node_changed(nullptr);
+    invalidate_journal();
 }
 
 void SgfTree::init(unique_ptr<SgfNode>& root)
 {
     m_root = move(root);
     m_modified = false;
+    node_changed(nullptr);
+    invalidate_journal();
 }
 
 bool SgfTree::is_doubtful_move(const SgfNode& node)
@@ -123,6 +131,7 @@ void SgfTree::make_first_child(const SgfNode& node)
     auto parent = node.get_parent_or_null();
     if (parent != nullptr && &parent->get_first_child() != &node)
     {
+        journal_add(SgfJournal::Op::make_first_child, node);
         non_const(node).make_first_child();
         m_modified = true;
     }
@@ -147,18 +156,25 @@ void SgfTree::make_root(const SgfNode& node)
     unique_ptr<SgfNode> new_root = non_const(parent).remove_child(non_const(node));
     m_root = move(new_root);
     m_modified = true;
+    node_changed(nullptr);
+    invalidate_journal();
 }
 
 void SgfTree::move_property_to_front(const SgfNode& node, const string& id)
 {
     if (non_const(node).move_property_to_front(id))
+    {
         m_modified = true;
+        node_changed(&node);
+        journal_add(SgfJournal::Op::move_property_to_front, node, id);
+    }
 }
 
 void SgfTree::move_down(const SgfNode& node)
 {
     if (node.get_sibling() != nullptr)
     {
+        journal_add(SgfJournal::Op::move_down, node);
         non_const(node).move_down();
         m_modified = true;
     }
@@ -169,6 +185,7 @@ void SgfTree::move_up(const SgfNode& node)
     auto parent = node.get_parent_or_null();
     if (parent != nullptr && &parent->get_first_child() != &node)
     {
+        journal_add(SgfJournal::Op::move_up, node);
         non_const(node).move_up();
         m_modified = true;
     }
@@ -186,7 +203,11 @@ bool SgfTree::remove_property(const SgfNode& node, const string& id)
 {
     bool prop_existed = non_const(node).remove_property(id);
     if (prop_existed)
+    {
         m_modified = true;
+        node_changed(&node);
+        journal_add(SgfJournal::Op::remove_property, node, id);
+    }
     return prop_existed;
 }
 
@@ -202,7 +223,11 @@ void SgfTree::set_property(const SgfNode& node, const string& id, const char* va
 {
     bool was_changed = non_const(node).set_property(id, value);
     if (was_changed)
+    {
         m_modified = true;
+        node_changed(&node);
+        journal_add(SgfJournal::Op::set_property, node, id);
+    }
 }
 
 void SgfTree::set_property_remove_empty(const SgfNode& node, const string& id,
@@ -252,8 +277,10 @@ void SgfTree::set_interesting_move(const SgfNode& node)
 const SgfNode& SgfTree::truncate(const SgfNode& node)
 {
     auto& parent = node.get_parent();
+    journal_add(SgfJournal::Op::truncate, node);
     non_const(parent).remove_child(non_const(node));
     m_modified = true;
+    node_changed(nullptr);
     return parent;
 }
 
@@ -7,7 +7,7 @@
 #ifndef LIBBOARDGAME_BASE_SGF_TREE_H
 #define LIBBOARDGAME_BASE_SGF_TREE_H
 
-#include "SgfNode.h"
+#include "SgfJournal.h"
 
 namespace libboardgame_base {
 
@@ -45,6 +45,27 @@ public:
 
     void clear_modified() { m_modified = false; }
 
+    /** Get the number of changes of existing nodes.
+        Counts modifications of properties and deletions of nodes but not
+        the creation or reordering of children. Can be used to check if
+        information derived from the nodes is still valid. */
+    unsigned get_nu_changes() const { return m_nu_changes; }
+
+    /** Get the node that all changes since a given number of changes were
+        made to.
+        @param nu_changes A value of get_nu_changes() that is smaller than
+        the current value.
+        @return The node, or nullptr if the changes were made to more than
+        one node or deleted nodes. */
+    const SgfNode* get_changed_node(unsigned nu_changes) const;
+
+    /** Record all modifications of the tree in a journal.
+        The journal is invalidated by init() and by modifications that cannot
+        be recorded.
+        @param journal The journal or nullptr to stop recording. The journal
+        must exist as long as it is attached to the tree. */
+    void set_journal(SgfJournal* journal) { m_journal = journal; }
+
     const SgfNode& get_root() const { return *m_root; }
 
     const SgfNode& create_new_child(const SgfNode& node);
@@ -166,18 +187,68 @@ public:
 private:
     bool m_modified;
 
+    unsigned m_nu_changes = 0;
+
+    /** Value of m_nu_changes before the first of the changes that were
+        all made to m_changed_node. */
+    unsigned m_changed_node_begin = 0;
+
+    const SgfNode* m_changed_node = nullptr;
+
+    SgfJournal* m_journal = nullptr;
+
     unique_ptr<SgfNode> m_root;
 
+    void invalidate_journal();
+
+    void journal_add(SgfJournal::Op op, const SgfNode& node,
+                     const string& id = "");
+
+    /** Count a change of a node.
+        @param node The changed node or nullptr if nodes were deleted. */
+    void node_changed(const SgfNode* node);
+
     SgfNode& non_const(const SgfNode& node);
 };
 
 inline void SgfTree::append(const SgfNode& node, unique_ptr<SgfNode> child)
 {
     if (child)
+    {
         m_modified = true;
+        invalidate_journal();
+    }
     non_const(node).append(move(child));
 }
 
+inline const SgfNode* SgfTree::get_changed_node(unsigned nu_changes) const
+{
+    return nu_changes >= m_changed_node_begin ? m_changed_node : nullptr;
+}
+
+inline void SgfTree::invalidate_journal()
+{
+    if (m_journal != nullptr)
+        m_journal->invalidate();
+}
+
+inline void SgfTree::journal_add(SgfJournal::Op op, const SgfNode& node,
+                                 const string& id)
+{
+    if (m_journal != nullptr)
+        m_journal->add(op, node, id);
+}
+
+inline void SgfTree::node_changed(const SgfNode* node)
+{
+    if (node == nullptr || node != m_changed_node)
+    {
+        m_changed_node = node;
+        m_changed_node_begin = m_nu_changes;
+    }
+    ++m_nu_changes;
+}
+
 inline SgfNode& SgfTree::non_const(const SgfNode& node)
 {
     LIBBOARDGAME_ASSERT(contains(node));
@@ -187,7 +258,11 @@ inline SgfNode& SgfTree::non_const(const SgfNode& node)
 inline void SgfTree::remove_children(const SgfNode& node)
 {
     if (node.has_children())
+    {
         m_modified = true;
+        node_changed(nullptr);
+        journal_add(SgfJournal::Op::remove_children, node);
+    }
     non_const(node).remove_children();
 }
 
@@ -211,7 +286,11 @@ void SgfTree::set_property(const SgfNode& node, const string& id, const T& value
 {
     bool was_changed = non_const(node).set_property(id, value);
     if (was_changed)
+    {
         m_modified = true;
+        node_changed(&node);
+        journal_add(SgfJournal::Op::set_property, node, id);
+    }
 }
 
 template<typename T>
@@ -220,7 +299,11 @@ void SgfTree::set_property(const SgfNode& node, const string& id,
 {
     bool was_changed = non_const(node).set_property(id, values);
     if (was_changed)
+    {
         m_modified = true;
+        node_changed(&node);
+        journal_add(SgfJournal::Op::set_property, node, id);
+    }
 }
 
 inline void SgfTree::set_round(const string& round)
@@ -31,10 +31,12 @@ public:
         value does not affect the mean returned if count is greater 0. */
     explicit StatisticsBase(FLOAT init_val = 0) { clear(init_val); }
 
-    void add(FLOAT val);
+    void add(FLOAT val, FLOAT weight = 1);
 
     void clear(FLOAT init_val = 0);
 
+    void init(FLOAT mean, FLOAT count);
+
     FLOAT get_count() const { return m_count; }
 
     FLOAT get_mean() const { return m_mean; }
@@ -48,12 +50,12 @@ private:
 };
 
 template<typename FLOAT>
-void StatisticsBase<FLOAT>::add(FLOAT val)
+void StatisticsBase<FLOAT>::add(FLOAT val, FLOAT weight)
 {
     FLOAT count = m_count;
-    ++count;
+    count += weight;
     val -= m_mean;
-    m_mean +=  val / count;
+    m_mean +=  weight * val / count;
     m_count = count;
 }
 
@@ -64,6 +66,13 @@ inline void StatisticsBase<FLOAT>::clear(FLOAT init_val)
     m_mean = init_val;
 }
 
+template<typename FLOAT>
+inline void StatisticsBase<FLOAT>::init(FLOAT mean, FLOAT count)
+{
+    m_count = count;
+    m_mean = mean;
+}
+
 template<typename FLOAT>
 void StatisticsBase<FLOAT>::write(ostream& out, bool fixed,
                                   int precision) const
@@ -0,0 +1,127 @@
+//-----------------------------------------------------------------------------
+/** @file libboardgame_base/VirtualMemory.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "VirtualMemory.h"
+
+#include <algorithm>
+#include <new>
+#include "Assert.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace libboardgame_base {
+
+//-----------------------------------------------------------------------------
+
+#ifdef _WIN32
+
+VirtualMemory::VirtualMemory(size_t size)
+    : m_size(size)
+{
+    m_data = static_cast<char*>(VirtualAlloc(nullptr, max(size, size_t(1)),
+                                             MEM_RESERVE, PAGE_NOACCESS));
+    if (m_data == nullptr)
+        throw bad_alloc();
+}
+
+VirtualMemory::~VirtualMemory()
+{
+    VirtualFree(m_data, 0, MEM_RELEASE);
+}
+
+size_t VirtualMemory::get_page_size()
+{
+    static size_t page_size = [] {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return static_cast<size_t>(info.dwPageSize);
+    }();
+    return page_size;
+}
+
+bool VirtualMemory::commit(size_t begin, size_t end)
+{
+    LIBBOARDGAME_ASSERT(begin <= end);
+    LIBBOARDGAME_ASSERT(end <= m_size);
+    if (begin == end)
+        return true;
+    return VirtualAlloc(m_data + begin, end - begin, MEM_COMMIT,
+                        PAGE_READWRITE) != nullptr;
+}
+
+void VirtualMemory::release(size_t begin, size_t end)
+{
+    LIBBOARDGAME_ASSERT(begin <= end);
+    LIBBOARDGAME_ASSERT(end <= m_size);
+    auto page_size = get_page_size();
+    begin = (begin + page_size - 1) / page_size * page_size;
+    end = end / page_size * page_size;
+    if (begin < end)
+        VirtualFree(m_data + begin, end - begin, MEM_DECOMMIT);
+}
+
+#else
+
+VirtualMemory::VirtualMemory(size_t size)
+    : m_size(size)
+{
+    // The address space is reserved with PROT_NONE and MAP_NORESERVE, so it
+    // neither uses physical memory nor counts as committed memory on systems
+    // that limit overcommitting
+    void* data = mmap(nullptr, max(size, size_t(1)), PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (data == MAP_FAILED)
+        throw bad_alloc();
+    m_data = static_cast<char*>(data);
+}
+
+VirtualMemory::~VirtualMemory()
+{
+    munmap(m_data, max(m_size, size_t(1)));
+}
+
+size_t VirtualMemory::get_page_size()
+{
+    static size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return page_size;
+}
+
+bool VirtualMemory::commit(size_t begin, size_t end)
+{
+    LIBBOARDGAME_ASSERT(begin <= end);
+    LIBBOARDGAME_ASSERT(end <= m_size);
+    if (begin == end)
+        return true;
+    auto page_size = get_page_size();
+    begin = begin / page_size * page_size;
+    return mprotect(m_data + begin, end - begin, PROT_READ | PROT_WRITE) == 0;
+}
+
+void VirtualMemory::release(size_t begin, size_t end)
+{
+    LIBBOARDGAME_ASSERT(begin <= end);
+    LIBBOARDGAME_ASSERT(end <= m_size);
+    auto page_size = get_page_size();
+    begin = (begin + page_size - 1) / page_size * page_size;
+    end = end / page_size * page_size;
+    if (begin >= end)
+        return;
+    // Replacing the pages by a new mapping frees the physical memory and
+    // the commit charge
+    mmap(m_data + begin, end - begin, PROT_NONE,
+         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+}
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+} // namespace libboardgame_base
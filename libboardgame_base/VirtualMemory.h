@@ -0,0 +1,63 @@
+//-----------------------------------------------------------------------------
+/** @file libboardgame_base/VirtualMemory.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBBOARDGAME_BASE_VIRTUAL_MEMORY_H
+#define LIBBOARDGAME_BASE_VIRTUAL_MEMORY_H
+
+#include <cstddef>
+
+namespace libboardgame_base {
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+
+/** Range of reserved virtual memory that is committed on demand.
+    Reserving the address space does not use physical memory. Parts of the
+    range must be committed before they are accessed and can be released
+    again, after which their content is undefined. */
+class VirtualMemory
+{
+public:
+    /** Reserve memory.
+        @throws bad_alloc if the address space cannot be reserved. */
+    explicit VirtualMemory(size_t size);
+
+    ~VirtualMemory();
+
+    VirtualMemory(const VirtualMemory&) = delete;
+
+    VirtualMemory& operator=(const VirtualMemory&) = delete;
+
+    static size_t get_page_size();
+
+    void* data() const { return m_data; }
+
+    size_t size() const { return m_size; }
+
+    /** Commit a part of the memory.
+        The part is extended to page boundaries. Committing memory that is
+        already committed is allowed and does not change its content.
+        @param begin The offset of the first byte.
+        @param end The offset after the last byte.
+        @return false if there is not enough memory. */
+    bool commit(size_t begin, size_t end);
+
+    /** Release a part of the memory.
+        The part is shrunk to page boundaries. */
+    void release(size_t begin, size_t end);
+
+private:
+    char* m_data;
+
+    size_t m_size;
+};
+
+//-----------------------------------------------------------------------------
+
+} // namespace libboardgame_base
+
+#endif // LIBBOARDGAME_BASE_VIRTUAL_MEMORY_H
@@ -0,0 +1,115 @@
+//-----------------------------------------------------------------------------
+/** @file libboardgame_base/tests/CompactTreeTest.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "libboardgame_base/CompactTreeReader.h"
+
+#include <cstring>
+#include <sstream>
+#include "libboardgame_base/TreeReader.h"
+#include "libboardgame_base/TreeWriter.h"
+#include "libboardgame_test/Test.h"
+
+using namespace std;
+using namespace libboardgame_base;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+string write_tree(const SgfNode& root)
+{
+    ostringstream out;
+    TreeWriter writer(out, root);
+    writer.write();
+    return out.str();
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+LIBBOARDGAME_TEST_CASE(sgf_compact_tree_basic)
+{
+    istringstream in("(;C[1]FF[4](;B[aa];W[bb])(;B[cc]AB[dd][ee]))");
+    CompactTreeReader reader;
+    reader.read(in);
+    auto& tree = reader.get_tree();
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_nu_nodes(), 4u);
+    auto root = tree.get_root();
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_parent(root), CompactTree::null_node);
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_property(root, "C"), "1");
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_nu_children(root), 2u);
+    auto child_1 = tree.get_first_child(root);
+    auto child_2 = tree.get_sibling(child_1);
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_parent(child_2), root);
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_property(child_1, "B"), "aa");
+    LIBBOARDGAME_CHECK(! tree.has_property(child_1, "W"));
+    LIBBOARDGAME_CHECK_EQUAL(
+                tree.get_property(tree.get_first_child(child_1), "W"), "bb");
+    // Interned identifiers are shared by all nodes
+    auto id = tree.find_id("B");
+    LIBBOARDGAME_CHECK(id != CompactTree::null_id);
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_id(id), "B");
+    LIBBOARDGAME_CHECK(tree.has_property(child_2, id));
+    LIBBOARDGAME_CHECK_EQUAL(tree.find_id("XY"), CompactTree::null_id);
+    LIBBOARDGAME_CHECK(! tree.has_property(child_2, "XY"));
+    auto property = tree.find_property(child_2, tree.find_id("AB"));
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_nu_values(property), 2u);
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_value(property, 1), "ee");
+    LIBBOARDGAME_CHECK_THROW(tree.get_property(child_2, "W"),
+                             MissingProperty);
+}
+
+/** Test that the conversion of a CompactTree read from an SGF file into an
+    SgfNode gives the same tree as TreeReader. */
+LIBBOARDGAME_TEST_CASE(sgf_compact_tree_to_sgf_node)
+{
+    const char* sgf =
+        "(;FF[4]C[a\\]b\r\nc]PL[B];B[aa]C[];W[bb]C[x]C[y]LB[aa:1][bb:2]"
+        "(;B[cc](;W[dd])(;W[ee]))(;B[ff]))";
+    istringstream in(sgf);
+    TreeReader tree_reader;
+    tree_reader.read(in);
+    CompactTreeReader reader;
+    const char* begin = sgf;
+    reader.read(begin, sgf + strlen(sgf));
+    auto& tree = reader.get_tree();
+    auto expected = write_tree(tree_reader.get_tree());
+    LIBBOARDGAME_CHECK_EQUAL(write_tree(*tree.to_sgf_node()), expected);
+    // Subtree
+    auto node = tree.get_first_child(tree.get_first_child(tree.get_root()));
+    LIBBOARDGAME_CHECK_EQUAL(
+                write_tree(*tree.to_sgf_node(tree.get_first_child(node))),
+                "(\n;B[cc]\n(\n;W[dd]\n)\n(\n;W[ee]\n)\n)\n");
+}
+
+/** Test the conversion of an SgfNode into a CompactTree and back. */
+LIBBOARDGAME_TEST_CASE(sgf_compact_tree_from_sgf_node)
+{
+    istringstream in("(;FF[4];B[aa](;W[bb];B[cc](;W[dd])(;W[ee]))(;W[ff])"
+                     "(;W[gg]AB[hh][ii]))");
+    TreeReader reader;
+    reader.read(in);
+    auto& root = reader.get_tree();
+    CompactTree tree(root);
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_nu_nodes(), 8u);
+    LIBBOARDGAME_CHECK_EQUAL(write_tree(*tree.to_sgf_node()), write_tree(root));
+}
+
+/** Test that reading another tree reuses the reader's tree. */
+LIBBOARDGAME_TEST_CASE(sgf_compact_tree_reader_multi_tree)
+{
+    istringstream in("(;B[aa];W[bb])\n(;B[cc])");
+    CompactTreeReader reader;
+    LIBBOARDGAME_CHECK(reader.read(in, false));
+    LIBBOARDGAME_CHECK_EQUAL(reader.get_tree().get_nu_nodes(), 2u);
+    LIBBOARDGAME_CHECK(! reader.read(in, false));
+    auto& tree = reader.get_tree();
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_nu_nodes(), 1u);
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_property(tree.get_root(), "B"), "cc");
+}
+
+//-----------------------------------------------------------------------------
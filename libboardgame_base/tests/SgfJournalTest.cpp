@@ -0,0 +1,110 @@
+//-----------------------------------------------------------------------------
+/** @file libboardgame_base/tests/SgfJournalTest.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "libboardgame_base/SgfJournal.h"
+
+#include <sstream>
+#include "libboardgame_base/SgfTree.h"
+#include "libboardgame_base/TreeReader.h"
+#include "libboardgame_base/TreeWriter.h"
+#include "libboardgame_test/Test.h"
+
+using namespace std;
+using namespace libboardgame_base;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+void read_tree(SgfTree& tree, const string& sgf)
+{
+    istringstream in(sgf);
+    TreeReader reader;
+    reader.read(in);
+    auto root = reader.get_tree_transfer_ownership();
+    tree.init(root);
+}
+
+string write_tree(const SgfTree& tree)
+{
+    ostringstream out;
+    TreeWriter writer(out, tree.get_root());
+    writer.set_indent(-1);
+    writer.write();
+    return out.str();
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+/** Test that replaying the journal on the snapshot restores the tree. */
+LIBBOARDGAME_TEST_CASE(sgf_journal_replay)
+{
+    const string snapshot = "(;FF[4];B[aa](;W[bb];B[cc])(;W[dd])(;W[ee]))";
+    SgfTree tree;
+    read_tree(tree, snapshot);
+    SgfJournal journal;
+    tree.set_journal(&journal);
+    journal.clear();
+    auto& node1 = tree.get_root().get_first_child();
+    tree.set_comment(node1, "line 1\nline 2 with ] and \\ and [x]");
+    tree.move_down(node1.get_child(0));
+    tree.make_first_child(node1.get_child(2));
+    tree.truncate(node1.get_child(1));
+    auto& node2 = tree.create_new_child(node1.get_child(1));
+    tree.set_property(node2, "B", "ff");
+    vector<string> values{"aa", "", "bb"};
+    tree.set_property(node2, "AB", values);
+    tree.move_property_to_front(node2, "AB");
+    tree.set_good_move(node2);
+    tree.set_bad_move(node2);
+    tree.remove_property(tree.get_root(), "FF");
+    tree.delete_variations(tree.get_root());
+    LIBBOARDGAME_CHECK(journal.is_valid());
+    SgfTree restored;
+    read_tree(restored, snapshot);
+    SgfJournal::replay(restored, journal.get_records());
+    LIBBOARDGAME_CHECK_EQUAL(write_tree(restored), write_tree(tree));
+    // Records can be stored in parts
+    auto records = journal.get_records();
+    journal.clear_records();
+    tree.remove_children(node1);
+    tree.set_comment(tree.get_root(), "x");
+    records += journal.get_records();
+    read_tree(restored, snapshot);
+    SgfJournal::replay(restored, records);
+    LIBBOARDGAME_CHECK_EQUAL(write_tree(restored), write_tree(tree));
+}
+
+LIBBOARDGAME_TEST_CASE(sgf_journal_invalidate)
+{
+    SgfTree tree;
+    SgfJournal journal;
+    tree.set_journal(&journal);
+    LIBBOARDGAME_CHECK(! journal.is_valid());
+    journal.clear();
+    auto& node = tree.create_new_child(tree.get_root());
+    LIBBOARDGAME_CHECK(journal.is_valid());
+    tree.make_root(node);
+    LIBBOARDGAME_CHECK(! journal.is_valid());
+    LIBBOARDGAME_CHECK(journal.get_records().empty());
+    journal.clear();
+    tree.init();
+    LIBBOARDGAME_CHECK(! journal.is_valid());
+}
+
+LIBBOARDGAME_TEST_CASE(sgf_journal_mismatch)
+{
+    SgfTree tree;
+    read_tree(tree, "(;FF[4];B[aa])");
+    LIBBOARDGAME_CHECK_THROW(SgfJournal::replay(tree, "t 2 0 0\n"),
+                             SgfJournal::Error);
+    LIBBOARDGAME_CHECK_THROW(SgfJournal::replay(tree, "p 1 0 1:C"),
+                             SgfJournal::Error);
+}
+
+//-----------------------------------------------------------------------------
@@ -11,6 +11,26 @@ using namespace libboardgame_base;
 
 //-----------------------------------------------------------------------------
 
+LIBBOARDGAME_TEST_CASE(sgf_tree_changed_node)
+{
+    SgfTree tree;
+    auto& root = tree.get_root();
+    auto nu_changes = tree.get_nu_changes();
+    auto& node1 = tree.create_new_child(root);
+    auto& node2 = tree.create_new_child(root);
+    tree.move_up(node2);
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_nu_changes(), nu_changes);
+    tree.set_property(node1, "C", "foo");
+    tree.remove_property(node1, "C");
+    LIBBOARDGAME_CHECK(tree.get_changed_node(nu_changes) == &node1);
+    tree.set_property(node2, "C", "foo");
+    LIBBOARDGAME_CHECK(tree.get_changed_node(nu_changes) == nullptr);
+    LIBBOARDGAME_CHECK(tree.get_changed_node(nu_changes + 2) == &node2);
+    nu_changes = tree.get_nu_changes();
+    tree.truncate(node1);
+    LIBBOARDGAME_CHECK(tree.get_changed_node(nu_changes) == nullptr);
+}
+
 LIBBOARDGAME_TEST_CASE(sgf_tree_delete_all_variations)
 {
     // root - node1 - node2 - node3
@@ -26,4 +26,20 @@ LIBBOARDGAME_TEST_CASE(libboardgame_base_statistics_basic)
     LIBBOARDGAME_CHECK_CLOSE_EPS(s.get_deviation(), 1.854723, 1e-6);
 }
 
+/** Test that adding a mean with a weight is equivalent to adding the values
+    individually. */
+LIBBOARDGAME_TEST_CASE(libboardgame_base_statistics_base_weight)
+{
+    StatisticsBase<double> s1;
+    s1.add(12);
+    s1.add(11);
+    s1.add(14);
+    s1.add(16);
+    StatisticsBase<double> s2;
+    s2.init(11.5, 2);
+    s2.add(15, 2);
+    LIBBOARDGAME_CHECK_EQUAL(s2.get_count(), s1.get_count());
+    LIBBOARDGAME_CHECK_CLOSE_EPS(s2.get_mean(), s1.get_mean(), 1e-6);
+}
+
 //-----------------------------------------------------------------------------
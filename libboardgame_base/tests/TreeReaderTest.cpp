@@ -15,6 +15,20 @@ using namespace libboardgame_base;
 
 //-----------------------------------------------------------------------------
 
+namespace {
+
+string write_tree(const SgfNode& root)
+{
+    ostringstream out;
+    TreeWriter writer(out, root);
+    writer.write();
+    return out.str();
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
 LIBBOARDGAME_TEST_CASE(sgf_tree_reader_basic)
 {
     istringstream in("(;B[aa];W[bb])");
@@ -91,6 +105,50 @@ LIBBOARDGAME_TEST_CASE(sgf_tree_reader_property_after_newline)
     The reader should convert all platform-dependent newline sequences (LF,
     CR+LF, CR) into LF, such that property values containing newlines are
     independent on the platform that was used to write the file. */
+/** Test that reading from a buffer gives the same trees as reading from a
+    stream.
+    The values are longer than the block size of the SIMD scan and contain
+    delimiters at different positions. */
+LIBBOARDGAME_TEST_CASE(sgf_tree_reader_buffer)
+{
+    string sgf =
+        "(;GM[Blokus Duo] C [0123456789abcdef0123456789\\]\\\\x]\r\n"
+        "(;B[e10,f10,g10];C[line1\r\nline2\rline3\n0123456789abcdef]"
+        "X[][a][0123456789abcdef\\]](;W[aa]))(;B[j5]))  "
+        "(;GM[Blokus]  ;AB[1])\n";
+    const char* begin = sgf.data();
+    const char* end = begin + sgf.size();
+    istringstream in(sgf);
+    TreeReader buffer_reader;
+    TreeReader stream_reader;
+    LIBBOARDGAME_CHECK(buffer_reader.read(begin, end, false));
+    LIBBOARDGAME_CHECK(stream_reader.read(in, false));
+    auto& root = buffer_reader.get_tree();
+    LIBBOARDGAME_CHECK_EQUAL(root.get_property("C"),
+                             "0123456789abcdef0123456789]\\x");
+    LIBBOARDGAME_CHECK_EQUAL(root.get_child(0).get_child().get_property("C"),
+                             "line1\nline2\nline3\n0123456789abcdef");
+    LIBBOARDGAME_CHECK_EQUAL(write_tree(root),
+                             write_tree(stream_reader.get_tree()));
+    LIBBOARDGAME_CHECK(! buffer_reader.read(begin, end, false));
+    LIBBOARDGAME_CHECK(begin == end);
+    LIBBOARDGAME_CHECK(buffer_reader.get_tree().has_property("GM"));
+    LIBBOARDGAME_CHECK(buffer_reader.get_tree().get_child().has_property(
+                           "AB"));
+
+    // Single tree expected
+    begin = sgf.data();
+    LIBBOARDGAME_CHECK_THROW(buffer_reader.read(begin, end),
+                             TreeReader::ReadError);
+
+    // Unterminated value
+    string truncated = "(;C[0123456789abcdef0123456789";
+    begin = truncated.data();
+    LIBBOARDGAME_CHECK_THROW(buffer_reader.read(begin,
+                                                begin + truncated.size()),
+                             TreeReader::ReadError);
+}
+
 LIBBOARDGAME_TEST_CASE(sgf_tree_reader_newline)
 {
     {
@@ -0,0 +1,32 @@
+//-----------------------------------------------------------------------------
+/** @file libboardgame_mcts/CpuDispatch.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBBOARDGAME_MCTS_CPU_DISPATCH_H
+#define LIBBOARDGAME_MCTS_CPU_DISPATCH_H
+
+//-----------------------------------------------------------------------------
+
+/** Attribute for the hot functions of the search.
+    If LIBBOARDGAME_MCTS_CPU_DISPATCH is defined, the compiler generates
+    additional versions of the function for AVX2 and AVX-512 and the dynamic
+    linker selects the version for the CPU at program start. This allows
+    binaries built for a generic x86-64 CPU to use the wider instructions of
+    newer CPUs. Functions called by the function only benefit if they are
+    inlined into it, and the function itself can no longer be inlined.
+    The default version uses the same code as without this attribute.
+    Only supported with GCC on x86-64 Linux, because it needs the ifunc
+    support of the dynamic linker. */
+#if defined LIBBOARDGAME_MCTS_CPU_DISPATCH && defined __GNUC__ \
+    && ! defined __clang__ && defined __x86_64__ && defined __linux__
+#define LIBBOARDGAME_MCTS_DISPATCH \
+    __attribute__((target_clones("default", "avx2", "avx512f")))
+#else
+#define LIBBOARDGAME_MCTS_DISPATCH
+#endif
+
+//-----------------------------------------------------------------------------
+
+#endif // LIBBOARDGAME_MCTS_CPU_DISPATCH_H
@@ -113,6 +113,10 @@ public:
 
     void inc_visit_count();
 
+    /** Add several visits at once.
+        Used for flushing updates that were accumulated by a thread. */
+    void add_visit_count(Float n);
+
     /** Get node index of first child.
         @pre get_nu_children() > 0. Note that in lock-free search, it can
         happen that get_nu_children() was greater 0 but becomes negative
@@ -154,6 +158,15 @@ void Node<M, F, MT>::add_value(Float v, Float weight)
     m_value_count.store(count, memory_order_relaxed);
 }
 
+template<typename M, typename F, bool MT>
+inline void Node<M, F, MT>::add_visit_count(Float n)
+{
+    // See inc_visit_count()
+    Float count = m_visit_count.load(memory_order_relaxed);
+    count += n;
+    m_visit_count.store(count, memory_order_relaxed);
+}
+
 template<typename M, typename F, bool MT>
 void Node<M, F, MT>::add_value_remove_loss(Float v)
 {
@@ -7,12 +7,14 @@
 #ifndef LIBBOARDGAME_MCTS_SEARCH_BASE_H
 #define LIBBOARDGAME_MCTS_SEARCH_BASE_H
 
+#include <algorithm>
 #include <array>
 #include <condition_variable>
 #include <functional>
 #include <mutex>
 #include <thread>
 #include "Atomic.h"
+#include "CpuDispatch.h"
 #include "LastGoodReply.h"
 #include "PlayerMove.h"
 #include "Tree.h"
@@ -87,6 +89,15 @@ struct SearchParamConstDefault
         RAVE weight. */
     static constexpr bool rave_dist_weighting = false;
 
+    /** Minimum number of children of a node for using the sparse RAVE
+        update.
+        The sparse update iterates over the moves that the player to play at
+        the node played later in the simulation and finds the corresponding
+        children with a cache of child indices sorted by move, instead of
+        iterating over all children. The updated values are the same. 0
+        disables the sparse update. */
+    static constexpr unsigned rave_sparse_min_children = 0;
+
     /** Enable Last-Good-Reply heuristic.
         @see LastGoodReply */
     static constexpr bool use_lgr = false;
@@ -123,6 +134,51 @@ struct SearchParamConstDefault
     /** Increase of the expansion threshold per in-tree move played. */
     static constexpr Float expansion_threshold_inc = 0;
 
+    /** Depth up to which updates of the nodes are accumulated per thread.
+        If greater 0 and the search runs with more than one thread, the visit
+        count of the root and the value and visit count of the nodes up to
+        this depth are not written to the tree after each simulation but
+        accumulated in a buffer of the thread and added to the tree every
+        accumulation_interval simulations and at the end of the search. The
+        nodes near the root are visited in every simulation, so writing them
+        from all threads causes a lot of cache line transfers between the CPU
+        cores and lost updates. Virtual losses are not used for the
+        accumulated nodes.
+        The buffer stores pointers to the nodes. This requires that nodes
+        are not moved or deleted while the threads run the search loop.
+        Each thread flushes
+        its buffer before it leaves the search loop, so the buffers are
+        empty when the tree is pruned. */
+    static constexpr unsigned accumulation_depth = 0;
+
+    /** See accumulation_depth. */
+    static constexpr unsigned accumulation_interval = 16;
+
+    /** Number of leaves that are evaluated together by the leaf evaluator.
+        If greater 0, simulations whose leaf can be evaluated by the state
+        don't run a playout. Instead, the leaf is added to a queue shared by
+        all threads and the nodes of the simulation are held by a virtual
+        loss (also in a single-threaded search) until the value is backed up.
+        The thread that fills the queue evaluates all leaves in it with a
+        single call to the evaluator and backs up the values. This makes
+        evaluators affordable that have a high cost per call but a low cost
+        per position in the batch (e.g. vectorized linear models or small
+        neural networks). RAVE and Last-Good-Reply are only updated by
+        simulations with a playout. The state must provide:
+        - a type LeafInput containing the input of the evaluator for a
+          position
+        - bool get_leaf_input(LeafInput& input), called after the in-tree
+          phase, which returns false if the leaf should be evaluated by a
+          playout (e.g. at the end of the game)
+        - void evaluate_leaves(const LeafInput* inputs, size_t n,
+          array<Float, max_players>* evals), which may be called on the state
+          of any thread
+        The queued simulations store pointers to the nodes. Like for
+        accumulation_depth, this requires that nodes are not moved or
+        deleted during the search loop. The queue is empty after all threads
+        left the search loop. */
+    static constexpr unsigned leaf_batch_size = 0;
+
     /** Expected simulations per second.
         If the simulations per second vary a lot, it should be a value closer
         to the lower values. This value is used, for example, to determine an
@@ -137,6 +193,24 @@ struct SearchParamConstDefault
 
 //-----------------------------------------------------------------------------
 
+/** Type of the input of the leaf evaluator.
+    See SearchParamConstDefault::leaf_batch_size. Defined as an empty type if
+    the leaf evaluator is not used, such that the state does not need to
+    define it. */
+template<class S, bool use_leaf_evaluator>
+struct LeafInputType
+{
+    struct type { };
+};
+
+template<class S>
+struct LeafInputType<S, true>
+{
+    using type = typename S::LeafInput;
+};
+
+//-----------------------------------------------------------------------------
+
 /** Game-independent Monte-Carlo tree search.
     Game-dependent functionality is added by implementing some pure virtual
     functions and by template parameters.
@@ -187,6 +261,10 @@ public:
 
     using PlayerMove = libboardgame_mcts::PlayerMove<M>;
 
+    using LeafInput =
+        typename LeafInputType<S, (SearchParamConst::leaf_batch_size > 0)>
+        ::type;
+
 
     static constexpr PlayerInt max_players = SearchParamConst::max_players;
 
@@ -238,6 +316,21 @@ public:
         caches from the last search (e.g. Last-Good-Reply heuristic). */
     virtual bool check_followup(ArrayList<Move, max_moves>& sequence);
 
+    /** Check if the position at the root is equal to or a follow-up
+        position of a position stored with save_position().
+        Like check_followup(), but used for the trees in the tree cache (see
+        set_tree_cache()). The default implementation returns false. */
+    virtual bool check_cached_followup(unsigned key,
+                                       ArrayList<Move, max_moves>& sequence);
+
+    /** Store the game state at the root for the tree cache.
+        Called at the end of each search if the tree cache is enabled. The
+        subclass needs to remember the game state under the given key, such
+        that check_cached_followup() can compare it to the state at the root
+        of a later search. The keys are less than the maximum number of trees
+        in the cache plus one. The default implementation does nothing. */
+    virtual void save_position(unsigned key);
+
     virtual string get_info() const;
 
     virtual string get_info_ext() const;
@@ -273,6 +366,24 @@ public:
 
     bool get_reuse_tree() const;
 
+    /** Keep the trees of past searches that cannot be reused immediately.
+        If the tree of the last search cannot be reused, e.g. after an undo
+        or when analyzing positions in a different order, the search looks
+        for a cached tree whose root position is equal to or an ancestor of
+        the current position and reuses the corresponding subtree (subject
+        to set_reuse_subtree() and set_reuse_tree()). The least recently used
+        trees are removed if the cache contains more than max_trees trees or
+        the committed memory of the cached trees exceeds max_memory. The
+        subclass needs to implement save_position() and
+        check_cached_followup(). By default, the cache is disabled.
+        Calling this function clears the cache. */
+    void set_tree_cache(unsigned max_trees, size_t max_memory);
+
+    /** Remove all trees from the tree cache.
+        Needs to be called if the trees cannot be reused anymore, e.g.
+        because the prior knowledge for initializing nodes changed. */
+    void clear_tree_cache();
+
     /** Maximum parent visit count for applying RAVE. */
     void set_rave_parent_max(Float n);
 
@@ -333,11 +444,15 @@ public:
         of the callback function are: elapsed time, estimated remaining time. */
     void set_callback(const function<void(double, double)>& callback);
 
-    /** Get evaluation for a player at root node. */
-    const StatisticsDirty<Float>& get_root_val(PlayerInt player) const;
+    /** Get evaluation for a player at root node.
+        During a search, the evaluation is merged from the statistics of the
+        threads. This reads statistics that the threads write concurrently,
+        so it should only be used for reporting and infrequent checks
+        during a search. */
+    StatisticsBase<Float> get_root_val(PlayerInt player) const;
 
     /** Get evaluation for get_player() at root node. */
-    const StatisticsDirty<Float>& get_root_val() const;
+    StatisticsBase<Float> get_root_val() const;
 
     /** The number of times the root node was visited.
         This is equal to the number of simulations plus the visit count
@@ -351,6 +466,12 @@ public:
     /** Was the last search aborted? */
     bool was_aborted() const { return m_abort; }
 
+    /** Reset the abort flag outside of a search.
+        Needed if was_aborted() is used for aborting other algorithms that
+        run before a search, because search() resets the flag only when it
+        starts. */
+    void clear_abort() { m_abort = false; }
+
     /** Create the threads used in the search.
         This cannot be done in the constructor because it uses the virtual
         function create_state(). This function will automatically be called
@@ -387,6 +508,46 @@ private:
     };
 #endif
 
+    /** Update of a node accumulated by a thread.
+        See SearchParamConstDefault::accumulation_depth about the validity
+        of the node pointer. */
+    struct AccumulatedUpdate
+    {
+        const Node* node;
+
+        StatisticsBase<Float> value;
+
+        Float visit_count;
+    };
+
+    /** Indices of the children of a node sorted by move.
+        Used for the sparse RAVE update, see
+        SearchParamConstDefault::rave_sparse_min_children. */
+    struct RaveChildIndex
+    {
+        const Node* node = nullptr;
+
+        const Node* first_child;
+
+        unsigned nu_children;
+
+        /** Pairs of move (as integer) and child index. */
+        vector<pair<unsigned, unsigned>> children;
+    };
+
+    /** Size of the per-thread cache of RaveChildIndex. */
+    static constexpr unsigned rave_child_index_cache_size = 64;
+
+    static constexpr bool use_leaf_evaluator =
+            (SearchParamConst::leaf_batch_size > 0);
+
+    /** Add virtual losses to the nodes of a simulation?
+        Needed by the leaf evaluator even in a single-threaded search because
+        a thread selects several leaves before their values are backed up. */
+    static constexpr bool use_virtual_loss =
+            (multithread && SearchParamConst::virtual_loss)
+            || use_leaf_evaluator;
+
     /** Thread-specific search state. */
     struct ThreadState
     {
@@ -404,6 +565,16 @@ private:
 
         StatisticsExt<> stat_in_tree_len;
 
+        /** Evaluation of the root node in the simulations of this thread.
+            Only written by this thread, see get_root_val(). */
+        array<StatisticsDirty<Float>, max_players> root_val;
+
+        /** See SearchParamConstDefault::accumulation_depth. */
+        vector<AccumulatedUpdate> accumulated;
+
+        /** Number of simulations in accumulated. */
+        unsigned nu_accumulated_simulations = 0;
+
         /** Local variable for update_rave().
             Reused for efficiency. */
         array<PlayerInt, Move::range> was_played;
@@ -411,6 +582,52 @@ private:
         /** Local variable for update_rave().
             Reused for efficiency. */
         array<unsigned, Move::range> first_play;
+
+        /** Local variable for update_rave().
+            Indices of the moves of each player played after the current node
+            in the simulation. Reused for efficiency. */
+        array<ArrayList<unsigned, max_moves>, max_players> rave_moves;
+
+        /** Local variable for update_rave().
+            Children to update at the current node in the sparse update.
+            Reused for efficiency. */
+        array<const Node*, max_moves> rave_children;
+
+        /** Local variable for update_rave().
+            Distances and weights of the children in rave_children. Reused
+            for efficiency. */
+        array<Float, max_moves> rave_weights;
+
+        /** See RaveChildIndex. */
+        array<RaveChildIndex, rave_child_index_cache_size> rave_child_index;
+
+        /** Local variable for add_leaf().
+            Reused for efficiency. */
+        LeafInput leaf_input;
+
+        /** Batch of leaves taken from the shared queue for evaluation.
+            See SearchParamConstDefault::leaf_batch_size. */
+        vector<Simulation> leaf_simulations;
+
+        /** See leaf_simulations. */
+        vector<LeafInput> leaf_inputs;
+
+        /** Local variable for evaluate_leaves().
+            Reused for efficiency. */
+        vector<array<Float, max_players>> leaf_evals;
+    };
+
+    /** Tree of a past search in the tree cache.
+        See set_tree_cache(). */
+    struct CachedTree
+    {
+        unique_ptr<Tree> tree;
+
+        /** Key for save_position() and check_cached_followup(). */
+        unsigned key;
+
+        /** Time of last use for the LRU replacement, 0 if unused. */
+        uint64_t last_used = 0;
     };
 
     /** Thread in the parallel search.
@@ -470,7 +687,9 @@ private:
 
     Tree m_tree;
 
-    /** See get_root_val(). */
+    /** Evaluation of the root node at the start of the search.
+        The evaluations of the simulations of the current search are in
+        ThreadState::root_val. See get_root_val(). */
     array<StatisticsDirty<Float>, max_players> m_root_val;
 
     LastGoodReply<Move, max_players, lgr_hash_table_size, multithread> m_lgr;
@@ -489,6 +708,20 @@ private:
 
     bool m_reuse_tree = false;
 
+    /** Are node updates accumulated per thread in the current search?
+        See SearchParamConstDefault::accumulation_depth. */
+    bool m_accumulate = false;
+
+    /** Protects m_leaf_simulations and m_leaf_inputs. */
+    mutex m_leaf_mutex;
+
+    /** Simulations waiting for the evaluation of their leaf.
+        See SearchParamConstDefault::leaf_batch_size. */
+    vector<Simulation> m_leaf_simulations;
+
+    /** Inputs of the leaf evaluator for m_leaf_simulations. */
+    vector<LeafInput> m_leaf_inputs;
+
     /** Player to play at the root node of the search. */
     PlayerInt m_player;
 
@@ -530,6 +763,26 @@ private:
 
     Tree m_tmp_tree;
 
+    /** Memory of a tree as passed to the constructor of Tree. */
+    size_t m_tree_memory;
+
+    /** See set_tree_cache(). */
+    vector<CachedTree> m_tree_cache;
+
+    /** See set_tree_cache(). */
+    size_t m_tree_cache_max_memory = 0;
+
+    /** Counter for CachedTree::last_used. */
+    uint64_t m_tree_cache_time = 0;
+
+    /** Key of the position at the root of m_tree in the tree cache.
+        The keys of m_tree and the entries of m_tree_cache are a permutation
+        of [0..m_tree_cache.size()]. */
+    unsigned m_tree_key = 0;
+
+    /** Was save_position() called for m_tree_key? */
+    bool m_has_tree_key = false;
+
 #ifdef LIBBOARDGAME_DEBUG
     AssertionHandler m_assertion_handler;
 #endif
@@ -539,6 +792,10 @@ private:
 
     ArrayList<Move, max_moves> m_followup_sequence;
 
+    unsigned accumulate_values(ThreadState& thread_state);
+
+    bool add_leaf(ThreadState& thread_state);
+
     bool check_abort(const ThreadState& thread_state) const;
 
     LIBBOARDGAME_NOINLINE
@@ -546,15 +803,34 @@ private:
 
     bool check_cannot_change(ThreadState& thread_state, Float remaining) const;
 
+    void cache_tree(Tree& tree);
+
+    bool reuse_cached_tree(TimeSource& time_source, double& max_time);
+
     bool estimate_reused_root_val(Tree& tree, const Node& root, Float& value,
                                   Float& count);
 
     bool expand_node(ThreadState& thread_state, const Node& node,
                      const Node*& best_child);
 
-    void playout(ThreadState& thread_state);
+    void evaluate_leaves(ThreadState& thread_state);
 
-    void play_in_tree(ThreadState& thread_state);
+    StatisticsBase<Float> get_thread_root_val(const ThreadState& thread_state,
+                                              PlayerInt player) const;
+
+    void clear_rave_child_index();
+
+    void flush_accumulated(ThreadState& thread_state);
+
+    const RaveChildIndex& get_rave_child_index(
+            ThreadState& thread_state, const Node& node,
+            const typename Tree::Children& children);
+
+    bool is_accumulated(unsigned depth) const;
+
+    LIBBOARDGAME_MCTS_DISPATCH void playout(ThreadState& thread_state);
+
+    LIBBOARDGAME_MCTS_DISPATCH void play_in_tree(ThreadState& thread_state);
 
     bool prune(TimeSource& time_source, double time, Float prune_min_count,
                Float& new_prune_min_count);
@@ -568,6 +844,10 @@ private:
 
     void update_rave(ThreadState& thread_state);
 
+    void update_rave_sparse(ThreadState& thread_state, const Node& node,
+                            const typename Tree::Children& children,
+                            unsigned i, Float dist_factor);
+
     void update_values(ThreadState& thread_state);
 };
 
@@ -662,7 +942,8 @@ template<class S, class M, class R>
 SearchBase<S, M, R>::SearchBase(unsigned nu_threads, size_t memory)
     : m_tree(memory / 2, nu_threads),
       m_nu_threads(nu_threads),
-      m_tmp_tree(memory / 2, m_nu_threads)
+      m_tmp_tree(memory / 2, m_nu_threads),
+      m_tree_memory(memory / 2)
 #ifdef LIBBOARDGAME_DEBUG
       , m_assertion_handler(*this)
 #endif
@@ -671,6 +952,68 @@ SearchBase<S, M, R>::SearchBase(unsigned nu_threads, size_t memory)
 template<class S, class M, class R>
 SearchBase<S, M, R>::~SearchBase() = default; // Non-inline to avoid GCC -Winline warning
 
+/** Accumulate the updates of the nodes near the root in the buffer of the
+    thread.
+    @return The number of nodes of the simulation that were handled. */
+template<class S, class M, class R>
+unsigned SearchBase<S, M, R>::accumulate_values(ThreadState& thread_state)
+{
+    const auto& simulation = thread_state.simulation;
+    auto& nodes = simulation.nodes;
+    auto& eval = simulation.eval;
+    auto& accumulated = thread_state.accumulated;
+    auto nu_nodes =
+            min(static_cast<unsigned>(nodes.size()),
+                SearchParamConst::accumulation_depth + 1);
+    for (unsigned i = 0; i < nu_nodes; ++i)
+    {
+        auto node = nodes[i];
+        auto update = accumulated.begin();
+        while (update != accumulated.end() && update->node != node)
+            ++update;
+        if (update == accumulated.end())
+        {
+            accumulated.push_back({node, StatisticsBase<Float>(), 0});
+            update = accumulated.end() - 1;
+        }
+        if (i > 0)
+            update->value.add(eval[simulation.moves[i - 1].player]);
+        ++update->visit_count;
+    }
+    if (++thread_state.nu_accumulated_simulations
+            >= SearchParamConst::accumulation_interval)
+        flush_accumulated(thread_state);
+    return nu_nodes;
+}
+
+/** Add the leaf of the current simulation to the queue of the leaf
+    evaluator.
+    Evaluates the queued leaves if the batch is full.
+    @return false if the leaf needs to be evaluated by a playout. */
+template<class S, class M, class R>
+bool SearchBase<S, M, R>::add_leaf(ThreadState& thread_state)
+{
+    if constexpr (use_leaf_evaluator)
+    {
+        auto& input = thread_state.leaf_input;
+        if (! thread_state.state->get_leaf_input(input))
+            return false;
+        {
+            lock_guard<mutex> lock(m_leaf_mutex);
+            m_leaf_simulations.push_back(thread_state.simulation);
+            m_leaf_inputs.push_back(input);
+            if (m_leaf_inputs.size() < SearchParamConst::leaf_batch_size)
+                return true;
+            thread_state.leaf_simulations.swap(m_leaf_simulations);
+            thread_state.leaf_inputs.swap(m_leaf_inputs);
+        }
+        evaluate_leaves(thread_state);
+        return true;
+    }
+    else
+        return false;
+}
+
 template<class S, class M, class R>
 bool SearchBase<S, M, R>::check_abort(
         [[maybe_unused]] const ThreadState& thread_state) const
@@ -755,7 +1098,7 @@ bool SearchBase<S, M, R>::check_cannot_change(
     Float diff = max_wins - second_max;
     // Weight remaining number of simulations with current global win rate,
     // but not less than 10%
-    auto& root_val = m_root_val[m_player];
+    auto root_val = get_root_val(m_player);
     Float win_rate;
     if (root_val.get_count() > 100)
     {
@@ -771,6 +1114,64 @@ bool SearchBase<S, M, R>::check_cannot_change(
     return true;
 }
 
+/** Move a tree of the last search into the tree cache.
+    @param tree The tree with the root position of the last search (m_tree
+    or m_tmp_tree after m_tree was replaced by a subtree of it). After the
+    call, the tree is empty and m_tree_key is unused. */
+template<class S, class M, class R>
+void SearchBase<S, M, R>::cache_tree(Tree& tree)
+{
+    if (m_tree_cache.empty() || ! m_has_tree_key || tree.get_nu_nodes() <= 1)
+        return;
+    // Use an unused entry or replace the least recently used entry
+    auto entry = &m_tree_cache[0];
+    for (auto& i : m_tree_cache)
+        if (i.last_used < entry->last_used)
+            entry = &i;
+    if (! entry->tree)
+    {
+        try
+        {
+            entry->tree = make_unique<Tree>(m_tree_memory, m_nu_threads);
+        }
+        catch (const bad_alloc&)
+        {
+            LIBBOARDGAME_LOG("Not enough memory for tree cache");
+            return;
+        }
+    }
+    entry->tree->clear();
+    entry->tree->swap(tree);
+    std::swap(entry->key, m_tree_key);
+    entry->last_used = ++m_tree_cache_time;
+    m_has_tree_key = false;
+    // Remove least recently used trees if the memory limit is exceeded
+    while (true)
+    {
+        size_t memory = 0;
+        CachedTree* lru = nullptr;
+        for (auto& i : m_tree_cache)
+            if (i.last_used > 0)
+            {
+                memory += i.tree->get_committed_memory();
+                if (! lru || i.last_used < lru->last_used)
+                    lru = &i;
+            }
+        if (memory <= m_tree_cache_max_memory)
+            break;
+        lru->tree.reset();
+        lru->last_used = 0;
+    }
+}
+
+template<class S, class M, class R>
+bool SearchBase<S, M, R>::check_cached_followup(
+        [[maybe_unused]] unsigned key,
+        [[maybe_unused]] ArrayList<Move, max_moves>& sequence)
+{
+    return false;
+}
+
 template<class S, class M, class R>
 bool SearchBase<S, M, R>::check_followup(
         [[maybe_unused]] ArrayList<Move, max_moves>& sequence)
@@ -778,6 +1179,61 @@ bool SearchBase<S, M, R>::check_followup(
     return false;
 }
 
+template<class S, class M, class R>
+void SearchBase<S, M, R>::save_position([[maybe_unused]] unsigned key)
+{
+}
+
+template<class S, class M, class R>
+void SearchBase<S, M, R>::clear_tree_cache()
+{
+    for (auto& i : m_tree_cache)
+    {
+        i.tree.reset();
+        i.last_used = 0;
+    }
+}
+
+/** Evaluate the leaves in the batch of a thread and back up their values.
+    The batch can contain leaves of all threads. */
+template<class S, class M, class R>
+void SearchBase<S, M, R>::evaluate_leaves(ThreadState& thread_state)
+{
+    if constexpr (use_leaf_evaluator)
+    {
+        auto& simulations = thread_state.leaf_simulations;
+        auto& inputs = thread_state.leaf_inputs;
+        auto n = inputs.size();
+        if (n == 0)
+            return;
+        auto& evals = thread_state.leaf_evals;
+        evals.resize(n);
+        thread_state.state->evaluate_leaves(inputs.data(), n, evals.data());
+        auto& simulation = thread_state.simulation;
+        for (size_t i = 0; i < n; ++i)
+        {
+            simulation.nodes = simulations[i].nodes;
+            simulation.moves = simulations[i].moves;
+            simulation.eval = evals[i];
+            update_values(thread_state);
+        }
+        simulations.clear();
+        inputs.clear();
+    }
+}
+
+/** Invalidate the cached child indices of all threads.
+    Must be called if nodes were moved or deleted. */
+template<class S, class M, class R>
+void SearchBase<S, M, R>::clear_rave_child_index()
+{
+    if (SearchParamConst::rave_sparse_min_children == 0)
+        return;
+    for (auto& i : m_threads)
+        for (auto& j : i->thread_state.rave_child_index)
+            j.node = nullptr;
+}
+
 template<class S, class M, class R>
 void SearchBase<S, M, R>::create_threads()
 {
@@ -796,6 +1252,10 @@ void SearchBase<S, M, R>::create_threads()
         auto& thread_state = t->thread_state;
         thread_state.thread_id = i;
         thread_state.state = create_state();
+        if (SearchParamConst::accumulation_depth > 0)
+            thread_state.accumulated.reserve(
+                        SearchParamConst::accumulation_interval
+                        * SearchParamConst::accumulation_depth + 1);
         for (auto& was_played : thread_state.was_played)
             was_played = max_players;
         if (i > 0)
@@ -828,14 +1288,30 @@ bool SearchBase<S, M, R>::expand_node(ThreadState& thread_state,
     typename Tree::NodeExpander expander(thread_id, m_tree,
                                          SearchParamConst::child_min_count,
                                          SearchParamConst::max_move_prior);
-    auto root_val = m_root_val[state.get_player()].get_mean();
-    if (state.gen_children(expander, root_val))
+    auto root_val =
+            get_thread_root_val(thread_state, state.get_player()).get_mean();
+    if (! state.gen_children(expander, root_val))
+        return false;
+    expander.link_children(m_tree, node);
+    best_child = expander.get_best_child();
+    return true;
+}
+
+/** Add the updates accumulated by a thread to the tree. */
+template<class S, class M, class R>
+void SearchBase<S, M, R>::flush_accumulated(ThreadState& thread_state)
+{
+    for (auto& i : thread_state.accumulated)
     {
-        expander.link_children(m_tree, node);
-        best_child = expander.get_best_child();
-        return true;
+        // Adding the mean with the count as weight is equivalent to adding
+        // the values individually
+        if (i.value.get_count() > 0)
+            m_tree.add_value(*i.node, i.value.get_mean(),
+                             i.value.get_count());
+        m_tree.add_visit_count(*i.node, i.visit_count);
     }
-    return false;
+    thread_state.accumulated.clear();
+    thread_state.nu_accumulated_simulations = 0;
 }
 
 template<class S, class M, class R>
@@ -844,21 +1320,76 @@ inline size_t SearchBase<S, M, R>::get_nu_simulations() const
     return m_nu_simulations;
 }
 
+/** Get the cached child index of a node or create it.
+    The cache entry is recreated if the node was expanded again in the
+    meantime, which can happen in the lock-free search. */
 template<class S, class M, class R>
-inline auto SearchBase<S, M, R>::get_root_val(PlayerInt player) const
--> const StatisticsDirty<Float>&
+auto SearchBase<S, M, R>::get_rave_child_index(
+        ThreadState& thread_state, const Node& node,
+        const typename Tree::Children& children) -> const RaveChildIndex&
+{
+    auto hash = reinterpret_cast<uintptr_t>(&node) / sizeof(Node);
+    auto& index =
+            thread_state.rave_child_index[hash % rave_child_index_cache_size];
+    auto nu_children = static_cast<unsigned>(children.size());
+    if (index.node == &node && index.first_child == children.begin()
+            && index.nu_children == nu_children)
+        return index;
+    index.node = &node;
+    index.first_child = children.begin();
+    index.nu_children = nu_children;
+    index.children.clear();
+    for (unsigned i = 0; i < nu_children; ++i)
+        index.children.emplace_back(children.begin()[i].get_move().to_int(),
+                                    i);
+    sort(index.children.begin(), index.children.end());
+    return index;
+}
+
+template<class S, class M, class R>
+auto SearchBase<S, M, R>::get_root_val(PlayerInt player) const
+-> StatisticsBase<Float>
 {
     LIBBOARDGAME_ASSERT(player < m_nu_players);
-    return m_root_val[player];
+    StatisticsBase<Float> result;
+    result.init(m_root_val[player].get_mean(), m_root_val[player].get_count());
+    for (auto& i : m_threads)
+    {
+        auto& root_val = i->thread_state.root_val[player];
+        auto count = root_val.get_count();
+        if (count > 0)
+            result.add(root_val.get_mean(), count);
+    }
+    return result;
 }
 
 template<class S, class M, class R>
 inline auto SearchBase<S, M, R>::get_root_val() const
--> const StatisticsDirty<Float>&
+-> StatisticsBase<Float>
 {
     return get_root_val(get_player());
 }
 
+/** Get the evaluation of the root node as seen by a thread.
+    Like get_root_val() but only uses the evaluations of the simulations of
+    this thread in the current search. Unlike get_root_val(), it does not
+    read the statistics that other threads write concurrently, so it can be
+    used in the search loop. */
+template<class S, class M, class R>
+auto SearchBase<S, M, R>::get_thread_root_val(
+        const ThreadState& thread_state, PlayerInt player) const
+-> StatisticsBase<Float>
+{
+    LIBBOARDGAME_ASSERT(player < m_nu_players);
+    StatisticsBase<Float> result;
+    result.init(m_root_val[player].get_mean(), m_root_val[player].get_count());
+    auto& root_val = thread_state.root_val[player];
+    auto count = root_val.get_count();
+    if (count > 0)
+        result.add(root_val.get_mean(), count);
+    return result;
+}
+
 template<class S, class M, class R>
 inline auto SearchBase<S, M, R>::get_root_visit_count() const -> Float
 {
@@ -915,6 +1446,13 @@ inline auto SearchBase<S, M, R>::get_tree() const -> const Tree&
     return m_tree;
 }
 
+template<class S, class M, class R>
+inline bool SearchBase<S, M, R>::is_accumulated(unsigned depth) const
+{
+    return SearchParamConst::accumulation_depth > 0 && m_accumulate
+            && depth <= SearchParamConst::accumulation_depth;
+}
+
 template<class S, class M, class R>
 void SearchBase<S, M, R>::on_start_search([[maybe_unused]] bool is_followup)
 {
@@ -955,7 +1493,7 @@ void SearchBase<S, M, R>::play_in_tree(ThreadState& thread_state)
     while (! (children = m_tree.get_children(*node)).empty())
     {
         node = select_child(*node, children);
-        if (multithread && SearchParamConst::virtual_loss)
+        if (use_virtual_loss && ! is_accumulated(simulation.nodes.size()))
             m_tree.add_value(*node, 0);
         simulation.nodes.push_back(node);
         Move mv = node->get_move();
@@ -971,6 +1509,13 @@ void SearchBase<S, M, R>::play_in_tree(ThreadState& thread_state)
             thread_state.is_out_of_mem = true;
         else if (node)
         {
+            // update_values() removes a virtual loss from all nodes of the
+            // simulation. Without the leaf evaluator, the expanded child is
+            // updated right after the playout, and it never had a virtual
+            // loss, which is kept for unchanged search results.
+            if (use_leaf_evaluator
+                    && ! is_accumulated(simulation.nodes.size()))
+                m_tree.add_value(*node, 0);
             simulation.nodes.push_back(node);
             Move mv = node->get_move();
             simulation.moves.push_back({state.get_player(), mv});
@@ -1018,6 +1563,15 @@ bool SearchBase<S, M, R>::prune(
         TimeSource& time_source, [[maybe_unused]] double time,
         Float prune_min_count, Float& new_prune_min_count)
 {
+#ifdef LIBBOARDGAME_DEBUG
+    // The accumulated updates and queued leaves point to nodes of m_tree
+    LIBBOARDGAME_ASSERT(m_leaf_simulations.empty());
+    for (auto& i : m_threads)
+    {
+        LIBBOARDGAME_ASSERT(i->thread_state.accumulated.empty());
+        LIBBOARDGAME_ASSERT(i->thread_state.leaf_simulations.empty());
+    }
+#endif
     Timer timer(time_source);
     m_tmp_tree.clear();
     m_tree.copy_subtree(m_tmp_tree, m_tmp_tree.get_root(), m_tree.get_root(),
@@ -1062,6 +1616,61 @@ bool SearchBase<S, M, R>::estimate_reused_root_val(Tree& tree,
     return count > 0;
 }
 
+/** Replace the empty m_tree by the best matching tree in the tree cache.
+    @return true if a cached tree was found. */
+template<class S, class M, class R>
+bool SearchBase<S, M, R>::reuse_cached_tree(TimeSource& time_source,
+                                            double& max_time)
+{
+    CachedTree* entry = nullptr;
+    const Node* node = nullptr;
+    ArrayList<Move, max_moves> sequence;
+    for (auto& i : m_tree_cache)
+    {
+        if (i.last_used == 0 || ! check_cached_followup(i.key, sequence))
+            continue;
+        if (sequence.empty() ? ! m_reuse_tree : ! m_reuse_subtree)
+            continue;
+        auto n = find_node(*i.tree, sequence);
+        if (n && n->get_nu_children() > 0
+                && (! node || n->get_visit_count() > node->get_visit_count()))
+        {
+            entry = &i;
+            node = n;
+        }
+    }
+    if (! entry)
+        return false;
+    Timer timer(time_source);
+    size_t tree_nodes = entry->tree->get_nu_nodes();
+    if (node == &entry->tree->get_root())
+    {
+        // Same position, move the whole tree out of the cache
+        m_tree.swap(*entry->tree);
+        std::swap(entry->key, m_tree_key);
+        m_has_tree_key = true;
+        entry->tree.reset();
+        entry->last_used = 0;
+    }
+    else
+    {
+        entry->tree->extract_subtree(m_tree, *node);
+        entry->last_used = ++m_tree_cache_time;
+    }
+    Float value, count;
+    if (estimate_reused_root_val(m_tree, m_tree.get_root(), value, count))
+        m_root_val[m_player].add(value, count);
+    double time = timer();
+    LIBBOARDGAME_LOG("Reusing ", m_tree.get_nu_nodes(), " nodes (",
+                     std::fixed, setprecision(1),
+                     100 * double(m_tree.get_nu_nodes()) / double(tree_nodes),
+                     "% of cached tree, tm=", setprecision(4), time, ")");
+    max_time -= time;
+    if (max_time < 0)
+        max_time = 0;
+    return true;
+}
+
 template<class S, class M, class R>
 bool SearchBase<S, M, R>::search(Move& mv, Float max_count,
                                  size_t min_simulations, double max_time,
@@ -1132,6 +1741,7 @@ bool SearchBase<S, M, R>::search(Move& mv, Float max_count,
                                      / double(tree_nodes),
                                      "% tm=", setprecision(4), time, ")");
                     m_tree.swap(m_tmp_tree);
+                    cache_tree(m_tmp_tree);
                     clear_tree = false;
                     max_time -= time;
                     if (max_time < 0)
@@ -1141,7 +1751,13 @@ bool SearchBase<S, M, R>::search(Move& mv, Float max_count,
         }
     }
     if (clear_tree)
+    {
+        cache_tree(m_tree);
         m_tree.clear();
+        if (reuse_cached_tree(time_source, max_time))
+            clear_tree = false;
+    }
+    clear_rave_child_index();
 
     m_timer.reset(time_source);
     m_time_source = &time_source;
@@ -1176,6 +1792,7 @@ bool SearchBase<S, M, R>::search(Move& mv, Float max_count,
         LIBBOARDGAME_LOG("Using single-threading for short search");
         nu_threads = 1;
     }
+    m_accumulate = (multithread && nu_threads > 1);
 
     auto& thread_state_0 = m_threads[0]->thread_state;
     auto& root = m_tree.get_root();
@@ -1211,7 +1828,24 @@ bool SearchBase<S, M, R>::search(Move& mv, Float max_count,
                 break;
             double time = m_timer();
             prune(time_source, time, prune_min_count, prune_min_count);
+            clear_rave_child_index();
         }
+    for (auto& i : m_threads)
+    {
+        auto& root_val = i->thread_state.root_val;
+        for (PlayerInt j = 0; j < m_nu_players; ++j)
+        {
+            if (root_val[j].get_count() > 0)
+                m_root_val[j].add(root_val[j].get_mean(),
+                                  root_val[j].get_count());
+            root_val[j].clear();
+        }
+    }
+    if (! m_tree_cache.empty())
+    {
+        save_position(m_tree_key);
+        m_has_tree_key = true;
+    }
 
     m_last_time = m_timer();
     LIBBOARDGAME_LOG(get_info());
@@ -1251,6 +1885,8 @@ void SearchBase<S, M, R>::search_loop(ThreadState& thread_state)
         play_in_tree(thread_state);
         if (thread_state.is_out_of_mem)
             break;
+        if (use_leaf_evaluator && add_leaf(thread_state))
+            continue;
         playout(thread_state);
         state.evaluate_playout(simulation.eval);
         thread_state.stat_len.add(double(simulation.moves.size()));
@@ -1260,6 +1896,19 @@ void SearchBase<S, M, R>::search_loop(ThreadState& thread_state)
         if (SearchParamConst::use_lgr)
             update_lgr(thread_state);
     }
+    if (use_leaf_evaluator)
+    {
+        // Evaluate the remaining leaves. Threads that are still running
+        // evaluate the leaves they add later themselves.
+        {
+            lock_guard<mutex> lock(m_leaf_mutex);
+            thread_state.leaf_simulations.swap(m_leaf_simulations);
+            thread_state.leaf_inputs.swap(m_leaf_inputs);
+        }
+        evaluate_leaves(thread_state);
+    }
+    if (SearchParamConst::accumulation_depth > 0)
+        flush_accumulated(thread_state);
 }
 
 /** Select child in in-tree phase of the search.
@@ -1377,6 +2026,19 @@ void SearchBase<S, M, R>::set_reuse_tree(bool enable)
     m_reuse_tree = enable;
 }
 
+template<class S, class M, class R>
+void SearchBase<S, M, R>::set_tree_cache(unsigned max_trees,
+                                         size_t max_memory)
+{
+    m_tree_cache.clear();
+    m_tree_cache.resize(max_trees);
+    for (unsigned i = 0; i < max_trees; ++i)
+        m_tree_cache[i].key = i + 1;
+    m_tree_cache_max_memory = max_memory;
+    m_tree_key = 0;
+    m_has_tree_key = false;
+}
+
 template<class S, class M, class R>
 void SearchBase<S, M, R>::update_lgr(ThreadState& thread_state)
 {
@@ -1421,12 +2083,17 @@ void SearchBase<S, M, R>::update_rave(ThreadState& thread_state)
         return;
     auto& was_played = thread_state.was_played;
     auto& first_play = thread_state.first_play;
+    auto& rave_moves = thread_state.rave_moves;
     auto& nodes = thread_state.simulation.nodes;
     auto nu_nodes = static_cast<unsigned>(nodes.size());
     unsigned i = nu_moves - 1;
     // nu_nodes is at least 2 (including root) because the case of no legal
     // moves at the root is already handled before running any simulations.
     LIBBOARDGAME_ASSERT(nu_nodes > 1);
+    constexpr bool sparse = (SearchParamConst::rave_sparse_min_children > 0);
+    if (sparse)
+        for (PlayerInt j = 0; j < m_nu_players; ++j)
+            rave_moves[j].clear();
 
     // Fill was_played and first_play with information from playout moves
     for ( ; i >= nu_nodes - 1; --i)
@@ -1436,6 +2103,8 @@ void SearchBase<S, M, R>::update_rave(ThreadState& thread_state)
             continue;
         was_played[mv.move.to_int()] = mv.player;
         first_play[mv.move.to_int()] = i;
+        if (sparse)
+            rave_moves[mv.player].push_back(i);
     }
 
     // Add RAVE values to children of nodes of current simulation
@@ -1446,28 +2115,37 @@ void SearchBase<S, M, R>::update_rave(ThreadState& thread_state)
             break;
         auto mv = moves[i];
         auto player = mv.player;
-        Float dist_factor;
+        Float dist_factor = 0;
         if (SearchParamConst::rave_dist_weighting)
             dist_factor = 1 / static_cast<Float>(nu_moves - i);
-        for (auto& it : m_tree.get_children(*node))
-        {
-            auto mv = it.get_move();
-            if (was_played[mv.to_int()] != player
-                    || it.get_value_count() > m_rave_child_max)
-                continue;
-            auto first = first_play[mv.to_int()];
-            LIBBOARDGAME_ASSERT(first > i);
-            Float weight = m_rave_weight;
-            if (SearchParamConst::rave_dist_weighting)
-                weight *= 1 - static_cast<Float>(first - i) * dist_factor;
-            m_tree.add_value(it, thread_state.simulation.eval[player], weight);
-        }
+        auto children = m_tree.get_children(*node);
+        if (sparse
+                && children.size()
+                   >= SearchParamConst::rave_sparse_min_children)
+            update_rave_sparse(thread_state, *node, children, i, dist_factor);
+        else
+            for (auto& it : children)
+            {
+                auto mv = it.get_move();
+                if (was_played[mv.to_int()] != player
+                        || it.get_value_count() > m_rave_child_max)
+                    continue;
+                auto first = first_play[mv.to_int()];
+                LIBBOARDGAME_ASSERT(first > i);
+                Float weight = m_rave_weight;
+                if (SearchParamConst::rave_dist_weighting)
+                    weight *= 1 - static_cast<Float>(first - i) * dist_factor;
+                m_tree.add_value(it, thread_state.simulation.eval[player],
+                                 weight);
+            }
         if (i == 0)
             break;
         if (! state.skip_rave(mv.move))
         {
             was_played[mv.move.to_int()] = player;
             first_play[mv.move.to_int()] = i;
+            if (sparse)
+                rave_moves[player].push_back(i);
         }
         --i;
     }
@@ -1477,6 +2155,62 @@ void SearchBase<S, M, R>::update_rave(ThreadState& thread_state)
         was_played[moves[i].move.to_int()] = max_players;
 }
 
+/** Sparse version of the RAVE update of the children of a node.
+    Produces the same values as the loop over all children in update_rave()
+    but only iterates over the moves played later in the simulation by the
+    player to play at the node.
+    @param thread_state
+    @param node The node.
+    @param children The children of the node.
+    @param i The index of the node in the simulation.
+    @param dist_factor The distance factor, only used if
+    SearchParamConst::rave_dist_weighting */
+template<class S, class M, class R>
+void SearchBase<S, M, R>::update_rave_sparse(
+        ThreadState& thread_state, const Node& node,
+        const typename Tree::Children& children, unsigned i,
+        [[maybe_unused]] Float dist_factor)
+{
+    auto& moves = thread_state.simulation.moves;
+    auto& first_play = thread_state.first_play;
+    auto& rave_children = thread_state.rave_children;
+    auto& rave_weights = thread_state.rave_weights;
+    auto player = moves[i].player;
+    auto& index = get_rave_child_index(thread_state, node, children);
+    auto begin = index.children.begin();
+    auto end = index.children.end();
+    // Collect the children to update with their distance to the node
+    unsigned n = 0;
+    for (auto j : thread_state.rave_moves[player])
+    {
+        unsigned mv_int = moves[j].move.to_int();
+        if (first_play[mv_int] != j)
+            continue; // Move was played again earlier in the simulation
+        auto pos = lower_bound(begin, end, make_pair(mv_int, 0u));
+        if (pos == end || pos->first != mv_int)
+            continue;
+        auto& child = children.begin()[pos->second];
+        if (child.get_value_count() > m_rave_child_max)
+            continue;
+        rave_children[n] = &child;
+        rave_weights[n] = static_cast<Float>(j - i);
+        ++n;
+    }
+    // Compute the weights in a separate loop, which the compiler can
+    // vectorize
+    auto rave_weight = m_rave_weight;
+    if (SearchParamConst::rave_dist_weighting)
+        for (unsigned j = 0; j < n; ++j)
+            rave_weights[j] =
+                    rave_weight * (1 - rave_weights[j] * dist_factor);
+    else
+        for (unsigned j = 0; j < n; ++j)
+            rave_weights[j] = rave_weight;
+    auto eval = thread_state.simulation.eval[player];
+    for (unsigned j = 0; j < n; ++j)
+        m_tree.add_value(*rave_children[j], eval, rave_weights[j]);
+}
+
 template<class S, class M, class R>
 void SearchBase<S, M, R>::update_values(ThreadState& thread_state)
 {
@@ -1484,12 +2218,16 @@ void SearchBase<S, M, R>::update_values(ThreadState& thread_state)
     auto& nodes = simulation.nodes;
     auto& eval = simulation.eval;
     auto nu_nodes = static_cast<unsigned>(nodes.size());
-    m_tree.inc_visit_count(*nodes[0]);
-    for (unsigned i = 1; i < nu_nodes; ++i)
+    unsigned i = 1;
+    if (is_accumulated(0))
+        i = accumulate_values(thread_state);
+    else
+        m_tree.inc_visit_count(*nodes[0]);
+    for ( ; i < nu_nodes; ++i)
     {
         auto& node = *nodes[i];
         auto mv = simulation.moves[i - 1];
-        if (multithread && SearchParamConst::virtual_loss)
+        if (use_virtual_loss)
             // Note that this could become problematic if the number of threads
             // is large. The lock-free algorithm intentionally ignores lost or
             // partial updates to run faster. But the probability that adding
@@ -1503,7 +2241,7 @@ void SearchBase<S, M, R>::update_values(ThreadState& thread_state)
         m_tree.inc_visit_count(node);
     }
     for (PlayerInt i = 0; i < m_nu_players; ++i)
-        m_root_val[i].add(eval[i]);
+        thread_state.root_val[i].add(eval[i]);
 }
 
 //-----------------------------------------------------------------------------
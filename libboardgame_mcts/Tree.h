@@ -9,12 +9,16 @@
 
 #include <algorithm>
 #include <memory>
+#include <new>
 #include "Node.h"
+#include "libboardgame_base/Range.h"
+#include "libboardgame_base/VirtualMemory.h"
 
 namespace libboardgame_mcts {
 
 using namespace std;
 using libboardgame_base::Range;
+using libboardgame_base::VirtualMemory;
 
 //-----------------------------------------------------------------------------
 
@@ -25,7 +29,11 @@ using libboardgame_base::Range;
     The tree uses separate parts of the node storage for different threads,
     so it can be used without locking in multi-threaded search. Not all
     functions are thread-safe, only the ones that are used during a search
-    (e.g. expanding a node is thread-safe, but clear() is not) */
+    (e.g. expanding a node is thread-safe, but clear() is not)<p>
+    The memory for the nodes is only reserved at construction. It is
+    committed in chunks when nodes are created and released by clear(), so
+    the physical memory used is proportional to the actual size of the
+    tree. */
 template<typename N>
 class Tree
 {
@@ -65,8 +73,9 @@ public:
                      Float max_move_prior);
 
         /** Check if the tree still has the capacity for a given number
-            of children. */
-        bool check_capacity(unsigned short nu_children) const;
+            of children.
+            Commits the memory for the children if needed. */
+        bool check_capacity(unsigned short nu_children);
 
         /** Add new child.
             It needs to be checked first with check_capacity() that the tree
@@ -85,6 +94,8 @@ public:
         const Node* get_best_child() const;
 
     private:
+        Tree& m_tree;
+
         ThreadStorage& m_thread_storage;
 
         Float m_best_move_prior = -numeric_limits<Float>::max();
@@ -114,6 +125,9 @@ public:
 
     size_t get_nu_nodes() const;
 
+    /** Get the memory currently committed for the nodes. */
+    size_t get_committed_memory() const;
+
     const Node& get_node(NodeIdx i) const;
 
     void set_expanding(const Node& node) { non_const(node).set_expanding(); }
@@ -129,6 +143,8 @@ public:
 
     void inc_visit_count(const Node& node);
 
+    void add_visit_count(const Node& node, Float n);
+
     void swap(Tree& tree);
 
     /** Extract a subtree.
@@ -158,10 +174,19 @@ private:
         Node* end;
 
         Node* next;
+
+        /** End of the committed memory. */
+        Node* committed;
     };
 
 
-    unique_ptr<Node[]> m_nodes;
+    /** Number of nodes in the chunks in which memory is committed. */
+    static constexpr size_t chunk_nodes = (size_t(1) << 20) / sizeof(Node);
+
+
+    unique_ptr<VirtualMemory> m_memory;
+
+    Node* m_nodes;
 
     unique_ptr<ThreadStorage[]> m_thread_storage;
 
@@ -172,6 +197,8 @@ private:
     size_t m_nodes_per_thread;
 
 
+    bool commit(ThreadStorage& thread_storage, Node* end);
+
     bool contains(const Node& node) const;
 
     void copy_recurse(Tree& target, const Node& target_node, const Node& node,
@@ -186,7 +213,8 @@ template<typename N>
 inline Tree<N>::NodeExpander::NodeExpander(
         unsigned thread_id, Tree& tree, [[maybe_unused]] Float child_min_count,
         [[maybe_unused]] Float max_move_prior)
-    : m_thread_storage(tree.m_thread_storage[thread_id]),
+    : m_tree(tree),
+      m_thread_storage(tree.m_thread_storage[thread_id]),
       m_first_child(m_thread_storage.next),
       m_best_child(nullptr)
 {
@@ -218,9 +246,11 @@ inline void Tree<N>::NodeExpander::add_child(const Move& mv, Float value,
 
 template<typename N>
 inline bool Tree<N>::NodeExpander::check_capacity(
-        unsigned short nu_children) const
+        unsigned short nu_children)
 {
-    return m_thread_storage.end - m_thread_storage.next  >= nu_children;
+    return m_thread_storage.end - m_thread_storage.next  >= nu_children
+            && m_tree.commit(m_thread_storage,
+                             m_thread_storage.next + nu_children);
 }
 
 template<typename N>
@@ -270,20 +300,16 @@ Tree<N>::Tree(size_t memory, unsigned nu_threads)
         min(max_nodes, static_cast<size_t>(numeric_limits<NodeIdx>::max()));
     m_nu_threads = nu_threads;
     m_max_nodes = max_nodes;
-
-    // Using make_unique<Node[]>(max_nodes) slows down the array creation and
-    // thereby the startup time of Pentobi with GCC 7/8 because the compiler
-    // does not optimize away the call to the empty Move() constructor (last
-    // tested with GCC 7.2.0 and GCC 8.0.0 on Ubuntu 17.10).
-    m_nodes.reset(new Node[max_nodes]);
-
+    m_memory = make_unique<VirtualMemory>(max_nodes * sizeof(Node));
+    m_nodes = static_cast<Node*>(m_memory->data());
     m_thread_storage = make_unique<ThreadStorage[]>(nu_threads);
     m_nodes_per_thread = max_nodes / nu_threads;
     for (unsigned i = 0; i < nu_threads; ++i)
     {
         auto& thread_storage = m_thread_storage[i];
-        thread_storage.begin = m_nodes.get() + i * m_nodes_per_thread;
+        thread_storage.begin = m_nodes + i * m_nodes_per_thread;
         thread_storage.end = thread_storage.begin + m_nodes_per_thread;
+        thread_storage.committed = thread_storage.begin;
     }
     clear();
 }
@@ -303,16 +329,55 @@ inline void Tree<N>::add_value(const Node& node, Float v, Float weight)
 template<typename N>
 void Tree<N>::clear()
 {
-    m_thread_storage[0].next = m_thread_storage[0].begin + 1;
-    for (unsigned i = 1; i < m_nu_threads; ++i)
-        m_thread_storage[i].next = m_thread_storage[i].begin;
+    for (unsigned i = 0; i < m_nu_threads; ++i)
+    {
+        auto& thread_storage = m_thread_storage[i];
+        // Release the committed memory but the first chunk of the first
+        // thread, which contains the root node
+        auto keep = thread_storage.begin;
+        if (i == 0)
+            keep = min(thread_storage.committed, keep + chunk_nodes);
+        m_memory->release(static_cast<size_t>(keep - m_nodes) * sizeof(Node),
+                          static_cast<size_t>(thread_storage.committed
+                                              - m_nodes) * sizeof(Node));
+        thread_storage.committed = keep;
+        thread_storage.next = thread_storage.begin;
+    }
+    auto& thread_storage = m_thread_storage[0];
+    if (! commit(thread_storage, thread_storage.begin + 1))
+        throw bad_alloc();
+    ++thread_storage.next;
     m_nodes[0].init_root();
 }
 
+/** Commit the memory of a thread storage up to a node.
+    Commits at least a chunk at a time to avoid a system call for each node
+    expansion. */
+template<typename N>
+bool Tree<N>::commit(ThreadStorage& thread_storage, Node* end)
+{
+    LIBBOARDGAME_ASSERT(end <= thread_storage.end);
+    auto committed = thread_storage.committed;
+    if (end <= committed)
+        return true;
+    if (thread_storage.end - committed > ptrdiff_t(chunk_nodes))
+        end = max(end, committed + chunk_nodes);
+    else
+        end = thread_storage.end;
+    if (! m_memory->commit(static_cast<size_t>(committed - m_nodes)
+                           * sizeof(Node),
+                           static_cast<size_t>(end - m_nodes) * sizeof(Node)))
+        return false;
+    for (auto i = committed; i != end; ++i)
+        new (i) Node;
+    thread_storage.committed = end;
+    return true;
+}
+
 template<typename N>
 bool Tree<N>::contains(const Node& node) const
 {
-    return &node >= m_nodes.get() && &node < m_nodes.get() + m_max_nodes;
+    return &node >= m_nodes && &node < m_nodes + m_max_nodes;
 }
 
 template<typename N>
@@ -343,11 +408,13 @@ void Tree<N>::copy_recurse(Tree& target, const Node& target_node,
         target.m_thread_storage[get_thread_storage(first_child)];
     auto target_child = thread_storage.next;
     auto target_first_child =
-        static_cast<NodeIdx>(target_child - target.m_nodes.get());
+        static_cast<NodeIdx>(target_child - target.m_nodes);
     target.non_const(target_node).link_children_st(target_first_child,
                                                    nu_children);
     thread_storage.next += nu_children;
     LIBBOARDGAME_ASSERT(thread_storage.next < thread_storage.end);
+    if (! target.commit(thread_storage, thread_storage.next))
+        throw bad_alloc();
     auto end = &first_child + nu_children;
     for (auto i = &first_child; i != end; ++i, ++target_child)
     {
@@ -383,6 +450,19 @@ size_t Tree<N>::get_nu_nodes() const
     return result;
 }
 
+template<typename N>
+size_t Tree<N>::get_committed_memory() const
+{
+    size_t result = 0;
+    for (unsigned i = 0; i < m_nu_threads; ++i)
+    {
+        auto& thread_storage = m_thread_storage[i];
+        result += (thread_storage.committed - thread_storage.begin)
+                * sizeof(Node);
+    }
+    return result;
+}
+
 template<typename N>
 inline auto Tree<N>::get_root() const -> const Node&
 {
@@ -393,7 +473,7 @@ inline auto Tree<N>::get_root() const -> const Node&
 template<typename N>
 inline unsigned Tree<N>::get_thread_storage(const Node& node) const
 {
-    size_t diff = &node - m_nodes.get();
+    size_t diff = &node - m_nodes;
     return static_cast<unsigned>(diff / m_nodes_per_thread);
 }
 
@@ -403,11 +483,17 @@ inline void Tree<N>::inc_visit_count(const Node& node)
     non_const(node).inc_visit_count();
 }
 
+template<typename N>
+inline void Tree<N>::add_visit_count(const Node& node, Float n)
+{
+    non_const(node).add_visit_count(n);
+}
+
 template<typename N>
 inline void Tree<N>::link_children(const Node& node, const Node* first_child,
                                    unsigned nu_children)
 {
-    auto first_child_idx = static_cast<NodeIdx>(first_child - m_nodes.get());
+    auto first_child_idx = static_cast<NodeIdx>(first_child - m_nodes);
     LIBBOARDGAME_ASSERT(first_child_idx > 0);
     LIBBOARDGAME_ASSERT(first_child_idx < m_max_nodes);
     non_const(node).link_children(first_child_idx, nu_children);
@@ -439,14 +525,16 @@ void Tree<N>::swap(Tree& tree)
         size_t m_max_nodes;
         size_t m_nodes_per_thread;
         unique_ptr<ThreadStorage> m_thread_storage;
-        unique_ptr<Node[]> m_nodes;
+        unique_ptr<VirtualMemory> m_memory;
+        Node* m_nodes;
     };
     static_assert(sizeof(Tree) == sizeof(Dummy));
     std::swap(m_nu_threads, tree.m_nu_threads);
     std::swap(m_max_nodes, tree.m_max_nodes);
     std::swap(m_nodes_per_thread, tree.m_nodes_per_thread);
     m_thread_storage.swap(tree.m_thread_storage);
-    m_nodes.swap(tree.m_nodes);
+    m_memory.swap(tree.m_memory);
+    std::swap(m_nodes, tree.m_nodes);
 }
 
 //-----------------------------------------------------------------------------
@@ -0,0 +1,215 @@
+//-----------------------------------------------------------------------------
+/** @file libboardgame_mcts/tests/SearchBaseTest.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "libboardgame_mcts/SearchBase.h"
+
+#include "libboardgame_base/CpuTimeSource.h"
+#include "libboardgame_test/Test.h"
+
+using namespace std;
+using libboardgame_base::CpuTimeSource;
+using libboardgame_mcts::PlayerInt;
+using libboardgame_mcts::PlayerMove;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+struct TestMove
+{
+    using IntType = unsigned;
+
+    static constexpr IntType range = 4;
+
+    IntType i;
+
+    static TestMove null() { return {range}; }
+
+    IntType to_int() const { return i; }
+
+    bool operator==(TestMove mv) const { return i == mv.i; }
+
+    bool operator!=(TestMove mv) const { return i != mv.i; }
+};
+
+struct TestSearchParamConst
+    : public libboardgame_mcts::SearchParamConstDefault
+{
+    static constexpr unsigned leaf_batch_size = 8;
+};
+
+/** Counters shared by the states of all threads. */
+struct LeafCounters
+{
+    atomic<size_t> nu_queued{0};
+
+    atomic<size_t> nu_evaluated{0};
+
+    atomic<size_t> nu_playouts{0};
+};
+
+/** State of a game in which each of two players has three moves in each
+    position and the game ends after a fixed number of moves.
+    All evaluations return 1 for both players, so the value of every node
+    is 1 if all values were backed up and all virtual losses removed. */
+class TestState
+{
+public:
+    using Float = float;
+
+    using Tree = libboardgame_mcts::Tree<
+        libboardgame_mcts::Node<TestMove, Float, true>>;
+
+    struct LeafInput
+    {
+        unsigned nu_moves;
+    };
+
+    static constexpr unsigned game_length = 12;
+
+
+    explicit TestState(LeafCounters& counters)
+        : m_counters(counters)
+    { }
+
+    void start_search() { }
+
+    void start_simulation([[maybe_unused]] size_t n) { m_nu_moves = 0; }
+
+    void play_in_tree([[maybe_unused]] TestMove mv) { ++m_nu_moves; }
+
+    void finish_in_tree() { }
+
+    void play_expanded_child([[maybe_unused]] TestMove mv) { ++m_nu_moves; }
+
+    PlayerInt get_player() const { return PlayerInt(m_nu_moves % 2); }
+
+    bool gen_children(Tree::NodeExpander& expander,
+                      [[maybe_unused]] Float root_val)
+    {
+        if (m_nu_moves >= game_length)
+            return true;
+        if (! expander.check_capacity(3))
+            return false;
+        for (unsigned i = 0; i < 3; ++i)
+            expander.add_child({i}, 1, 1, 1);
+        return true;
+    }
+
+    bool get_leaf_input(LeafInput& input)
+    {
+        if (m_nu_moves >= game_length)
+            return false;
+        input.nu_moves = m_nu_moves;
+        ++m_counters.nu_queued;
+        return true;
+    }
+
+    void evaluate_leaves(const LeafInput* inputs, size_t n,
+                         array<Float, 2>* evals)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            LIBBOARDGAME_CHECK(inputs[i].nu_moves < game_length);
+            evals[i].fill(1);
+        }
+        m_counters.nu_evaluated += n;
+    }
+
+    void start_playout() { ++m_counters.nu_playouts; }
+
+    template<class L>
+    bool gen_playout_move([[maybe_unused]] const L& lgr,
+                          [[maybe_unused]] TestMove last,
+                          [[maybe_unused]] TestMove second_last,
+                          PlayerMove<TestMove>& mv)
+    {
+        if (m_nu_moves >= game_length)
+            return false;
+        mv = {get_player(), {0}};
+        return true;
+    }
+
+    void play_playout([[maybe_unused]] TestMove mv) { ++m_nu_moves; }
+
+    void evaluate_playout(array<Float, 2>& result) { result.fill(1); }
+
+    bool skip_rave([[maybe_unused]] TestMove mv) const { return false; }
+
+#ifdef LIBBOARDGAME_DEBUG
+    string dump() const { return {}; }
+#endif
+
+private:
+    LeafCounters& m_counters;
+
+    unsigned m_nu_moves = 0;
+};
+
+class TestSearch
+    : public libboardgame_mcts::SearchBase<TestState, TestMove,
+                                           TestSearchParamConst>
+{
+public:
+    LeafCounters counters;
+
+    using SearchBase::SearchBase;
+
+    unique_ptr<TestState> create_state() override
+    {
+        return make_unique<TestState>(counters);
+    }
+
+    PlayerInt get_nu_players() const override { return 2; }
+
+    PlayerInt get_player() const override { return 0; }
+};
+
+/** Check that all queued leaves were evaluated and backed up. */
+void check_leaf_evaluator(unsigned nu_threads)
+{
+    TestSearch search(nu_threads, 10000000);
+    CpuTimeSource time_source;
+    TestMove mv;
+    LIBBOARDGAME_CHECK(search.search(mv, 2000, 0, 0, time_source));
+    auto& counters = search.counters;
+    LIBBOARDGAME_CHECK(counters.nu_queued > 0);
+    LIBBOARDGAME_CHECK_EQUAL(counters.nu_evaluated.load(),
+                             counters.nu_queued.load());
+    LIBBOARDGAME_CHECK_EQUAL(
+                counters.nu_evaluated.load() + counters.nu_playouts.load(),
+                search.get_nu_simulations());
+    if (nu_threads > 1)
+        // Lost updates in the lock-free search could change the visit
+        // counts and values
+        return;
+    auto& tree = search.get_tree();
+    LIBBOARDGAME_CHECK_EQUAL(size_t(tree.get_root().get_visit_count()),
+                             search.get_nu_simulations());
+    vector<const TestSearch::Node*> stack;
+    for (auto& child : tree.get_root_children())
+        stack.push_back(&child);
+    while (! stack.empty())
+    {
+        auto node = stack.back();
+        stack.pop_back();
+        LIBBOARDGAME_CHECK_CLOSE(node->get_value(), 1.f, 1e-4f);
+        for (auto& child : tree.get_children(*node))
+            stack.push_back(&child);
+    }
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+LIBBOARDGAME_TEST_CASE(libboardgame_mcts_search_base_leaf_evaluator)
+{
+    check_leaf_evaluator(1);
+    check_leaf_evaluator(4);
+}
+
+//-----------------------------------------------------------------------------
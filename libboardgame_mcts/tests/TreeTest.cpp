@@ -0,0 +1,73 @@
+//-----------------------------------------------------------------------------
+/** @file libboardgame_mcts/tests/TreeTest.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "libboardgame_mcts/Tree.h"
+
+#include "libboardgame_test/Test.h"
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+struct TestMove
+{
+    static constexpr unsigned range = 100;
+
+    unsigned i;
+
+    static TestMove null() { return {range}; }
+
+    bool operator==(TestMove mv) const { return i == mv.i; }
+};
+
+using TestNode = libboardgame_mcts::Node<TestMove, float, true>;
+
+using TestTree = libboardgame_mcts::Tree<TestNode>;
+
+const float priors[] = { 0.1f, 0.5f, 0.2f, 0.4f, 0.3f };
+
+void add_children(TestTree::NodeExpander& expander, float value)
+{
+    LIBBOARDGAME_CHECK(expander.check_capacity(5));
+    for (unsigned i = 0; i < 5; ++i)
+        expander.add_child({i}, value, 1, priors[i]);
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+/** Test that memory is committed only when nodes are created. */
+LIBBOARDGAME_TEST_CASE(libboardgame_mcts_tree_committed_memory)
+{
+    size_t memory = 100000000;
+    TestTree tree(memory, 2);
+    auto committed = tree.get_committed_memory();
+    LIBBOARDGAME_CHECK(committed > 0);
+    LIBBOARDGAME_CHECK(committed < memory / 10);
+    auto& root = tree.get_root();
+    auto node = &root;
+    unsigned nu_nodes = 1;
+    // Create a chain of nodes in the storage of the second thread, which
+    // needs more than one chunk
+    while (tree.get_committed_memory() <= 2 * committed)
+    {
+        TestTree::NodeExpander expander(1, tree, 1, 1);
+        add_children(expander, 0.5f);
+        expander.link_children(tree, *node);
+        node = tree.get_children(*node).begin();
+        nu_nodes += 5;
+    }
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_nu_nodes(), size_t(nu_nodes));
+    LIBBOARDGAME_CHECK(tree.get_committed_memory() < memory / 10);
+    tree.clear();
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_committed_memory(), committed);
+    LIBBOARDGAME_CHECK(tree.get_children(root).empty());
+}
+
+//-----------------------------------------------------------------------------
@@ -132,6 +132,13 @@ public:
     /** Get number of bonus points of a color. */
     ScoreType get_bonus(Color c) const;
 
+    /** Get the bonus for playing all pieces in the current game variant. */
+    ScoreType get_bonus_all_pieces() const { return m_bonus_all_pieces; }
+
+    /** Get the additional bonus for playing the 1-piece last in the current
+        game variant. */
+    ScoreType get_bonus_one_piece() const { return m_bonus_one_piece; }
+
     /** Is a point a potential attachment point for a color.
         Does not check if the point is forbidden. */
     bool is_attach_point(Point p, Color c) const;
@@ -7,6 +7,10 @@
 #include "BoardConst.h"
 
 #include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <random>
 #include "Marker.h"
 #include "PieceTransformsClassic.h"
 #include "PieceTransformsGembloQ.h"
@@ -24,6 +28,65 @@ namespace {
 
 const bool log_move_creation = false;
 
+/** Version of the cache file.
+    Must be increased if the format of the cache file or the algorithms that
+    compute the cached data change. */
+const uint32_t cache_version = 1;
+
+/** Header of the cache file.
+    The header is followed by the move info arrays, m_nu_attach_points,
+    m_move_index and the compact representation of m_precomp_moves, each
+    starting at a multiple of cache_alignment. */
+struct CacheHeader
+{
+    char magic[8];
+
+    uint32_t version;
+
+    uint32_t board_type;
+
+    uint32_t piece_set;
+
+    uint32_t range;
+
+    uint32_t move_info_size;
+
+    uint32_t move_info_ext_size;
+
+    uint32_t move_info_ext_2_size;
+
+    uint32_t adj_status_nu_adj;
+
+    uint32_t move_index_size;
+
+    uint32_t nu_precomp_moves;
+};
+
+const char cache_magic[8] = { 'P', 'B', 'C', 'O', 'N', 'S', 'T', '\0' };
+
+const size_t cache_alignment = 64;
+
+/** Protects the instances returned by BoardConst::get(), g_cache_dir and
+    the global variables used during construction. */
+mutex g_mutex;
+
+string g_cache_dir;
+
+
+size_t get_cache_aligned(size_t n)
+{
+    return (n + cache_alignment - 1) / cache_alignment * cache_alignment;
+}
+
+/** Size of the hash table BoardConst::m_move_index. */
+size_t get_move_index_size(Move::IntType range)
+{
+    size_t size = 1;
+    while (size < 2 * static_cast<size_t>(range))
+        size *= 2;
+    return size;
+}
+
 /** Local variable used during construction.
     Making this variable global slightly speeds up construction and a
     thread-safe construction is not needed. */
@@ -808,7 +871,8 @@ vector<PieceInfo> create_pieces_nexos(const Geometry& geo,
 
 //-----------------------------------------------------------------------------
 
-BoardConst::BoardConst(BoardType board_type, PieceSet piece_set)
+BoardConst::BoardConst(BoardType board_type, PieceSet piece_set,
+                       const string& cache_file)
     : m_board_type(board_type),
       m_piece_set(piece_set),
       m_geo(libpentobi_base::get_geometry(board_type))
@@ -863,32 +927,32 @@ BoardConst::BoardConst(BoardType board_type, PieceSet piece_set)
         m_pieces = create_pieces_classic(m_geo, *m_transforms);
         m_max_piece_size = 5;
         m_max_adj_attach = 16;
-        m_move_info.reset(calloc(m_range, sizeof(MoveInfo<5>)));
-        m_move_info_ext.reset(calloc(m_range, sizeof(MoveInfoExt<16>)));
+        m_move_info_size = sizeof(MoveInfo<5>);
+        m_move_info_ext_size = sizeof(MoveInfoExt<16>);
         break;
     case PieceSet::junior:
         m_transforms = make_unique<PieceTransformsClassic>();
         m_pieces = create_pieces_junior(m_geo, *m_transforms);
         m_max_piece_size = 5;
         m_max_adj_attach = 16;
-        m_move_info.reset(calloc(m_range, sizeof(MoveInfo<5>)));
-        m_move_info_ext.reset(calloc(m_range, sizeof(MoveInfoExt<16>)));
+        m_move_info_size = sizeof(MoveInfo<5>);
+        m_move_info_ext_size = sizeof(MoveInfoExt<16>);
         break;
     case PieceSet::trigon:
         m_transforms = make_unique<PieceTransformsTrigon>();
         m_pieces = create_pieces_trigon(m_geo, *m_transforms);
         m_max_piece_size = 6;
         m_max_adj_attach = 22;
-        m_move_info.reset(calloc(m_range, sizeof(MoveInfo<6>)));
-        m_move_info_ext.reset(calloc(m_range, sizeof(MoveInfoExt<22>)));
+        m_move_info_size = sizeof(MoveInfo<6>);
+        m_move_info_ext_size = sizeof(MoveInfoExt<22>);
         break;
     case PieceSet::nexos:
         m_transforms = make_unique<PieceTransformsClassic>();
         m_pieces = create_pieces_nexos(m_geo, *m_transforms);
         m_max_piece_size = 7;
         m_max_adj_attach = 12;
-        m_move_info.reset(calloc(m_range, sizeof(MoveInfo<7>)));
-        m_move_info_ext.reset(calloc(m_range, sizeof(MoveInfoExt<12>)));
+        m_move_info_size = sizeof(MoveInfo<7>);
+        m_move_info_ext_size = sizeof(MoveInfoExt<12>);
         break;
     case PieceSet::callisto:
         m_transforms = make_unique<PieceTransformsClassic>();
@@ -899,19 +963,18 @@ BoardConst::BoardConst(BoardType board_type, PieceSet piece_set)
         // faster if we don't have to handle different values for
         // m_max_adj_attach for the same m_max_piece_size.
         m_max_adj_attach = 16;
-        m_move_info.reset(calloc(m_range, sizeof(MoveInfo<5>)));
-        m_move_info_ext.reset(calloc(m_range, sizeof(MoveInfoExt<16>)));
+        m_move_info_size = sizeof(MoveInfo<5>);
+        m_move_info_ext_size = sizeof(MoveInfoExt<16>);
         break;
     case PieceSet::gembloq:
         m_transforms = make_unique<PieceTransformsGembloQ>();
         m_pieces = create_pieces_gembloq(m_geo, *m_transforms);
         m_max_piece_size = 22;
         m_max_adj_attach = 44;
-        m_move_info.reset(calloc(m_range, sizeof(MoveInfo<22>)));
-        m_move_info_ext.reset(calloc(m_range, sizeof(MoveInfoExt<44>)));
+        m_move_info_size = sizeof(MoveInfo<22>);
+        m_move_info_ext_size = sizeof(MoveInfoExt<44>);
         break;
     }
-    m_move_info_ext_2 = make_unique<MoveInfoExt2[]>(m_range);
     m_nu_pieces = static_cast<Piece::IntType>(m_pieces.size());
     for (Point p : m_geo)
         if (has_adj_status_points(p))
@@ -921,7 +984,16 @@ BoardConst::BoardConst(BoardType board_type, PieceSet piece_set)
     for (Point p : m_geo)
         m_compare_val[p] =
                 (height - m_geo.get_y(p) - 1) * width + m_geo.get_x(p);
+    if (! cache_file.empty() && load_cache(cache_file))
+        return;
+    m_move_info_storage.reset(calloc(m_range, m_move_info_size));
+    m_move_info_ext_storage.reset(calloc(m_range, m_move_info_ext_size));
+    m_move_info_ext_2_storage = make_unique<MoveInfoExt2[]>(m_range);
+    m_move_info = m_move_info_storage.get();
+    m_move_info_ext = m_move_info_ext_storage.get();
+    m_move_info_ext_2 = m_move_info_ext_2_storage.get();
     create_moves();
+    init_move_index();
     switch (piece_set)
     {
     case PieceSet::classic:
@@ -949,6 +1021,8 @@ BoardConst::BoardConst(BoardType board_type, PieceSet piece_set)
         init_symmetry_info<6>();
     else if (board_type == BoardType::gembloq_2)
         init_symmetry_info<22>();
+    if (! cache_file.empty())
+        save_cache(cache_file);
 }
 
 template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH>
@@ -960,14 +1034,15 @@ inline void BoardConst::create_move(unsigned& moves_created, Piece piece,
     LIBBOARDGAME_ASSERT(moves_created < m_range);
     Move mv(static_cast<Move::IntType>(moves_created));
     void* place =
-            static_cast<MoveInfo<MAX_SIZE>*>(m_move_info.get())
+            static_cast<MoveInfo<MAX_SIZE>*>(m_move_info_storage.get())
             + moves_created;
     new(place) MoveInfo<MAX_SIZE>(piece, points);
     place =
-            static_cast<MoveInfoExt<MAX_ADJ_ATTACH>*>(m_move_info_ext.get())
+            static_cast<MoveInfoExt<MAX_ADJ_ATTACH>*>(
+                m_move_info_ext_storage.get())
             + moves_created;
     auto& info_ext = *new(place) MoveInfoExt<MAX_ADJ_ATTACH>();
-    auto& info_ext_2 = m_move_info_ext_2[moves_created];
+    auto& info_ext_2 = m_move_info_ext_2_storage[moves_created];
     ++moves_created;
     auto scored_points = &info_ext_2.scored_points[0];
     for (auto p : points)
@@ -1059,6 +1134,7 @@ void BoardConst::create_moves()
                 }
     }
     LIBBOARDGAME_ASSERT(moves_created == m_range);
+    m_nu_precomp_moves = n;
     LIBBOARDGAME_LOG("Created moves: ", moves_created, ", precomp: ", n);
 }
 
@@ -1147,7 +1223,7 @@ bool BoardConst::from_string(Move& mv, const string& s) const
         while (end != s.end() && *end != ',')
             ++end;
         Point p;
-        if (! m_geo.from_string(begin, end, p))
+        if (! read_point(begin, end, p))
             return false;
         if (points.size() == MovePoints::max_size)
             return false;
@@ -1163,11 +1239,20 @@ bool BoardConst::from_string(Move& mv, const string& s) const
 const BoardConst& BoardConst::get(Variant variant)
 {
     static map<BoardType, map<PieceSet, unique_ptr<BoardConst>>> board_const;
+    lock_guard<mutex> lock(g_mutex);
     auto board_type = libpentobi_base::get_board_type(variant);
     auto piece_set = libpentobi_base::get_piece_set(variant);
     auto& bc = board_const[board_type][piece_set];
     if (! bc)
-        bc.reset(new BoardConst(board_type, piece_set));
+    {
+        string cache_file;
+        if (! g_cache_dir.empty())
+            cache_file = g_cache_dir + "/board-const-"
+                    + std::to_string(cache_version) + "-"
+                    + std::to_string(static_cast<int>(board_type)) + "-"
+                    + std::to_string(static_cast<int>(piece_set)) + ".dat";
+        bc.reset(new BoardConst(board_type, piece_set, cache_file));
+    }
     return *bc;
 }
 
@@ -1200,22 +1285,22 @@ bool BoardConst::find_move(const MovePoints& points, Move& move) const
         return false;
     MovePoints sorted_points = points;
     sort(sorted_points);
-    for (Piece::IntType i = 0; i < m_pieces.size(); ++i)
+    auto begin = sorted_points.begin();
+    auto end = sorted_points.end();
+    for (auto i = get_points_hash(begin, end) & m_move_index_mask; ;
+         i = (i + 1) & m_move_index_mask)
     {
-        Piece piece(i);
-        for (auto mv : get_moves(piece, points[0]))
+        auto mv = m_move_index[i];
+        if (mv.is_null())
+            return false;
+        auto& info_ext_2 = get_move_info_ext_2(mv);
+        if (equal(begin, end, info_ext_2.begin_scored_points(),
+                  info_ext_2.end_scored_points()))
         {
-            auto& info_ext_2 = get_move_info_ext_2(mv);
-            if (equal(sorted_points.begin(), sorted_points.end(),
-                      info_ext_2.begin_scored_points(),
-                      info_ext_2.end_scored_points()))
-            {
-                move = mv;
-                return true;
-            }
+            move = mv;
+            return true;
         }
     }
-    return false;
 }
 
 bool BoardConst::find_move(const MovePoints& points, Piece piece,
@@ -1233,6 +1318,14 @@ bool BoardConst::find_move(const MovePoints& points, Piece piece,
     return false;
 }
 
+size_t BoardConst::get_points_hash(const Point* begin, const Point* end)
+{
+    size_t hash = 0;
+    for (auto i = begin; i != end; ++i)
+        hash = (hash ^ i->to_int()) * 0x100000001b3u;
+    return hash ^ (hash >> 29);
+}
+
 /** Builds the list of neighboring points that is used for the adjacent
     status for matching precompted move lists. */
 void BoardConst::init_adj_status_points(Point p)
@@ -1289,6 +1382,32 @@ void BoardConst::init_adj_status_points(Point p)
     LIBBOARDGAME_ASSERT(n == max_size);
 }
 
+void BoardConst::init_move_index()
+{
+    auto size = get_move_index_size(m_range);
+    m_move_index.assign(size, Move::null());
+    m_move_index_mask = size - 1;
+    for (Move::IntType i = 1; i < m_range; ++i)
+    {
+        Move mv(i);
+        auto& info_ext_2 = get_move_info_ext_2(mv);
+        auto begin = info_ext_2.begin_scored_points();
+        auto end = info_ext_2.end_scored_points();
+        auto j = get_points_hash(begin, end) & m_move_index_mask;
+        for ( ; ! m_move_index[j].is_null(); j = (j + 1) & m_move_index_mask)
+        {
+            // If several moves have the same points, find_move() returns
+            // the first one
+            auto& info_ext_2_j = get_move_info_ext_2(m_move_index[j]);
+            if (equal(begin, end, info_ext_2_j.begin_scored_points(),
+                      info_ext_2_j.end_scored_points()))
+                break;
+        }
+        if (m_move_index[j].is_null())
+            m_move_index[j] = mv;
+    }
+}
+
 template<unsigned MAX_SIZE>
 void BoardConst::init_symmetry_info()
 {
@@ -1297,7 +1416,7 @@ void BoardConst::init_symmetry_info()
     {
         Move mv(i);
         auto& info = get_move_info<MAX_SIZE>(mv);
-        auto& info_ext_2 = m_move_info_ext_2[i];
+        auto& info_ext_2 = m_move_info_ext_2_storage[i];
         info_ext_2.breaks_symmetry = false;
         array<Point, PieceInfo::max_size> sym_points;
         MovePoints::IntType n = 0;
@@ -1319,6 +1438,166 @@ void BoardConst::init_symmetry_info()
     }
 }
 
+bool BoardConst::load_cache(const string& file)
+{
+    try
+    {
+        m_cache_file = make_unique<MappedFile>(file);
+    }
+    catch (const MappedFile::Error&)
+    {
+        return false;
+    }
+    auto data = m_cache_file->data();
+    auto size = m_cache_file->size();
+    CacheHeader header;
+    if (size < sizeof(header))
+    {
+        m_cache_file.reset();
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, cache_magic, sizeof(cache_magic)) != 0
+            || header.version != cache_version
+            || header.board_type != static_cast<uint32_t>(m_board_type)
+            || header.piece_set != static_cast<uint32_t>(m_piece_set)
+            || header.range != m_range
+            || header.move_info_size != m_move_info_size
+            || header.move_info_ext_size != m_move_info_ext_size
+            || header.move_info_ext_2_size != sizeof(MoveInfoExt2)
+            || header.adj_status_nu_adj != PrecompMoves::adj_status_nu_adj
+            || header.move_index_size != get_move_index_size(m_range)
+            || header.nu_precomp_moves
+                    > PrecompMoves::max_move_lists_sum_length)
+    {
+        m_cache_file.reset();
+        return false;
+    }
+    size_t offset = get_cache_aligned(sizeof(header));
+    auto get_section = [&](size_t section_size) {
+        auto begin = data + offset;
+        offset = get_cache_aligned(offset + section_size);
+        return begin;
+    };
+    auto move_info = get_section(m_range * m_move_info_size);
+    auto move_info_ext = get_section(m_range * m_move_info_ext_size);
+    auto move_info_ext_2 = get_section(m_range * sizeof(MoveInfoExt2));
+    auto nu_attach_points = get_section(sizeof(m_nu_attach_points));
+    auto move_index = get_section(header.move_index_size * sizeof(Move));
+    auto precomp_moves = data + offset;
+    if (offset + PrecompMoves::get_compact_size(m_geo,
+                                                header.nu_precomp_moves)
+            != size)
+    {
+        m_cache_file.reset();
+        return false;
+    }
+    m_move_info = move_info;
+    m_move_info_ext = move_info_ext;
+    m_move_info_ext_2 = reinterpret_cast<const MoveInfoExt2*>(move_info_ext_2);
+    memcpy(&m_nu_attach_points, nu_attach_points, sizeof(m_nu_attach_points));
+    auto move_index_begin = reinterpret_cast<const Move*>(move_index);
+    m_move_index.assign(move_index_begin,
+                        move_index_begin + header.move_index_size);
+    m_move_index_mask = header.move_index_size - 1;
+    m_nu_precomp_moves = header.nu_precomp_moves;
+    m_precomp_moves.read_compact(precomp_moves, m_geo, m_nu_precomp_moves);
+    if (m_board_type == BoardType::duo || m_board_type == BoardType::callisto_2
+            || m_board_type == BoardType::trigon
+            || m_board_type == BoardType::gembloq_2)
+        m_symmetric_points.init(m_geo);
+    LIBBOARDGAME_LOG("Loaded moves from ", file);
+    return true;
+}
+
+/** Read a point of a move string.
+    Handles the common case of lowercase letters followed by digits without
+    whitespace directly and falls back to Geometry::from_string() for
+    everything else. */
+bool BoardConst::read_point(string::const_iterator begin,
+                            string::const_iterator end, Point& p) const
+{
+    auto width = m_geo.get_width();
+    auto height = m_geo.get_height();
+    auto i = begin;
+    unsigned x = 0;
+    for ( ; i != end && *i >= 'a' && *i <= 'z' && x <= width; ++i)
+        x = 26 * x + static_cast<unsigned>(*i - 'a' + 1);
+    unsigned y = 0;
+    if (i != begin && x <= width)
+    {
+        auto digits_begin = i;
+        for ( ; i != end && *i >= '0' && *i <= '9' && y <= height; ++i)
+            y = 10 * y + static_cast<unsigned>(*i - '0');
+        if (i == end && i != digits_begin && y >= 1 && y <= height
+                && m_geo.is_onboard(x - 1, height - y))
+        {
+            p = m_geo.get_point(x - 1, height - y);
+            return true;
+        }
+    }
+    return m_geo.from_string(begin, end, p);
+}
+
+void BoardConst::save_cache(const string& file) const
+{
+    // Write to a temporary file and rename it, such that other processes
+    // never see a partially written file
+    auto tmp_file = file + "." + std::to_string(random_device()()) + ".tmp";
+    {
+        ofstream out(tmp_file, ios::binary);
+        size_t offset = 0;
+        auto write_section = [&](const void* section, size_t section_size) {
+            static const char zeros[cache_alignment] = {};
+            auto padding = get_cache_aligned(offset) - offset;
+            out.write(zeros, static_cast<streamsize>(padding));
+            out.write(static_cast<const char*>(section),
+                      static_cast<streamsize>(section_size));
+            offset += padding + section_size;
+        };
+        CacheHeader header;
+        memcpy(header.magic, cache_magic, sizeof(cache_magic));
+        header.version = cache_version;
+        header.board_type = static_cast<uint32_t>(m_board_type);
+        header.piece_set = static_cast<uint32_t>(m_piece_set);
+        header.range = m_range;
+        header.move_info_size = static_cast<uint32_t>(m_move_info_size);
+        header.move_info_ext_size = static_cast<uint32_t>(m_move_info_ext_size);
+        header.move_info_ext_2_size = sizeof(MoveInfoExt2);
+        header.adj_status_nu_adj = PrecompMoves::adj_status_nu_adj;
+        header.move_index_size = static_cast<uint32_t>(m_move_index.size());
+        header.nu_precomp_moves = m_nu_precomp_moves;
+        write_section(&header, sizeof(header));
+        write_section(m_move_info, m_range * m_move_info_size);
+        write_section(m_move_info_ext, m_range * m_move_info_ext_size);
+        write_section(m_move_info_ext_2, m_range * sizeof(MoveInfoExt2));
+        write_section(&m_nu_attach_points, sizeof(m_nu_attach_points));
+        write_section(m_move_index.data(), m_move_index.size() * sizeof(Move));
+        write_section(nullptr, 0);
+        m_precomp_moves.write_compact(out, m_geo, m_nu_precomp_moves);
+        out.close();
+        if (! out)
+        {
+            LIBBOARDGAME_LOG("Could not write ", tmp_file);
+            remove(tmp_file.c_str());
+            return;
+        }
+    }
+    if (rename(tmp_file.c_str(), file.c_str()) != 0)
+    {
+        // Another process may have created the file at the same time
+        remove(tmp_file.c_str());
+        return;
+    }
+    LIBBOARDGAME_LOG("Wrote ", file);
+}
+
+void BoardConst::set_cache_dir(const string& dir)
+{
+    lock_guard<mutex> lock(g_mutex);
+    g_cache_dir = dir;
+}
+
 void BoardConst::sort(MovePoints& points) const
 {
     auto less = [this](Point a, Point b)
@@ -12,10 +12,12 @@
 #include "PrecompMoves.h"
 #include "SymmetricPoints.h"
 #include "Variant.h"
+#include "libboardgame_base/MappedFile.h"
 #include "libboardgame_base/Range.h"
 
 namespace libpentobi_base {
 
+using libboardgame_base::MappedFile;
 using libboardgame_base::Range;
 
 //-----------------------------------------------------------------------------
@@ -41,9 +43,18 @@ public:
 
     /** Get the single instance for a given board size.
         The instance is created the first time this function is called.
-        This function is not thread-safe. */
+        This function is thread-safe. */
     static const BoardConst& get(Variant variant);
 
+    /** Set a directory for caching the precomputed data.
+        If set, get() loads the data from a cache file in this directory,
+        which is memory-mapped, such that processes that use the same game
+        variant share the pages of the move info arrays. If the file does not
+        exist or was created by a different version, the data is computed and
+        the file is written. Should be called before the first call of get().
+        An empty string (the default) disables the cache. */
+    static void set_cache_dir(const string& dir);
+
     template<unsigned MAX_SIZE>
     static const MoveInfo<MAX_SIZE>&
     get_move_info(Move mv, MoveInfoArray move_info_array);
@@ -83,7 +94,7 @@ public:
     template<unsigned MAX_SIZE>
     Piece get_move_piece(Move mv) const;
 
-    MoveInfoArray get_move_info_array() const { return m_move_info.get(); }
+    MoveInfoArray get_move_info_array() const { return m_move_info; }
 
     /** Get pointer to extended move info array.
         Can be used to speed up the access to the move info by avoiding the
@@ -96,6 +107,10 @@ public:
 
     Move::IntType get_range() const { return m_range; }
 
+    /** Find a move by its points.
+        Uses a hash index of the sorted points of all moves, so the cost does
+        not depend on the number of moves in the game variant.
+        @param points The points of the move in any order. */
     bool find_move(const MovePoints& points, Move& move) const;
 
     bool find_move(const MovePoints& points, Piece piece, Move& move) const;
@@ -182,21 +197,44 @@ private:
 
     PieceMap<unsigned> m_nu_attach_points{0};
 
+    /** Size of MoveInfo<MAX_SIZE> in the current game variant. */
+    size_t m_move_info_size;
+
+    /** Size of MoveInfoExt<MAX_ADJ_ATTACH> in the current game variant. */
+    size_t m_move_info_ext_size;
+
     /** Array of MoveInfo<MAX_SIZE> with MAX_SIZE being the maximum piece size
         in the corresponding game variant.
-        See comments at MoveInfo. */
-    unique_ptr<void, MallocFree> m_move_info;
+        See comments at MoveInfo. Points to m_move_info_storage or into
+        m_cache_file. */
+    const void* m_move_info;
 
     /** Array of MoveInfoExt<MAX_ADJ_ATTACH> with MAX_ADJ_ATTACH being the
         maximum total number of attach points and adjacent points of a piece in
         the corresponding game variant.
-        See comments at MoveInfoExt. */
-    unique_ptr<void, MallocFree> m_move_info_ext;
+        See comments at MoveInfoExt. Points to m_move_info_ext_storage or into
+        m_cache_file. */
+    const void* m_move_info_ext;
+
+    /** Points to m_move_info_ext_2_storage or into m_cache_file. */
+    const MoveInfoExt2* m_move_info_ext_2;
 
-    unique_ptr<MoveInfoExt2[]> m_move_info_ext_2;
+    /** Storage for m_move_info if not loaded from the cache. */
+    unique_ptr<void, MallocFree> m_move_info_storage;
+
+    /** Storage for m_move_info_ext if not loaded from the cache. */
+    unique_ptr<void, MallocFree> m_move_info_ext_storage;
+
+    /** Storage for m_move_info_ext_2 if not loaded from the cache. */
+    unique_ptr<MoveInfoExt2[]> m_move_info_ext_2_storage;
+
+    unique_ptr<MappedFile> m_cache_file;
 
     PrecompMoves m_precomp_moves;
 
+    /** Sum of the sizes of all lists in m_precomp_moves. */
+    unsigned m_nu_precomp_moves;
+
     /** Value for comparing points using the ordering used in blksgf files.
         As specified in doc/blksgf/Pentobi-SGF.html, the order should be
         (a1, b1, ..., a2, b2, ...) with y going upwards whereas the convention
@@ -205,8 +243,17 @@ private:
 
     SymmetricPoints m_symmetric_points;
 
+    /** Hash index for find_move().
+        Open addressing with linear probing. Contains the moves at the slot
+        given by get_points_hash() of their sorted scored points, empty slots
+        contain Move::null(). */
+    vector<Move> m_move_index;
 
-    BoardConst(BoardType board_type, PieceSet piece_set);
+    size_t m_move_index_mask;
+
+
+    BoardConst(BoardType board_type, PieceSet piece_set,
+               const string& cache_file);
 
     template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH>
     void create_move(unsigned& moves_created, Piece piece,
@@ -217,13 +264,24 @@ private:
     template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH>
     void create_moves(unsigned& moves_created, Piece piece);
 
+    static size_t get_points_hash(const Point* begin, const Point* end);
+
     template<unsigned MAX_SIZE>
     const MoveInfo<MAX_SIZE>& get_move_info(Move mv) const;
 
     void init_adj_status_points(Point p);
 
+    void init_move_index();
+
+    bool read_point(string::const_iterator begin, string::const_iterator end,
+                    Point& p) const;
+
     template<unsigned MAX_SIZE>
     void init_symmetry_info();
+
+    bool load_cache(const string& file);
+
+    void save_cache(const string& file) const;
 };
 
 inline const Geometry& BoardConst::get_geometry() const
@@ -244,7 +302,7 @@ template<unsigned MAX_SIZE>
 inline const MoveInfo<MAX_SIZE>& BoardConst::get_move_info(Move mv) const
 {
     LIBBOARDGAME_ASSERT(m_max_piece_size == MAX_SIZE);
-    return get_move_info<MAX_SIZE>(mv, m_move_info.get());
+    return get_move_info<MAX_SIZE>(mv, m_move_info);
 }
 
 template<unsigned MAX_ADJ_ATTACH>
@@ -264,12 +322,12 @@ inline const MoveInfoExt2& BoardConst::get_move_info_ext_2(Move mv) const
 
 inline auto BoardConst::get_move_info_ext_array() const -> MoveInfoExtArray
 {
-    return m_move_info_ext.get();
+    return m_move_info_ext;
 }
 
 inline const MoveInfoExt2* BoardConst::get_move_info_ext_2_array() const
 {
-    return m_move_info_ext_2.get();
+    return m_move_info_ext_2;
 }
 
 template<unsigned MAX_SIZE>
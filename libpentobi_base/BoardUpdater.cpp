@@ -6,6 +6,7 @@
 
 #include "BoardUpdater.h"
 
+#include <algorithm>
 #include "BoardUtil.h"
 #include "NodeUtil.h"
 #include "libboardgame_base/SgfUtil.h"
@@ -103,28 +104,183 @@ void init_setup(Board& bd, const SgfNode& node)
     bd.init(&setup);
 }
 
+bool is_board_property(const string& id)
+{
+    return id == "B" || id == "W" || id == "1" || id == "2" || id == "3"
+            || id == "4" || id == "BLUE" || id == "YELLOW" || id == "RED"
+            || id == "GREEN" || id == "AB" || id == "AW" || id == "A1"
+            || id == "A2" || id == "A3" || id == "A4" || id == "AE"
+            || id == "PL";
+}
+
+/** Get a hash of the properties of a node that can affect the board state.
+    Uses FNV-1a, values are terminated by a character that cannot occur in
+    property identifiers to avoid ambiguities. */
+uint64_t get_key(const SgfNode& node)
+{
+    uint64_t key = 0xcbf29ce484222325u;
+    auto add = [&](const string& s) {
+        for (char c : s)
+            key = (key ^ static_cast<unsigned char>(c)) * 0x100000001b3u;
+        key = (key ^ 0xffu) * 0x100000001b3u;
+    };
+    for (auto& prop : node.get_properties())
+        if (is_board_property(prop.id))
+        {
+            add(prop.id);
+            for (auto& value : prop.values)
+                add(value);
+        }
+    return key;
+}
+
+void update_node(Board& bd, const PentobiTree& tree, const SgfNode& node)
+{
+    if (libpentobi_base::has_setup(node))
+        init_setup(bd, node);
+    auto mv = tree.get_move(node);
+    if (! mv.is_null())
+    {
+        if (! bd.is_piece_left(mv.color, bd.get_move_piece(mv.move)))
+            throw SgfError("piece played twice");
+        bd.play(mv);
+    }
+}
+
 } // namespace
 
 //-----------------------------------------------------------------------------
 
+BoardUpdater::BoardUpdater()
+    : m_variant(Variant::classic)
+{
+}
+
+BoardUpdater::~BoardUpdater() = default; // Non-inline to avoid GCC -Winline warning
+
+void BoardUpdater::add_checkpoint(size_t depth, const Board& bd)
+{
+    // Keep at most one checkpoint that is not at a multiple of the interval
+    // (the node of the last update), otherwise navigating forward one move
+    // at a time would create a checkpoint for every node.
+    if (m_nu_checkpoints > 0
+            && ! is_interval(m_checkpoints[m_nu_checkpoints - 1].depth))
+        --m_nu_checkpoints;
+    if (m_nu_checkpoints == m_checkpoints.size())
+        m_checkpoints.push_back({0, make_unique<Board>(bd.get_variant())});
+    auto& checkpoint = m_checkpoints[m_nu_checkpoints++];
+    checkpoint.depth = depth;
+    checkpoint.bd->copy_from(bd);
+}
+
+void BoardUpdater::clear()
+{
+    m_tree = nullptr;
+    m_nu_checkpoints = 0;
+    m_last_path.clear();
+    m_last_keys.clear();
+}
+
+size_t BoardUpdater::get_nu_unchanged(const SgfNode& changed) const
+{
+    auto pos = find(m_last_path.begin(), m_last_path.end(), &changed);
+    if (pos == m_last_path.end())
+        return m_last_path.size();
+    auto i = static_cast<size_t>(pos - m_last_path.begin());
+    if (get_key(changed) == m_last_keys[i])
+        return m_last_path.size();
+    return i;
+}
+
+size_t BoardUpdater::init_path(const SgfNode& node, size_t nu_valid)
+{
+    size_t nu_common = 1;
+    for (auto i = node.get_parent_or_null(); i != nullptr;
+         i = i->get_parent_or_null())
+        ++nu_common;
+    m_path.clear();
+    auto i = &node;
+    while (nu_common > 0
+           && (nu_common > nu_valid || m_last_path[nu_common - 1] != i))
+    {
+        m_path.push_back(i);
+        i = i->get_parent_or_null();
+        --nu_common;
+    }
+    reverse(m_path.begin(), m_path.end());
+    return nu_common;
+}
+
+size_t BoardUpdater::init_path_rehash(const SgfNode& node)
+{
+    get_path_from_root(node, m_path);
+    size_t nu_common = 0;
+    while (nu_common < m_path.size() && nu_common < m_last_path.size()
+           && m_path[nu_common] == m_last_path[nu_common]
+           && get_key(*m_path[nu_common]) == m_last_keys[nu_common])
+        ++nu_common;
+    m_path.erase(m_path.begin(),
+                 m_path.begin() + static_cast<ptrdiff_t>(nu_common));
+    return nu_common;
+}
+
 void BoardUpdater::update(Board& bd, const PentobiTree& tree,
                           const SgfNode& node)
 {
     LIBBOARDGAME_ASSERT(tree.contains(node));
-    bd.init();
-    get_path_from_root(node, m_path);
-    for (const auto i : m_path)
+    if (bd.get_variant() != m_variant)
+    {
+        clear();
+        m_variant = bd.get_variant();
+    }
+    size_t nu_common;
+    if (&tree != m_tree)
+        nu_common = init_path_rehash(node);
+    else if (tree.get_nu_changes() == m_nu_changes)
+        nu_common = init_path(node, m_last_path.size());
+    else
     {
-        if (libpentobi_base::has_setup(*i))
-            init_setup(bd, *i);
-        auto mv = tree.get_move(*i);
-        if (! mv.is_null())
+        auto changed = tree.get_changed_node(m_nu_changes);
+        if (changed != nullptr)
+            nu_common = init_path(node, get_nu_unchanged(*changed));
+        else
+            nu_common = init_path_rehash(node);
+    }
+    while (m_nu_checkpoints > 0
+           && m_checkpoints[m_nu_checkpoints - 1].depth >= nu_common)
+        --m_nu_checkpoints;
+    m_last_path.resize(nu_common);
+    m_last_keys.resize(nu_common);
+    for (auto i : m_path)
+    {
+        m_last_path.push_back(i);
+        m_last_keys.push_back(get_key(*i));
+    }
+    size_t begin = 0;
+    if (m_nu_checkpoints == 0)
+        bd.init();
+    else
+    {
+        auto& checkpoint = m_checkpoints[m_nu_checkpoints - 1];
+        bd.copy_from(*checkpoint.bd);
+        begin = checkpoint.depth + 1;
+    }
+    try
+    {
+        for (auto i = begin; i < m_last_path.size(); ++i)
         {
-            if (! bd.is_piece_left(mv.color, bd.get_move_piece(mv.move)))
-                throw SgfError("piece played twice");
-            bd.play(mv);
+            update_node(bd, tree, *m_last_path[i]);
+            if (is_interval(i) || i + 1 == m_last_path.size())
+                add_checkpoint(i, bd);
         }
     }
+    catch (...)
+    {
+        clear();
+        throw;
+    }
+    m_tree = &tree;
+    m_nu_changes = tree.get_nu_changes();
 }
 
 //-----------------------------------------------------------------------------
@@ -14,21 +14,110 @@ namespace libpentobi_base {
 
 //-----------------------------------------------------------------------------
 
-/** Updates a board state to a node in a game tree. */
+/** Updates a board state to a node in a game tree.
+    Replaying all moves from the root is slow if the updater is used for
+    navigating in a large tree or analyzing all positions of a game. Therefore,
+    the updater keeps copies of the board (checkpoints) for every
+    checkpoint_interval nodes along the path to the node of the last update and
+    for the node of the last update itself. An update starts from the deepest
+    checkpoint that is on the path to the new node, so the cost of an update
+    is proportional to the distance from the last node and not to the depth of
+    the new node.
+
+    The tree can be modified between updates. Checkpoints are only used if the
+    node pointers on the path and the board-relevant properties of these nodes
+    (moves, setup properties and player to play) are unchanged. The updater
+    stores a hash of the board-relevant properties for each node on the path
+    and uses SgfTree::get_nu_changes() to recompute only the hashes of nodes
+    that were changed since the last update. */
 class BoardUpdater
 {
 public:
+    static constexpr unsigned checkpoint_interval = 8;
+
+
+    BoardUpdater();
+
+    ~BoardUpdater();
+
     /** Update the board to a node.
+        The initial state of the board is not used, only its game variant.
+        @pre The tree of the last update still exists or clear() was called
+        after its destruction.
         @throws Exception if tree contains invalid properties, moves that play
         the same piece twice or other conditions that prevent the updater to
         update the board to the given node. */
     void update(Board& bd, const PentobiTree& tree, const SgfNode& node);
 
+    /** Remove all checkpoints. */
+    void clear();
+
 private:
+    using Key = uint64_t;
+
+    struct Checkpoint
+    {
+        /** Index of the node in m_last_path. */
+        size_t depth;
+
+        unique_ptr<Board> bd;
+    };
+
+
+    Variant m_variant;
+
+    /** Tree of the last update. */
+    const PentobiTree* m_tree = nullptr;
+
+    /** Value of SgfTree::get_nu_changes() at the last update. */
+    unsigned m_nu_changes = 0;
+
+    /** Number of used entries in m_checkpoints.
+        The used entries are ordered by depth. Unused entries keep their
+        boards to avoid reallocations. */
+    unsigned m_nu_checkpoints = 0;
+
+    vector<Checkpoint> m_checkpoints;
+
+    /** Path from the root to the node of the last update. */
+    vector<const SgfNode*> m_last_path;
+
+    /** Keys of the nodes in m_last_path. */
+    vector<Key> m_last_keys;
+
     /** Local variable reused for efficiency. */
     vector<const SgfNode*> m_path;
+
+
+    static bool is_interval(size_t depth);
+
+    void add_checkpoint(size_t depth, const Board& bd);
+
+    /** Get the number of nodes in m_last_path that are still valid if only
+        a given node was changed since the last update. */
+    size_t get_nu_unchanged(const SgfNode& changed) const;
+
+    /** Store the nodes on the path to a node that are not in m_last_path in
+        m_path.
+        @param node The node.
+        @param nu_valid The number of nodes at the beginning of m_last_path
+        that are known to be unchanged.
+        @return The number of nodes on the path that are in m_last_path. */
+    size_t init_path(const SgfNode& node, size_t nu_valid);
+
+    /** Like init_path() but compares the keys of all nodes that are in
+        m_last_path.
+        Used if it is unknown what nodes were changed since the last update.
+        Does not dereference the pointers in m_last_path, which might refer to
+        deleted nodes. */
+    size_t init_path_rehash(const SgfNode& node);
 };
 
+inline bool BoardUpdater::is_interval(size_t depth)
+{
+    return (depth + 1) % checkpoint_interval == 0;
+}
+
 //-----------------------------------------------------------------------------
 
 } // namespace libpentobi_base
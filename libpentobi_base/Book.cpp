@@ -28,6 +28,8 @@ Book::~Book() = default; // Non-inline to avoid GCC -Winline warning
 
 Move Book::genmove(const Board& bd, Color c)
 {
+    if (m_compiled.is_loaded())
+        return genmove_compiled(bd, c);
     if (bd.has_setup())
         // Book cannot handle setup positions
         return Move::null();
@@ -59,6 +61,21 @@ bool Book::genmove(const Board& bd, Color c, Move& mv,
     return true;
 }
 
+Move Book::genmove_compiled(const Board& bd, Color c)
+{
+    // Compiled books are indexed by position, so setup positions need no
+    // special handling.
+    vector<Move> good_moves;
+    m_compiled.get_moves(bd, c, good_moves);
+    if (good_moves.empty())
+        return Move::null();
+    for (Move mv : good_moves)
+        LIBBOARDGAME_LOG(bd.to_string(mv), " !");
+    LIBBOARDGAME_LOG("Book moves: ", good_moves.size());
+    auto nu_good_moves = static_cast<unsigned>(good_moves.size());
+    return good_moves[m_random.generate() % nu_good_moves];
+}
+
 void Book::load(istream& in)
 {
     TreeReader reader;
@@ -73,6 +90,12 @@ void Book::load(istream& in)
     unique_ptr<SgfNode> root = reader.get_tree_transfer_ownership();
     m_tree.init(root);
     get_transforms(m_tree.get_variant(), m_transforms, m_inv_transforms);
+    m_compiled.clear();
+}
+
+void Book::load_compiled(const string& file)
+{
+    m_compiled.load(file);
 }
 
 const SgfNode* Book::select_child(const Board& bd, Color c,
@@ -9,6 +9,7 @@
 
 #include <iosfwd>
 #include "Board.h"
+#include "CompiledBook.h"
 #include "PentobiTree.h"
 #include "libboardgame_base/PointTransform.h"
 #include "libboardgame_base/RandomGenerator.h"
@@ -23,7 +24,10 @@ using libboardgame_base::RandomGenerator;
     Opening books are stored as trees in SGF files. Thay contain move
     annotation properties according to the SGF standard. The book will select
     randomly among the child nodes that have the move annotation good move
-    or very good move (TE[1] or TE[2]). */
+    or very good move (TE[1] or TE[2]).
+    Alternatively, a book can be loaded from a file created with
+    CompiledBook::compile(), which avoids parsing the SGF tree and walking
+    it for each symmetry transformation. */
 class Book
 {
 public:
@@ -33,8 +37,16 @@ public:
 
     void load(istream& in);
 
+    /** Load a compiled book.
+        Replaces a book loaded with load(istream&).
+        @throws CompiledBook::Error */
+    void load_compiled(const string& file);
+
     Move genmove(const Board& bd, Color c);
 
+    /** Get the game variant of the loaded book. */
+    Variant get_variant() const;
+
     const PentobiTree& get_tree() const;
 
 private:
@@ -43,12 +55,16 @@ private:
 
     PentobiTree m_tree;
 
+    CompiledBook m_compiled;
+
     RandomGenerator m_random;
 
     vector<unique_ptr<PointTransform>> m_transforms;
 
     vector<unique_ptr<PointTransform>> m_inv_transforms;
 
+    Move genmove_compiled(const Board& bd, Color c);
+
     bool genmove(const Board& bd, Color c, Move& mv,
                  const PointTransform& transform,
                  const PointTransform& inv_transform);
@@ -63,6 +79,12 @@ inline const PentobiTree& Book::get_tree() const
     return m_tree;
 }
 
+inline Variant Book::get_variant() const
+{
+    return m_compiled.is_loaded() ? m_compiled.get_variant()
+                                  : m_tree.get_variant();
+}
+
 //-----------------------------------------------------------------------------
 
 } // namespace libpentobi_base
@@ -22,6 +22,7 @@ class CallistoGeometry final
 {
 public:
     /** Create or reuse an already created geometry.
+        This function is thread-safe.
         @param nu_colors The number of colors (2, 3, or 4). */
     static const CallistoGeometry& get(unsigned nu_colors);
 
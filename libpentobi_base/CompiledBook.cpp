@@ -0,0 +1,325 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_base/CompiledBook.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "CompiledBook.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <ostream>
+#include "NodeUtil.h"
+
+namespace libpentobi_base {
+
+//-----------------------------------------------------------------------------
+
+/** Header of a compiled book file.
+    The header is followed by the hash table (table_size entries) and the
+    moves (nu_moves entries). */
+struct CompiledBook::Header
+{
+    static constexpr uint32_t current_version = 1;
+
+
+    array<char, 8> magic;
+
+    uint32_t version;
+
+    /** PieceInfo::max_size of the program that wrote the file. */
+    uint32_t max_piece_size;
+
+    /** Variant as returned by to_string_id() */
+    array<char, 24> variant;
+
+    uint64_t nu_positions;
+
+    /** Size of the hash table. Always a power of two. */
+    uint64_t table_size;
+
+    uint64_t nu_moves;
+};
+
+/** Entry of the hash table.
+    Empty entries have hash 0. */
+struct CompiledBook::Entry
+{
+    uint64_t hash;
+
+    /** Index of the first move of this position. */
+    uint32_t begin;
+
+    uint32_t nu_moves;
+};
+
+/** A move stored as the coordinates of its points. */
+struct CompiledBook::MoveEntry
+{
+    uint8_t nu_points;
+
+    /** The x and y coordinate of each point. */
+    array<uint8_t, 2 * PieceInfo::max_size> coord;
+};
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+const array<char, 8> magic = { 'P', 'B', 'L', 'B', 'O', 'O', 'K', '\0' };
+
+using MoveCoords = vector<pair<unsigned, unsigned>>;
+
+/** Collects the good moves of all positions of a book tree. */
+class Compiler
+{
+public:
+    map<PositionHash::IntType, vector<MoveCoords>> positions;
+
+    Compiler(const PentobiTree& tree);
+
+    void add(const SgfNode& node);
+
+private:
+    const PentobiTree& m_tree;
+
+    PositionHash m_hash;
+
+    vector<ColorMove> m_moves;
+
+    void add_good_move(ColorMove mv);
+};
+
+Compiler::Compiler(const PentobiTree& tree)
+    : m_tree(tree),
+      m_hash(tree.get_variant())
+{
+}
+
+void Compiler::add(const SgfNode& node)
+{
+    if (has_setup(node))
+        throw CompiledBook::Error("book contains setup properties");
+    auto mv = m_tree.get_move(node);
+    if (! mv.is_null())
+        m_moves.push_back(mv);
+    for (auto& child : node.get_children())
+        if (SgfTree::get_good_move(child) > 0)
+        {
+            auto child_mv = m_tree.get_move(child);
+            if (! child_mv.is_null())
+                add_good_move(child_mv);
+        }
+    for (auto& child : node.get_children())
+        add(child);
+    if (! mv.is_null())
+        m_moves.pop_back();
+}
+
+void Compiler::add_good_move(ColorMove mv)
+{
+    auto begin = m_moves.data();
+    auto end = begin + m_moves.size();
+    unsigned transform;
+    auto hash = m_hash.get_canonical(begin, end, mv.color, transform);
+    auto& bc = BoardConst::get(m_tree.get_variant());
+    auto& geo = bc.get_geometry();
+    auto& moves = positions[hash == 0 ? 1 : hash];
+    // If the position is symmetric, several transformations create the
+    // canonical hash. Add the move for each of them, such that the lookup
+    // finds all equivalent moves independent of the transformation used.
+    for (unsigned i = transform; i < m_hash.get_nu_transforms(); ++i)
+    {
+        if (m_hash.get(begin, end, mv.color, i) != hash)
+            continue;
+        auto& t = m_hash.get_transform(i);
+        MoveCoords coords;
+        // Use the scored points, because the move points in Nexos also
+        // contain junction points, which are not used by
+        // BoardConst::find_move()
+        auto& info_ext_2 = bc.get_move_info_ext_2(mv.move);
+        for (auto p = info_ext_2.begin_scored_points();
+             p != info_ext_2.end_scored_points(); ++p)
+        {
+            auto p_transformed = t.get_transformed(*p, geo);
+            coords.emplace_back(geo.get_x(p_transformed),
+                                geo.get_y(p_transformed));
+        }
+        sort(coords.begin(), coords.end());
+        if (find(moves.begin(), moves.end(), coords) == moves.end())
+            moves.push_back(coords);
+    }
+}
+
+template<typename T>
+void write(ostream& out, const T& t)
+{
+    out.write(reinterpret_cast<const char*>(&t), sizeof(T));
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+const char* CompiledBook::file_extension = ".blkbook";
+
+CompiledBook::CompiledBook() = default;
+
+CompiledBook::~CompiledBook() = default; // Non-inline to avoid GCC -Winline warning
+
+void CompiledBook::clear()
+{
+    m_file.reset();
+    m_hash.reset();
+}
+
+void CompiledBook::compile(const PentobiTree& tree, ostream& out)
+{
+    Compiler compiler(tree);
+    compiler.add(tree.get_root());
+    auto& positions = compiler.positions;
+    size_t table_size = 1;
+    while (table_size < 2 * positions.size())
+        table_size *= 2;
+    vector<Entry> entries(table_size);
+    vector<MoveEntry> moves;
+    for (auto& i : positions)
+    {
+        auto index = i.first & (table_size - 1);
+        while (entries[index].hash != 0)
+            index = (index + 1) & (table_size - 1);
+        auto& entry = entries[index];
+        entry.hash = i.first;
+        entry.begin = static_cast<uint32_t>(moves.size());
+        entry.nu_moves = static_cast<uint32_t>(i.second.size());
+        for (auto& coords : i.second)
+        {
+            MoveEntry move_entry{};
+            move_entry.nu_points = static_cast<uint8_t>(coords.size());
+            for (unsigned j = 0; j < coords.size(); ++j)
+            {
+                move_entry.coord[2 * j] =
+                        static_cast<uint8_t>(coords[j].first);
+                move_entry.coord[2 * j + 1] =
+                        static_cast<uint8_t>(coords[j].second);
+            }
+            moves.push_back(move_entry);
+        }
+    }
+    Header header{};
+    header.magic = magic;
+    header.version = Header::current_version;
+    header.max_piece_size = PieceInfo::max_size;
+    strncpy(header.variant.data(), to_string_id(tree.get_variant()),
+            header.variant.size() - 1);
+    header.nu_positions = positions.size();
+    header.table_size = table_size;
+    header.nu_moves = moves.size();
+    write(out, header);
+    for (auto& entry : entries)
+        write(out, entry);
+    for (auto& move_entry : moves)
+        write(out, move_entry);
+}
+
+void CompiledBook::get_moves(const Board& bd, Color c,
+                             vector<Move>& moves) const
+{
+    LIBBOARDGAME_ASSERT(is_loaded());
+    LIBBOARDGAME_ASSERT(bd.get_variant() == get_variant());
+    moves.clear();
+    unsigned transform;
+    auto hash = m_hash->get_canonical(bd, c, transform);
+    if (hash == 0)
+        hash = 1;
+    auto index = hash & (m_table_size - 1);
+    const Entry* entry = nullptr;
+    for (size_t i = 0; i < m_table_size; ++i)
+    {
+        if (m_entries[index].hash == hash)
+        {
+            entry = m_entries + index;
+            break;
+        }
+        if (m_entries[index].hash == 0)
+            break;
+        index = (index + 1) & (m_table_size - 1);
+    }
+    if (entry == nullptr)
+        return;
+    if (entry->begin > m_nu_moves
+            || entry->nu_moves > m_nu_moves - entry->begin)
+        throw Error("invalid compiled book");
+    auto& geo = bd.get_geometry();
+    auto& inv_transform = m_hash->get_inv_transform(transform);
+    for (auto i = m_moves + entry->begin,
+         end = i + entry->nu_moves; i != end; ++i)
+    {
+        if (i->nu_points > PieceInfo::max_size)
+            throw Error("invalid compiled book");
+        MovePoints points;
+        for (unsigned j = 0; j < i->nu_points; ++j)
+        {
+            unsigned x = i->coord[2 * j];
+            unsigned y = i->coord[2 * j + 1];
+            if (x >= geo.get_width() || y >= geo.get_height())
+                throw Error("invalid compiled book");
+            auto p = geo.get_point(x, y);
+            if (p.is_null())
+                break;
+            points.push_back(inv_transform.get_transformed(p, geo));
+        }
+        Move mv;
+        if (points.size() == i->nu_points && bd.find_move(points, mv)
+                && bd.is_legal(c, mv))
+            moves.push_back(mv);
+    }
+}
+
+void CompiledBook::load(const string& file)
+{
+    clear();
+    try
+    {
+        auto mapped_file = make_unique<MappedFile>(file);
+        Header header;
+        if (mapped_file->size() < sizeof(header))
+            throw Error(file + " is not a compiled book");
+        memcpy(&header, mapped_file->data(), sizeof(header));
+        if (header.magic != magic)
+            throw Error(file + " is not a compiled book");
+        if (header.version != Header::current_version
+                || header.max_piece_size != PieceInfo::max_size)
+            throw Error(file + " has an incompatible version");
+        header.variant.back() = '\0';
+        Variant variant;
+        if (! parse_variant_id(header.variant.data(), variant))
+            throw Error(file + " has an unknown game variant");
+        if (header.table_size == 0
+                || (header.table_size & (header.table_size - 1)) != 0
+                || header.table_size > mapped_file->size()
+                || header.nu_moves > mapped_file->size()
+                || mapped_file->size()
+                   != sizeof(Header) + header.table_size * sizeof(Entry)
+                      + header.nu_moves * sizeof(MoveEntry))
+            throw Error(file + " is not a valid compiled book");
+        m_nu_positions = header.nu_positions;
+        m_table_size = header.table_size;
+        m_nu_moves = header.nu_moves;
+        auto data = mapped_file->data() + sizeof(Header);
+        m_entries = reinterpret_cast<const Entry*>(data);
+        m_moves = reinterpret_cast<const MoveEntry*>(
+                    data + m_table_size * sizeof(Entry));
+        m_hash = make_unique<PositionHash>(variant);
+        m_file = std::move(mapped_file);
+    }
+    catch (const MappedFile::Error& e)
+    {
+        throw Error(e.what());
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_base
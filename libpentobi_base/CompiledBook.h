@@ -0,0 +1,122 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_base/CompiledBook.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBPENTOBI_BASE_COMPILED_BOOK_H
+#define LIBPENTOBI_BASE_COMPILED_BOOK_H
+
+#include <iosfwd>
+#include <stdexcept>
+#include "Board.h"
+#include "PentobiTree.h"
+#include "PositionHash.h"
+#include "libboardgame_base/MappedFile.h"
+
+namespace libpentobi_base {
+
+using libboardgame_base::MappedFile;
+
+//-----------------------------------------------------------------------------
+
+/** Opening book in a compact binary format.
+    A compiled book is created from an opening book tree (see Book) and
+    contains a hash table that maps the canonical PositionHash of each
+    position in the tree (including the color to play) to the good moves
+    (TE[1] or TE[2]) in this position. Transpositions and positions that are
+    equivalent by symmetry are merged into a single entry. Moves are stored
+    as point coordinates in the orientation of the canonical hash.
+
+    The file is memory-mapped when loading, such that loading needs no
+    parsing and a lookup needs only a constant number of hash computations
+    and memory accesses. The file uses the byte order of the machine that
+    created it. */
+class CompiledBook
+{
+public:
+    class Error
+        : public runtime_error
+    {
+        using runtime_error::runtime_error;
+    };
+
+
+    /** File name extension used for compiled books. */
+    static const char* file_extension;
+
+
+    CompiledBook();
+
+    ~CompiledBook();
+
+    /** Unload the book. */
+    void clear();
+
+    /** Write a compiled book for an opening book tree.
+        @throws Error if the tree contains setup properties. */
+    static void compile(const PentobiTree& tree, ostream& out);
+
+    /** Load a compiled book file.
+        @throws Error */
+    void load(const string& file);
+
+    bool is_loaded() const { return m_file != nullptr; }
+
+    /** Get the game variant of the loaded book.
+        @pre is_loaded() */
+    Variant get_variant() const;
+
+    /** Get the number of positions in the loaded book.
+        @pre is_loaded() */
+    size_t get_nu_positions() const;
+
+    /** Get the good moves for a position.
+        Moves that are not legal in the position are not returned.
+        @param bd The position.
+        @param c The color to play.
+        @param[out] moves The good moves.
+        @pre is_loaded()
+        @pre bd.get_variant() == get_variant() */
+    void get_moves(const Board& bd, Color c, vector<Move>& moves) const;
+
+private:
+    struct Header;
+
+    struct Entry;
+
+    struct MoveEntry;
+
+
+    unique_ptr<MappedFile> m_file;
+
+    unique_ptr<PositionHash> m_hash;
+
+    size_t m_nu_positions;
+
+    size_t m_table_size;
+
+    size_t m_nu_moves;
+
+    const Entry* m_entries;
+
+    const MoveEntry* m_moves;
+};
+
+inline Variant CompiledBook::get_variant() const
+{
+    LIBBOARDGAME_ASSERT(is_loaded());
+    return m_hash->get_variant();
+}
+
+inline size_t CompiledBook::get_nu_positions() const
+{
+    LIBBOARDGAME_ASSERT(is_loaded());
+    return m_nu_positions;
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_base
+
+#endif // LIBPENTOBI_BASE_COMPILED_BOOK_H
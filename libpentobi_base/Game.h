@@ -14,6 +14,8 @@
 
 namespace libpentobi_base {
 
+using libboardgame_base::SgfJournal;
+
 //-----------------------------------------------------------------------------
 
 class Game
@@ -191,6 +193,9 @@ public:
     /** See libpentobi_base::Tree::remove_player() */
     void remove_player();
 
+    /** See libboardgame_base::SgfTree::set_journal() */
+    void set_journal(SgfJournal* journal) { m_tree.set_journal(journal); }
+
 private:
     const SgfNode* m_current;
 
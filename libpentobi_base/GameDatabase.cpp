@@ -0,0 +1,585 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_base/GameDatabase.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "GameDatabase.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+#include "BoardUpdater.h"
+#include "NodeUtil.h"
+#include "ScoreUtil.h"
+
+namespace libpentobi_base {
+
+using libboardgame_base::SgfError;
+
+//-----------------------------------------------------------------------------
+
+/** Header of a game database file.
+    The header is followed by the games (nu_games entries), the positions
+    sorted by hash (nu_positions entries), the moves (nu_moves entries) and
+    the file names (files_size bytes, each name terminated by a null
+    character). */
+struct GameDatabase::Header
+{
+    static constexpr uint32_t current_version = 1;
+
+
+    array<char, 8> magic;
+
+    uint32_t version;
+
+    /** PieceInfo::max_size of the program that wrote the file. */
+    uint32_t max_piece_size;
+
+    /** Variant as returned by to_string_id() */
+    array<char, 24> variant;
+
+    uint64_t nu_games;
+
+    uint64_t nu_positions;
+
+    uint64_t nu_moves;
+
+    uint64_t files_size;
+};
+
+struct GameDatabase::GameEntry
+{
+    /** Index of the file name. */
+    uint32_t file;
+
+    /** Index of the game in the file. */
+    uint32_t index;
+
+    uint32_t nu_moves;
+
+    uint32_t reserved;
+
+    array<float, Color::range> result;
+};
+
+struct GameDatabase::PositionEntry
+{
+    static constexpr uint32_t no_move = numeric_limits<uint32_t>::max();
+
+
+    uint64_t hash;
+
+    uint32_t game;
+
+    /** Index of the move played in this position or no_move. */
+    uint32_t next_move;
+
+    uint32_t move_number;
+
+    uint32_t reserved;
+};
+
+/** A move stored as the coordinates of its points. */
+struct GameDatabase::MoveEntry
+{
+    uint8_t nu_points;
+
+    /** The x and y coordinate of each point. */
+    array<uint8_t, 2 * PieceInfo::max_size> coord;
+};
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+const array<char, 8> magic = { 'P', 'B', 'L', 'G', 'M', 'D', 'B', '\0' };
+
+template<typename T>
+void write_data(ostream& out, const T& t)
+{
+    out.write(reinterpret_cast<const char*>(&t), sizeof(T));
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+GameDatabase::Indexer::Indexer(Variant variant)
+    : m_variant(variant),
+      m_hash(variant),
+      m_bd(make_unique<Board>(variant)),
+      m_pieces(m_hash.get_nu_transforms())
+{
+}
+
+GameDatabase::Indexer::~Indexer() = default; // Non-inline to avoid GCC -Winline warning
+
+void GameDatabase::Indexer::add(const PentobiTree& tree, unsigned file,
+                                unsigned index, uint64_t order)
+{
+    LIBBOARDGAME_ASSERT(tree.get_variant() == m_variant);
+    auto& bd = *m_bd;
+    auto nu_positions = m_positions.size();
+    try
+    {
+        BoardUpdater updater;
+        bd.init();
+        init_pieces();
+        auto node = &tree.get_root();
+        while (true)
+        {
+            if (has_setup(*node))
+            {
+                // Rare, it is simpler to update the board and the hashes from
+                // scratch
+                updater.update(bd, tree, *node);
+                init_pieces();
+            }
+            else
+            {
+                auto mv = tree.get_move(*node);
+                if (! mv.is_null())
+                {
+                    if (! bd.is_piece_left(mv.color,
+                                           bd.get_move_piece(mv.move)))
+                        throw SgfError("piece played twice");
+                    bd.play(mv);
+                    for (unsigned i = 0; i < m_pieces.size(); ++i)
+                        m_pieces[i] ^= m_hash.get_piece(mv, i);
+                }
+            }
+            // Skip nodes that don't change the position
+            auto next = node->get_first_child_or_null();
+            while (next != nullptr && ! has_setup(*next)
+                   && ! tree.has_move(*next))
+                next = next->get_first_child_or_null();
+            auto next_mv = ColorMove::null();
+            if (next != nullptr && ! has_setup(*next))
+                next_mv = tree.get_move(*next);
+            add_position(next_mv, next_mv.is_null() ?
+                             bd.get_effective_to_play() : next_mv.color);
+            if (next == nullptr)
+                break;
+            node = next;
+        }
+    }
+    catch (const SgfError&)
+    {
+        m_positions.resize(nu_positions);
+        throw;
+    }
+    Game game;
+    game.order = order;
+    game.file = file;
+    game.index = index;
+    game.nu_moves = bd.get_nu_moves();
+    game.result.fill(0.5f);
+    auto nu_players = bd.get_nu_players();
+    if (nu_players == 2)
+        for (Color c : bd.get_colors())
+        {
+            auto score = bd.get_score_twoplayer(c);
+            if (score > 0)
+                game.result[c.to_int()] = 1;
+            else if (score < 0)
+                game.result[c.to_int()] = 0;
+            else if (bd.get_break_ties())
+                // Ties are broken in favor of the second player
+                game.result[c.to_int()] = static_cast<float>(c.to_int() % 2);
+        }
+    else
+    {
+        array<ScoreType, Color::range> points{};
+        for (Color::IntType i = 0; i < nu_players; ++i)
+            points[i] = bd.get_points(Color(i));
+        array<float, Color::range> player_result;
+        get_multiplayer_result(nu_players, points, player_result,
+                               bd.get_break_ties());
+        for (Color c : bd.get_colors())
+            if (c.to_int() < nu_players)
+                game.result[c.to_int()] = player_result[c.to_int()];
+    }
+    m_games.push_back(game);
+}
+
+void GameDatabase::Indexer::add_position(ColorMove next_mv, Color to_play)
+{
+    auto to_play_hash = PositionHash::get_to_play(to_play);
+    unsigned transform = 0;
+    auto hash = m_pieces[0] ^ to_play_hash;
+    for (unsigned i = 1; i < m_pieces.size(); ++i)
+        if ((m_pieces[i] ^ to_play_hash) < hash)
+        {
+            hash = m_pieces[i] ^ to_play_hash;
+            transform = i;
+        }
+    auto next_move = no_move;
+    if (! next_mv.is_null())
+    {
+        auto& bc = m_bd->get_board_const();
+        auto& geo = bc.get_geometry();
+        auto& t = m_hash.get_transform(transform);
+        MoveCoords coords;
+        // Use the scored points, because the move points in Nexos also
+        // contain junction points, which are not used by
+        // BoardConst::find_move()
+        auto& info_ext_2 = bc.get_move_info_ext_2(next_mv.move);
+        for (auto p = info_ext_2.begin_scored_points();
+             p != info_ext_2.end_scored_points(); ++p)
+        {
+            auto p_transformed = t.get_transformed(*p, geo);
+            coords.emplace_back(geo.get_x(p_transformed),
+                                geo.get_y(p_transformed));
+        }
+        sort(coords.begin(), coords.end());
+        auto pos = m_move_index.find(coords);
+        if (pos != m_move_index.end())
+            next_move = pos->second;
+        else
+        {
+            next_move = static_cast<unsigned>(m_moves.size());
+            m_move_index.emplace(coords, next_move);
+            m_moves.push_back(std::move(coords));
+        }
+    }
+    m_positions.push_back({hash, static_cast<unsigned>(m_games.size()),
+                           m_bd->get_nu_moves(), next_move});
+}
+
+void GameDatabase::Indexer::init_pieces()
+{
+    auto& bd = *m_bd;
+    fill(m_pieces.begin(), m_pieces.end(), 0);
+    auto& setup = bd.get_setup();
+    for (Color c : bd.get_colors())
+        for (Move mv : setup.placements[c])
+            for (unsigned i = 0; i < m_pieces.size(); ++i)
+                m_pieces[i] ^= m_hash.get_piece(ColorMove(c, mv), i);
+    for (auto mv : bd.get_moves())
+        if (! mv.is_null())
+            for (unsigned i = 0; i < m_pieces.size(); ++i)
+                m_pieces[i] ^= m_hash.get_piece(mv, i);
+}
+
+//-----------------------------------------------------------------------------
+
+const char* GameDatabase::file_extension = ".blkdb";
+
+GameDatabase::GameDatabase() = default;
+
+GameDatabase::~GameDatabase() = default; // Non-inline to avoid GCC -Winline warning
+
+void GameDatabase::clear()
+{
+    m_file.reset();
+    m_hash.reset();
+    m_files.clear();
+}
+
+auto GameDatabase::find(const Board& bd, Color c, unsigned& transform) const
+    -> pair<const PositionEntry*, const PositionEntry*>
+{
+    LIBBOARDGAME_ASSERT(is_loaded());
+    LIBBOARDGAME_ASSERT(bd.get_variant() == get_variant());
+    auto hash = m_hash->get_canonical(bd, c, transform);
+    auto begin = m_positions;
+    auto end = m_positions + m_nu_positions;
+    begin = lower_bound(begin, end, hash,
+                        [](const PositionEntry& e, uint64_t h) {
+                            return e.hash < h; });
+    end = upper_bound(begin, end, hash,
+                      [](uint64_t h, const PositionEntry& e) {
+                          return h < e.hash; });
+    for (auto i = begin; i != end; ++i)
+        if (i->game >= m_nu_games
+                || (i->next_move != PositionEntry::no_move
+                    && i->next_move >= m_nu_moves))
+            throw Error("invalid game database");
+    return {begin, end};
+}
+
+void GameDatabase::get_continuations(
+        const Board& bd, Color c, vector<Continuation>& continuations) const
+{
+    continuations.clear();
+    unsigned transform;
+    auto range = find(bd, c, transform);
+    if (range.first == range.second)
+        return;
+    auto& geo = bd.get_geometry();
+    auto& inv_transform = m_hash->get_inv_transform(transform);
+    vector<ColorMove> moves;
+    auto& setup = bd.get_setup();
+    for (Color i : bd.get_colors())
+        for (Move mv : setup.placements[i])
+            moves.emplace_back(i, mv);
+    for (auto& mv : bd.get_moves())
+        moves.push_back(mv);
+    moves.push_back(ColorMove::null());
+    // Index in continuations for each move entry and for the canonical hash
+    // of the position after the move, such that moves that are equivalent by
+    // symmetry are merged.
+    map<uint32_t, size_t> move_index;
+    map<PositionHash::IntType, size_t> child_index;
+    vector<float> value_sum;
+    for (auto i = range.first; i != range.second; ++i)
+    {
+        if (i->next_move == PositionEntry::no_move)
+            continue;
+        auto pos = move_index.find(i->next_move);
+        if (pos == move_index.end())
+        {
+            auto& move_entry = m_moves[i->next_move];
+            if (move_entry.nu_points > PieceInfo::max_size)
+                throw Error("invalid game database");
+            MovePoints points;
+            for (unsigned j = 0; j < move_entry.nu_points; ++j)
+            {
+                unsigned x = move_entry.coord[2 * j];
+                unsigned y = move_entry.coord[2 * j + 1];
+                if (x >= geo.get_width() || y >= geo.get_height())
+                    throw Error("invalid game database");
+                auto p = geo.get_point(x, y);
+                if (p.is_null())
+                    break;
+                points.push_back(inv_transform.get_transformed(p, geo));
+            }
+            Move mv;
+            size_t index = continuations.size();
+            if (points.size() == move_entry.nu_points
+                    && bd.find_move(points, mv) && bd.is_legal(c, mv))
+            {
+                moves.back() = ColorMove(c, mv);
+                unsigned child_transform;
+                auto hash = m_hash->get_canonical(
+                            moves.data(), moves.data() + moves.size(), c,
+                            child_transform);
+                auto child_pos = child_index.find(hash);
+                if (child_pos != child_index.end())
+                    index = child_pos->second;
+                else
+                {
+                    child_index.emplace(hash, index);
+                    continuations.push_back({mv, 0, 0});
+                    value_sum.push_back(0);
+                }
+            }
+            pos = move_index.emplace(i->next_move, index).first;
+        }
+        auto index = pos->second;
+        if (index == continuations.size())
+            // Illegal move
+            continue;
+        ++continuations[index].count;
+        value_sum[index] += get_result(i->game, c);
+    }
+    for (size_t i = 0; i < continuations.size(); ++i)
+        continuations[i].value =
+                value_sum[i] / static_cast<float>(continuations[i].count);
+    stable_sort(continuations.begin(), continuations.end(),
+                [](const Continuation& c1, const Continuation& c2) {
+                    return c1.count > c2.count; });
+}
+
+const string& GameDatabase::get_file(unsigned game) const
+{
+    LIBBOARDGAME_ASSERT(game < get_nu_games());
+    return m_files[m_games[game].file];
+}
+
+void GameDatabase::get_games(const Board& bd, Color c,
+                             vector<GameRef>& games) const
+{
+    games.clear();
+    unsigned transform;
+    auto range = find(bd, c, transform);
+    for (auto i = range.first; i != range.second; ++i)
+        games.push_back({i->game, i->move_number});
+}
+
+unsigned GameDatabase::get_index(unsigned game) const
+{
+    LIBBOARDGAME_ASSERT(game < get_nu_games());
+    return m_games[game].index;
+}
+
+unsigned GameDatabase::get_nu_moves(unsigned game) const
+{
+    LIBBOARDGAME_ASSERT(game < get_nu_games());
+    return m_games[game].nu_moves;
+}
+
+float GameDatabase::get_result(unsigned game, Color c) const
+{
+    LIBBOARDGAME_ASSERT(game < get_nu_games());
+    return m_games[game].result[c.to_int()];
+}
+
+void GameDatabase::load(const string& file)
+{
+    clear();
+    try
+    {
+        auto mapped_file = make_unique<MappedFile>(file);
+        Header header;
+        if (mapped_file->size() < sizeof(header))
+            throw Error(file + " is not a game database");
+        memcpy(&header, mapped_file->data(), sizeof(header));
+        if (header.magic != magic)
+            throw Error(file + " is not a game database");
+        if (header.version != Header::current_version
+                || header.max_piece_size != PieceInfo::max_size)
+            throw Error(file + " has an incompatible version");
+        header.variant.back() = '\0';
+        Variant variant;
+        if (! parse_variant_id(header.variant.data(), variant))
+            throw Error(file + " has an unknown game variant");
+        auto size = mapped_file->size();
+        if (header.nu_games > numeric_limits<uint32_t>::max()
+                || header.nu_positions > size || header.nu_moves > size
+                || header.files_size > size
+                || size != sizeof(Header)
+                           + header.nu_games * sizeof(GameEntry)
+                           + header.nu_positions * sizeof(PositionEntry)
+                           + header.nu_moves * sizeof(MoveEntry)
+                           + header.files_size)
+            throw Error(file + " is not a valid game database");
+        m_nu_games = static_cast<unsigned>(header.nu_games);
+        m_nu_positions = header.nu_positions;
+        m_nu_moves = header.nu_moves;
+        auto data = mapped_file->data() + sizeof(Header);
+        m_games = reinterpret_cast<const GameEntry*>(data);
+        data += m_nu_games * sizeof(GameEntry);
+        m_positions = reinterpret_cast<const PositionEntry*>(data);
+        data += m_nu_positions * sizeof(PositionEntry);
+        m_moves = reinterpret_cast<const MoveEntry*>(data);
+        data += m_nu_moves * sizeof(MoveEntry);
+        for (auto end = data + header.files_size; data != end; )
+        {
+            auto name_end = static_cast<const char*>(
+                        memchr(data, '\0', static_cast<size_t>(end - data)));
+            if (name_end == nullptr)
+                throw Error(file + " is not a valid game database");
+            m_files.emplace_back(data, name_end);
+            data = name_end + 1;
+        }
+        for (unsigned i = 0; i < m_nu_games; ++i)
+            if (m_games[i].file >= m_files.size())
+                throw Error(file + " is not a valid game database");
+        m_hash = make_unique<PositionHash>(variant);
+        m_file = std::move(mapped_file);
+    }
+    catch (const MappedFile::Error& e)
+    {
+        throw Error(e.what());
+    }
+}
+
+void GameDatabase::write(ostream& out, Variant variant,
+                         const vector<string>& files,
+                         const vector<const Indexer*>& indexers)
+{
+    // Number the games by their order
+    vector<pair<uint64_t, pair<size_t, unsigned>>> order;
+    for (size_t i = 0; i < indexers.size(); ++i)
+    {
+        LIBBOARDGAME_ASSERT(indexers[i]->m_variant == variant);
+        for (unsigned j = 0; j < indexers[i]->m_games.size(); ++j)
+            order.push_back({indexers[i]->m_games[j].order, {i, j}});
+    }
+    sort(order.begin(), order.end());
+    if (order.size() > numeric_limits<uint32_t>::max())
+        throw Error("too many games");
+    vector<vector<uint32_t>> game_number(indexers.size());
+    for (size_t i = 0; i < indexers.size(); ++i)
+        game_number[i].resize(indexers[i]->m_games.size());
+    vector<GameEntry> games;
+    for (auto& i : order)
+    {
+        auto& game = indexers[i.second.first]->m_games[i.second.second];
+        game_number[i.second.first][i.second.second] =
+                static_cast<uint32_t>(games.size());
+        GameEntry entry{};
+        entry.file = game.file;
+        entry.index = game.index;
+        entry.nu_moves = game.nu_moves;
+        entry.result = game.result;
+        games.push_back(entry);
+    }
+    // Number the moves in sorted order, such that the database does not
+    // depend on the order in which the indexers found them
+    map<Indexer::MoveCoords, uint32_t> move_number;
+    for (auto indexer : indexers)
+        for (auto& coords : indexer->m_moves)
+            move_number.emplace(coords, 0);
+    if (move_number.size() >= PositionEntry::no_move)
+        throw Error("too many moves");
+    uint32_t n = 0;
+    for (auto& i : move_number)
+        i.second = n++;
+    vector<PositionEntry> positions;
+    for (size_t i = 0; i < indexers.size(); ++i)
+    {
+        auto& indexer = *indexers[i];
+        vector<uint32_t> indexer_move_number;
+        for (auto& coords : indexer.m_moves)
+            indexer_move_number.push_back(move_number[coords]);
+        for (auto& position : indexer.m_positions)
+        {
+            PositionEntry entry{};
+            entry.hash = position.hash;
+            entry.game = game_number[i][position.game];
+            entry.next_move =
+                    (position.next_move == Indexer::no_move ?
+                         PositionEntry::no_move
+                       : indexer_move_number[position.next_move]);
+            entry.move_number = position.move_number;
+            positions.push_back(entry);
+        }
+    }
+    sort(positions.begin(), positions.end(),
+         [](const PositionEntry& e1, const PositionEntry& e2) {
+             if (e1.hash != e2.hash)
+                 return e1.hash < e2.hash;
+             if (e1.game != e2.game)
+                 return e1.game < e2.game;
+             return e1.move_number < e2.move_number; });
+    string files_data;
+    for (auto& file : files)
+    {
+        files_data.append(file);
+        files_data.push_back('\0');
+    }
+    Header header{};
+    header.magic = magic;
+    header.version = Header::current_version;
+    header.max_piece_size = PieceInfo::max_size;
+    strncpy(header.variant.data(), to_string_id(variant),
+            header.variant.size() - 1);
+    header.nu_games = games.size();
+    header.nu_positions = positions.size();
+    header.nu_moves = move_number.size();
+    header.files_size = files_data.size();
+    write_data(out, header);
+    for (auto& entry : games)
+        write_data(out, entry);
+    for (auto& entry : positions)
+        write_data(out, entry);
+    for (auto& i : move_number)
+    {
+        MoveEntry entry{};
+        entry.nu_points = static_cast<uint8_t>(i.first.size());
+        for (unsigned j = 0; j < i.first.size(); ++j)
+        {
+            entry.coord[2 * j] = i.first[j].first;
+            entry.coord[2 * j + 1] = i.first[j].second;
+        }
+        write_data(out, entry);
+    }
+    out.write(files_data.data(), static_cast<streamsize>(files_data.size()));
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_base
@@ -0,0 +1,291 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_base/GameDatabase.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBPENTOBI_BASE_GAME_DATABASE_H
+#define LIBPENTOBI_BASE_GAME_DATABASE_H
+
+#include <iosfwd>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include "Board.h"
+#include "PentobiTree.h"
+#include "PositionHash.h"
+#include "libboardgame_base/MappedFile.h"
+
+namespace libpentobi_base {
+
+using libboardgame_base::MappedFile;
+
+//-----------------------------------------------------------------------------
+
+/** Index of the positions in a collection of game records.
+    The database contains an entry for each position in the main variation
+    of each game, sorted by the canonical PositionHash of the position
+    (including the color to play), so all games that reach a position, also
+    by transpositions or in an orientation that is equivalent by symmetry, can
+    be found with a binary search. Each entry also contains the move played
+    in the position, stored as point coordinates in the orientation of the
+    canonical hash like in CompiledBook, so the continuations of a position
+    and their results can be listed.
+
+    The games themselves are not stored, only the name of the file and the
+    index of the game in the file, so the games can be read again if needed
+    (e.g. for extracting all games that reach a position).
+
+    The file is memory-mapped when loading and uses the byte order of the
+    machine that created it. Hash collisions are not detected, but are very
+    unlikely with 64-bit hashes. */
+class GameDatabase
+{
+public:
+    class Error
+        : public runtime_error
+    {
+        using runtime_error::runtime_error;
+    };
+
+    /** Indexes the positions of games for writing a database.
+        Different instances can be used in different threads, so a large
+        collection of games can be indexed in parallel. */
+    class Indexer
+    {
+    public:
+        explicit Indexer(Variant variant);
+
+        ~Indexer();
+
+        /** Index the main variation of a game.
+            @param tree The game.
+            @param file The index of the file of the game in the file list
+            passed to write().
+            @param index The index of the game in the file.
+            @param order The position of the game in the order of all games,
+            which determines the game numbers in the database, such that
+            the database does not depend on the number of threads used for
+            indexing (e.g. the number of games read before this game).
+            @throws SgfError if the game contains invalid moves
+            @pre tree.get_variant() == variant */
+        void add(const PentobiTree& tree, unsigned file, unsigned index,
+                 uint64_t order);
+
+        unsigned get_nu_games() const {
+            return static_cast<unsigned>(m_games.size());
+        }
+
+    private:
+        friend class GameDatabase;
+
+        struct Game
+        {
+            uint64_t order;
+
+            unsigned file;
+
+            unsigned index;
+
+            unsigned nu_moves;
+
+            array<float, Color::range> result;
+        };
+
+        struct Position
+        {
+            PositionHash::IntType hash;
+
+            /** Index in m_games. */
+            unsigned game;
+
+            unsigned move_number;
+
+            /** Index of the next move in m_moves or no_move if the position
+                is the last position of the game or the next node contains
+                setup properties. */
+            unsigned next_move;
+        };
+
+        /** Coordinates of the scored points of a move, sorted. */
+        using MoveCoords = vector<pair<uint8_t, uint8_t>>;
+
+        static constexpr unsigned no_move = numeric_limits<unsigned>::max();
+
+        Variant m_variant;
+
+        PositionHash m_hash;
+
+        vector<Game> m_games;
+
+        vector<Position> m_positions;
+
+        /** Moves in the orientation of the canonical hash of the position
+            in which they were played. */
+        vector<MoveCoords> m_moves;
+
+        map<MoveCoords, unsigned> m_move_index;
+
+        unique_ptr<Board> m_bd;
+
+        /** Hash of the pieces on the board for each transformation. */
+        vector<PositionHash::IntType> m_pieces;
+
+        void add_position(ColorMove next_mv, Color to_play);
+
+        void init_pieces();
+    };
+
+    /** Reference to a game that reaches a position. */
+    struct GameRef
+    {
+        unsigned game;
+
+        /** The number of moves played in the game before the position. */
+        unsigned move_number;
+    };
+
+    /** Statistics of a move played in a position. */
+    struct Continuation
+    {
+        Move mv;
+
+        /** Number of games in which the move was played. */
+        unsigned count;
+
+        /** Average game result of these games for the color to play.
+            See get_result() */
+        float value;
+    };
+
+
+    /** File name extension used for game databases. */
+    static const char* file_extension;
+
+
+    GameDatabase();
+
+    ~GameDatabase();
+
+    /** Write a database.
+        @param out
+        @param variant The game variant of all indexed games.
+        @param files The list of game files referenced by the indexers.
+        @param indexers The indexers containing the games. */
+    static void write(ostream& out, Variant variant,
+                      const vector<string>& files,
+                      const vector<const Indexer*>& indexers);
+
+    /** Unload the database. */
+    void clear();
+
+    /** Load a database file.
+        @throws Error */
+    void load(const string& file);
+
+    bool is_loaded() const { return m_file != nullptr; }
+
+    /** @pre is_loaded() */
+    Variant get_variant() const;
+
+    /** @pre is_loaded() */
+    unsigned get_nu_games() const;
+
+    /** @pre is_loaded() */
+    size_t get_nu_positions() const;
+
+    /** Get the file of a game.
+        @pre game < get_nu_games() */
+    const string& get_file(unsigned game) const;
+
+    /** Get the index of a game in its file.
+        @pre game < get_nu_games() */
+    unsigned get_index(unsigned game) const;
+
+    /** Get the number of moves in the main variation of a game.
+        @pre game < get_nu_games() */
+    unsigned get_nu_moves(unsigned game) const;
+
+    /** Get the result of a game for a color.
+        The result is 1 for a win, 0.5 for a tie and 0 for a loss in
+        two-player variants (see ScoreUtil for more players). For the
+        fourth color in Blokus Three, which is played alternately by all
+        players, the result is the average result of all players.
+        @pre game < get_nu_games() */
+    float get_result(unsigned game, Color c) const;
+
+    /** Get the games that reach a position.
+        @param bd The position.
+        @param c The color to play.
+        @param[out] games The games ordered by game number.
+        @pre is_loaded()
+        @pre bd.get_variant() == get_variant() */
+    void get_games(const Board& bd, Color c, vector<GameRef>& games) const;
+
+    /** Get the moves played in a position.
+        Moves that are equivalent by symmetry of the position are merged.
+        Moves that are not legal in the position are ignored.
+        @param bd The position.
+        @param c The color to play.
+        @param[out] continuations The moves ordered by decreasing count.
+        @pre is_loaded()
+        @pre bd.get_variant() == get_variant() */
+    void get_continuations(const Board& bd, Color c,
+                           vector<Continuation>& continuations) const;
+
+private:
+    struct Header;
+
+    struct GameEntry;
+
+    struct PositionEntry;
+
+    struct MoveEntry;
+
+
+    unique_ptr<MappedFile> m_file;
+
+    unique_ptr<PositionHash> m_hash;
+
+    unsigned m_nu_games;
+
+    size_t m_nu_positions;
+
+    size_t m_nu_moves;
+
+    const GameEntry* m_games;
+
+    const PositionEntry* m_positions;
+
+    const MoveEntry* m_moves;
+
+    vector<string> m_files;
+
+
+    pair<const PositionEntry*, const PositionEntry*>
+    find(const Board& bd, Color c, unsigned& transform) const;
+};
+
+inline unsigned GameDatabase::get_nu_games() const
+{
+    LIBBOARDGAME_ASSERT(is_loaded());
+    return m_nu_games;
+}
+
+inline size_t GameDatabase::get_nu_positions() const
+{
+    LIBBOARDGAME_ASSERT(is_loaded());
+    return m_nu_positions;
+}
+
+inline Variant GameDatabase::get_variant() const
+{
+    LIBBOARDGAME_ASSERT(is_loaded());
+    return m_hash->get_variant();
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_base
+
+#endif // LIBPENTOBI_BASE_GAME_DATABASE_H
@@ -30,6 +30,7 @@ class GembloQGeometry final
 {
 public:
     /** Create or reuse an already created geometry.
+        This function is thread-safe.
         @param nu_players The number of players (2, 3, or 4). */
     static const GembloQGeometry& get(unsigned nu_players);
 
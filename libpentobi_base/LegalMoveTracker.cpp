@@ -0,0 +1,191 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_base/LegalMoveTracker.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "LegalMoveTracker.h"
+
+#include <algorithm>
+
+namespace libpentobi_base {
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+bool is_same_setup(const Board& bd1, const Board& bd2)
+{
+    if (bd1.get_variant() != bd2.get_variant())
+        return false;
+    auto& setup1 = bd1.get_setup();
+    auto& setup2 = bd2.get_setup();
+    if (setup1.to_play != setup2.to_play)
+        return false;
+    for (Color c : bd1.get_colors())
+        if (! (setup1.placements[c] == setup2.placements[c]))
+            return false;
+    return true;
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+LegalMoveTracker::LegalMoveTracker()
+    : m_marker(make_unique<ColorMap<MoveMarker>>()),
+      m_tmp_moves(make_unique<MoveList>())
+{
+}
+
+LegalMoveTracker::~LegalMoveTracker() = default; // Non-inline to avoid GCC -Winline warning
+
+void LegalMoveTracker::add(Color c, Move mv)
+{
+    m_moves[c].push_back(mv);
+    (*m_marker)[c].set(mv);
+}
+
+void LegalMoveTracker::clear()
+{
+    m_bd.reset();
+    for_each_color([&](Color c) {
+        (*m_marker)[c].clear(m_moves[c]);
+        m_moves[c].clear();
+    });
+    m_steps.clear();
+    m_removed.clear();
+    m_added.clear();
+}
+
+void LegalMoveTracker::init(const Board& bd)
+{
+    clear();
+    m_bd = make_unique<Board>(bd.get_variant());
+    m_bd->init(&bd.get_setup());
+    for (Color c : m_bd->get_colors())
+    {
+        m_bd->gen_moves(c, (*m_marker)[c], *m_tmp_moves);
+        m_moves[c].assign(m_tmp_moves->begin(), m_tmp_moves->end());
+    }
+}
+
+void LegalMoveTracker::play(ColorMove mv)
+{
+    auto c = mv.color;
+    auto& bd = *m_bd;
+    m_steps.push_back({m_removed.size(), m_added.size()});
+    bool was_first_piece = (! bd.is_callisto() && bd.is_first_piece(c));
+    auto nu_attach_points = bd.get_attach_points(c).size();
+    bd.play(mv);
+    for (Color i : bd.get_colors())
+        remove_illegal(i);
+    auto& marker = (*m_marker)[c];
+    auto& moves = m_moves[c];
+    if (was_first_piece)
+    {
+        // Moves are no longer generated at the starting points
+        for (Move i : moves)
+            m_removed.emplace_back(c, i);
+        marker.clear(moves);
+        bd.gen_moves(c, marker, *m_tmp_moves);
+        moves.assign(m_tmp_moves->begin(), m_tmp_moves->end());
+        for (Move i : moves)
+            m_added.emplace_back(c, i);
+        return;
+    }
+    // Same as Board::gen_moves() restricted to the new attach points
+    auto& attach_points = bd.get_attach_points(c);
+    for (auto i = nu_attach_points; i < attach_points.size(); ++i)
+    {
+        auto p = attach_points[i];
+        if (bd.is_forbidden(p, c))
+            continue;
+        auto adj_status = bd.get_adj_status(p, c);
+        for (Piece piece : bd.get_pieces_left(c))
+        {
+            if (bd.is_callisto() && piece == bd.get_one_piece())
+                continue;
+            for (Move j : bd.get_moves(piece, p, adj_status))
+                if (! marker[j] && ! bd.is_forbidden(c, j))
+                {
+                    add(c, j);
+                    m_added.emplace_back(c, j);
+                }
+        }
+    }
+}
+
+void LegalMoveTracker::remove_illegal(Color c)
+{
+    auto& bd = *m_bd;
+    auto& moves = m_moves[c];
+    auto& marker = (*m_marker)[c];
+    auto end = moves.end();
+    auto pos = moves.begin();
+    for (auto i = moves.begin(); i != end; ++i)
+    {
+        auto mv = *i;
+        if (bd.is_piece_left(c, bd.get_move_piece(mv))
+                && ! bd.is_forbidden(c, mv))
+            *(pos++) = mv;
+        else
+        {
+            m_removed.emplace_back(c, mv);
+            marker.clear(mv);
+        }
+    }
+    moves.erase(pos, end);
+}
+
+void LegalMoveTracker::undo()
+{
+    LIBBOARDGAME_ASSERT(! m_steps.empty());
+    auto& step = m_steps.back();
+    for (auto i = m_added.begin() + static_cast<ptrdiff_t>(step.added_begin);
+         i != m_added.end(); ++i)
+        (*m_marker)[i->color].clear(i->move);
+    for (Color c : m_bd->get_colors())
+    {
+        auto& marker = (*m_marker)[c];
+        auto& moves = m_moves[c];
+        moves.erase(remove_if(moves.begin(), moves.end(),
+                              [&](Move mv) { return ! marker[mv]; }),
+                    moves.end());
+    }
+    for (auto i = m_removed.begin()
+         + static_cast<ptrdiff_t>(step.removed_begin);
+         i != m_removed.end(); ++i)
+        add(i->color, i->move);
+    m_added.resize(step.added_begin);
+    m_removed.resize(step.removed_begin);
+    m_steps.pop_back();
+}
+
+void LegalMoveTracker::update(const Board& bd)
+{
+    if (! m_bd || ! is_same_setup(*m_bd, bd))
+        init(bd);
+    auto& moves = bd.get_moves();
+    auto& old_moves = m_bd->get_moves();
+    unsigned n = 0;
+    while (n < moves.size() && n < old_moves.size()
+           && moves[n] == old_moves[n])
+        ++n;
+    if (n < old_moves.size())
+    {
+        while (m_steps.size() > n)
+            undo();
+        // Board has no undo, replay the common moves
+        m_bd->init(&bd.get_setup());
+        for (unsigned i = 0; i < n; ++i)
+            m_bd->play(moves[i]);
+    }
+    for (auto i = n; i < moves.size(); ++i)
+        play(moves[i]);
+    LIBBOARDGAME_ASSERT(m_steps.size() == moves.size());
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_base
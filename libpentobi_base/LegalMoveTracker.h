@@ -0,0 +1,123 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_base/LegalMoveTracker.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBPENTOBI_BASE_LEGAL_MOVE_TRACKER_H
+#define LIBPENTOBI_BASE_LEGAL_MOVE_TRACKER_H
+
+#include "Board.h"
+#include "MoveMarker.h"
+
+namespace libpentobi_base {
+
+//-----------------------------------------------------------------------------
+
+/** Incrementally updated lists of the moves of all colors in a position.
+    The lists contain the same moves as Board::gen_moves() (in a different
+    order), but are not generated from scratch for each position. Playing a
+    move can only remove moves of the other colors and remove moves or add
+    moves at the new attach points of the color that played, so the lists are
+    updated by checking only the existing moves and the moves at the new
+    attach points. The changes are recorded for each move, such that the
+    lists can be rolled back to an earlier position of the same game.
+
+    This is intended for user interfaces that navigate in a game and need
+    the moves for move hints or for checking if a color has moves left. */
+class LegalMoveTracker
+{
+public:
+    LegalMoveTracker();
+
+    ~LegalMoveTracker();
+
+    /** Update the lists to the position of a board.
+        If the board has the same game variant and setup as in the last
+        update, the moves after the longest common prefix of the move
+        sequences of the board and of the last update are rolled back and the
+        remaining moves of the board are played incrementally. Otherwise, the
+        lists are computed from scratch. */
+    void update(const Board& bd);
+
+    /** Forget the position of the last update. */
+    void clear();
+
+    /** Get the moves of a color.
+        @pre update() was called after construction or clear() */
+    const vector<Move>& get_moves(Color c) const;
+
+    /** Check if a color has moves.
+        Same as Board::has_moves() for the board of the last update.
+        @pre update() was called after construction or clear() */
+    bool has_moves(Color c) const;
+
+    /** Check if a move is contained in the moves of a color.
+        @pre update() was called after construction or clear() */
+    bool contains(Color c, Move mv) const;
+
+private:
+    /** Changes of the lists caused by a move. */
+    struct Step
+    {
+        /** Start of the removed moves in m_removed. */
+        size_t removed_begin;
+
+        /** Start of the added moves in m_added. */
+        size_t added_begin;
+    };
+
+
+    /** Board in the position of the lists. */
+    unique_ptr<Board> m_bd;
+
+    ColorMap<vector<Move>> m_moves;
+
+    /** Marks the moves in m_moves. */
+    unique_ptr<ColorMap<MoveMarker>> m_marker;
+
+    /** Changes for each move played on m_bd. */
+    vector<Step> m_steps;
+
+    vector<ColorMove> m_removed;
+
+    vector<ColorMove> m_added;
+
+    /** Local variable reused for efficiency. */
+    unique_ptr<MoveList> m_tmp_moves;
+
+
+    void add(Color c, Move mv);
+
+    void init(const Board& bd);
+
+    void play(ColorMove mv);
+
+    void remove_illegal(Color c);
+
+    void undo();
+};
+
+inline bool LegalMoveTracker::contains(Color c, Move mv) const
+{
+    LIBBOARDGAME_ASSERT(m_bd);
+    return (*m_marker)[c][mv];
+}
+
+inline const vector<Move>& LegalMoveTracker::get_moves(Color c) const
+{
+    LIBBOARDGAME_ASSERT(m_bd);
+    return m_moves[c];
+}
+
+inline bool LegalMoveTracker::has_moves(Color c) const
+{
+    LIBBOARDGAME_ASSERT(m_bd);
+    return ! m_moves[c].empty();
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_base
+
+#endif // LIBPENTOBI_BASE_LEGAL_MOVE_TRACKER_H
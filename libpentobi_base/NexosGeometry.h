@@ -37,7 +37,8 @@ class NexosGeometry final
     : public Geometry
 {
 public:
-    /** Create or reuse an already created geometry. */
+    /** Create or reuse an already created geometry.
+        This function is thread-safe. */
     static const NexosGeometry& get();
 
 
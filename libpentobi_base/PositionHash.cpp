@@ -0,0 +1,119 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_base/PositionHash.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "PositionHash.h"
+
+#include "Board.h"
+
+namespace libpentobi_base {
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+/** Finalizer of the SplitMix64 generator.
+    Used as a fixed hash function, such that hash values are the same on
+    all platforms. */
+inline PositionHash::IntType mix(PositionHash::IntType x)
+{
+    x += 0x9e3779b97f4a7c15u;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9u;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebu;
+    return x ^ (x >> 31);
+}
+
+inline PositionHash::IntType get_color_hash(Color c, unsigned salt)
+{
+    return mix((static_cast<PositionHash::IntType>(salt) << 32)
+               | c.to_int());
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+PositionHash::PositionHash(Variant variant)
+    : m_variant(variant),
+      m_bc(BoardConst::get(variant))
+{
+    get_transforms(variant, m_transforms, m_inv_transforms);
+}
+
+PositionHash::~PositionHash() = default; // Non-inline to avoid GCC -Winline warning
+
+auto PositionHash::get(const ColorMove* begin, const ColorMove* end,
+                       Color to_play, unsigned transform) const -> IntType
+{
+    IntType hash = get_to_play(to_play);
+    for (auto i = begin; i != end; ++i)
+        if (! i->is_null())
+            hash ^= get_piece(*i, transform);
+    return hash;
+}
+
+auto PositionHash::get_canonical(const ColorMove* begin, const ColorMove* end,
+                                 Color to_play, unsigned& transform) const
+-> IntType
+{
+    transform = 0;
+    auto result = get(begin, end, to_play, 0);
+    for (unsigned i = 1; i < m_transforms.size(); ++i)
+    {
+        auto hash = get(begin, end, to_play, i);
+        if (hash < result)
+        {
+            result = hash;
+            transform = i;
+        }
+    }
+    return result;
+}
+
+auto PositionHash::get_canonical(const Board& bd, Color to_play,
+                                 unsigned& transform) const -> IntType
+{
+    LIBBOARDGAME_ASSERT(bd.get_variant() == m_variant);
+    vector<ColorMove> moves;
+    moves.reserve(bd.get_nu_onboard_pieces());
+    auto& setup = bd.get_setup();
+    for (Color c : bd.get_colors())
+        for (Move mv : setup.placements[c])
+            moves.emplace_back(c, mv);
+    for (auto& mv : bd.get_moves())
+        moves.push_back(mv);
+    return get_canonical(moves.data(), moves.data() + moves.size(), to_play,
+                         transform);
+}
+
+auto PositionHash::get_piece(ColorMove mv, unsigned transform) const
+    -> IntType
+{
+    LIBBOARDGAME_ASSERT(! mv.is_null());
+    auto& geo = m_bc.get_geometry();
+    auto& t = *m_transforms[transform];
+    IntType piece_hash = get_color_hash(mv.color, 2);
+    for (Point p : m_bc.get_move_points(mv.move))
+    {
+        auto p_transformed = t.get_transformed(p, geo);
+        piece_hash ^= get_point_hash(geo.get_x(p_transformed),
+                                     geo.get_y(p_transformed));
+    }
+    return mix(piece_hash);
+}
+
+auto PositionHash::get_point_hash(unsigned x, unsigned y) -> IntType
+{
+    return mix((static_cast<IntType>(x) << 16) | y);
+}
+
+auto PositionHash::get_to_play(Color c) -> IntType
+{
+    return get_color_hash(c, 1);
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_base
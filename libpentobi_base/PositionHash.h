@@ -0,0 +1,118 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_base/PositionHash.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBPENTOBI_BASE_POSITION_HASH_H
+#define LIBPENTOBI_BASE_POSITION_HASH_H
+
+#include <cstdint>
+#include "BoardConst.h"
+#include "ColorMove.h"
+
+namespace libpentobi_base {
+
+class Board;
+
+//-----------------------------------------------------------------------------
+
+/** Hash of a position that does not depend on the order of the moves.
+    The hash of a position is the XOR of a hash for each placed piece, which
+    depends only on the color and the coordinates of the points of the
+    piece, and a hash for the color to play. Therefore, transpositions have
+    the same hash and the hash values do not depend on the internal
+    numbering of moves or points and can be stored in files.
+
+    The hash can be computed for a position transformed by any of the
+    symmetry transformations of the game variant (see get_transforms()).
+    The canonical hash is the minimum of these hashes, it is the same for all
+    positions that are equivalent by symmetry. */
+class PositionHash
+{
+public:
+    using IntType = uint64_t;
+
+    using PointTransform = libboardgame_base::PointTransform<Point>;
+
+
+    explicit PositionHash(Variant variant);
+
+    ~PositionHash();
+
+    Variant get_variant() const { return m_variant; }
+
+    unsigned get_nu_transforms() const;
+
+    const PointTransform& get_transform(unsigned i) const;
+
+    const PointTransform& get_inv_transform(unsigned i) const;
+
+    /** Get the hash of a position transformed by a symmetry transformation.
+        @param begin Start of the pieces placed on the board.
+        @param end End of the pieces placed on the board.
+        @param to_play The color to play.
+        @param transform The index of the transformation.
+        Null moves are ignored. */
+    IntType get(const ColorMove* begin, const ColorMove* end, Color to_play,
+                unsigned transform) const;
+
+    /** Get the canonical hash of a position.
+        @param begin
+        @param end
+        @param to_play
+        @param[out] transform The index of the first transformation that
+        creates the canonical hash. */
+    IntType get_canonical(const ColorMove* begin, const ColorMove* end,
+                          Color to_play, unsigned& transform) const;
+
+    /** Get the canonical hash of the current position of a board.
+        The position includes the setup pieces and the played moves. */
+    IntType get_canonical(const Board& bd, Color to_play,
+                          unsigned& transform) const;
+
+    /** Get the hash of a piece placed on the board transformed by a
+        symmetry transformation.
+        The hash of a position is the XOR of get_to_play() and the hashes of
+        all pieces, so it can be updated incrementally when a piece is
+        placed. */
+    IntType get_piece(ColorMove mv, unsigned transform) const;
+
+    /** Get the hash of the color to play. */
+    static IntType get_to_play(Color c);
+
+    /** Get the hash of a point by its coordinates. */
+    static IntType get_point_hash(unsigned x, unsigned y);
+
+private:
+    Variant m_variant;
+
+    const BoardConst& m_bc;
+
+    vector<unique_ptr<PointTransform>> m_transforms;
+
+    vector<unique_ptr<PointTransform>> m_inv_transforms;
+};
+
+inline const PositionHash::PointTransform& PositionHash::get_inv_transform(
+        unsigned i) const
+{
+    return *m_inv_transforms[i];
+}
+
+inline unsigned PositionHash::get_nu_transforms() const
+{
+    return static_cast<unsigned>(m_transforms.size());
+}
+
+inline const PositionHash::PointTransform& PositionHash::get_transform(
+        unsigned i) const
+{
+    return *m_transforms[i];
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_base
+
+#endif // LIBPENTOBI_BASE_POSITION_HASH_H
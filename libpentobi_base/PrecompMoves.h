@@ -7,6 +7,9 @@
 #ifndef LIBPENTOBI_BASE_PRECOMP_MOVES_H
 #define LIBPENTOBI_BASE_PRECOMP_MOVES_H
 
+#include <cstring>
+#include <ostream>
+#include "Geometry.h"
 #include "Grid.h"
 #include "Move.h"
 #include "PieceMap.h"
@@ -90,6 +93,27 @@ public:
         during the construction. */
     const Move* move_lists_begin() const { return &(*m_move_lists.begin()); }
 
+    /** Get the size of the compact binary representation.
+        The compact representation contains only the lists of on-board points
+        and the used part of the storage for move lists. It is used by
+        BoardConst for caching.
+        @param geo The geometry
+        @param nu_moves The sum of the sizes of all lists. */
+    static size_t get_compact_size(const Geometry& geo, unsigned nu_moves);
+
+    /** Write the compact binary representation.
+        @see get_compact_size() */
+    void write_compact(ostream& out, const Geometry& geo,
+                       unsigned nu_moves) const;
+
+    /** Read the compact binary representation.
+        @param data The data written by write_compact(), must contain
+        get_compact_size() bytes.
+        @param geo See get_compact_size()
+        @param nu_moves See get_compact_size() */
+    void read_compact(const char* data, const Geometry& geo,
+                      unsigned nu_moves);
+
 private:
     class CompressedRange
     {
@@ -116,8 +140,10 @@ private:
         uint_least32_t m_val;
     };
 
+    using MovesRanges = array<PieceMap<CompressedRange>, nu_adj_status>;
+
     /** See m_move_lists. */
-    Grid<array<PieceMap<CompressedRange>, nu_adj_status>> m_moves_range;
+    Grid<MovesRanges> m_moves_range;
 
     /** Compact representation of lists of moves of a piece at a point
         constrained by the forbidden status of adjacent points.
@@ -126,6 +152,36 @@ private:
     array<Move, max_move_lists_sum_length> m_move_lists;
 };
 
+inline size_t PrecompMoves::get_compact_size(const Geometry& geo,
+                                             unsigned nu_moves)
+{
+    return geo.get_range() * sizeof(MovesRanges)
+            + nu_moves * sizeof(Move);
+}
+
+inline void PrecompMoves::read_compact(const char* data, const Geometry& geo,
+                                       unsigned nu_moves)
+{
+    LIBBOARDGAME_ASSERT(nu_moves <= max_move_lists_sum_length);
+    for (Point p : geo)
+    {
+        memcpy(&m_moves_range[p], data, sizeof(MovesRanges));
+        data += sizeof(MovesRanges);
+    }
+    memcpy(m_move_lists.data(), data, nu_moves * sizeof(Move));
+}
+
+inline void PrecompMoves::write_compact(ostream& out, const Geometry& geo,
+                                        unsigned nu_moves) const
+{
+    LIBBOARDGAME_ASSERT(nu_moves <= max_move_lists_sum_length);
+    for (Point p : geo)
+        out.write(reinterpret_cast<const char*>(&m_moves_range[p]),
+                  sizeof(MovesRanges));
+    out.write(reinterpret_cast<const char*>(m_move_lists.data()),
+              static_cast<streamsize>(nu_moves * sizeof(Move)));
+}
+
 //-----------------------------------------------------------------------------
 
 } // namespace libpentobi_base
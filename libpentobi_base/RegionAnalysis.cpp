@@ -0,0 +1,164 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_base/RegionAnalysis.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "RegionAnalysis.h"
+
+namespace libpentobi_base {
+
+//-----------------------------------------------------------------------------
+
+/** Add the region of a color that contains a point.
+    The reachable points are marked in m_reachable and the point list of the
+    color is used as the queue of the flood fill.
+    @param bd
+    @param c
+    @param seed
+    @param max_points
+    @param check_independent Stop if the region contains an attach point of
+    another color that is not forbidden for the other color.
+    @return @c false if the flood fill was stopped because the number of
+    points of the color exceeded max_points or because of
+    check_independent, in which case the last region is incomplete. */
+bool RegionAnalysis::add_region(const Board& bd, Color c, Point seed,
+                                unsigned max_points, bool check_independent)
+{
+    auto& geo = bd.get_geometry();
+    auto& is_forbidden = bd.is_forbidden(c);
+    auto& points = m_points[c];
+    uint_fast8_t bit = 1u << c.to_int();
+    if (is_forbidden[seed] || (m_reachable[seed] & bit) != 0)
+        return true;
+    Region region;
+    region.begin = points.size();
+    region.is_independent = false;
+    m_reachable[seed] |= bit;
+    points.push_back(seed);
+    auto add = [&](Point p) {
+        if (! is_forbidden[p] && (m_reachable[p] & bit) == 0)
+        {
+            m_reachable[p] |= bit;
+            points.push_back(p);
+        }
+    };
+    for (auto i = region.begin; i < points.size(); ++i)
+    {
+        if (points.size() > max_points)
+            return false;
+        // Diagonal neighbors are reachable with a new piece at the attach
+        // points created by a piece at points[i]
+        Point p = points[i];
+        if (check_independent)
+            for (Color c2 : bd.get_colors())
+                if (c2 != c && bd.is_attach_point(p, c2)
+                        && ! bd.is_forbidden(p, c2))
+                    return false;
+        for (Point adj : geo.get_adj(p))
+            add(adj);
+        for (Point diag : geo.get_diag(p))
+            add(diag);
+    }
+    region.end = points.size();
+    m_regions[c].push_back(region);
+    return points.size() <= max_points;
+}
+
+void RegionAnalysis::init(const Board& bd)
+{
+    auto& geo = bd.get_geometry();
+    m_reachable.fill(0, geo);
+    m_independent.fill(0, geo);
+    for (Color c : bd.get_colors())
+    {
+        m_regions[c].clear();
+        m_points[c].clear();
+        if (bd.is_first_piece(c))
+            for (Point p : bd.get_starting_points(c))
+                add_region(bd, c, p, Point::range_onboard, false);
+        else
+            for (Point p : bd.get_attach_points(c))
+                add_region(bd, c, p, Point::range_onboard, false);
+    }
+    for (Color c : bd.get_colors())
+    {
+        uint_fast8_t bit = 1u << c.to_int();
+        auto& points = m_points[c];
+        m_is_independent[c] = true;
+        for (auto& region : m_regions[c])
+        {
+            region.is_independent = true;
+            for (auto i = region.begin; i < region.end; ++i)
+                if (m_reachable[points[i]] != bit)
+                {
+                    region.is_independent = false;
+                    m_is_independent[c] = false;
+                    break;
+                }
+            if (region.is_independent)
+                for (auto i = region.begin; i < region.end; ++i)
+                    m_independent[points[i]] |= bit;
+        }
+    }
+}
+
+bool RegionAnalysis::init_independent(const Board& bd, Color c,
+                                      const PointList& seeds,
+                                      unsigned max_points)
+{
+    auto& geo = bd.get_geometry();
+    m_reachable.fill(0, geo);
+    m_independent.fill(0, geo);
+    m_regions[c].clear();
+    m_points[c].clear();
+    for (Point p : seeds)
+        if (! add_region(bd, c, p, max_points, true))
+            return false;
+    auto& points = m_points[c];
+    // Flood fill from the points of the regions over the points that are
+    // not forbidden for another color until an attach point of the other
+    // color is found. Attach points of other colors in the regions were
+    // already checked in add_region(), but the other colors can also reach
+    // the regions over points that are forbidden for the color.
+    for (Color c2 : bd.get_colors())
+    {
+        if (c2 == c)
+            continue;
+        if (bd.is_first_piece(c2))
+            return false;
+        auto& is_forbidden = bd.is_forbidden(c2);
+        uint_fast8_t bit = 1u << c2.to_int();
+        m_queue.clear();
+        auto add = [&](Point p) {
+            if (! is_forbidden[p] && (m_reachable[p] & bit) == 0)
+            {
+                m_reachable[p] |= bit;
+                m_queue.push_back(p);
+            }
+        };
+        for (Point p : points)
+            add(p);
+        for (unsigned i = 0; i < m_queue.size(); ++i)
+        {
+            Point p = m_queue[i];
+            if (bd.is_attach_point(p, c2))
+                return false;
+            for (Point adj : geo.get_adj(p))
+                add(adj);
+            for (Point diag : geo.get_diag(p))
+                add(diag);
+        }
+    }
+    uint_fast8_t bit = 1u << c.to_int();
+    for (auto& region : m_regions[c])
+        region.is_independent = true;
+    for (Point p : points)
+        m_independent[p] = bit;
+    m_is_independent[c] = true;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_base
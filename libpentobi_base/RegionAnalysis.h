@@ -0,0 +1,122 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_base/RegionAnalysis.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBPENTOBI_BASE_REGION_ANALYSIS_H
+#define LIBPENTOBI_BASE_REGION_ANALYSIS_H
+
+#include "Board.h"
+
+namespace libpentobi_base {
+
+//-----------------------------------------------------------------------------
+
+/** Decomposition of the points reachable by each color into regions.
+    A region of a color is a set of points that are not forbidden for the
+    color and are connected by adjacent or diagonal points, and that contains
+    an attach point of the color (or a starting point if the color has not
+    played a piece yet). Diagonal connections are needed because a piece
+    creates new attach points at its corners. All future moves of a color
+    are placed within its regions.
+    A region is independent if no other color can reach any of its points,
+    which is common in the late game. The moves of a color in its
+    independent regions cannot interact with the moves of other colors, so
+    the best packing of its pieces into them can be computed in isolation.
+    A region in which a color has no legal moves stays without legal moves
+    for the rest of the game, because new attach points of the color in the
+    region can only be created by its own moves in the region.
+
+    Only meaningful in game variants in which the pieces of a color must
+    touch each other at the corners and can be placed on any point not
+    adjacent to them (Classic, Duo, Junior and Trigon). */
+class RegionAnalysis
+{
+public:
+    struct Region
+    {
+        /** Index of the first point of the region in get_points(). */
+        unsigned begin;
+
+        /** Index behind the last point of the region in get_points(). */
+        unsigned end;
+
+        /** Is the region not reachable by any other color? */
+        bool is_independent;
+    };
+
+    using RegionList = ArrayList<Region, Point::range_onboard>;
+
+    /** Analyze the regions of all colors in a position. */
+    void init(const Board& bd);
+
+    /** Analyze only the regions of a color that contain given points and
+        check if they are all independent.
+        Faster than init() in the late game, because it explores only the
+        regions of the color and the points reachable by other colors from
+        them, and stops as soon as the result is known. Afterwards, only
+        get_regions(), get_points() and is_independent() for this color can
+        be used.
+        @param bd
+        @param c
+        @param seeds The points, usually one point of each legal move of the
+        color.
+        @param max_points The maximum total number of points of the regions.
+        @return @c false if the regions have more than max_points points or
+        not all of them are independent. */
+    bool init_independent(const Board& bd, Color c, const PointList& seeds,
+                          unsigned max_points);
+
+    const RegionList& get_regions(Color c) const { return m_regions[c]; }
+
+    /** Get the points of all regions of a color.
+        The points of a region are stored contiguously, see Region. */
+    const PointList& get_points(Color c) const { return m_points[c]; }
+
+    /** Check if a point is in a region of a color. */
+    bool is_reachable(Point p, Color c) const;
+
+    /** Check if a point is in an independent region of a color. */
+    bool is_independent(Point p, Color c) const;
+
+    /** Check if all regions of a color are independent.
+        Also true if the color has no regions. */
+    bool is_independent(Color c) const { return m_is_independent[c]; }
+
+private:
+    ColorMap<RegionList> m_regions;
+
+    ColorMap<PointList> m_points;
+
+    ColorMap<bool> m_is_independent;
+
+    /** Bit i is set if a point is in a region of Color(i). */
+    Grid<uint_fast8_t> m_reachable;
+
+    /** Bit i is set if a point is in an independent region of Color(i). */
+    Grid<uint_fast8_t> m_independent;
+
+    /** Queue for the flood fill in init_independent(). */
+    PointList m_queue;
+
+
+    bool add_region(const Board& bd, Color c, Point seed,
+                    unsigned max_points, bool check_independent);
+};
+
+inline bool RegionAnalysis::is_independent(Point p, Color c) const
+{
+    return (m_independent[p] & (1u << c.to_int())) != 0;
+}
+
+inline bool RegionAnalysis::is_reachable(Point p, Color c) const
+{
+    return (m_reachable[p] & (1u << c.to_int())) != 0;
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_base
+
+#endif // LIBPENTOBI_BASE_REGION_ANALYSIS_H
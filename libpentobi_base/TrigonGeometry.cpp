@@ -8,6 +8,7 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 
 namespace libpentobi_base {
 
@@ -24,7 +25,9 @@ TrigonGeometry::TrigonGeometry(unsigned sz)
 const TrigonGeometry& TrigonGeometry::get(unsigned sz)
 {
     static map<unsigned, shared_ptr<TrigonGeometry>> s_geometry;
+    static mutex s_mutex;
 
+    lock_guard<mutex> lock(s_mutex);
     auto pos = s_geometry.find(sz);
     if (pos != s_geometry.end())
         return *pos->second;
@@ -31,6 +31,7 @@ class TrigonGeometry final
 {
 public:
     /** Create or reuse an already created geometry with a given size.
+        This function is thread-safe.
         @param sz The edge size of the hexagon. */
     static const TrigonGeometry& get(unsigned sz);
 
@@ -23,6 +23,34 @@ LIBBOARDGAME_TEST_CASE(pentobi_base_board_const_from_string_null)
     LIBBOARDGAME_CHECK(mv.is_null());
 }
 
+/** Test that from_string() finds every move from its string representation
+    and handles strings that are not in the standard format. */
+LIBBOARDGAME_TEST_CASE(pentobi_base_board_const_from_string)
+{
+    for (auto variant : { Variant::duo, Variant::trigon, Variant::nexos,
+                          Variant::callisto, Variant::gembloq })
+    {
+        auto& bc = BoardConst::get(variant);
+        for (Move::IntType i = 1; i < bc.get_range(); ++i)
+        {
+            Move mv;
+            LIBBOARDGAME_CHECK(bc.from_string(mv, bc.to_string(Move(i))));
+            LIBBOARDGAME_CHECK_EQUAL(mv.to_int(), i);
+        }
+    }
+    auto& bc = BoardConst::get(Variant::duo);
+    Move mv;
+    LIBBOARDGAME_CHECK(bc.from_string(mv, "H7, i7,I6 ,j6,j5"));
+    LIBBOARDGAME_CHECK_EQUAL(bc.to_string(mv), "j5,i6,j6,h7,i7");
+    LIBBOARDGAME_CHECK(! bc.from_string(mv, "h7,i7,i6,j6,j4"));
+    LIBBOARDGAME_CHECK(! bc.from_string(mv, "h7,i7,i6,j6,j5,j4"));
+    LIBBOARDGAME_CHECK(! bc.from_string(mv, "h7,i7,i6,j6,o5"));
+    LIBBOARDGAME_CHECK(! bc.from_string(mv, "h7,i7,i6,j6,j15"));
+    LIBBOARDGAME_CHECK(! bc.from_string(mv, "h7,i7,i6,j6,j0"));
+    LIBBOARDGAME_CHECK(! bc.from_string(mv, "h7,i7,i6,j6,j5x"));
+    LIBBOARDGAME_CHECK(! bc.from_string(mv, ""));
+}
+
 /** Test that points in move strings are ordered.
     As specified in doc/blksgf/Pentobi-SGF.html, the order should be
     (a1, b1, ..., a2, b2, ...). There is no restriction on the order when
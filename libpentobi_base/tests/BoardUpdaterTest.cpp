@@ -6,6 +6,8 @@
 
 #include "libpentobi_base/BoardUpdater.h"
 
+#include <sstream>
+#include "libpentobi_base/MoveMarker.h"
 #include "libboardgame_base/SgfUtil.h"
 #include "libboardgame_base/TreeReader.h"
 #include "libboardgame_test/Test.h"
@@ -17,6 +19,132 @@ using libboardgame_base::get_last_node;
 
 //-----------------------------------------------------------------------------
 
+namespace {
+
+/** Append a sequence of moves to a node.
+    Plays the i'th legal move (modulo the number of legal moves) of the color
+    to play in each position.
+    @return The last node. */
+const SgfNode& append_moves(PentobiTree& tree, const SgfNode& node,
+                            unsigned nu_moves, unsigned i)
+{
+    auto bd = make_unique<Board>(tree.get_variant());
+    BoardUpdater updater;
+    updater.update(*bd, tree, node);
+    auto marker = make_unique<MoveMarker>();
+    auto moves = make_unique<MoveList>();
+    auto result = &node;
+    for (unsigned j = 0; j < nu_moves; ++j)
+    {
+        auto c = bd->get_effective_to_play();
+        bd->gen_moves(c, *marker, *moves);
+        marker->clear(*moves);
+        LIBBOARDGAME_ASSERT(! moves->empty());
+        auto mv = (*moves)[i % moves->size()];
+        result = &tree.create_new_child(*result);
+        tree.set_move(*result, c, mv);
+        bd->play(c, mv);
+    }
+    return *result;
+}
+
+string to_string(const Board& bd)
+{
+    ostringstream out;
+    bd.write(out, false);
+    out << bd.get_nu_moves() << ' ' << bd.get_to_play().to_int();
+    return out.str();
+}
+
+/** Check that an update gives the same position as an update with a new
+    updater without checkpoints. */
+void check_update(BoardUpdater& updater, Board& bd, const PentobiTree& tree,
+                  const SgfNode& node)
+{
+    updater.update(bd, tree, node);
+    auto expected = make_unique<Board>(tree.get_variant());
+    BoardUpdater new_updater;
+    new_updater.update(*expected, tree, node);
+    LIBBOARDGAME_CHECK_EQUAL(to_string(bd), to_string(*expected));
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+/** Test navigating between nodes of a tree with variations.
+    Covers updates to descendants, ancestors and nodes in other variations,
+    which use different checkpoints. */
+LIBBOARDGAME_TEST_CASE(pentobi_base_board_updater_navigate)
+{
+    PentobiTree tree(Variant::duo);
+    auto& main_end = append_moves(tree, tree.get_root(), 24, 0);
+    auto node_10 = &tree.get_root();
+    for (unsigned i = 0; i < 10; ++i)
+        node_10 = &node_10->get_first_child();
+    auto& variation_end = append_moves(tree, *node_10, 6, 1);
+    auto mv = tree.get_move(*node_10);
+    auto& setup_node = tree.remove_setup(*node_10, mv.color, mv.move);
+    auto& setup_end = append_moves(tree, setup_node, 5, 2);
+    auto bd = make_unique<Board>(tree.get_variant());
+    BoardUpdater updater;
+    check_update(updater, *bd, tree, *node_10);
+    check_update(updater, *bd, tree, main_end);
+    check_update(updater, *bd, tree, main_end.get_parent());
+    check_update(updater, *bd, tree, variation_end);
+    check_update(updater, *bd, tree, setup_end);
+    check_update(updater, *bd, tree, setup_node);
+    check_update(updater, *bd, tree, node_10->get_parent());
+    check_update(updater, *bd, tree, tree.get_root());
+    check_update(updater, *bd, tree, main_end);
+    // Forward one move at a time
+    for (auto node = &tree.get_root(); node != nullptr;
+         node = node->get_first_child_or_null())
+        check_update(updater, *bd, tree, *node);
+}
+
+/** Test that the updater detects modifications of nodes on the path of the
+    last update. */
+LIBBOARDGAME_TEST_CASE(pentobi_base_board_updater_modified_tree)
+{
+    PentobiTree tree(Variant::duo);
+    auto& node = append_moves(tree, tree.get_root(), 20, 0);
+    auto bd = make_unique<Board>(tree.get_variant());
+    BoardUpdater updater;
+    check_update(updater, *bd, tree, node);
+    auto& parent = node.get_parent();
+    check_update(updater, *bd, tree, parent);
+    tree.remove_children(parent);
+    auto& new_node = append_moves(tree, parent, 1, 3);
+    check_update(updater, *bd, tree, new_node);
+    tree.set_move(new_node, tree.get_move(new_node).color,
+                  tree.get_move(append_moves(tree, parent, 1, 4)).move);
+    check_update(updater, *bd, tree, new_node);
+}
+
+/** Test that the updater detects a modification of a single node in the
+    middle of the path of the last update. */
+LIBBOARDGAME_TEST_CASE(pentobi_base_board_updater_modified_node)
+{
+    PentobiTree tree(Variant::duo);
+    auto& node = append_moves(tree, tree.get_root(), 20, 0);
+    auto bd = make_unique<Board>(tree.get_variant());
+    BoardUpdater updater;
+    check_update(updater, *bd, tree, node);
+    auto node_12 = &node;
+    for (unsigned i = 0; i < 8; ++i)
+        node_12 = &node_12->get_parent();
+    auto node_3 = node_12;
+    for (unsigned i = 0; i < 9; ++i)
+        node_3 = &node_3->get_parent();
+    tree.set_comment(*node_12, "comment");
+    check_update(updater, *bd, tree, node);
+    tree.set_property(*node_12, "AE",
+                      bd->to_string(tree.get_move(*node_3).move));
+    check_update(updater, *bd, tree, node);
+    check_update(updater, *bd, tree, *node_12);
+}
+
 /** Test that BoardUpdater throws an exception if a piece is played twice.
     A tree from a file written by another application could contain move
     sequences where a piece is played twice. This could break assumptions
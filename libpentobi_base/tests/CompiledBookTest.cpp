@@ -0,0 +1,127 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_base/tests/CompiledBookTest.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include "libboardgame_base/TreeReader.h"
+#include "libboardgame_test/Test.h"
+#include "libpentobi_base/BoardUtil.h"
+#include "libpentobi_base/CompiledBook.h"
+
+using namespace std;
+using namespace libpentobi_base;
+using libboardgame_base::TreeReader;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+bool contains(const vector<Move>& moves, Move mv)
+{
+    return find(moves.begin(), moves.end(), mv) != moves.end();
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+/** Test that the hash does not depend on the move order and that the
+    canonical hash is the same for positions equivalent by symmetry. */
+LIBBOARDGAME_TEST_CASE(pentobi_base_position_hash)
+{
+    auto variant = Variant::duo;
+    auto& bc = BoardConst::get(variant);
+    PositionHash hash(variant);
+    LIBBOARDGAME_CHECK_EQUAL(hash.get_nu_transforms(), 2u);
+    Move mv1;
+    Move mv2;
+    LIBBOARDGAME_CHECK(bc.from_string(mv1, "f9,e10,f10,g10,f11"));
+    LIBBOARDGAME_CHECK(bc.from_string(mv2, "i4,h5,i5,j5,i6"));
+    ColorMove moves[2] = { ColorMove(Color(0), mv1), ColorMove(Color(1), mv2) };
+    ColorMove reversed[2] = { moves[1], moves[0] };
+    LIBBOARDGAME_CHECK_EQUAL(hash.get(moves, moves + 2, Color(0), 0),
+                             hash.get(reversed, reversed + 2, Color(0), 0));
+    LIBBOARDGAME_CHECK(hash.get(moves, moves + 2, Color(0), 0)
+                       != hash.get(moves, moves + 2, Color(1), 0));
+    LIBBOARDGAME_CHECK(hash.get(moves, moves + 1, Color(0), 0)
+                       != hash.get(moves, moves + 2, Color(0), 0));
+    Board bd(variant);
+    ColorMove transformed[2];
+    for (unsigned i = 0; i < 2; ++i)
+        transformed[i] = ColorMove(moves[i].color,
+                                   get_transformed(bd, moves[i].move,
+                                                   hash.get_transform(1)));
+    unsigned transform;
+    unsigned transform_transformed;
+    LIBBOARDGAME_CHECK_EQUAL(
+                hash.get_canonical(moves, moves + 2, Color(0), transform),
+                hash.get_canonical(transformed, transformed + 2, Color(0),
+                                   transform_transformed));
+}
+
+/** Test that a compiled book returns the good moves of the tree also for
+    positions that are equivalent by symmetry. */
+LIBBOARDGAME_TEST_CASE(pentobi_base_compiled_book_get_moves)
+{
+    istringstream in("(;GM[Blokus Duo]"
+                     "(;B[f9,e10,f10,g10,f11]TE[1]"
+                     " (;W[i4,h5,i5,j5,i6]TE[1];B[h7,g8,h8,h9,i9]TE[1])"
+                     " (;W[j4,i5,j5,k5,j6]))"
+                     "(;B[e10,f10,g10,h10,e11]))");
+    TreeReader reader;
+    reader.read(in);
+    unique_ptr<SgfNode> root = reader.get_tree_transfer_ownership();
+    PentobiTree tree(root);
+    string file = "pentobi_base_compiled_book_get_moves.blkbook";
+    {
+        ofstream out(file, ios::binary);
+        CompiledBook::compile(tree, out);
+    }
+    CompiledBook book;
+    book.load(file);
+    remove(file.c_str());
+    LIBBOARDGAME_CHECK(book.get_variant() == Variant::duo);
+    LIBBOARDGAME_CHECK_EQUAL(book.get_nu_positions(), 3u);
+    Board bd(Variant::duo);
+    auto& bc = bd.get_board_const();
+    Move mv1;
+    Move mv2;
+    Move mv3;
+    LIBBOARDGAME_CHECK(bc.from_string(mv1, "f9,e10,f10,g10,f11"));
+    LIBBOARDGAME_CHECK(bc.from_string(mv2, "i4,h5,i5,j5,i6"));
+    LIBBOARDGAME_CHECK(bc.from_string(mv3, "h7,g8,h8,h9,i9"));
+    vector<Move> moves;
+    book.get_moves(bd, Color(0), moves);
+    LIBBOARDGAME_CHECK(contains(moves, mv1));
+    bd.play(Color(0), mv1);
+    book.get_moves(bd, Color(1), moves);
+    LIBBOARDGAME_CHECK_EQUAL(moves.size(), 1u);
+    LIBBOARDGAME_CHECK(contains(moves, mv2));
+    bd.play(Color(1), mv2);
+    book.get_moves(bd, Color(0), moves);
+    LIBBOARDGAME_CHECK_EQUAL(moves.size(), 1u);
+    LIBBOARDGAME_CHECK(contains(moves, mv3));
+
+    // Same position transformed by the symmetry of Duo
+    PositionHash hash(Variant::duo);
+    auto& transform = hash.get_transform(1);
+    bd.init();
+    bd.play(Color(0), get_transformed(bd, mv1, transform));
+    bd.play(Color(1), get_transformed(bd, mv2, transform));
+    book.get_moves(bd, Color(0), moves);
+    LIBBOARDGAME_CHECK_EQUAL(moves.size(), 1u);
+    LIBBOARDGAME_CHECK(contains(moves, get_transformed(bd, mv3, transform)));
+
+    // Position not in book
+    bd.init();
+    bd.play(Color(0), mv1);
+    bd.play(Color(1), mv3);
+    book.get_moves(bd, Color(0), moves);
+    LIBBOARDGAME_CHECK(moves.empty());
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,114 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_base/tests/GameDatabaseTest.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include <cstdio>
+#include <fstream>
+#include "libboardgame_base/TreeReader.h"
+#include "libboardgame_test/Test.h"
+#include "libpentobi_base/BoardUtil.h"
+#include "libpentobi_base/GameDatabase.h"
+
+using namespace std;
+using namespace libpentobi_base;
+using libboardgame_base::TreeReader;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+unique_ptr<PentobiTree> read_tree(const string& sgf)
+{
+    istringstream in(sgf);
+    TreeReader reader;
+    reader.read(in);
+    unique_ptr<SgfNode> root = reader.get_tree_transfer_ownership();
+    return make_unique<PentobiTree>(root);
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+/** Test finding games that reach a position by a transposition or in an
+    orientation that is equivalent by symmetry. */
+LIBBOARDGAME_TEST_CASE(pentobi_base_game_database_get_games)
+{
+    auto variant = Variant::duo;
+    Board bd(variant);
+    auto& bc = bd.get_board_const();
+    Move mv1;
+    Move mv2;
+    Move mv3;
+    LIBBOARDGAME_CHECK(bc.from_string(mv1, "f9,e10,f10,g10,f11"));
+    LIBBOARDGAME_CHECK(bc.from_string(mv2, "i4,h5,i5,j5,i6"));
+    LIBBOARDGAME_CHECK(bc.from_string(mv3, "h7,g8,h8,h9,i9"));
+    PositionHash hash(variant);
+    auto& transform = hash.get_transform(1);
+    auto transformed = [&](Move mv) {
+        return bd.to_string(get_transformed(bd, mv, transform)); };
+    GameDatabase::Indexer indexer(variant);
+    indexer.add(*read_tree("(;GM[Blokus Duo];B[" + bd.to_string(mv1) + "];W["
+                           + bd.to_string(mv2) + "];B[" + bd.to_string(mv3)
+                           + "])"), 0, 0, 0);
+    // Same game in the other orientation
+    indexer.add(*read_tree("(;GM[Blokus Duo];B[" + transformed(mv1) + "];W["
+                           + transformed(mv2) + "];B[" + transformed(mv3)
+                           + "])"), 0, 1, 1);
+    // Game with an invalid move is not added
+    LIBBOARDGAME_CHECK_THROW(
+                indexer.add(*read_tree("(;GM[Blokus Duo];B[e10];B[e10])"),
+                            0, 2, 2),
+                runtime_error);
+    string file = "pentobi_base_game_database_get_games.blkdb";
+    {
+        ofstream out(file, ios::binary);
+        GameDatabase::write(out, variant, {"games.blksgf"}, {&indexer});
+    }
+    GameDatabase db;
+    db.load(file);
+    remove(file.c_str());
+    LIBBOARDGAME_CHECK(db.get_variant() == variant);
+    LIBBOARDGAME_CHECK_EQUAL(db.get_nu_games(), 2u);
+    LIBBOARDGAME_CHECK_EQUAL(db.get_nu_positions(), 8u);
+    LIBBOARDGAME_CHECK_EQUAL(db.get_file(1), "games.blksgf");
+    LIBBOARDGAME_CHECK_EQUAL(db.get_index(1), 1u);
+    LIBBOARDGAME_CHECK_EQUAL(db.get_nu_moves(1), 3u);
+    LIBBOARDGAME_CHECK_EQUAL(db.get_result(0, Color(0)), 1.f);
+    LIBBOARDGAME_CHECK_EQUAL(db.get_result(0, Color(1)), 0.f);
+
+    // The first moves are equivalent by symmetry of the starting position
+    vector<GameDatabase::Continuation> continuations;
+    db.get_continuations(bd, Color(0), continuations);
+    LIBBOARDGAME_CHECK_EQUAL(continuations.size(), 1u);
+    LIBBOARDGAME_CHECK_EQUAL(continuations[0].count, 2u);
+    LIBBOARDGAME_CHECK_EQUAL(continuations[0].value, 1.f);
+
+    bd.play(Color(0), mv1);
+    vector<GameDatabase::GameRef> games;
+    db.get_games(bd, Color(1), games);
+    LIBBOARDGAME_CHECK_EQUAL(games.size(), 2u);
+    LIBBOARDGAME_CHECK_EQUAL(games[0].game, 0u);
+    LIBBOARDGAME_CHECK_EQUAL(games[0].move_number, 1u);
+    db.get_continuations(bd, Color(1), continuations);
+    LIBBOARDGAME_CHECK_EQUAL(continuations.size(), 1u);
+    LIBBOARDGAME_CHECK(continuations[0].mv == mv2);
+    LIBBOARDGAME_CHECK_EQUAL(continuations[0].value, 0.f);
+    // Wrong color to play
+    db.get_games(bd, Color(0), games);
+    LIBBOARDGAME_CHECK(games.empty());
+
+    // Transposition
+    bd.init();
+    bd.play(Color(1), mv2);
+    bd.play(Color(0), mv1);
+    db.get_games(bd, Color(0), games);
+    LIBBOARDGAME_CHECK_EQUAL(games.size(), 2u);
+    db.get_continuations(bd, Color(0), continuations);
+    LIBBOARDGAME_CHECK_EQUAL(continuations.size(), 1u);
+    LIBBOARDGAME_CHECK(continuations[0].mv == mv3);
+}
+
+//-----------------------------------------------------------------------------
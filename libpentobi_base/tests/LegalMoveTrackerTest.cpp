@@ -0,0 +1,110 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_base/tests/LegalMoveTrackerTest.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "libpentobi_base/LegalMoveTracker.h"
+
+#include <algorithm>
+#include "libboardgame_test/Test.h"
+
+using namespace std;
+using namespace libpentobi_base;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+/** Check that the tracker contains the moves generated by the board. */
+void check(const LegalMoveTracker& tracker, const Board& bd)
+{
+    auto marker = make_unique<MoveMarker>();
+    auto moves = make_unique<MoveList>();
+    for (Color c : bd.get_colors())
+    {
+        bd.gen_moves(c, *marker, *moves);
+        marker->clear(*moves);
+        vector<Move> expected(moves->begin(), moves->end());
+        auto& tracked = tracker.get_moves(c);
+        LIBBOARDGAME_CHECK_EQUAL(tracked.size(), expected.size());
+        vector<Move> actual(tracked);
+        auto less = [](Move mv1, Move mv2) {
+            return mv1.to_int() < mv2.to_int();
+        };
+        sort(expected.begin(), expected.end(), less);
+        sort(actual.begin(), actual.end(), less);
+        LIBBOARDGAME_CHECK(actual == expected);
+        LIBBOARDGAME_CHECK_EQUAL(tracker.has_moves(c), bd.has_moves(c));
+        for (Move mv : expected)
+            LIBBOARDGAME_CHECK(tracker.contains(c, mv));
+    }
+}
+
+/** Play moves on a board.
+    Plays the i'th legal move (modulo the number of legal moves) of the
+    effective color to play in each position until the game is over or
+    nu_moves moves were played. */
+void play_moves(Board& bd, unsigned nu_moves, unsigned i)
+{
+    auto marker = make_unique<MoveMarker>();
+    auto moves = make_unique<MoveList>();
+    for (unsigned j = 0; j < nu_moves && ! bd.is_game_over(); ++j)
+    {
+        auto c = bd.get_effective_to_play();
+        bd.gen_moves(c, *marker, *moves);
+        marker->clear(*moves);
+        bd.play(c, (*moves)[(i + j) % moves->size()]);
+    }
+}
+
+/** Check playing a game, rolling back to an earlier position and playing a
+    different continuation. */
+void check_variant(Variant variant)
+{
+    LegalMoveTracker tracker;
+    auto bd = make_unique<Board>(variant);
+    bd->init();
+    tracker.update(*bd);
+    check(tracker, *bd);
+    for (unsigned i = 0; i < 100 && ! bd->is_game_over(); ++i)
+    {
+        play_moves(*bd, 1, 7);
+        tracker.update(*bd);
+        check(tracker, *bd);
+    }
+    auto nu_moves = bd->get_nu_moves();
+    auto bd2 = make_unique<Board>(variant);
+    bd2->init();
+    for (unsigned i = 0; i < nu_moves / 2; ++i)
+        bd2->play(bd->get_move(i));
+    tracker.update(*bd2);
+    check(tracker, *bd2);
+    play_moves(*bd2, 100, 3);
+    tracker.update(*bd2);
+    check(tracker, *bd2);
+    tracker.update(*bd);
+    check(tracker, *bd);
+    // Different setup
+    Setup setup;
+    setup.placements[Color(0)].push_back(bd->get_move(0).move);
+    setup.to_play = Color(1);
+    bd2->init(&setup);
+    tracker.update(*bd2);
+    check(tracker, *bd2);
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+LIBBOARDGAME_TEST_CASE(pentobi_base_legal_move_tracker)
+{
+    for (auto variant : {Variant::classic, Variant::classic_3, Variant::duo,
+                         Variant::junior, Variant::trigon, Variant::nexos,
+                         Variant::callisto, Variant::callisto_2,
+                         Variant::gembloq})
+        check_variant(variant);
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,160 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_base/tests/RegionAnalysisTest.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "libpentobi_base/RegionAnalysis.h"
+
+#include "libpentobi_base/MoveMarker.h"
+#include "libboardgame_test/Test.h"
+
+using namespace std;
+using namespace libpentobi_base;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+/** Check that the regions contain all legal moves and that no legal move of
+    another color touches an independent region. */
+void check(const RegionAnalysis& analysis, const Board& bd)
+{
+    auto marker = make_unique<MoveMarker>();
+    auto moves = make_unique<MoveList>();
+    for (Color c : bd.get_colors())
+    {
+        auto& points = analysis.get_points(c);
+        auto& regions = analysis.get_regions(c);
+        unsigned nu_points = 0;
+        bool is_independent = true;
+        for (auto& region : regions)
+        {
+            LIBBOARDGAME_CHECK_EQUAL(region.begin, nu_points);
+            LIBBOARDGAME_CHECK(region.end > region.begin);
+            nu_points = region.end;
+            if (! region.is_independent)
+                is_independent = false;
+            for (auto i = region.begin; i < region.end; ++i)
+                LIBBOARDGAME_CHECK_EQUAL(
+                            analysis.is_independent(points[i], c),
+                            region.is_independent);
+        }
+        LIBBOARDGAME_CHECK_EQUAL(nu_points, points.size());
+        LIBBOARDGAME_CHECK_EQUAL(analysis.is_independent(c), is_independent);
+        for (Point p : points)
+        {
+            LIBBOARDGAME_CHECK(! bd.is_forbidden(p, c));
+            LIBBOARDGAME_CHECK(analysis.is_reachable(p, c));
+        }
+        bd.gen_moves(c, *marker, *moves);
+        marker->clear(*moves);
+        for (Move mv : *moves)
+            for (Point p : bd.get_move_points(mv))
+            {
+                LIBBOARDGAME_CHECK(analysis.is_reachable(p, c));
+                for (Color c2 : bd.get_colors())
+                    if (c2 != c)
+                        for (auto& region : analysis.get_regions(c2))
+                            if (region.is_independent)
+                                for (auto i = region.begin; i < region.end;
+                                     ++i)
+                                    LIBBOARDGAME_CHECK(
+                                            analysis.get_points(c2)[i] != p);
+            }
+    }
+}
+
+/** Check that RegionAnalysis::init_independent() is consistent with the
+    regions of RegionAnalysis::init() that contain legal moves. */
+void check_independent(const RegionAnalysis& analysis, const Board& bd)
+{
+    RegionAnalysis analysis2;
+    auto marker = make_unique<MoveMarker>();
+    auto moves = make_unique<MoveList>();
+    for (Color c : bd.get_colors())
+    {
+        bd.gen_moves(c, *marker, *moves);
+        marker->clear(*moves);
+        PointList seeds;
+        bool is_independent = true;
+        for (Move mv : *moves)
+        {
+            Point p = *bd.get_move_points(mv).begin();
+            if (! analysis.is_independent(p, c))
+                is_independent = false;
+            if (! seeds.contains(p))
+                seeds.push_back(p);
+        }
+        bool is_first_piece = false;
+        for (Color c2 : bd.get_colors())
+            if (bd.is_first_piece(c2))
+                is_first_piece = true;
+        if (is_first_piece)
+            continue;
+        LIBBOARDGAME_CHECK_EQUAL(
+                    analysis2.init_independent(bd, c, seeds,
+                                               Point::range_onboard),
+                    is_independent);
+        if (! is_independent)
+            continue;
+        unsigned nu_points = 0;
+        for (auto& region : analysis.get_regions(c))
+        {
+            bool contains_seed = false;
+            for (auto i = region.begin; i < region.end; ++i)
+                if (seeds.contains(analysis.get_points(c)[i]))
+                    contains_seed = true;
+            if (! contains_seed)
+                continue;
+            nu_points += region.end - region.begin;
+            for (auto i = region.begin; i < region.end; ++i)
+                LIBBOARDGAME_CHECK(
+                        analysis2.is_independent(analysis.get_points(c)[i],
+                                                 c));
+        }
+        LIBBOARDGAME_CHECK_EQUAL(analysis2.get_points(c).size(), nu_points);
+    }
+}
+
+void check_variant(Variant variant)
+{
+    RegionAnalysis analysis;
+    auto bd = make_unique<Board>(variant);
+    bd->init();
+    analysis.init(*bd);
+    check(analysis, *bd);
+    for (Color c : bd->get_colors())
+        LIBBOARDGAME_CHECK(! analysis.get_regions(c).empty());
+    auto marker = make_unique<MoveMarker>();
+    auto moves = make_unique<MoveList>();
+    bool has_independent = false;
+    for (unsigned i = 0; ! bd->is_game_over(); ++i)
+    {
+        auto c = bd->get_effective_to_play();
+        bd->gen_moves(c, *marker, *moves);
+        marker->clear(*moves);
+        bd->play(c, (*moves)[(7 * i) % moves->size()]);
+        analysis.init(*bd);
+        check(analysis, *bd);
+        check_independent(analysis, *bd);
+        for (Color c2 : bd->get_colors())
+            for (auto& region : analysis.get_regions(c2))
+                if (region.is_independent)
+                    has_independent = true;
+    }
+    LIBBOARDGAME_CHECK(has_independent);
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+LIBBOARDGAME_TEST_CASE(pentobi_base_region_analysis)
+{
+    for (auto variant : {Variant::classic, Variant::classic_3, Variant::duo,
+                         Variant::junior, Variant::trigon})
+        check_variant(variant);
+}
+
+//-----------------------------------------------------------------------------
@@ -6,6 +6,7 @@
 
 #include "AnalyzeGame.h"
 
+#include "EndgameSolver.h"
 #include "Search.h"
 #include "libboardgame_base/Log.h"
 #include "libboardgame_base/WallTimeSource.h"
@@ -18,6 +19,39 @@ using libpentobi_base::BoardUpdater;
 
 //-----------------------------------------------------------------------------
 
+namespace {
+
+/** Get the exact value of a position if it can be solved.
+    The value has the same meaning as the value of a search. The solver uses
+    at most half of the budget of the search as in Player::genmove() and
+    gives up if the search is aborted. */
+bool solve(EndgameSolver& solver, const Board& bd, Color c,
+           size_t nu_simulations, TimeSource& time_source,
+           const Search& search, double& value)
+{
+    if (! solver.is_small(bd))
+        return false;
+    Move mv;
+    ScoreType score;
+    auto max_nodes = static_cast<size_t>(
+                0.5f * Float(nu_simulations)
+                * EndgameSolver::nodes_per_simulation);
+    if (! solver.solve(bd, c, mv, score, max_nodes, 0, time_source,
+                       [&search] { return search.was_aborted(); }))
+        return false;
+    if (score > 0)
+        value = 1;
+    else if (score < 0)
+        value = 0;
+    else
+        value = static_cast<double>(Search::SearchParamConst::tie_value);
+    return true;
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
 void AnalyzeGame::clear()
 {
     m_moves.clear();
@@ -44,6 +78,8 @@ void AnalyzeGame::run(const Game& game, Search& search, size_t nu_simulations,
     }
     while (node != nullptr);
     WallTimeSource time_source;
+    // The solver checks the abort flag before the first search resets it
+    search.clear_abort();
     node = &root;
     unsigned move_number = 0;
     auto tie_value = Search::SearchParamConst::tie_value;
@@ -55,6 +91,8 @@ void AnalyzeGame::run(const Game& game, Search& search, size_t nu_simulations,
     // count of the new root from the best child)
     size_t min_simulations = min(size_t(100), nu_simulations);
     Move dummy;
+    EndgameSolver solver;
+    double value;
     do
     {
         auto mv = tree.get_move(*node);
@@ -73,13 +111,20 @@ void AnalyzeGame::run(const Game& game, Search& search, size_t nu_simulations,
                 {
                     updater.update(*bd, tree, node->get_parent());
                     LIBBOARDGAME_LOG("Analyzing move ", bd->get_nu_moves());
-                    search.search(dummy, *bd, mv.color, max_count,
-                                  min_simulations, max_time, time_source);
-                    if (search.was_aborted())
-                        break;
+                    if (! solve(solver, *bd, mv.color, nu_simulations,
+                                time_source, search, value))
+                    {
+                        if (search.was_aborted())
+                            break;
+                        search.search(dummy, *bd, mv.color, max_count,
+                                      min_simulations, max_time, time_source);
+                        if (search.was_aborted())
+                            break;
+                        value = static_cast<double>(
+                                    search.get_root_val().get_mean());
+                    }
                     m_moves.push_back(mv);
-                    m_values.push_back(static_cast<double>(
-                                           search.get_root_val().get_mean()));
+                    m_values.push_back(value);
                 }
                 catch (const SgfError&)
                 {
@@ -100,13 +145,19 @@ void AnalyzeGame::run(const Game& game, Search& search, size_t nu_simulations,
                 c = m_moves.back().color;
             else
                 c = bd->get_effective_to_play();
-            search.search(dummy, *bd, c, max_count, min_simulations, max_time,
-                          time_source);
-            if (search.was_aborted())
-                break;
+            if (! solve(solver, *bd, c, nu_simulations, time_source, search,
+                        value))
+            {
+                if (search.was_aborted())
+                    break;
+                search.search(dummy, *bd, c, max_count, min_simulations,
+                              max_time, time_source);
+                if (search.was_aborted())
+                    break;
+                value = static_cast<double>(search.get_root_val().get_mean());
+            }
             m_moves.emplace_back(c, Move::null());
-            m_values.push_back(static_cast<double>(
-                                   search.get_root_val().get_mean()));
+            m_values.push_back(value);
         }
         node = node->get_first_child_or_null();
     }
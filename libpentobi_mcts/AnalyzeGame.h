@@ -22,7 +22,9 @@ using libpentobi_base::Variant;
 
 //-----------------------------------------------------------------------------
 
-/** Evaluate each position in the main variation of a game. */
+/** Evaluate each position in the main variation of a game.
+    Endgame positions that can be solved with EndgameSolver get the exact
+    value (win, loss or tie) instead of the value of a search. */
 class AnalyzeGame
 {
 public:
@@ -0,0 +1,250 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_mcts/EndgameSolver.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "EndgameSolver.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace libpentobi_mcts {
+
+using libpentobi_base::ColorMove;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+/** Finalizer of the SplitMix64 generator. */
+inline uint64_t mix(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15u;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9u;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebu;
+    return x ^ (x >> 31);
+}
+
+const ScoreType infinity = numeric_limits<ScoreType>::max();
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+EndgameSolver::EndgameSolver()
+    : m_variant(Variant::classic),
+      m_move_list(new MoveList),
+      m_marker(new MoveMarker)
+{
+}
+
+EndgameSolver::~EndgameSolver() = default; // Non-inline to avoid GCC -Winline warning
+
+void EndgameSolver::gen_moves(const Board& bd, Color c, Move first_move,
+                              vector<Move>& moves)
+{
+    bd.gen_moves(c, *m_marker, *m_move_list);
+    m_marker->clear(*m_move_list);
+    moves.assign(m_move_list->begin(), m_move_list->end());
+    auto get_score_points = [&](Move mv) {
+        return bd.get_piece_info(bd.get_move_piece(mv)).get_score_points();
+    };
+    stable_sort(moves.begin(), moves.end(), [&](Move mv1, Move mv2) {
+        return get_score_points(mv1) > get_score_points(mv2); });
+    if (! first_move.is_null())
+    {
+        auto pos = find(moves.begin(), moves.end(), first_move);
+        if (pos != moves.end())
+            rotate(moves.begin(), pos, pos + 1);
+    }
+}
+
+auto EndgameSolver::get_bonus_hash(const Board& bd) const -> Hash
+{
+    // The bonus depends on the order of the moves, so positions with
+    // different bonuses must have different hashes.
+    Hash hash = 0;
+    for (Color c : bd.get_colors())
+        if (bd.get_bonus(c) != 0)
+            hash ^= mix((Hash(3) << 32) | (Hash(c.to_int()) << 16)
+                        | static_cast<Hash>(bd.get_bonus(c)));
+    return hash;
+}
+
+auto EndgameSolver::get_hash(Color c, Move mv) -> Hash
+{
+    return mix((Hash(1) << 32) | (Hash(c.to_int()) << 24) | mv.to_int());
+}
+
+unsigned EndgameSolver::get_nu_legal_moves(const Board& bd)
+{
+    unsigned n = 0;
+    for (Color c : bd.get_colors())
+    {
+        bd.gen_moves(c, *m_marker, *m_move_list);
+        m_marker->clear(*m_move_list);
+        n += m_move_list->size();
+    }
+    return n;
+}
+
+auto EndgameSolver::get_to_play_hash(Color c) -> Hash
+{
+    return mix((Hash(2) << 32) | c.to_int());
+}
+
+bool EndgameSolver::is_supported(Variant variant)
+{
+    return get_nu_colors(variant) == 2 && get_nu_players(variant) == 2;
+}
+
+bool EndgameSolver::is_small(const Board& bd)
+{
+    return m_max_legal_moves > 0 && is_supported(bd.get_variant())
+            && get_nu_legal_moves(bd) <= m_max_legal_moves;
+}
+
+ScoreType EndgameSolver::search(unsigned ply, Color c, ScoreType alpha,
+                                ScoreType beta, Hash hash, bool is_pass)
+{
+    if (++m_nu_nodes > m_node_limit
+            || (m_time_checker != nullptr && (*m_time_checker)())
+            // Check the abort function only every 256 nodes (starting with
+            // the first), it can be more expensive than a node
+            || (m_abort_check != nullptr && m_nu_nodes % 256 == 1
+                && (*m_abort_check)()))
+    {
+        m_aborted = true;
+        return 0;
+    }
+    auto& bd = *m_boards[ply];
+    auto key = hash ^ get_bonus_hash(bd);
+    auto& entry = m_table[key & ((Hash(1) << table_bits) - 1)];
+    auto first_move = Move::null();
+    if (entry.hash == key)
+    {
+        // Don't use cutoffs at the root, we need the best move there
+        if (ply > 0)
+        {
+            if (entry.lower >= beta)
+                return entry.lower;
+            if (entry.upper <= alpha)
+                return entry.upper;
+            if (entry.lower == entry.upper)
+                return entry.lower;
+            alpha = max(alpha, entry.lower);
+            beta = min(beta, entry.upper);
+        }
+        first_move = entry.best_move;
+    }
+    auto second_color = bd.get_next(c);
+    auto to_play_hash = get_to_play_hash(c) ^ get_to_play_hash(second_color);
+    if (m_moves.size() <= ply)
+        m_moves.resize(ply + 1);
+    auto& moves = m_moves[ply];
+    gen_moves(bd, c, first_move, moves);
+    ScoreType result;
+    auto best_move = Move::null();
+    if (moves.empty())
+    {
+        if (is_pass)
+            return bd.get_score_twocolor(c);
+        result = -search(ply, second_color, -beta, -alpha,
+                         hash ^ to_play_hash, true);
+        if (m_aborted)
+            return 0;
+    }
+    else
+    {
+        if (m_boards.size() <= ply + 1)
+            m_boards.push_back(make_unique<Board>(m_variant));
+        auto& child = *m_boards[ply + 1];
+        result = -infinity;
+        for (Move mv : moves)
+        {
+            child.copy_from(bd);
+            child.play(c, mv);
+            auto value = -search(ply + 1, second_color, -beta,
+                                 -max(alpha, result),
+                                 hash ^ get_hash(c, mv) ^ to_play_hash,
+                                 false);
+            if (m_aborted)
+                return 0;
+            if (value > result)
+            {
+                result = value;
+                best_move = mv;
+                if (result >= beta)
+                    break;
+            }
+        }
+    }
+    if (ply == 0)
+        m_best_move = best_move;
+    entry.hash = key;
+    entry.best_move = best_move;
+    entry.lower = (result > alpha ? result : -infinity);
+    entry.upper = (result < beta ? result : infinity);
+    return result;
+}
+
+bool EndgameSolver::solve(const Board& bd, Color c, Move& mv,
+                          ScoreType& score)
+{
+    return solve(bd, c, mv, score, m_max_nodes, nullptr, nullptr);
+}
+
+bool EndgameSolver::solve(const Board& bd, Color c, Move& mv,
+                          ScoreType& score, size_t max_nodes,
+                          double max_time, TimeSource& time_source,
+                          const function<bool()>& abort_check)
+{
+    auto abort_check_ptr = (abort_check ? &abort_check : nullptr);
+    if (max_time <= 0)
+        return solve(bd, c, mv, score, max_nodes, nullptr, abort_check_ptr);
+    TimeIntervalChecker time_checker(time_source, max_time);
+    return solve(bd, c, mv, score, max_nodes, &time_checker,
+                 abort_check_ptr);
+}
+
+bool EndgameSolver::solve(const Board& bd, Color c, Move& mv,
+                          ScoreType& score, size_t max_nodes,
+                          TimeIntervalChecker* time_checker,
+                          const function<bool()>* abort_check)
+{
+    auto variant = bd.get_variant();
+    if (! is_supported(variant))
+        return false;
+    if (m_table.empty() || variant != m_variant)
+    {
+        m_variant = variant;
+        m_boards.clear();
+        m_table.assign(size_t(1) << table_bits, Entry{0, 0, 0, Move::null()});
+    }
+    if (m_boards.empty())
+        m_boards.push_back(make_unique<Board>(variant));
+    m_boards[0]->copy_from(bd);
+    Hash hash = get_to_play_hash(c);
+    auto& setup = bd.get_setup();
+    for (Color i : bd.get_colors())
+        for (Move setup_mv : setup.placements[i])
+            hash ^= get_hash(i, setup_mv);
+    for (ColorMove i : bd.get_moves())
+        if (! i.is_null())
+            hash ^= get_hash(i.color, i.move);
+    m_aborted = false;
+    m_nu_nodes = 0;
+    m_node_limit = min(max_nodes, m_max_nodes);
+    m_time_checker = time_checker;
+    m_abort_check = abort_check;
+    score = search(0, c, -infinity, infinity, hash, false);
+    if (m_aborted)
+        return false;
+    mv = m_best_move;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_mcts
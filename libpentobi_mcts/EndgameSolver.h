@@ -0,0 +1,181 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_mcts/EndgameSolver.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBPENTOBI_MCTS_ENDGAME_SOLVER_H
+#define LIBPENTOBI_MCTS_ENDGAME_SOLVER_H
+
+#include <cstdint>
+#include <functional>
+#include "libboardgame_base/TimeIntervalChecker.h"
+#include "libpentobi_base/Board.h"
+#include "libpentobi_base/MoveMarker.h"
+
+namespace libpentobi_mcts {
+
+using namespace std;
+using libboardgame_base::TimeIntervalChecker;
+using libboardgame_base::TimeSource;
+using libpentobi_base::Board;
+using libpentobi_base::Color;
+using libpentobi_base::Move;
+using libpentobi_base::MoveList;
+using libpentobi_base::MoveMarker;
+using libpentobi_base::ScoreType;
+using libpentobi_base::Variant;
+
+//-----------------------------------------------------------------------------
+
+/** Exact solver for endgame positions.
+    Uses an alpha-beta search over Board to the end of the game with a
+    transposition table. Moves are ordered by the move stored in the
+    transposition table and then by the score of the piece, which is the
+    strongest feature of the move priors in PriorKnowledge. (PriorKnowledge
+    itself cannot be used because it prunes moves.)
+
+    The result is the exact final score (see Board::get_score_twocolor()) with
+    perfect play of both colors. Only game variants with two colors are
+    supported. The solver gives up if a maximum number of nodes or a maximum
+    time is exceeded, so it can be tried before a regular search in
+    positions for which is_small() returns true. */
+class EndgameSolver
+{
+public:
+    /** Ratio of the speed of the solver in nodes per second to the speed
+        of Search in simulations per second.
+        Can be used for converting a number of simulations into a number of
+        nodes for the solver. Measured in Duo endgame positions. */
+    static constexpr float nodes_per_simulation = 5;
+
+
+    EndgameSolver();
+
+    ~EndgameSolver();
+
+    static bool is_supported(Variant variant);
+
+    /** Get the number of legal moves of both colors.
+        Can be used for deciding if a position is small enough for
+        solving. */
+    unsigned get_nu_legal_moves(const Board& bd);
+
+    /** Check if solving a position should be tried.
+        @return true if the game variant is supported and the number of
+        legal moves of both colors is not greater than
+        get_max_legal_moves(). */
+    bool is_small(const Board& bd);
+
+    /** Maximum number of nodes of a solve() call. */
+    void set_max_nodes(size_t max_nodes) { m_max_nodes = max_nodes; }
+
+    size_t get_max_nodes() const { return m_max_nodes; }
+
+    /** Maximum number of legal moves for is_small().
+        A value of 0 disables is_small(). */
+    void set_max_legal_moves(unsigned n) { m_max_legal_moves = n; }
+
+    unsigned get_max_legal_moves() const { return m_max_legal_moves; }
+
+    /** Solve a position.
+        @param bd The position.
+        @param c The color to play.
+        @param[out] mv A best move or Move::null() if c has no legal moves.
+        @param[out] score The final score for c with perfect play.
+        @return false if the game variant is not supported or the maximum
+        number of nodes was exceeded. */
+    bool solve(const Board& bd, Color c, Move& mv, ScoreType& score);
+
+    /** Solve a position with a limited budget.
+        Like solve(), but the number of nodes is limited to the minimum of
+        max_nodes and get_max_nodes().
+        @param max_time The maximum time in seconds or 0 for no time limit.
+        @param time_source The time source for max_time.
+        @param abort_check Function returning true if the solver should
+        give up (e.g. if the search was aborted from a different thread), or
+        an empty function.
+        @return false if the game variant is not supported, the maximum
+        number of nodes or the maximum time was exceeded or abort_check
+        returned true. */
+    bool solve(const Board& bd, Color c, Move& mv, ScoreType& score,
+               size_t max_nodes, double max_time, TimeSource& time_source,
+               const function<bool()>& abort_check = {});
+
+    /** Get the number of nodes of the last solve() call. */
+    size_t get_nu_nodes() const { return m_nu_nodes; }
+
+private:
+    using Hash = uint64_t;
+
+    struct Entry
+    {
+        Hash hash;
+
+        ScoreType lower;
+
+        ScoreType upper;
+
+        Move best_move;
+    };
+
+    static constexpr unsigned table_bits = 18;
+
+
+    Variant m_variant;
+
+    bool m_aborted;
+
+    size_t m_max_nodes = 1000000;
+
+    unsigned m_max_legal_moves = 80;
+
+    size_t m_nu_nodes;
+
+    /** Node limit of the current solve() call. */
+    size_t m_node_limit;
+
+    /** Time limit checker of the current solve() call or nullptr. */
+    TimeIntervalChecker* m_time_checker;
+
+    /** Abort check of the current solve() call or nullptr. */
+    const function<bool()>* m_abort_check;
+
+    /** Best move at the root of the last search. */
+    Move m_best_move;
+
+    vector<Entry> m_table;
+
+    /** Board for each ply. */
+    vector<unique_ptr<Board>> m_boards;
+
+    /** Ordered legal moves for each ply. */
+    vector<vector<Move>> m_moves;
+
+    unique_ptr<MoveList> m_move_list;
+
+    unique_ptr<MoveMarker> m_marker;
+
+
+    static Hash get_hash(Color c, Move mv);
+
+    static Hash get_to_play_hash(Color c);
+
+    Hash get_bonus_hash(const Board& bd) const;
+
+    void gen_moves(const Board& bd, Color c, Move first_move,
+                   vector<Move>& moves);
+
+    bool solve(const Board& bd, Color c, Move& mv, ScoreType& score,
+               size_t max_nodes, TimeIntervalChecker* time_checker,
+               const function<bool()>* abort_check);
+
+    ScoreType search(unsigned ply, Color c, ScoreType alpha, ScoreType beta,
+                     Hash hash, bool is_pass);
+};
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_mcts
+
+#endif // LIBPENTOBI_MCTS_ENDGAME_SOLVER_H
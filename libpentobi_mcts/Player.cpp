@@ -8,6 +8,7 @@
 
 #include <fstream>
 #include <iomanip>
+#include <limits>
 #include "libboardgame_base/CpuTimeSource.h"
 #include "libboardgame_base/Memory.h"
 #include "libboardgame_base/WallTimeSource.h"
@@ -17,6 +18,7 @@ namespace libpentobi_mcts {
 using libboardgame_base::CpuTimeSource;
 using libboardgame_base::WallTimeSource;
 using libpentobi_base::BoardType;
+using libpentobi_base::CompiledBook;
 
 //-----------------------------------------------------------------------------
 
@@ -157,6 +159,7 @@ Move Player::genmove(const Board& bd, Color c)
 {
     m_resign = false;
     m_was_aborted = false;
+    m_was_solved = false;
     if (! bd.has_moves(c))
         return Move::null();
     Move mv;
@@ -168,8 +171,7 @@ Move Player::genmove(const Board& bd, Color c)
         && (level >= 4 || bd.get_nu_moves() < 2u * bd.get_nu_colors()))
     {
         if (! is_book_loaded(variant))
-            load_book(m_books_dir
-                      + "/book_" + to_string_id(variant) + ".blksgf");
+            load_book(variant);
         if (m_is_book_loaded)
         {
             mv = m_book.genmove(bd, c);
@@ -244,6 +246,29 @@ Move Player::genmove(const Board& bd, Color c)
             max_count = ceil(max_count * weight);
         }
     }
+    // Lower levels should not play endgames perfectly
+    if (level >= 4 && m_solver.is_small(bd))
+    {
+        // Use half of the budget of the search, such that the search still
+        // has enough left if the solver gives up
+        size_t max_nodes = numeric_limits<size_t>::max();
+        if (max_count > 0)
+            max_nodes = static_cast<size_t>(
+                    0.5f * max_count * EndgameSolver::nodes_per_simulation);
+        auto start_time = (*m_time_source)();
+        if (m_solver.solve(bd, c, mv, m_solved_score, max_nodes,
+                           0.5 * max_time, *m_time_source))
+        {
+            LIBBOARDGAME_LOG("Solved: score ", m_solved_score, ", nodes ",
+                             m_solver.get_nu_nodes());
+            m_was_solved = true;
+            return mv;
+        }
+        LIBBOARDGAME_LOG("Solver aborted after ", m_solver.get_nu_nodes(),
+                         " nodes");
+        if (max_time > 0)
+            max_time -= (*m_time_source)() - start_time;
+    }
     if (max_count != 0)
         LIBBOARDGAME_LOG("MaxCnt ", fixed, setprecision(0), max_count);
     else
@@ -327,7 +352,7 @@ Rating Player::get_rating(Variant variant, unsigned level)
 
 bool Player::is_book_loaded(Variant variant) const
 {
-    return m_is_book_loaded && m_book.get_tree().get_variant() == variant;
+    return m_is_book_loaded && m_book.get_variant() == variant;
 }
 
 void Player::load_book(istream& in)
@@ -350,6 +375,31 @@ bool Player::load_book(const string& filepath)
     return true;
 }
 
+void Player::load_book(Variant variant)
+{
+    auto filepath = m_books_dir + "/book_" + to_string_id(variant);
+    auto compiled_filepath = filepath + CompiledBook::file_extension;
+    if (ifstream(compiled_filepath))
+        try
+        {
+            load_compiled_book(compiled_filepath);
+            return;
+        }
+        catch (const CompiledBook::Error& e)
+        {
+            LIBBOARDGAME_LOG("Could not load book ", compiled_filepath, ": ",
+                             e.what());
+        }
+    load_book(filepath + ".blksgf");
+}
+
+void Player::load_compiled_book(const string& filepath)
+{
+    m_book.load_compiled(filepath);
+    m_is_book_loaded = true;
+    LIBBOARDGAME_LOG("Loaded book ", filepath);
+}
+
 bool Player::resign() const
 {
     return m_resign;
@@ -7,6 +7,7 @@
 #ifndef LIBPENTOBI_MCTS_PLAYER_H
 #define LIBPENTOBI_MCTS_PLAYER_H
 
+#include "EndgameSolver.h"
 #include "Search.h"
 #include "libboardgame_base/Rating.h"
 #include "libpentobi_base/Book.h"
@@ -70,8 +71,21 @@ public:
 
     Search& get_search();
 
+    /** Get the endgame solver.
+        In levels 4 and higher, genmove() uses the solver instead of the
+        search in positions for which EndgameSolver::is_small() returns
+        true. The solver uses at most half of the time or number of
+        simulations of the search (converted into a number of nodes). If it
+        gives up, the search uses the remaining budget. Setting
+        EndgameSolver::set_max_legal_moves() to 0 disables the solver. */
+    EndgameSolver& get_solver() { return m_solver; }
+
     void load_book(istream& in);
 
+    /** Load a book created with CompiledBook::compile().
+        @throws libpentobi_base::CompiledBook::Error */
+    void load_compiled_book(const string& filepath);
+
     /** Is a book loaded and compatible with a given game variant? */
     bool is_book_loaded(Variant variant) const;
 
@@ -89,6 +103,13 @@ public:
     /** Was last move generation based on an aborted search? */
     bool was_aborted() const { return m_was_aborted; }
 
+    /** Was the last move generated by the endgame solver? */
+    bool was_solved() const { return m_was_solved; }
+
+    /** Get the exact final score of the last move generation.
+        @pre was_solved() */
+    ScoreType get_solved_score() const { return m_solved_score; }
+
 private:
     bool m_is_book_loaded;
 
@@ -98,6 +119,10 @@ private:
 
     bool m_was_aborted;
 
+    bool m_was_solved = false;
+
+    ScoreType m_solved_score;
+
     string m_books_dir;
 
     unsigned m_max_level;
@@ -120,6 +145,8 @@ private:
 
     Search m_search;
 
+    EndgameSolver m_solver;
+
     Book m_book;
 
     unique_ptr<TimeSource> m_time_source;
@@ -128,6 +155,10 @@ private:
     void init_settings();
 
     bool load_book(const string& filepath);
+
+    /** Load the book for a game variant from the books directory.
+        Prefers a compiled book if one exists. */
+    void load_book(Variant variant);
 };
 
 inline Float Player::get_fixed_simulations() const
@@ -10,6 +10,8 @@
 #include "Float.h"
 #include "LocalPoints.h"
 #include "SearchParamConst.h"
+#include "Weights.h"
+#include "libboardgame_mcts/CpuDispatch.h"
 #include "libboardgame_mcts/Tree.h"
 #include "libpentobi_base/Board.h"
 
@@ -35,7 +37,8 @@ using libpentobi_base::Variant;
 /** Initializes newly created nodes with move prior, count and value.
     Computes move priors of the form exp(phi*x) with a weight vector phi and a
     feature vector x. These weights can be learned with softmax training from
-    existing games (see pentobi/src/learn_tool).
+    existing games (see pentobi/src/learn_tool) and changed at runtime (see
+    Weights).
 
     The move generation also prunes certain moves in some game variants (e.g.
     opening moves that don't go towards the center). */
@@ -50,11 +53,12 @@ public:
 
     explicit PriorKnowledge(const Board& bd);
 
-    void start_search(const Board& bd);
+    void start_search(const Board& bd, const Weights& weights);
 
     /** Generate children nodes initialized with prior knowledge.
         @return false If the tree has not enough capacity for the children. */
     template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH, bool IS_CALLISTO>
+    LIBBOARDGAME_MCTS_DISPATCH
     bool gen_children(const Board& bd, const MoveList& moves,
                       bool is_symmetry_broken, Tree::NodeExpander& expander,
                       Float root_val);
@@ -144,9 +148,12 @@ private:
 
 
     template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH, bool IS_CALLISTO>
+    LIBBOARDGAME_MCTS_DISPATCH
     void compute_features(const Board& bd, const MoveList& moves,
                           bool check_dist_to_center, bool check_connect);
 
+    void init_gamma(const Board& bd, const Weights& weights);
+
     void init_variant(const Board& bd);
 };
 
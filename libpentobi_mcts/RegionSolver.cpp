@@ -0,0 +1,290 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_mcts/RegionSolver.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "RegionSolver.h"
+
+#include <algorithm>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace libpentobi_mcts {
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+inline unsigned get_lowest_bit(uint64_t mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(mask));
+#endif
+}
+
+inline unsigned get_nu_bits(uint64_t mask)
+{
+#ifdef _MSC_VER
+    return static_cast<unsigned>(__popcnt64(mask));
+#else
+    return static_cast<unsigned>(__builtin_popcountll(mask));
+#endif
+}
+
+/** Finalizer of SplitMix64, used for hashing. */
+inline uint64_t mix(uint64_t x)
+{
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+    return x ^ (x >> 31);
+}
+
+/** Hash value for a piece with a given number of instances left. */
+inline uint64_t get_piece_hash(Piece piece, unsigned nu_left)
+{
+    return mix(0x10000 + 16 * piece.to_int() + nu_left);
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+RegionSolver::RegionSolver()
+    : m_visited(visited_size)
+{
+    m_index.fill_all(-1);
+}
+
+RegionSolver::~RegionSolver() = default;
+
+void RegionSolver::clear()
+{
+    m_cache.clear();
+}
+
+bool RegionSolver::is_supported(BoardType board_type)
+{
+    return board_type == BoardType::classic || board_type == BoardType::duo;
+}
+
+void RegionSolver::search(Mask free, Mask attach, ScoreType points,
+                          ScoreType points_left, unsigned nu_pieces_left,
+                          uint64_t pieces_hash)
+{
+    if (points > m_best)
+        m_best = points;
+    if (++m_nu_nodes > m_max_nodes)
+    {
+        m_is_aborted = true;
+        return;
+    }
+    auto nu_free = static_cast<ScoreType>(get_nu_bits(free));
+    auto bound = points + min(points_left, nu_free);
+    if (nu_free >= points_left)
+        bound += m_bonus_all_pieces + m_bonus_one_piece;
+    if (bound <= m_best || attach == 0)
+        return;
+    auto hash = mix(free) ^ mix(attach ^ 0x5555555555555555) ^ pieces_hash;
+    auto& visited = m_visited[hash % visited_size];
+    if (visited == hash)
+        return;
+    visited = hash;
+    for (auto a = attach; a != 0; a &= a - 1)
+    {
+        auto i = get_lowest_bit(a);
+        // Placements at several attach points are only tried at the lowest
+        Mask lower_attach = attach & ((Mask(1) << i) - 1);
+        for (auto j : m_placements_at[i])
+        {
+            auto& placement = m_placements[j];
+            if ((placement.points & ~free) != 0
+                    || (placement.points & lower_attach) != 0)
+                continue;
+            auto& nu_left = m_nu_left[placement.piece];
+            if (nu_left == 0)
+                continue;
+            auto new_points = points + placement.score;
+            if (nu_pieces_left == 1)
+            {
+                new_points += m_bonus_all_pieces;
+                if (placement.score == 1)
+                    new_points += m_bonus_one_piece;
+                if (new_points > m_best)
+                    m_best = new_points;
+                continue;
+            }
+            auto new_free = free & ~placement.forbidden;
+            auto new_pieces_hash = pieces_hash
+                    ^ get_piece_hash(placement.piece, nu_left)
+                    ^ get_piece_hash(placement.piece, nu_left - 1);
+            --nu_left;
+            search(new_free, (attach | placement.attach) & new_free,
+                   new_points, points_left - placement.score,
+                   nu_pieces_left - 1, new_pieces_hash);
+            ++nu_left;
+            if (m_is_aborted)
+                return;
+        }
+    }
+}
+
+void RegionSolver::set_max_region_points(unsigned n)
+{
+    m_max_region_points = min(n, max_points);
+}
+
+bool RegionSolver::solve(const Board& bd, Color c,
+                         const RegionAnalysis& analysis, ScoreType& points)
+{
+    LIBBOARDGAME_ASSERT(is_supported(bd.get_board_type()));
+    auto& pieces_left = bd.get_pieces_left(c);
+    if (pieces_left.empty())
+    {
+        // Bonus already included in Board::get_points()
+        points = 0;
+        return true;
+    }
+    if (bd.is_first_piece(c))
+        return false;
+    auto& region_points = m_region_points;
+    region_points.clear();
+    for (auto& region : analysis.get_regions(c))
+    {
+        if (! region.is_independent)
+            continue;
+        if (region_points.size() + region.end - region.begin
+                > m_max_region_points)
+            return false;
+        for (auto i = region.begin; i < region.end; ++i)
+            region_points.push_back(analysis.get_points(c)[i]);
+    }
+    auto& bc = bd.get_board_const();
+    if (&bc != m_bc)
+    {
+        m_bc = &bc;
+        m_cache.clear();
+    }
+
+    // Key of the cache
+    uint64_t pieces_hash = 0;
+    unsigned nu_pieces_left = 0;
+    ScoreType points_left = 0;
+    for (Piece piece : pieces_left)
+    {
+        auto nu_left = bd.get_nu_left_piece(c, piece);
+        m_nu_left[piece] = nu_left;
+        pieces_hash ^= get_piece_hash(piece, nu_left);
+        nu_pieces_left += nu_left;
+        points_left += static_cast<ScoreType>(nu_left)
+                * bd.get_piece_info(piece).get_score_points();
+    }
+    auto key = pieces_hash;
+    Mask attach = 0;
+    for (unsigned i = 0; i < region_points.size(); ++i)
+    {
+        Point p = region_points[i];
+        m_index[p] = static_cast<int>(i);
+        bool is_attach = bd.is_attach_point(p, c);
+        if (is_attach)
+            attach |= (Mask(1) << i);
+        key ^= mix(2 * p.to_int() + (is_attach ? 1 : 0));
+    }
+    auto pos = m_cache.find(key);
+    if (pos != m_cache.end())
+    {
+        for (Point p : region_points)
+            m_index[p] = -1;
+        points = pos->second;
+        return points >= 0;
+    }
+
+    // Placements
+    auto& geo = bd.get_geometry();
+    m_placements.clear();
+    for (unsigned i = 0; i < region_points.size(); ++i)
+        m_placements_at[i].clear();
+    for (unsigned i = 0; i < region_points.size(); ++i)
+    {
+        Point p = region_points[i];
+        auto adj_status = bd.get_adj_status(p, c);
+        for (Piece piece : pieces_left)
+            for (auto mv : bc.get_moves(piece, p, adj_status))
+            {
+                // Each placement is added only at its point with the lowest
+                // index
+                Mask mask = 0;
+                bool is_valid = true;
+                for (Point q : bd.get_move_points(mv))
+                {
+                    auto index = m_index[q];
+                    if (index < 0 || static_cast<unsigned>(index) < i)
+                    {
+                        is_valid = false;
+                        break;
+                    }
+                    mask |= (Mask(1) << index);
+                }
+                if (! is_valid)
+                    continue;
+                Placement placement;
+                placement.points = mask;
+                placement.forbidden = mask;
+                placement.attach = 0;
+                for (Point q : bd.get_move_points(mv))
+                {
+                    for (Point r : geo.get_adj(q))
+                        if (m_index[r] >= 0)
+                            placement.forbidden |= (Mask(1) << m_index[r]);
+                    for (Point r : geo.get_diag(q))
+                        if (m_index[r] >= 0)
+                            placement.attach |= (Mask(1) << m_index[r]);
+                }
+                placement.attach &= ~placement.forbidden;
+                placement.piece = piece;
+                placement.score = bd.get_piece_info(piece).get_score_points();
+                m_placements.push_back(placement);
+            }
+    }
+    for (Point p : region_points)
+        m_index[p] = -1;
+    // Larger pieces first, for finding good packings early
+    stable_sort(m_placements.begin(), m_placements.end(),
+                [](const Placement& p1, const Placement& p2) {
+                    return p1.score > p2.score;
+                });
+    for (unsigned i = 0; i < m_placements.size(); ++i)
+        for (auto mask = m_placements[i].points; mask != 0; mask &= mask - 1)
+            m_placements_at[get_lowest_bit(mask)].push_back(i);
+
+    m_bonus_all_pieces = bd.get_bonus_all_pieces();
+    m_bonus_one_piece =
+            bd.is_piece_left(c, bd.get_one_piece()) ?
+                bd.get_bonus_one_piece() : 0;
+    m_nu_nodes = 0;
+    m_is_aborted = false;
+    m_best = 0;
+    fill(m_visited.begin(), m_visited.end(), 0);
+    Mask free = (region_points.size() == max_points ?
+                     ~Mask(0) : (Mask(1) << region_points.size()) - 1);
+    search(free, attach, 0, points_left, nu_pieces_left, pieces_hash);
+    if (m_cache.size() >= max_cache_size)
+        m_cache.clear();
+    if (m_is_aborted)
+    {
+        m_cache.emplace(key, -1);
+        return false;
+    }
+    m_cache.emplace(key, m_best);
+    points = m_best;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_mcts
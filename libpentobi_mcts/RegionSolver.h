@@ -0,0 +1,160 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_mcts/RegionSolver.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBPENTOBI_MCTS_REGION_SOLVER_H
+#define LIBPENTOBI_MCTS_REGION_SOLVER_H
+
+#include <unordered_map>
+#include "libpentobi_base/RegionAnalysis.h"
+
+namespace libpentobi_mcts {
+
+using namespace std;
+using libboardgame_base::ArrayList;
+using libpentobi_base::Board;
+using libpentobi_base::BoardConst;
+using libpentobi_base::BoardType;
+using libpentobi_base::Color;
+using libpentobi_base::Grid;
+using libpentobi_base::Piece;
+using libpentobi_base::PieceMap;
+using libpentobi_base::Point;
+using libpentobi_base::RegionAnalysis;
+using libpentobi_base::ScoreType;
+
+//-----------------------------------------------------------------------------
+
+/** Computes the best packing of the pieces left of a color into its
+    independent regions.
+    If all legal moves of a color are in independent regions, its moves do
+    not interact with the moves of other colors anymore, so the rest of the
+    game of this color does not need to be played out in the simulations.
+    The solver does a depth-first search over the placements with an upper
+    bound on the points that can still be gained and skips positions already
+    searched with a different order of the same placements. The results are
+    cached by the points and attach points of the regions and the pieces
+    left.
+    Only supports board types in which the pieces of a color touch at the
+    corners (Classic and Duo) and regions with at most max_points points. */
+class RegionSolver
+{
+public:
+    /** The maximum total number of points of the regions of a color.
+        The points are represented as bits in a 64-bit integer. */
+    static constexpr unsigned max_points = 64;
+
+    RegionSolver();
+
+    ~RegionSolver();
+
+    static bool is_supported(BoardType board_type);
+
+    /** Get the points that a color can still gain.
+        @pre is_supported(bd.get_board_type())
+        @pre analysis was initialized with bd and the color has no legal
+        moves in regions that are not independent.
+        @param bd
+        @param c
+        @param analysis
+        @param[out] points The maximum points including the bonus for playing
+        all pieces
+        @return @c false if the regions were too large or the search was
+        aborted because of the node limit. */
+    bool solve(const Board& bd, Color c, const RegionAnalysis& analysis,
+               ScoreType& points);
+
+    /** Clear the cache. */
+    void clear();
+
+    /** Maximum total number of points of the regions of a color.
+        At most max_points. */
+    void set_max_region_points(unsigned n);
+
+    unsigned get_max_region_points() const { return m_max_region_points; }
+
+    /** Maximum number of nodes searched in a single call of solve(). */
+    void set_max_nodes(unsigned n) { m_max_nodes = n; }
+
+    unsigned get_max_nodes() const { return m_max_nodes; }
+
+private:
+    using Mask = uint64_t;
+
+    /** A placement of a piece in the regions. */
+    struct Placement
+    {
+        /** The points of the piece. */
+        Mask points;
+
+        /** The points that become forbidden, including the points of the
+            piece. */
+        Mask forbidden;
+
+        /** The new attach points. */
+        Mask attach;
+
+        Piece piece;
+
+        ScoreType score;
+    };
+
+    /** The number of entries in m_visited. */
+    static constexpr unsigned visited_size = 4096;
+
+    /** The maximum number of entries in m_cache before it is cleared. */
+    static constexpr size_t max_cache_size = 100000;
+
+    unsigned m_max_region_points = 40;
+
+    unsigned m_max_nodes = 3000;
+
+    unsigned m_nu_nodes;
+
+    bool m_is_aborted;
+
+    ScoreType m_best;
+
+    /** Bonus for playing all pieces. */
+    ScoreType m_bonus_all_pieces;
+
+    /** Bonus for playing the 1-piece last. */
+    ScoreType m_bonus_one_piece;
+
+    /** Board constant of the last solve() used for detecting a change of
+        the game variant, which invalidates the cache. */
+    const BoardConst* m_bc = nullptr;
+
+    /** Number of instances left of each piece. */
+    PieceMap<unsigned> m_nu_left;
+
+    /** The points of the independent regions. */
+    ArrayList<Point, max_points> m_region_points;
+
+    /** Index of a point in m_region_points, or -1. */
+    Grid<int> m_index;
+
+    vector<Placement> m_placements;
+
+    /** Indices of the placements in m_placements that contain a point. */
+    array<vector<unsigned>, max_points> m_placements_at;
+
+    /** Hash values of the positions visited in the current search.
+        Lossy, an entry can be overwritten by a different position. */
+    vector<uint64_t> m_visited;
+
+    /** Cached results of solve() or negative values for failed searches. */
+    unordered_map<uint64_t, ScoreType> m_cache;
+
+    void search(Mask free, Mask attach, ScoreType points,
+                ScoreType points_left, unsigned nu_pieces_left,
+                uint64_t pieces_hash);
+};
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_mcts
+
+#endif // LIBPENTOBI_MCTS_REGION_SOLVER_H
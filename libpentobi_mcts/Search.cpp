@@ -15,17 +15,25 @@ namespace libpentobi_mcts {
 Search::Search(Variant initial_variant, unsigned nu_threads, size_t memory)
     : SearchBase(nu_threads == 0 ? get_nu_threads() : nu_threads, memory),
       m_variant(initial_variant),
-      m_shared_const(m_to_play)
+      m_shared_const(m_to_play),
+      m_default_weights(Weights::get_default(initial_variant))
 {
+    m_shared_const.weights = &m_default_weights;
     set_default_param(m_variant);
+    // Keep a few trees for reuse after undoing moves or navigating in the
+    // game tree, but don't let them use more than half of the memory of the
+    // search tree
+    set_tree_cache(4, memory / 4);
     create_threads();
 }
 
-bool Search::check_followup(ArrayList<Move, max_moves>& sequence)
+/** Check if m_history is a follow-up position of a position searched
+    before. */
+bool Search::check_followup(const History& history,
+                            ArrayList<Move, max_moves>& sequence) const
 {
     auto& bd = get_board();
-    m_history.init(bd, m_to_play);
-    bool is_followup = m_history.is_followup(m_last_history, sequence);
+    bool is_followup = m_history.is_followup(history, sequence);
 
     // If avoid_symmetric_draw is enabled, class State uses a different
     // evaluation function depending on which player is to play in the root
@@ -34,11 +42,31 @@ bool Search::check_followup(ArrayList<Move, max_moves>& sequence)
     // symmetric draws to avoid going for such a draw). In this case, we cannot
     // reuse parts of the old search tree if the computer plays both colors.
     if (m_shared_const.avoid_symmetric_draw
-            && is_followup && m_to_play != m_last_history.get_to_play()
+            && is_followup && m_to_play != history.get_to_play()
             && has_central_symmetry(bd.get_variant())
             && ! check_symmetry_broken(bd))
         is_followup = false;
 
+    return is_followup;
+}
+
+bool Search::check_cached_followup(unsigned key,
+                                   ArrayList<Move, max_moves>& sequence)
+{
+    return check_followup(m_cached_history[key], sequence);
+}
+
+bool Search::check_followup(ArrayList<Move, max_moves>& sequence)
+{
+    m_history.init(get_board(), m_to_play);
+    bool is_followup = check_followup(m_last_history, sequence);
+    if (m_weights_changed.erase(get_board().get_variant()) > 0)
+    {
+        // Cached trees also use the old move priors
+        clear_tree_cache();
+        is_followup = false;
+    }
+
     m_last_history = m_history;
     return is_followup;
 }
@@ -48,12 +76,33 @@ unique_ptr<State> Search::create_state()
     return make_unique<State>(m_variant, m_shared_const);
 }
 
+void Search::clear_weights()
+{
+    if (m_weights.empty())
+        return;
+    // m_shared_const.weights may point to an element of m_weights
+    if (m_default_weights.variant != m_variant)
+        m_default_weights = Weights::get_default(m_variant);
+    m_shared_const.weights = &m_default_weights;
+    for (auto& i : m_weights)
+        m_weights_changed.insert(i.first);
+    m_weights.clear();
+}
+
 void Search::get_root_position(Variant& variant, Setup& setup) const
 {
     m_last_history.get_as_setup(variant, setup);
     setup.to_play = m_to_play;
 }
 
+Weights Search::get_weights(Variant variant) const
+{
+    auto pos = m_weights.find(variant);
+    if (pos != m_weights.end())
+        return pos->second;
+    return Weights::get_default(variant);
+}
+
 void Search::on_start_search(bool is_followup)
 {
     m_shared_const.init(is_followup);
@@ -73,6 +122,15 @@ bool Search::search(Move& mv, const Board& bd, Color to_play,
     if (variant != m_variant)
         set_default_param(variant);
     m_variant = variant;
+    auto pos = m_weights.find(variant);
+    if (pos != m_weights.end())
+        m_shared_const.weights = &pos->second;
+    else
+    {
+        if (m_default_weights.variant != variant)
+            m_default_weights = Weights::get_default(variant);
+        m_shared_const.weights = &m_default_weights;
+    }
     bool result = SearchBase::search(mv, max_count, min_simulations, max_time,
                                       time_source);
     // Search doesn't generate all useless one-piece moves in Callisto
@@ -93,6 +151,19 @@ bool Search::search(Move& mv, const Board& bd, Color to_play,
     return result;
 }
 
+void Search::save_position(unsigned key)
+{
+    if (key >= m_cached_history.size())
+        m_cached_history.resize(key + 1);
+    m_cached_history[key] = m_history;
+}
+
+void Search::set_weights(const Weights& weights)
+{
+    m_weights[weights.variant] = weights;
+    m_weights_changed.insert(weights.variant);
+}
+
 void Search::set_default_param(Variant variant)
 {
     LIBBOARDGAME_LOG("Setting default parameters for ", to_string(variant));
@@ -7,6 +7,8 @@
 #ifndef LIBPENTOBI_MCTS_SEARCH_H
 #define LIBPENTOBI_MCTS_SEARCH_H
 
+#include <map>
+#include <set>
 #include "History.h"
 #include "SearchParamConst.h"
 #include "State.h"
@@ -53,6 +55,11 @@ public:
 
     bool check_followup(ArrayList<Move, max_moves>& sequence) override;
 
+    bool check_cached_followup(unsigned key,
+                               ArrayList<Move, max_moves>& sequence) override;
+
+    void save_position(unsigned key) override;
+
     string get_info() const override;
 
 
@@ -63,6 +70,26 @@ public:
 
     void set_avoid_symmetric_draw(bool enable);
 
+    bool get_solve_regions() const;
+
+    /** Replace the rest of the game of a color in the playouts by the best
+        packing of its pieces left if all its moves are in regions that no
+        other color can reach.
+        Only used in game variants with two colors and the board type of
+        Duo. */
+    void set_solve_regions(bool enable);
+
+    /** Use custom weights for the move priors and playout gammas.
+        The weights replace the built-in default weights for the game variant
+        of the weights. */
+    void set_weights(const Weights& weights);
+
+    /** Use the built-in default weights for all game variants. */
+    void clear_weights();
+
+    /** Get the weights used for a game variant. */
+    Weights get_weights(Variant variant) const;
+
     /** @} */ // @name
 
 
@@ -91,11 +118,30 @@ private:
 
     SharedConst m_shared_const;
 
+    /** Custom weights set with set_weights(). */
+    map<Variant, Weights> m_weights;
+
+    /** Default weights for the game variant of the last search. */
+    Weights m_default_weights;
+
+    /** Game variants whose weights were changed since their last search.
+        Reusing the subtree of the last search or a cached tree is not
+        possible for these variants because the move priors of the existing
+        nodes were computed with the old weights. */
+    set<Variant> m_weights_changed;
+
     /** Local variable reused for efficiency. */
     History m_history;
 
     History m_last_history;
 
+    /** Positions at the root of the trees in the tree cache.
+        Indexed by the key used in save_position(). */
+    vector<History> m_cached_history;
+
+    bool check_followup(const History& history,
+                        ArrayList<Move, max_moves>& sequence) const;
+
     const Board& get_board() const;
 
     void set_default_param(Variant variant);
@@ -129,6 +175,11 @@ inline PlayerInt Search::get_player() const
     return to_play;
 }
 
+inline bool Search::get_solve_regions() const
+{
+    return m_shared_const.solve_regions;
+}
+
 inline Color Search::get_to_play() const
 {
     return m_to_play;
@@ -139,6 +190,11 @@ inline void Search::set_avoid_symmetric_draw(bool enable)
     m_shared_const.avoid_symmetric_draw = enable;
 }
 
+inline void Search::set_solve_regions(bool enable)
+{
+    m_shared_const.solve_regions = enable;
+}
+
 //-----------------------------------------------------------------------------
 
 } // namespace libpentobi_mcts
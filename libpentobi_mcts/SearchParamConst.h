@@ -51,6 +51,11 @@ struct SearchParamConst
 
     static constexpr bool rave_dist_weighting = true;
 
+    /** Sparse RAVE update disabled.
+        It was not faster than the full update, even in the early game,
+        where the nodes near the root have many children. */
+    static constexpr unsigned rave_sparse_min_children = 0;
+
     static constexpr bool use_lgr = true;
 
 #ifdef PENTOBI_LOW_RESOURCES
@@ -73,6 +78,18 @@ struct SearchParamConst
 
     static constexpr Float expansion_threshold_inc = 0.5f;
 
+    /** Accumulation of updates near the root per thread.
+        Disabled until its effect on the scaling with many threads has been
+        measured. */
+    static constexpr unsigned accumulation_depth = 0;
+
+    static constexpr unsigned accumulation_interval = 16;
+
+    /** Batched leaf evaluation.
+        Not used, the playouts are currently faster and stronger than any
+        available static evaluator. */
+    static constexpr unsigned leaf_batch_size = 0;
+
     static constexpr double expected_sim_per_sec = 100;
 };
 
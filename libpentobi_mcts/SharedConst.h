@@ -7,6 +7,7 @@
 #ifndef LIBPENTOBI_MCTS_SHARED_CONST_H
 #define LIBPENTOBI_MCTS_SHARED_CONST_H
 
+#include "Weights.h"
 #include "libpentobi_base/Board.h"
 #include "libpentobi_base/MoveMarker.h"
 
@@ -38,11 +39,21 @@ public:
         Contains the current position. */
     const Board* board;
 
+    /** The weights for the move priors and playout gammas.
+        Matches the game variant of board. */
+    const Weights* weights;
+
     /** The color to play at the root of the search. */
     const Color& to_play;
 
     bool avoid_symmetric_draw;
 
+    /** Replace the rest of the game of a color in the playouts by the
+        result of RegionSolver if all its moves are in independent regions.
+        Default is false because the analysis reduces the number of
+        simulations per second in late positions. */
+    bool solve_regions;
+
     /** Minimum total number of pieces on the board where all pieces are
         considered until the rest of the simulation. */
     unsigned min_move_all_considered;
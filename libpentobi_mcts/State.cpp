@@ -182,6 +182,61 @@ inline bool State::check_move(Move mv, const MoveInfo<MAX_SIZE>& info,
                 playout_features, total_gamma);
 }
 
+/** Replace the rest of the game of a color by the result of m_region_solver
+    if all its legal moves are in independent regions. */
+void State::check_regions(Color c)
+{
+    auto& moves = m_moves[c];
+    // The regions are not checked again until the number of legal moves
+    // decreased considerably
+    m_regions_max_nu_legal[c] = moves.size() / 2;
+    // Moves of pieces that are not considered would be missing in m_moves
+    if (m_is_piece_considered[c] != &m_shared_const.is_piece_considered_all)
+        return;
+    auto key = m_position_hash ^ c.to_int();
+    auto& entry = m_regions_cache[key % regions_cache_size];
+    if (entry.key != key)
+    {
+        entry.key = key;
+        entry.points = -1;
+        // All points of a move are in the same region. Most checks fail
+        // because the other color can play at a point of a legal move,
+        // which is faster to detect here than in m_region_analysis.
+        LIBBOARDGAME_ASSERT(m_nu_colors == 2);
+        m_region_seeds.clear();
+        m_region_move_points.clear();
+        Color other = c.get_next(m_nu_colors);
+        for (Move mv : moves)
+        {
+            auto points = m_bd.get_move_points(mv);
+            if (! m_region_move_points[*points.begin()])
+                m_region_seeds.push_back(*points.begin());
+            for (Point p : points)
+                if (! m_region_move_points.set(p)
+                        && m_bd.is_attach_point(p, other)
+                        && ! m_bd.is_forbidden(p, other))
+                    return;
+        }
+        if (! m_region_analysis.init_independent(
+                m_bd, c, m_region_seeds,
+                m_region_solver.get_max_region_points())
+                || ! m_region_solver.solve(m_bd, c, m_region_analysis,
+                                           entry.points))
+        {
+            entry.points = -1;
+            return;
+        }
+    }
+    if (entry.points < 0)
+        return;
+    m_is_region_solved[c] = true;
+    m_has_region_solved = true;
+    m_region_points[c] = entry.points;
+    m_regions_max_nu_legal[c] = 0;
+    m_marker[c].clear(moves);
+    moves.clear();
+}
+
 #ifdef LIBBOARDGAME_DEBUG
 string State::dump() const
 {
@@ -191,6 +246,53 @@ string State::dump() const
 }
 #endif
 
+/** Evaluation function for playouts stopped by the playout cutoff.
+    The result is the probability of winning estimated from the difference of
+    the final points estimated by StaticEvaluator and the standard deviation
+    of their error. In variants with more than
+    2 players, it is the average of the estimated probabilities of beating
+    each opponent, which is a continuous version of the rank-based result
+    used in evaluate_multiplayer(). No quality bonus is added, because the
+    game length and final score are not known. */
+void State::evaluate_cutoff(array<Float, 6>& result)
+{
+    auto& weights = *m_shared_const.weights;
+    auto nu_players = m_bd.get_nu_players();
+    array<Float, Color::range> points;
+    for (Color c : Color::Range(nu_players == 2 ? m_nu_colors : nu_players))
+        if (m_has_region_solved && m_is_region_solved[c])
+            points[c.to_int()] = m_bd.get_points(c) + m_region_points[c];
+        else
+            points[c.to_int()] =
+                    m_static_evaluator.get_points(m_bd, c, weights);
+    auto scale = m_cutoff_scale;
+    if (nu_players == 2)
+    {
+        Float s = points[0] - points[1];
+        if (m_nu_colors == 4)
+            s += points[2] - points[3];
+        Float res = 0.5f + 0.5f * sigmoid(1.f, s / scale);
+        for (Color::IntType i = 0; i < m_nu_colors; ++i)
+            result[i] = (i % 2 == 0 ? res : 1.f - res);
+        return;
+    }
+    for (Color::IntType i = 0; i < nu_players; ++i)
+    {
+        Float res = 0;
+        for (Color::IntType j = 0; j < nu_players; ++j)
+            if (j != i)
+                res += 0.5f + 0.5f * sigmoid(1.f,
+                                             (points[i] - points[j]) / scale);
+        result[i] = res / static_cast<Float>(nu_players - 1);
+    }
+    if (m_bd.get_variant() == Variant::classic_3)
+    {
+        result[3] = result[0];
+        result[4] = result[1];
+        result[5] = result[2];
+    }
+}
+
 /** Evaluation function for game variants with 2 players and 2 colors per
     player. */
 void State::evaluate_multicolor(array<Float, 6>& result)
@@ -264,7 +366,11 @@ void State::evaluate_twocolor(array<Float, 6>& result)
             && m_bd.get_nu_onboard_pieces() >= m_symmetry_min_nu_pieces)
         s = 0;
     else
+    {
         s = m_bd.get_score_twocolor(Color(0));
+        if (m_has_region_solved)
+            s += m_region_points[Color(0)] - m_region_points[Color(1)];
+    }
     Float res;
     if (s > 0)
         res = 1;
@@ -415,11 +521,17 @@ bool State::gen_playout_move_full(PlayerMove& mv)
             else
                 update_moves<22, 44, false>(to_play);
         }
+        // A single legal move does not need to be solved
+        if (m_moves[to_play].size() <= m_regions_max_nu_legal[to_play]
+                && m_moves[to_play].size() > 1
+                && m_bd.get_nu_moves() >= m_regions_min_nu_moves)
+            check_regions(to_play);
         if ((m_has_moves[to_play] = ! m_moves[to_play].empty()))
             break;
         if (++m_nu_passes == m_nu_colors)
             return false;
-        if (m_check_terminate_early && m_bd.get_score_twoplayer(to_play) < 0
+        if (m_check_terminate_early && ! m_has_region_solved
+            && m_bd.get_score_twoplayer(to_play) < 0
             && ! m_has_moves[m_bd.get_second_color(to_play)])
         {
             return false;
@@ -560,97 +672,10 @@ inline Float State::get_quality_bonus_attach_multicolor()
 
 void State::init_gamma()
 {
-    auto& bd = *m_shared_const.board;
-    const auto piece_set = bd.get_piece_set();
-    if (piece_set == PieceSet::gembloq)
-    {
-        static_assert(PlayoutFeatures::max_local + 1 >= 20);
-        m_gamma_local[0] = 1;
-        m_gamma_local[1] = 1e6f;
-        m_gamma_local[2] = 1e6f;
-        m_gamma_local[3] = 1e6f;
-        m_gamma_local[4] = 1e6f;
-        m_gamma_local[5] = 1e6f;
-        m_gamma_local[6] = 1e6f;
-        m_gamma_local[7] = 1e6f;
-        m_gamma_local[8] = 1e12f;
-        m_gamma_local[9] = 1e12f;
-        m_gamma_local[10] = 1e12f;
-        m_gamma_local[11] = 1e12f;
-        m_gamma_local[12] = 1e18f;
-        m_gamma_local[13] = 1e18f;
-        m_gamma_local[14] = 1e18f;
-        m_gamma_local[15] = 1e18f;
-        m_gamma_local[16] = 1e24f;
-        m_gamma_local[17] = 1e24f;
-        m_gamma_local[18] = 1e24f;
-        m_gamma_local[19] = 1e24f;
-        for (unsigned i = 20; i < PlayoutFeatures::max_local + 1; ++i)
-            m_gamma_local[i] = 1e25f;
-    }
-    else if (piece_set == PieceSet::trigon)
-    {
-        static_assert(PlayoutFeatures::max_local + 1 >= 5);
-        m_gamma_local[0] = 1;
-        m_gamma_local[1] = 1e6f;
-        m_gamma_local[2] = 1e12f;
-        m_gamma_local[3] = 1e18f;
-        m_gamma_local[4] = 1e24f;
-        for (unsigned i = 5; i < PlayoutFeatures::max_local + 1; ++i)
-            m_gamma_local[i] = 1e30f;
-    }
-    else if (piece_set == PieceSet::nexos)
-    {
-        static_assert(PlayoutFeatures::max_local + 1 >= 4);
-        m_gamma_local[0] = 1;
-        m_gamma_local[1] = 1e6f;
-        m_gamma_local[2] = 1e12f;
-        m_gamma_local[3] = 1e18f;
-        for (unsigned i = 4; i < PlayoutFeatures::max_local + 1; ++i)
-            m_gamma_local[i] = 1e24f;
-    }
-    else
-    {
-        static_assert(PlayoutFeatures::max_local + 1 >= 5);
-        m_gamma_local[0] = 1;
-        m_gamma_local[1] = 1e6f;
-        m_gamma_local[2] = 1e12f;
-        m_gamma_local[3] = 1e18f;
-        m_gamma_local[4] = 1e24f;
-        for (unsigned i = 5; i < PlayoutFeatures::max_local + 1; ++i)
-            m_gamma_local[i] = 1e25f;
-    }
-    float gamma_size_factor = 1;
-    float gamma_nu_attach_factor = 1;
-    switch (bd.get_board_type())
-    {
-    case BoardType::classic:
-        gamma_size_factor = 5;
-        break;
-    case BoardType::duo:
-        gamma_size_factor = 3;
-        gamma_nu_attach_factor = 1.8f;
-        break;
-    case BoardType::trigon:
-    case BoardType::trigon_3: // Not tuned
-        gamma_size_factor = 5;
-        break;
-    case BoardType::nexos: // Not tuned
-        gamma_size_factor = 5;
-        gamma_nu_attach_factor = 1.8f;
-        break;
-    case BoardType::callisto_2:
-    case BoardType::callisto: // Not tuned
-    case BoardType::callisto_3: // Not tuned
-        gamma_size_factor = 12;
-        gamma_nu_attach_factor = 1.8f;
-        break;
-    case BoardType::gembloq_2:
-    case BoardType::gembloq: // Not tuned
-    case BoardType::gembloq_3: // Not tuned
-        gamma_size_factor = 1.5f;
-        break;
-    }
+    auto& weights = *m_shared_const.weights;
+    m_gamma_local = weights.playout_local;
+    auto gamma_size_factor = weights.playout_size_factor;
+    auto gamma_nu_attach_factor = weights.playout_nu_attach_factor;
     for (Piece::IntType i = 0; i < m_bc->get_nu_pieces(); ++i)
     {
         Piece piece(i);
@@ -818,7 +843,33 @@ void State::start_search()
         m_symmetry_min_nu_pieces = 3;
     }
 
-    m_prior_knowledge.start_search(bd);
+    m_cutoff_depth = m_shared_const.weights->cutoff_depth;
+    m_cutoff_nu_moves = numeric_limits<unsigned>::max();
+    {
+        // Assume independent normally distributed errors of the colors in
+        // the score difference of two players and use the logistic
+        // approximation of the normal distribution function
+        auto nu_diff_colors =
+                (m_bd.get_nu_players() == 2 ? m_nu_colors : 2);
+        m_cutoff_scale = m_shared_const.weights->cutoff_sigma
+                * sqrt(static_cast<Float>(nu_diff_colors)) / 1.702f;
+    }
+
+    m_solve_regions = (m_shared_const.solve_regions && m_nu_colors == 2
+                       && RegionSolver::is_supported(bd.get_board_type()));
+    // Independent regions are rare before the last third of the game
+    m_regions_min_nu_moves = 12 * m_nu_colors;
+    for (Color c : Color::Range(m_nu_colors))
+        m_region_points[c] = 0;
+    m_has_region_solved = false;
+    if (m_solve_regions)
+    {
+        // Key 0 does not occur in practice (see start_simulation()) and
+        // would only skip a check
+        m_regions_cache.fill({0, -1});
+    }
+
+    m_prior_knowledge.start_search(bd, *m_shared_const.weights);
     m_stat_len.clear();
     m_stat_attach.clear();
     for (Color c : Color::Range(m_nu_colors))
@@ -840,6 +891,21 @@ void State::start_simulation([[maybe_unused]] size_t n)
         m_moves_added_at[c].fill(false, geo);
     }
     m_nu_passes = 0;
+    m_is_cutoff = false;
+    // Arbitrary non-zero value for the root position
+    m_position_hash = 0x9e3779b97f4a7c15u;
+    if (m_has_region_solved)
+    {
+        m_has_region_solved = false;
+        for (Color c : Color::Range(m_nu_colors))
+            m_region_points[c] = 0;
+    }
+    for (Color c : Color::Range(m_nu_colors))
+    {
+        m_is_region_solved[c] = false;
+        // Regions are rarely independent if there are many legal moves
+        m_regions_max_nu_legal[c] = (m_solve_regions ? 16u : 0);
+    }
 }
 
 template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH, bool IS_CALLISTO>
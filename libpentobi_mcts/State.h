@@ -9,8 +9,11 @@
 
 #include "PlayoutFeatures.h"
 #include "PriorKnowledge.h"
+#include "RegionSolver.h"
 #include "SharedConst.h"
 #include "StateUtil.h"
+#include "StaticEvaluator.h"
+#include "libboardgame_mcts/CpuDispatch.h"
 #include "libboardgame_mcts/LastGoodReply.h"
 #include "libboardgame_mcts/PlayerMove.h"
 #include "libboardgame_base/RandomGenerator.h"
@@ -28,6 +31,7 @@ using libpentobi_base::MoveInfoExt;
 using libpentobi_base::Piece;
 using libpentobi_base::PieceInfo;
 using libpentobi_base::PieceSet;
+using libpentobi_base::RegionAnalysis;
 using libpentobi_base::Variant;
 
 //-----------------------------------------------------------------------------
@@ -108,6 +112,21 @@ public:
     string get_info() const;
 
 private:
+    /** Entry of m_regions_cache. */
+    struct RegionsEntry
+    {
+        /** Hash value of the color and the position. */
+        uint64_t key;
+
+        /** The points of the color from m_region_solver or a negative value
+            if the check failed. */
+        ScoreType points;
+    };
+
+    /** The number of entries in m_regions_cache. */
+    static constexpr unsigned regions_cache_size = 2048;
+
+
     /** The cumulative gamma value of the moves in m_moves. */
     array<float, MoveList::max_size> m_cumulative_gamma;
 
@@ -190,6 +209,43 @@ private:
 
     bool m_is_callisto;
 
+    /** Was the current playout stopped by the playout cutoff? */
+    bool m_is_cutoff;
+
+    /** Cache of Weights::cutoff_depth */
+    unsigned m_cutoff_depth;
+
+    /** Number of moves on the board at which the current playout is stopped
+        and evaluated with m_static_evaluator. */
+    unsigned m_cutoff_nu_moves;
+
+    /** Scale of the logistic function in evaluate_cutoff(). */
+    Float m_cutoff_scale;
+
+    /** Cache of SharedConst::solve_regions and RegionSolver::is_supported()
+        for the current game variant.
+        Only used in game variants with two colors. With four colors, most
+        checks fail and made the search about 50% slower in Classic. */
+    bool m_solve_regions;
+
+    /** Was any color in m_is_region_solved in the current simulation? */
+    bool m_has_region_solved;
+
+    /** Was the rest of the game of a color replaced by the result of
+        m_region_solver in the current simulation? */
+    ColorMap<bool> m_is_region_solved;
+
+    /** Points gained by a color in m_is_region_solved after the current
+        position. */
+    ColorMap<ScoreType> m_region_points;
+
+    /** Maximum number of legal moves of a color for calling
+        check_regions() in the current simulation. */
+    ColorMap<unsigned> m_regions_max_nu_legal;
+
+    /** Minimum number of moves on the board for check_regions(). */
+    unsigned m_regions_min_nu_moves;
+
     /** Minimum number of pieces on board to perform a symmetry check.
         3 in Duo/Junior or 5 in Trigon because this is the earliest move number
         to break the symmetry. The early playout termination that evaluates all
@@ -208,6 +264,32 @@ private:
         played pieces. */
     ColorMap<Grid<bool>> m_moves_added_at;
 
+    StaticEvaluator m_static_evaluator;
+
+    RegionAnalysis m_region_analysis;
+
+    /** One point of each region that contains moves, used in
+        check_regions(). */
+    PointList m_region_seeds;
+
+    /** The points of the legal moves in check_regions(). */
+    Marker m_region_move_points;
+
+    RegionSolver m_region_solver;
+
+    /** Hash value of the moves played in the current simulation.
+        The sum of get_move_hash() of the moves, such that transpositions
+        have the same value. */
+    uint64_t m_position_hash;
+
+    /** Results of check_regions() in earlier simulations of the current
+        search.
+        The positions in the tree occur in all simulations that pass through
+        their node, so the result of a check in them can be reused, also if
+        the check failed. Lossy, an entry can be overwritten by another
+        position. */
+    array<RegionsEntry, regions_cache_size> m_regions_cache;
+
 
     template<unsigned MAX_SIZE>
     void add_moves(Point p, Color c, const Board::PiecesLeftList& pieces,
@@ -223,6 +305,12 @@ private:
                                       float& total_gamma, MoveList& moves,
                                       unsigned& nu_moves);
 
+    LIBBOARDGAME_NOINLINE void check_regions(Color c);
+
+    static uint64_t get_move_hash(Color c, Move mv);
+
+    void evaluate_cutoff(array<Float, 6>& result);
+
     void evaluate_multicolor(array<Float, 6>& result);
 
     void evaluate_multiplayer(array<Float, 6>& result);
@@ -256,10 +344,10 @@ private:
     void init_gamma();
 
     template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH, bool IS_CALLISTO>
-    void init_moves_with_gamma(Color c);
+    LIBBOARDGAME_MCTS_DISPATCH void init_moves_with_gamma(Color c);
 
     template<unsigned MAX_SIZE, bool IS_CALLISTO>
-    void init_moves_without_gamma(Color c);
+    LIBBOARDGAME_MCTS_DISPATCH void init_moves_without_gamma(Color c);
 
     template<unsigned MAX_SIZE>
     bool check_forbidden(const GridExt<bool>& is_forbidden, Move mv,
@@ -282,7 +370,7 @@ private:
     bool gen_playout_move_full(PlayerMove& mv);
 
     template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH, bool IS_CALLISTO>
-    void update_moves(Color c);
+    LIBBOARDGAME_MCTS_DISPATCH void update_moves(Color c);
 
     template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH>
     void update_playout_features(Color c, Move mv);
@@ -327,6 +415,11 @@ inline bool State::check_lgr(Move mv) const
 
 inline void State::evaluate_playout(array<Float, 6>& result)
 {
+    if (m_is_cutoff)
+    {
+        evaluate_cutoff(result);
+        return;
+    }
     auto nu_players = m_bd.get_nu_players();
     if (nu_players == 2)
     {
@@ -343,6 +436,9 @@ inline void State::finish_in_tree()
 {
     if (m_check_symmetric_draw)
         m_is_symmetry_broken = check_symmetry_broken(m_bd);
+    if (m_cutoff_depth > 0)
+        // The move of an expanded child counts as a playout move
+        m_cutoff_nu_moves = m_bd.get_nu_moves() + m_cutoff_depth;
 }
 
 inline bool State::gen_playout_move(const LastGoodReply& lgr, Move last,
@@ -354,6 +450,14 @@ inline bool State::gen_playout_move(const LastGoodReply& lgr, Move last,
             && m_bd.get_nu_onboard_pieces() >= m_symmetry_min_nu_pieces)
         // See also the comment in evaluate_playout()
         return false;
+    if (m_bd.get_nu_moves() >= m_cutoff_nu_moves)
+    {
+        m_is_cutoff = true;
+        return false;
+    }
+    if (m_has_region_solved && m_is_region_solved[m_bd.get_to_play()])
+        // Let gen_playout_move_full() pass for the color
+        return gen_playout_move_full(mv);
     PlayerInt player = get_player();
     Move lgr2 = lgr.get_lgr2(player, last, second_last);
     if (check_lgr(lgr2))
@@ -406,6 +510,15 @@ inline bool State::has_moves(Color c, Piece piece, Point p,
     return m_shared_const.precomp_moves[c].has_moves(piece, p, adj_status);
 }
 
+/** Finalizer of the SplitMix64 generator applied to a color and move. */
+inline uint64_t State::get_move_hash(Color c, Move mv)
+{
+    uint64_t x = (uint64_t(mv.to_int()) << 2) | c.to_int();
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9u;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebu;
+    return x ^ (x >> 31);
+}
+
 inline void State::play_in_tree(Move mv)
 {
     Color to_play = m_bd.get_to_play();
@@ -413,6 +526,7 @@ inline void State::play_in_tree(Move mv)
     {
         LIBBOARDGAME_ASSERT(m_bd.is_legal(to_play, mv));
         m_nu_passes = 0;
+        m_position_hash += get_move_hash(to_play, mv);
         if (m_max_piece_size == 5)
         {
             m_bd.play<5, 16>(to_play, mv);
@@ -476,6 +590,7 @@ inline void State::play_playout(Move mv)
     ++m_nu_new_moves[to_play];
     m_last_move[to_play] = mv;
     m_nu_passes = 0;
+    m_position_hash += get_move_hash(to_play, mv);
 }
 
 inline bool State::skip_rave([[maybe_unused]] Move mv) const
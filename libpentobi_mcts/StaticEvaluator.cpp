@@ -0,0 +1,73 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_mcts/StaticEvaluator.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "StaticEvaluator.h"
+
+namespace libpentobi_mcts {
+
+using libpentobi_base::Piece;
+using libpentobi_base::Point;
+using libpentobi_base::ScoreType;
+
+//-----------------------------------------------------------------------------
+
+void StaticEvaluator::get_features(const Board& bd, Color c,
+                                   Features& features)
+{
+    ScoreType points_left = 0;
+    for (Piece piece : bd.get_pieces_left(c))
+        points_left += static_cast<ScoreType>(bd.get_nu_left_piece(c, piece))
+                * bd.get_piece_info(piece).get_score_points();
+    auto& is_forbidden = bd.is_forbidden(c);
+    auto& geo = bd.get_geometry();
+    m_marker.clear();
+    m_stack.clear();
+    unsigned attach = 0;
+    auto add_attach_point = [&](Point p) {
+        if (! is_forbidden[p] && ! m_marker.set(p))
+        {
+            ++attach;
+            m_stack.push_back(p);
+        }
+    };
+    // Use the starting points as attach points before the first piece, such
+    // that a color that has not played yet does not look blocked
+    if (bd.is_first_piece(c))
+        for (Point p : bd.get_starting_points(c))
+            add_attach_point(p);
+    else
+        for (Point p : bd.get_attach_points(c))
+            add_attach_point(p);
+    // Flood fill, no need to continue once the area is large enough for
+    // all pieces left
+    unsigned area = 0;
+    while (! m_stack.empty() && static_cast<ScoreType>(area) < points_left)
+    {
+        Point p = m_stack.pop_back();
+        ++area;
+        for (Point adj : geo.get_adj(p))
+            if (! is_forbidden[adj] && ! m_marker.set(adj))
+                m_stack.push_back(adj);
+    }
+    features.attach = static_cast<Float>(attach);
+    features.area = static_cast<Float>(area);
+    features.points_left = static_cast<Float>(points_left);
+}
+
+Float StaticEvaluator::get_points(const Board& bd, Color c,
+                                  const Weights& weights)
+{
+    Features features;
+    get_features(bd, c, features);
+    return static_cast<Float>(bd.get_points(c))
+            + weights.cutoff_attach * features.attach
+            + weights.cutoff_area * features.area
+            + weights.cutoff_pieces_left * features.points_left;
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_mcts
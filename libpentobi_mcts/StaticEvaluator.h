@@ -0,0 +1,63 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_mcts/StaticEvaluator.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBPENTOBI_MCTS_STATIC_EVALUATOR_H
+#define LIBPENTOBI_MCTS_STATIC_EVALUATOR_H
+
+#include "Weights.h"
+#include "libpentobi_base/Board.h"
+#include "libpentobi_base/Marker.h"
+
+namespace libpentobi_mcts {
+
+using libpentobi_base::Board;
+using libpentobi_base::Color;
+using libpentobi_base::Marker;
+using libpentobi_base::PointList;
+
+//-----------------------------------------------------------------------------
+
+/** Fast static evaluation of a position used for the playout cutoff.
+    Estimates the final points of a color as its current points plus a linear
+    function of features that indicate how many of the points left in hand
+    can still be placed on the board. The weights of the features are in
+    Weights and can be learned with learn_tool. */
+class StaticEvaluator
+{
+public:
+    /** The features of a color.
+        See get_features() */
+    struct Features
+    {
+        /** Number of non-forbidden attach points, or starting points if
+            the color has not played a piece yet. */
+        Float attach;
+
+        /** Number of non-forbidden points reachable from the non-forbidden
+            attach points, at most points_left. */
+        Float area;
+
+        /** Score points of the pieces left. */
+        Float points_left;
+    };
+
+
+    void get_features(const Board& bd, Color c, Features& features);
+
+    /** Get the estimated final points of a color. */
+    Float get_points(const Board& bd, Color c, const Weights& weights);
+
+private:
+    Marker m_marker;
+
+    PointList m_stack;
+};
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_mcts
+
+#endif // LIBPENTOBI_MCTS_STATIC_EVALUATOR_H
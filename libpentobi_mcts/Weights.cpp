@@ -0,0 +1,476 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_mcts/Weights.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "Weights.h"
+
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+
+namespace libpentobi_mcts {
+
+using libpentobi_base::BoardType;
+using libpentobi_base::GeometryType;
+using libpentobi_base::PieceSet;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+void set_playout_local(Weights& w, initializer_list<float> gammas)
+{
+    unsigned i = 0;
+    for (auto gamma : gammas)
+        w.playout_local[i++] = gamma;
+    for ( ; i < w.playout_local.size(); ++i)
+        w.playout_local[i] = *(gammas.end() - 1);
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+template<class FUNCTION>
+void Weights::for_each_weight(FUNCTION f)
+{
+    f("temperature", temperature);
+    f("point_other", point_other);
+    f("point_opp_attach_or_nb", point_opp_attach_or_nb);
+    f("point_second_color_attach", point_second_color_attach);
+    f("adj_connect", adj_connect);
+    f("adj_occupied_other", adj_occupied_other);
+    f("adj_forbidden_other", adj_forbidden_other);
+    f("adj_own_attach", adj_own_attach);
+    f("adj_nonforbidden", adj_nonforbidden);
+    f("attach_to_play", attach_to_play);
+    f("attach_forbidden_other", attach_forbidden_other);
+    for (unsigned i = 0; i < attach_nonforbidden.size(); ++i)
+        f("attach_nonforbidden[" + to_string(i) + "]",
+          attach_nonforbidden[i]);
+    f("attach_second_color", attach_second_color);
+    f("local", local);
+    for (unsigned i = 0; i < piece_score.size(); ++i)
+        f("piece_score[" + to_string(i) + "]", piece_score[i]);
+    for (unsigned i = 0; i < playout_local.size(); ++i)
+        f("playout_local[" + to_string(i) + "]", playout_local[i]);
+    f("playout_size_factor", playout_size_factor);
+    f("playout_nu_attach_factor", playout_nu_attach_factor);
+    f("cutoff_depth", cutoff_depth);
+    f("cutoff_attach", cutoff_attach);
+    f("cutoff_area", cutoff_area);
+    f("cutoff_pieces_left", cutoff_pieces_left);
+    f("cutoff_sigma", cutoff_sigma);
+}
+
+Weights Weights::get_default(Variant variant)
+{
+    Weights w;
+    w.variant = variant;
+    auto piece_set = get_piece_set(variant);
+    auto geometry_type = get_geometry_type(variant);
+
+    // Move prior weights. The values are learned using
+    // pentobi/src/learn_tool.
+    if (variant == Variant::duo || variant == Variant::junior)
+    {
+        w.temperature = 0.84f;
+        // Tuned for duo
+        w.point_other = 0.394f;
+        w.point_opp_attach_or_nb = 1.399f;
+        w.point_second_color_attach = 0; // unused
+        w.adj_connect = 0; // unused
+        w.adj_occupied_other = 0.359f;
+        w.adj_forbidden_other = 0.404f;
+        w.adj_own_attach = -1.164f;
+        w.adj_nonforbidden = -0.461f;
+        w.attach_to_play = -0.082f;
+        w.attach_forbidden_other = -0.305f;
+        w.attach_nonforbidden[0] = -0.200f;
+        w.attach_nonforbidden[1] = -0.116f;
+        w.attach_nonforbidden[2] = 0.331f;
+        w.attach_nonforbidden[3] = 0.588f;
+        w.attach_nonforbidden[4] = 0.923f;
+        w.attach_nonforbidden[5] = 0; // unused
+        w.attach_nonforbidden[6] = 0; // unused
+        w.attach_second_color = 0; // unused
+        w.local = 0.336f;
+        w.piece_score[0] = 0; // unused
+        w.piece_score[1] = 0.330f;
+        w.piece_score[2] = -0.402f;
+        w.piece_score[3] = -0.845f;
+        w.piece_score[4] = -0.245f;
+        w.piece_score[5] = 1.149f;
+        w.piece_score[6] = 0; // unused
+    }
+    else if (variant == Variant::callisto_2)
+    {
+        w.temperature = 0.84f;
+        w.point_other = 0.305f;
+        w.point_opp_attach_or_nb = 2.047f;
+        w.point_second_color_attach = 0; // unused
+        w.adj_connect = -0.022f;
+        w.adj_occupied_other = -0.049f;
+        w.adj_forbidden_other = 0; // unused
+        w.adj_own_attach = -0.631f;
+        w.adj_nonforbidden = 0.221f;
+        w.attach_to_play = -0.273f;
+        w.attach_forbidden_other = -0.597f;
+        w.attach_nonforbidden[0] = 0; // unused
+        w.attach_nonforbidden[1] = -0.070f;
+        w.attach_nonforbidden[2] = 0.140f;
+        w.attach_nonforbidden[3] = 0.075f;
+        w.attach_nonforbidden[4] = 0.199f;
+        w.attach_nonforbidden[5] = 0; // unused
+        w.attach_nonforbidden[6] = 0; // unused
+        w.attach_second_color = 0; // unused
+        w.local = 0.203f;
+        w.piece_score[0] = 0.942f;
+        w.piece_score[1] = 0; // unused
+        w.piece_score[2] = -1.642f;
+        w.piece_score[3] = -0.800f;
+        w.piece_score[4] = 0.436f;
+        w.piece_score[5] = 1.082f;
+        w.piece_score[6] = 0; // unused
+    }
+    else if (variant == Variant::gembloq_2)
+    {
+        w.temperature = 0.84f;
+        w.point_other = 0.120f;
+        w.point_opp_attach_or_nb = 0.315f;
+        w.point_second_color_attach = 0; // unused
+        w.adj_connect = 0; // unused
+        w.adj_occupied_other = 0.350f;
+        w.adj_forbidden_other = 0.511f;
+        w.adj_own_attach = 0.285f;
+        w.adj_nonforbidden = 0.095f;
+        w.attach_to_play = 0.181f;
+        w.attach_forbidden_other = -0.127f;
+        w.attach_nonforbidden[0] = -0.165f;
+        w.attach_nonforbidden[1] = -0.031f;
+        w.attach_nonforbidden[2] = -0.058f;
+        w.attach_nonforbidden[3] = -0.057f;
+        w.attach_nonforbidden[4] = 0; // unused
+        w.attach_nonforbidden[5] = 0; // unused
+        w.attach_nonforbidden[6] = 0; // unused
+        w.attach_second_color = 0; // unused
+        w.local = 1.109f;
+        w.piece_score[0] = 0; // unused
+        w.piece_score[1] = -0.468f;
+        w.piece_score[2] = -0.647f;
+        w.piece_score[3] = -0.386f;
+        w.piece_score[4] = 0.250f;
+        w.piece_score[5] = 1.283f;
+        w.piece_score[6] = 0; // unused
+    }
+    else if (piece_set == PieceSet::trigon)
+    {
+        w.temperature = 0.84f;
+        // Tuned for trigon_2
+        w.point_other = 0.182f;
+        w.point_opp_attach_or_nb = 0.828f;
+        w.point_second_color_attach = 0.016f;
+        w.adj_connect = 1.032f;
+        w.adj_occupied_other = 1.024f;
+        w.adj_forbidden_other = 0.671f;
+        w.adj_own_attach = 0.193f;
+        w.adj_nonforbidden = -0.155f;
+        w.attach_to_play = -0.153f;
+        w.attach_forbidden_other = -0.382f;
+        w.attach_nonforbidden[0] = -0.220f;
+        w.attach_nonforbidden[1] = -0.263f;
+        w.attach_nonforbidden[2] = -0.155f;
+        w.attach_nonforbidden[3] = 0.059f;
+        w.attach_nonforbidden[4] = 0; // unused
+        w.attach_nonforbidden[5] = 0; // unused
+        w.attach_nonforbidden[6] = 0; // unused
+        w.attach_second_color = -0.051f;
+        w.local = 0.536f;
+        w.piece_score[0] = 0; // unused
+        w.piece_score[1] = 0.453f;
+        w.piece_score[2] = 0.083f;
+        w.piece_score[3] = -0.620f;
+        w.piece_score[4] = -0.687f;
+        w.piece_score[5] = -0.373f;
+        w.piece_score[6] = 1.153f;
+    }
+    else if (piece_set == PieceSet::nexos)
+    {
+        w.temperature = 0.84f;
+        // Tuned for nexos_2
+        w.point_other = 0.601f;
+        w.point_opp_attach_or_nb = 1.525f;
+        w.point_second_color_attach = 0.112f;
+        w.adj_connect = 0.026f;
+        w.adj_occupied_other = 0.002f;
+        w.adj_forbidden_other = 0; // unused
+        w.adj_own_attach = -0.251f;
+        w.adj_nonforbidden = 0.036f;
+        w.attach_to_play = 0.021f;
+        w.attach_forbidden_other = -0.037f;
+        w.attach_nonforbidden[0] = 0; // unused
+        w.attach_nonforbidden[1] = 0.074f;
+        w.attach_nonforbidden[2] = -0.104f;
+        w.attach_nonforbidden[3] = -0.067f;
+        w.attach_nonforbidden[4] = -0.113f;
+        w.attach_nonforbidden[5] = -0.035f;
+        w.attach_nonforbidden[6] = 0.127f;
+        w.attach_second_color = 0.075f;
+        w.local = 1.101f;
+        w.piece_score[0] = 0; // unused
+        w.piece_score[1] = -0.167f;
+        w.piece_score[2] = -0.387f;
+        w.piece_score[3] = -0.306f;
+        w.piece_score[4] = 0.852f;
+        w.piece_score[5] = 0; // unused
+        w.piece_score[6] = 0; // unused
+    }
+    else if (geometry_type == GeometryType::callisto)
+    {
+        w.temperature = 0.84f;
+        // Tuned for callisto_2_4
+        w.point_other = 0.310f;
+        w.point_opp_attach_or_nb = 2.043f;
+        w.point_second_color_attach = -0.017f;
+        w.adj_connect = 0.189f;
+        w.adj_occupied_other = -0.033f;
+        w.adj_forbidden_other = 0; // unused
+        w.adj_own_attach = -0.500f;
+        w.adj_nonforbidden = 0.100f;
+        w.attach_to_play = -0.239f;
+        w.attach_forbidden_other = -0.545f;
+        w.attach_nonforbidden[0] = 0; // unused
+        w.attach_nonforbidden[1] = 0.152f;
+        w.attach_nonforbidden[2] = 0.159f;
+        w.attach_nonforbidden[3] = 0.104f;
+        w.attach_nonforbidden[4] = 0.122f;
+        w.attach_nonforbidden[5] = 0; // unused
+        w.attach_nonforbidden[6] = 0; // unused
+        w.attach_second_color = -0.107f;
+        w.local = 0.182f;
+        w.piece_score[0] = 0.823f;
+        w.piece_score[1] = 0; // unused
+        w.piece_score[2] = -1.507f;
+        w.piece_score[3] = -0.726f;
+        w.piece_score[4] = 0.436f;
+        w.piece_score[5] = 1.003f;
+        w.piece_score[6] = 0; // unused
+    }
+    else if (piece_set == PieceSet::gembloq)
+    {
+        w.temperature = 0.84f;
+        // Tuned for gembloq_2_4
+        w.point_other = 0.174f;
+        w.point_opp_attach_or_nb = 0.304f;
+        w.point_second_color_attach = 0.098f;
+        w.adj_connect = 0.296f;
+        w.adj_occupied_other = 0.314f;
+        w.adj_forbidden_other = 0.141f;
+        w.adj_own_attach = 0.138f;
+        w.adj_nonforbidden = -0.195f;
+        w.attach_to_play = 0.191f;
+        w.attach_forbidden_other = -0.129f;
+        w.attach_nonforbidden[0] = -0.123f;
+        w.attach_nonforbidden[1] = 0.104f;
+        w.attach_nonforbidden[2] = -0.005f;
+        w.attach_nonforbidden[3] = 0.045f;
+        w.attach_nonforbidden[4] = 0; // unused
+        w.attach_nonforbidden[5] = 0; // unused
+        w.attach_nonforbidden[6] = 0; // unused
+        w.attach_second_color = 0.128f;
+        w.local = 1.078f;
+        w.piece_score[0] = 0; // unused
+        w.piece_score[1] = -0.094f;
+        w.piece_score[2] = -0.563f;
+        w.piece_score[3] = -0.661f;
+        w.piece_score[4] = -0.021f;
+        w.piece_score[5] = 1.349f;
+        w.piece_score[6] = 0; // unused
+    }
+    else
+    {
+        // Tuned for classic_2
+        w.temperature = 0.84f;
+        w.point_other = 0.137f;
+        w.point_opp_attach_or_nb = 0.898f;
+        w.point_second_color_attach = -0.248f;
+        w.adj_connect = 0.616f;
+        w.adj_occupied_other = 0.568f;
+        w.adj_forbidden_other = 0.544f;
+        w.adj_own_attach = -0.849f;
+        w.adj_nonforbidden = -0.115f;
+        w.attach_to_play = 0.007f;
+        w.attach_forbidden_other = -0.439f;
+        w.attach_nonforbidden[0] = -0.177f;
+        w.attach_nonforbidden[1] = -0.002f;
+        w.attach_nonforbidden[2] = 0.232f;
+        w.attach_nonforbidden[3] = 0.342f;
+        w.attach_nonforbidden[4] = 0.694f;
+        w.attach_nonforbidden[5] = 0; // unused
+        w.attach_nonforbidden[6] = 0; // unused
+        w.attach_second_color = -0.011f;
+        w.local = 0.610f;
+        w.piece_score[0] = 0; // unused
+        w.piece_score[1] = 0.476f;
+        w.piece_score[2] = -0.316f;
+        w.piece_score[3] = -0.842f;
+        w.piece_score[4] = -0.301f;
+        w.piece_score[5] = 0.969f;
+        w.piece_score[6] = 0; // unused
+    }
+
+    // Playout gammas
+    if (piece_set == PieceSet::gembloq)
+    {
+        static_assert(PlayoutFeatures::max_local + 1 >= 20);
+        set_playout_local(w, { 1, 1e6f, 1e6f, 1e6f, 1e6f, 1e6f, 1e6f, 1e6f,
+                               1e12f, 1e12f, 1e12f, 1e12f,
+                               1e18f, 1e18f, 1e18f, 1e18f,
+                               1e24f, 1e24f, 1e24f, 1e24f, 1e25f });
+    }
+    else if (piece_set == PieceSet::trigon)
+        set_playout_local(w, { 1, 1e6f, 1e12f, 1e18f, 1e24f, 1e30f });
+    else if (piece_set == PieceSet::nexos)
+        set_playout_local(w, { 1, 1e6f, 1e12f, 1e18f, 1e24f });
+    else
+        set_playout_local(w, { 1, 1e6f, 1e12f, 1e18f, 1e24f, 1e25f });
+    w.playout_size_factor = 1;
+    w.playout_nu_attach_factor = 1;
+    switch (get_board_type(variant))
+    {
+    case BoardType::classic:
+        w.playout_size_factor = 5;
+        break;
+    case BoardType::duo:
+        w.playout_size_factor = 3;
+        w.playout_nu_attach_factor = 1.8f;
+        break;
+    case BoardType::trigon:
+    case BoardType::trigon_3: // Not tuned
+        w.playout_size_factor = 5;
+        break;
+    case BoardType::nexos: // Not tuned
+        w.playout_size_factor = 5;
+        w.playout_nu_attach_factor = 1.8f;
+        break;
+    case BoardType::callisto_2:
+    case BoardType::callisto: // Not tuned
+    case BoardType::callisto_3: // Not tuned
+        w.playout_size_factor = 12;
+        w.playout_nu_attach_factor = 1.8f;
+        break;
+    case BoardType::gembloq_2:
+    case BoardType::gembloq: // Not tuned
+    case BoardType::gembloq_3: // Not tuned
+        w.playout_size_factor = 1.5f;
+        break;
+    }
+
+    // Playout cutoff. Disabled by default because it did not clearly improve
+    // the playing strength in self-play tests in classic_2. The evaluator
+    // weights are learned with learn_tool --evaluator from games played at
+    // level 2.
+    w.cutoff_depth = 0;
+    if (piece_set == PieceSet::trigon)
+    {
+        // Tuned for trigon_2
+        w.cutoff_attach = -0.208f;
+        w.cutoff_area = 1.346f;
+        w.cutoff_pieces_left = -0.433f;
+        w.cutoff_sigma = 9.039f;
+    }
+    else if (piece_set == PieceSet::nexos)
+    {
+        // Tuned for nexos_2
+        w.cutoff_attach = 0.221f;
+        w.cutoff_area = -0.459f;
+        w.cutoff_pieces_left = 0.871f;
+        w.cutoff_sigma = 8.461f;
+    }
+    else
+    {
+        // Tuned for classic_2, not tuned for the other piece sets
+        w.cutoff_attach = -0.406f;
+        w.cutoff_area = 0.846f;
+        w.cutoff_pieces_left = -0.023f;
+        w.cutoff_sigma = 6.820f;
+    }
+    return w;
+}
+
+Float Weights::get_gamma(Float weight) const
+{
+    return exp(weight / temperature);
+}
+
+Weights Weights::read(istream& in, Variant variant)
+{
+    map<string, string> entries;
+    string line;
+    unsigned line_nu = 0;
+    while (getline(in, line))
+    {
+        ++line_nu;
+        istringstream is(line);
+        string name;
+        string value;
+        if (! (is >> name) || name[0] == '#')
+            continue;
+        if (! (is >> value))
+            throw ReadError("Missing value in line " + to_string(line_nu));
+        if (entries.count(name) != 0)
+            throw ReadError("Duplicate weight " + name);
+        entries[name] = value;
+    }
+    auto pos = entries.find("variant");
+    if (pos != entries.end())
+    {
+        if (! parse_variant_id(pos->second, variant))
+            throw ReadError("Unknown game variant " + pos->second);
+        entries.erase(pos);
+    }
+    auto w = get_default(variant);
+    w.for_each_weight([&](const string& name, auto& value) {
+        auto pos = entries.find(name);
+        if (pos == entries.end())
+            return;
+        istringstream is(pos->second);
+        if (! (is >> value))
+            throw ReadError("Invalid value for weight " + name);
+        entries.erase(pos);
+    });
+    if (! entries.empty())
+        throw ReadError("Unknown weight " + entries.begin()->first);
+    if (w.temperature <= 0)
+        throw ReadError("Temperature must be positive");
+    if (w.cutoff_sigma <= 0)
+        throw ReadError("Cutoff sigma must be positive");
+    return w;
+}
+
+Weights Weights::read(const string& file, Variant variant)
+{
+    ifstream in(file);
+    if (! in)
+        throw ReadError("Could not open " + file);
+    return read(in, variant);
+}
+
+void Weights::write(ostream& out) const
+{
+    auto w = *this;
+    auto precision = out.precision(numeric_limits<Float>::max_digits10);
+    out << "variant " << to_string_id(variant) << '\n';
+    w.for_each_weight([&](const string& name, auto& value) {
+        out << name << ' ' << value << '\n';
+    });
+    out.precision(precision);
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_mcts
@@ -0,0 +1,158 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_mcts/Weights.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBPENTOBI_MCTS_WEIGHTS_H
+#define LIBPENTOBI_MCTS_WEIGHTS_H
+
+#include <iosfwd>
+#include <stdexcept>
+#include "Float.h"
+#include "PlayoutFeatures.h"
+
+namespace libpentobi_mcts {
+
+using namespace std;
+using libpentobi_base::Variant;
+
+//-----------------------------------------------------------------------------
+
+/** Weights of the move features used by PriorKnowledge and by the playout
+    policy of State.
+    Each game variant has built-in default weights. Other weights can be
+    loaded at runtime from a text file to allow tuning without recompiling.
+
+    The file format has one weight per line consisting of a name and a value
+    separated by whitespace. Empty lines and lines starting with '#' are
+    ignored. Weights that do not occur in the file keep their default value.
+    The optional entry "variant" contains the game variant as returned by
+    libpentobi_base::to_string_id().
+
+    The weights for the move priors are in the form written by learn_tool,
+    the gamma value of a feature is exp(weight / temperature). The playout
+    weights are stored as gamma values. The weights of the static evaluator
+    for the playout cutoff can be learned with learn_tool --evaluator. */
+class Weights
+{
+public:
+    class ReadError
+        : public runtime_error
+    {
+        using runtime_error::runtime_error;
+    };
+
+
+    Variant variant;
+
+    /** @name Move prior weights
+        See the corresponding members PriorKnowledge::m_gamma_... */
+    /** @{ */
+
+    Float temperature;
+
+    Float point_other;
+
+    Float point_opp_attach_or_nb;
+
+    Float point_second_color_attach;
+
+    Float adj_connect;
+
+    Float adj_occupied_other;
+
+    Float adj_forbidden_other;
+
+    Float adj_own_attach;
+
+    Float adj_nonforbidden;
+
+    Float attach_to_play;
+
+    Float attach_forbidden_other;
+
+    array<Float, 7> attach_nonforbidden;
+
+    Float attach_second_color;
+
+    Float local;
+
+    /** Weight depending on the number of score points of a piece. */
+    array<Float, 7> piece_score;
+
+    /** @} */ // @name
+
+
+    /** @name Playout gammas
+        See State::init_gamma() */
+    /** @{ */
+
+    /** Gamma depending on PlayoutFeatures::Compute::get_nu_local(). */
+    array<float, PlayoutFeatures::max_local + 1> playout_local;
+
+    /** Factor for the gamma of a piece per score point. */
+    float playout_size_factor;
+
+    /** Factor for the gamma of a piece per attach point. */
+    float playout_nu_attach_factor;
+
+    /** @} */ // @name
+
+
+    /** @name Playout cutoff
+        See StaticEvaluator */
+    /** @{ */
+
+    /** Number of moves after the in-tree phase after which a playout is
+        stopped and evaluated with StaticEvaluator.
+        0 means that playouts are always played until the end of the game. */
+    unsigned cutoff_depth;
+
+    /** Estimated final points per non-forbidden attach point. */
+    Float cutoff_attach;
+
+    /** Estimated final points per reachable point. */
+    Float cutoff_area;
+
+    /** Estimated final points per score point of the pieces left. */
+    Float cutoff_pieces_left;
+
+    /** Standard deviation of the error of the estimated final points of a
+        color. */
+    Float cutoff_sigma;
+
+    /** @} */ // @name
+
+
+    /** Get the built-in default weights for a game variant. */
+    static Weights get_default(Variant variant);
+
+    /** Read weights from a stream.
+        @param in
+        @param variant The game variant to use if the file has no variant
+        entry.
+        @throws ReadError */
+    static Weights read(istream& in, Variant variant);
+
+    /** Read weights from a file.
+        @throws ReadError */
+    static Weights read(const string& file, Variant variant);
+
+    /** Write the weights in the format expected by read(). */
+    void write(ostream& out) const;
+
+    /** Get the gamma value of a move prior weight. */
+    Float get_gamma(Float weight) const;
+
+private:
+    /** Call a function with the name and a reference to each weight. */
+    template<class FUNCTION>
+    void for_each_weight(FUNCTION f);
+};
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_mcts
+
+#endif // LIBPENTOBI_MCTS_WEIGHTS_H
@@ -0,0 +1,124 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_mcts/tests/EndgameSolverTest.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "libpentobi_mcts/EndgameSolver.h"
+
+#include "libboardgame_base/CpuTimeSource.h"
+#include "libboardgame_test/Test.h"
+
+using namespace std;
+using namespace libpentobi_mcts;
+using libboardgame_base::CpuTimeSource;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+/** Plain minimax search without pruning for comparison. */
+ScoreType minimax(const Board& bd, Color c, bool is_pass)
+{
+    auto marker = make_unique<MoveMarker>();
+    auto moves = make_unique<MoveList>();
+    bd.gen_moves(c, *marker, *moves);
+    if (moves->empty())
+    {
+        if (is_pass)
+            return bd.get_score_twocolor(c);
+        return -minimax(bd, bd.get_next(c), true);
+    }
+    auto result = -numeric_limits<ScoreType>::max();
+    auto child = make_unique<Board>(bd.get_variant());
+    for (Move mv : *moves)
+    {
+        child->copy_from(bd);
+        child->play(c, mv);
+        result = max(result, -minimax(*child, bd.get_next(c), false));
+    }
+    return result;
+}
+
+/** Play the first generated legal move until the number of legal moves
+    of both colors is at most max_legal_moves. */
+void play_until(Board& bd, EndgameSolver& solver, unsigned max_legal_moves)
+{
+    auto marker = make_unique<MoveMarker>();
+    auto moves = make_unique<MoveList>();
+    while (solver.get_nu_legal_moves(bd) > max_legal_moves)
+    {
+        auto c = bd.get_effective_to_play();
+        bd.gen_moves(c, *marker, *moves);
+        marker->clear(*moves);
+        bd.play(c, (*moves)[0]);
+    }
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+/** Compare the score of the solver with a plain minimax search in small
+    endgame positions. */
+LIBBOARDGAME_TEST_CASE(pentobi_mcts_endgame_solver_score)
+{
+    EndgameSolver solver;
+    auto bd = make_unique<Board>(Variant::duo);
+    play_until(*bd, solver, 12);
+    while (! bd->is_game_over())
+    {
+        auto c = bd->get_effective_to_play();
+        Move mv;
+        ScoreType score;
+        LIBBOARDGAME_CHECK(solver.solve(*bd, c, mv, score));
+        LIBBOARDGAME_CHECK_EQUAL(score, minimax(*bd, c, false));
+        LIBBOARDGAME_CHECK(bd->is_legal(c, mv));
+        bd->play(c, mv);
+        LIBBOARDGAME_CHECK_EQUAL(-score,
+                                 minimax(*bd, bd->get_next(c), false));
+    }
+}
+
+/** Test that the solver gives up if the maximum number of nodes is
+    exceeded. */
+LIBBOARDGAME_TEST_CASE(pentobi_mcts_endgame_solver_max_nodes)
+{
+    EndgameSolver solver;
+    auto bd = make_unique<Board>(Variant::duo);
+    play_until(*bd, solver, 60);
+    Move mv;
+    ScoreType score;
+    CpuTimeSource time_source;
+    LIBBOARDGAME_CHECK(! solver.solve(*bd, bd->get_effective_to_play(), mv,
+                                      score, 10, 0, time_source));
+    solver.set_max_nodes(10);
+    LIBBOARDGAME_CHECK(! solver.solve(*bd, bd->get_effective_to_play(), mv,
+                                      score));
+}
+
+/** Test that the solver gives up if the abort check returns true. */
+LIBBOARDGAME_TEST_CASE(pentobi_mcts_endgame_solver_abort)
+{
+    EndgameSolver solver;
+    auto bd = make_unique<Board>(Variant::duo);
+    play_until(*bd, solver, 60);
+    Move mv;
+    ScoreType score;
+    CpuTimeSource time_source;
+    LIBBOARDGAME_CHECK(! solver.solve(*bd, bd->get_effective_to_play(), mv,
+                                      score, 1000000, 0, time_source,
+                                      [] { return true; }));
+    LIBBOARDGAME_CHECK_EQUAL(solver.get_nu_nodes(), 1u);
+}
+
+/** Test that game variants with more than two colors are not supported. */
+LIBBOARDGAME_TEST_CASE(pentobi_mcts_endgame_solver_supported)
+{
+    LIBBOARDGAME_CHECK(EndgameSolver::is_supported(Variant::duo));
+    LIBBOARDGAME_CHECK(EndgameSolver::is_supported(Variant::junior));
+    LIBBOARDGAME_CHECK(! EndgameSolver::is_supported(Variant::classic));
+    LIBBOARDGAME_CHECK(! EndgameSolver::is_supported(Variant::classic_2));
+}
+
+//-----------------------------------------------------------------------------
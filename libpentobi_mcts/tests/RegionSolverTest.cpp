@@ -0,0 +1,108 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_mcts/tests/RegionSolverTest.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "libpentobi_mcts/RegionSolver.h"
+
+#include "libpentobi_base/MoveMarker.h"
+#include "libboardgame_test/Test.h"
+
+using namespace std;
+using namespace libpentobi_mcts;
+using libpentobi_base::Move;
+using libpentobi_base::MoveList;
+using libpentobi_base::MoveMarker;
+using libpentobi_base::Variant;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+/** Maximum final points of a color by trying all move sequences of the
+    color for comparison. */
+ScoreType get_max_points(const Board& bd, Color c)
+{
+    auto marker = make_unique<MoveMarker>();
+    auto moves = make_unique<MoveList>();
+    bd.gen_moves(c, *marker, *moves);
+    auto result = bd.get_points(c);
+    auto child = make_unique<Board>(bd.get_variant());
+    for (Move mv : *moves)
+    {
+        child->copy_from(bd);
+        child->play(c, mv);
+        result = max(result, get_max_points(*child, c));
+    }
+    return result;
+}
+
+/** Check if all legal moves of a color are in independent regions and the
+    independent regions have at most max_points points. */
+bool is_small_independent(const Board& bd, Color c,
+                          const RegionAnalysis& analysis, unsigned max_points)
+{
+    unsigned nu_points = 0;
+    for (auto& region : analysis.get_regions(c))
+        if (region.is_independent)
+            nu_points += region.end - region.begin;
+    if (nu_points > max_points)
+        return false;
+    auto marker = make_unique<MoveMarker>();
+    auto moves = make_unique<MoveList>();
+    bd.gen_moves(c, *marker, *moves);
+    for (Move mv : *moves)
+        if (! analysis.is_independent(*bd.get_move_points(mv).begin(), c))
+            return false;
+    return true;
+}
+
+/** Play games and compare the solver with get_max_points() for colors with
+    small independent regions.
+    @return The number of comparisons. */
+unsigned check_variant(Variant variant)
+{
+    RegionSolver solver;
+    solver.set_max_nodes(1000000);
+    RegionAnalysis analysis;
+    auto marker = make_unique<MoveMarker>();
+    auto moves = make_unique<MoveList>();
+    unsigned nu_checked = 0;
+    for (unsigned n = 1; n <= 5; ++n)
+    {
+        auto bd = make_unique<Board>(variant);
+        for (unsigned i = 0; ! bd->is_game_over(); ++i)
+        {
+            analysis.init(*bd);
+            for (Color c : bd->get_colors())
+            {
+                if (! is_small_independent(*bd, c, analysis, 12))
+                    continue;
+                ScoreType points;
+                LIBBOARDGAME_CHECK(solver.solve(*bd, c, analysis, points));
+                LIBBOARDGAME_CHECK_EQUAL(bd->get_points(c) + points,
+                                         get_max_points(*bd, c));
+                ++nu_checked;
+            }
+            auto c = bd->get_effective_to_play();
+            bd->gen_moves(c, *marker, *moves);
+            marker->clear(*moves);
+            bd->play(c, (*moves)[(n * i) % moves->size()]);
+        }
+    }
+    return nu_checked;
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+LIBBOARDGAME_TEST_CASE(pentobi_mcts_region_solver)
+{
+    LIBBOARDGAME_CHECK(check_variant(Variant::duo) > 0);
+    LIBBOARDGAME_CHECK(check_variant(Variant::junior) > 0);
+    LIBBOARDGAME_CHECK(check_variant(Variant::classic_2) > 0);
+}
+
+//-----------------------------------------------------------------------------
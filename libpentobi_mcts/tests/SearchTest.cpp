@@ -65,6 +65,79 @@ LIBBOARDGAME_TEST_CASE(pentobi_mcts_search_no_large_pieces)
     LIBBOARDGAME_CHECK(! mv.is_null());
 }
 
+/** Test that a subtree of an older search tree is reused from the tree cache.
+    Searches a position, then a position in a different variation, then a
+    follow-up position of the first position. */
+LIBBOARDGAME_TEST_CASE(pentobi_mcts_search_tree_cache)
+{
+    auto bd = make_unique<Board>(Variant::duo);
+    unsigned nu_threads = 1;
+    size_t memory = 40000000;
+    auto search = make_unique<Search>(bd->get_variant(), nu_threads, memory);
+    // Reusing trees between colors is not possible with symmetric draw
+    // avoidance in Duo
+    search->set_avoid_symmetric_draw(false);
+    Float max_count = 2000;
+    // Don't abort early if the best move cannot change anymore, which
+    // depends on timing
+    size_t min_simulations = 2000;
+    double max_time = 0;
+    CpuTimeSource time_source;
+    Move mv;
+    LIBBOARDGAME_CHECK(search->search(mv, *bd, Color(0), max_count,
+                                      min_simulations, max_time, time_source));
+    LIBBOARDGAME_CHECK_EQUAL(search->get_nu_simulations(), size_t(2000));
+    Move mv_other;
+    for (auto& i : search->get_tree().get_root_children())
+        if (i.get_move() != mv)
+        {
+            mv_other = i.get_move();
+            break;
+        }
+    auto bd_other = make_unique<Board>(Variant::duo);
+    bd_other->play(Color(0), mv_other);
+    Move mv2;
+    LIBBOARDGAME_CHECK(search->search(mv2, *bd_other, Color(1), max_count,
+                                      min_simulations, max_time, time_source));
+    LIBBOARDGAME_CHECK_EQUAL(search->get_nu_simulations(), size_t(2000));
+    // The subtree of the best move of the first search has many more
+    // visits than this maximum count, so no simulations are needed if it is
+    // reused
+    bd->play(Color(0), mv);
+    max_count = 100;
+    min_simulations = 0;
+    LIBBOARDGAME_CHECK(search->search(mv2, *bd, Color(1), max_count,
+                                      min_simulations, max_time, time_source));
+    LIBBOARDGAME_CHECK_EQUAL(search->get_nu_simulations(), size_t(0));
+}
+
+/** Test a search that stops the playouts with the playout cutoff.
+    Uses a variant with more than 2 players, which has its own evaluation of
+    cut-off playouts. */
+LIBBOARDGAME_TEST_CASE(pentobi_mcts_search_playout_cutoff)
+{
+    auto bd = make_unique<Board>(Variant::classic);
+    unsigned nu_threads = 1;
+    size_t memory = 1000000;
+    auto search = make_unique<Search>(bd->get_variant(), nu_threads, memory);
+    auto weights = Weights::get_default(Variant::classic);
+    weights.cutoff_depth = 4;
+    weights.cutoff_attach = 0.5;
+    weights.cutoff_area = 0.1f;
+    weights.cutoff_pieces_left = 0.7f;
+    weights.cutoff_sigma = 7;
+    search->set_weights(weights);
+    Float max_count = 500;
+    size_t min_simulations = 1;
+    double max_time = 0;
+    CpuTimeSource time_source;
+    Move mv;
+    LIBBOARDGAME_CHECK(search->search(mv, *bd, Color(0), max_count,
+                                      min_simulations, max_time, time_source));
+    LIBBOARDGAME_CHECK(! mv.is_null());
+    LIBBOARDGAME_CHECK(bd->is_legal(Color(0), mv));
+}
+
 /** Test that useless one-piece moves are generated if no other moves exist.
     Useless one-piece moves (all neighbors occupied) are not needed during
     the search, but the search should still return one if no other legal
@@ -106,4 +179,66 @@ LIBBOARDGAME_TEST_CASE(pentobi_mcts_search_callisto_useless_one_piece)
     LIBBOARDGAME_CHECK(bd->get_move_piece(mv) == bd->get_one_piece());
 }
 
+/** Test a playout with the solving of independent regions.
+    In the final position, all legal moves of both colors are in independent
+    regions. Blue (to play) is behind by 5 points on the board, can gain 8
+    points and Orange 13 points, so Blue loses by 10 points. The search
+    starts at move 18 such that the early termination of playouts is checked,
+    which would evaluate the playout as a win for Blue if Blue passes after
+    its regions were solved. */
+LIBBOARDGAME_TEST_CASE(pentobi_mcts_search_solve_regions)
+{
+    istringstream
+        in(R"delim(
+           (;GM[Blokus Duo];B[e10,e11,e12,f12,g12];W[j4,h5,i5,j5,h6]
+           ;B[a13,b13,c13,d13,b14];W[k6,l6,k7,k8,l8];B[g8,g9,h9,h10,h11]
+           ;W[c4,d4,e4,f4,g4];B[d6,f6,d7,e7,f7];W[h2,i2,j2,k2,h3]
+           ;B[h13,i13,g14,h14,i14];W[e1,f1,g1,e2,f2];B[a9,b9,c9,d9,a10]
+           ;W[m2,n2,l3,m3,m4];B[j10,j11,k11,l11,j12];W[b5,b6,a7,b7,b8]
+           ;B[i6,h7,i7,j7,i8];W[m9,m10,m11,n11,n12];B[m12,l13,m13,k14,l14]
+           ;W[k12,l12,j13,k13,j14];B[b11,c11];W[a1,b1,c1,b2,b3];B[c5]
+           ;W[n5,n6,n7,n8];B[a2,a3,a4,b4];W[i10,i11,h12,i12];B[c3,d3,e3,f3,g3]
+           ;W[f13,g13,e14,f14];B[i3,j3,h4,i4];W[f10,g10,f11,g11])
+           )delim");
+    TreeReader reader;
+    reader.read(in);
+    unique_ptr<SgfNode> root = reader.get_tree_transfer_ownership();
+    PentobiTree tree(root);
+    auto bd_final = make_unique<Board>(tree.get_variant());
+    BoardUpdater updater;
+    updater.update(*bd_final, tree, get_last_node(tree.get_root()));
+    auto bd = make_unique<Board>(tree.get_variant());
+    unsigned nu_start_moves = 18;
+    for (unsigned i = 0; i < nu_start_moves; ++i)
+        bd->play(bd_final->get_move(i));
+    unsigned nu_threads = 1;
+    size_t memory = 10000;
+    auto search = make_unique<Search>(bd->get_variant(), nu_threads, memory);
+    search->set_solve_regions(true);
+    Float max_count = 1;
+    size_t min_simulations = 1;
+    double max_time = 0;
+    CpuTimeSource time_source;
+    Move mv;
+    LIBBOARDGAME_CHECK(search->search(mv, *bd, Color(0), max_count,
+                                      min_simulations, max_time, time_source));
+    // Continue with a simulation of the search that follows the game in the
+    // in-tree phase
+    auto& state = search->get_state(0);
+    state.start_simulation(0);
+    for (unsigned i = nu_start_moves; i < bd_final->get_nu_moves(); ++i)
+        state.play_in_tree(bd_final->get_move(i).move);
+    state.finish_in_tree();
+    auto lgr = make_unique<State::LastGoodReply>();
+    lgr->init(2);
+    State::PlayerMove player_move;
+    // Both colors pass after their regions were solved
+    LIBBOARDGAME_CHECK(! state.gen_playout_move(*lgr, Move::null(),
+                                                Move::null(), player_move));
+    array<Float, 6> result;
+    state.evaluate_playout(result);
+    LIBBOARDGAME_CHECK(result[0] < 0.5f);
+    LIBBOARDGAME_CHECK(result[1] > 0.5f);
+}
+
 //-----------------------------------------------------------------------------
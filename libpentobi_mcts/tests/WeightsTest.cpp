@@ -0,0 +1,58 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_mcts/tests/WeightsTest.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "libpentobi_mcts/Weights.h"
+
+#include <sstream>
+#include "libboardgame_test/Test.h"
+
+using namespace std;
+using namespace libpentobi_mcts;
+
+//-----------------------------------------------------------------------------
+
+/** Test that weights are unchanged after writing and reading them. */
+LIBBOARDGAME_TEST_CASE(pentobi_mcts_weights_write_read)
+{
+    auto w = Weights::get_default(Variant::trigon_2);
+    w.local = 0.123f;
+    w.playout_local[2] = 1e13f;
+    ostringstream out;
+    w.write(out);
+    istringstream in(out.str());
+    auto w2 = Weights::read(in, Variant::duo);
+    LIBBOARDGAME_CHECK(w2.variant == Variant::trigon_2);
+    LIBBOARDGAME_CHECK_EQUAL(w2.local, w.local);
+    LIBBOARDGAME_CHECK_EQUAL(w2.point_other, w.point_other);
+    LIBBOARDGAME_CHECK_EQUAL(w2.piece_score[5], w.piece_score[5]);
+    LIBBOARDGAME_CHECK_EQUAL(w2.playout_local[2], w.playout_local[2]);
+    LIBBOARDGAME_CHECK_EQUAL(w2.playout_size_factor, w.playout_size_factor);
+}
+
+/** Test that missing entries keep their default values. */
+LIBBOARDGAME_TEST_CASE(pentobi_mcts_weights_read_partial)
+{
+    istringstream in("# Comment\n"
+                     "\n"
+                     "local 0.5\n"
+                     "playout_size_factor 2\n");
+    auto w = Weights::read(in, Variant::duo);
+    auto w_default = Weights::get_default(Variant::duo);
+    LIBBOARDGAME_CHECK(w.variant == Variant::duo);
+    LIBBOARDGAME_CHECK_EQUAL(w.local, Float(0.5));
+    LIBBOARDGAME_CHECK_EQUAL(w.playout_size_factor, 2.f);
+    LIBBOARDGAME_CHECK_EQUAL(w.adj_own_attach, w_default.adj_own_attach);
+    LIBBOARDGAME_CHECK_EQUAL(w.playout_local[1], w_default.playout_local[1]);
+}
+
+LIBBOARDGAME_TEST_CASE(pentobi_mcts_weights_read_unknown)
+{
+    istringstream in("no_such_weight 1\n");
+    LIBBOARDGAME_CHECK_THROW(Weights::read(in, Variant::duo),
+                             Weights::ReadError);
+}
+
+//-----------------------------------------------------------------------------
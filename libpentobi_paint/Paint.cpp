@@ -334,6 +334,127 @@ void paintBoardTrigon(QPainter& painter, qreal width, qreal height,
                                    gridHeight, dark, light);
 }
 
+void getPieceColors(Variant variant, ColorMap<QColor>& base,
+                    ColorMap<QColor>& light, ColorMap<QColor>& dark)
+{
+    array<QColor, 3> blue{ {
+        QColor(0, 115, 207), QColor(20, 153, 255), QColor(0, 72, 129)} };
+    array<QColor, 3> green{ {
+        QColor(0, 192, 0), QColor(0, 250, 0), QColor(0, 120, 0)} };
+    array<QColor, 3> orange{ {
+        QColor(240, 146, 23), QColor(255, 187, 103), QColor(157, 94, 11)} };
+    array<QColor, 3> purple{ {
+        QColor(161, 44, 207), QColor(190, 112, 220), QColor(109, 39, 135)} };
+    array<QColor, 3> red{ {
+        QColor(230, 62, 44), QColor(255, 101, 90), QColor(144, 38, 27)} };
+    array<QColor, 3> yellow{ {
+        QColor(245, 195, 32), QColor(255, 219, 88), QColor(170, 133, 22)} };
+    if (variant == Variant::duo)
+    {
+        base[Color(0)] = purple[0];
+        light[Color(0)] = purple[1];
+        dark[Color(0)] = purple[2];
+    }
+    else if (variant == Variant::junior)
+    {
+        base[Color(0)] = green[0];
+        light[Color(0)] = green[1];
+        dark[Color(0)] = green[2];
+    }
+    else
+    {
+        base[Color(0)] = blue[0];
+        light[Color(0)] = blue[1];
+        dark[Color(0)] = blue[2];
+    }
+    if (variant == Variant::duo || variant == Variant::junior)
+    {
+        base[Color(1)] = orange[0];
+        light[Color(1)] = orange[1];
+        dark[Color(1)] = orange[2];
+    }
+    else if (get_nu_colors(variant) == 2)
+    {
+        base[Color(1)] = green[0];
+        light[Color(1)] = green[1];
+        dark[Color(1)] = green[2];
+    }
+    else
+    {
+        base[Color(1)] = yellow[0];
+        light[Color(1)] = yellow[1];
+        dark[Color(1)] = yellow[2];
+    }
+    base[Color(2)] = red[0];
+    light[Color(2)] = red[1];
+    dark[Color(2)] = red[2];
+    base[Color(3)] = green[0];
+    light[Color(3)] = green[1];
+    dark[Color(3)] = green[2];
+}
+
+/** Paint a piece element of a point in geometries, in which the elements
+    don't depend on the neighboring points.
+    The painter must be translated to the grid position of the point. */
+void paintElement(QPainter& painter, GeometryType geometryType,
+                  unsigned pointType, qreal gridWidth, qreal gridHeight,
+                  const QColor& base, const QColor& light,
+                  const QColor& dark)
+{
+    switch (geometryType)
+    {
+    case GeometryType::classic:
+        paintSquare(painter, 0, 0, gridWidth, gridHeight, base, light, dark);
+        break;
+    case GeometryType::trigon:
+        if (pointType == 0)
+            paintTriangleUp(painter, -0.5, 0, 2 * gridWidth, gridHeight, base,
+                            light, dark);
+        else
+            paintTriangleDown(painter, -0.5, 0, 2 * gridWidth, gridHeight,
+                              base, light, dark);
+        break;
+    case GeometryType::gembloq:
+    {
+        painter.save();
+        QColor border;
+        switch (pointType)
+        {
+        case 0:
+            border = light;
+            break;
+        case 1:
+            border = dark;
+            painter.rotate(180);
+            painter.translate(-gridWidth, -gridHeight);
+            break;
+        case 2:
+            border = dark;
+            painter.rotate(270);
+            painter.translate(-gridHeight, 0);
+            break;
+        case 3:
+            border = light;
+            painter.rotate(90);
+            painter.translate(0, -gridWidth);
+            break;
+        }
+        // Antialiasing cause unwanted seams between quarter squares
+        painter.setRenderHint(QPainter::Antialiasing, false);
+        paintQuarterSquareBase(painter, 0, 0, 2 * gridWidth, gridHeight,
+                               base);
+        painter.setRenderHint(QPainter::Antialiasing);
+        paintQuarterSquareFrame(painter, 0, 0, 2 * gridWidth, gridHeight,
+                                border);
+        painter.restore();
+        break;
+    }
+    default:
+        LIBBOARDGAME_ASSERT(false);
+        break;
+    }
+}
+
 void paintPiecesCallisto(
         QPainter& painter, qreal width, qreal height, const Geometry& geo,
         const Grid<PointState>& pointState, const Grid<unsigned>& pieceId,
@@ -397,9 +518,12 @@ void paintPiecesClassic(
         if (pointState[p].is_empty())
             continue;
         auto c = pointState[p].to_color();
-        paintSquare(painter, geo.get_x(p) * gridWidth,
-                    geo.get_y(p) * gridHeight, gridWidth, gridHeight, base[c],
-                    light[c], dark[c]);
+        painter.save();
+        painter.translate(QPointF(geo.get_x(p) * gridWidth,
+                                  geo.get_y(p) * gridHeight));
+        paintElement(painter, GeometryType::classic, 0, gridWidth,
+                     gridHeight, base[c], light[c], dark[c]);
+        painter.restore();
     }
 }
 
@@ -418,35 +542,8 @@ void paintPiecesGembloQ(
         painter.save();
         painter.translate(QPointF(geo.get_x(p) * gridWidth,
                                   geo.get_y(p) * gridHeight));
-        QColor border;
-        switch (geo.get_point_type(p))
-        {
-        case 0:
-            border = light[c];
-            break;
-        case 1:
-            border = dark[c];
-            painter.rotate(180);
-            painter.translate(-gridWidth, -gridHeight);
-            break;
-        case 2:
-            border = dark[c];
-            painter.rotate(270);
-            painter.translate(-gridHeight, 0);
-            break;
-        case 3:
-            border = light[c];
-            painter.rotate(90);
-            painter.translate(0, -gridWidth);
-            break;
-        }
-        // Antialiasing cause unwanted seams between quarter squares
-        painter.setRenderHint(QPainter::Antialiasing, false);
-        paintQuarterSquareBase(painter, 0, 0, 2 * gridWidth, gridHeight,
-                               base[c]);
-        painter.setRenderHint(QPainter::Antialiasing);
-        paintQuarterSquareFrame(painter, 0, 0, 2 * gridWidth, gridHeight,
-                           border);
+        paintElement(painter, GeometryType::gembloq, geo.get_point_type(p),
+                     gridWidth, gridHeight, base[c], light[c], dark[c]);
         painter.restore();
     }
 }
@@ -651,14 +748,12 @@ void paintPiecesTrigon(
         if (pointState[p].is_empty())
             continue;
         auto c = pointState[p].to_color();
-        if (geo.get_point_type(p) == 0)
-            paintTriangleUp(painter, geo.get_x(p) * gridWidth - 0.5,
-                            geo.get_y(p) * gridHeight, 2 * gridWidth,
-                            gridHeight, base[c], light[c], dark[c]);
-        else
-            paintTriangleDown(painter, geo.get_x(p) * gridWidth - 0.5,
-                              geo.get_y(p) * gridHeight, 2 * gridWidth,
-                              gridHeight, base[c], light[c], dark[c]);
+        painter.save();
+        painter.translate(QPointF(geo.get_x(p) * gridWidth,
+                                  geo.get_y(p) * gridHeight));
+        paintElement(painter, GeometryType::trigon, geo.get_point_type(p),
+                     gridWidth, gridHeight, base[c], light[c], dark[c]);
+        painter.restore();
     }
 }
 
@@ -669,6 +764,13 @@ void paintPiecesTrigon(
 void paint(QPainter& painter, qreal width, qreal height, Variant variant,
            const Geometry& geo, const Grid<PointState>& pointState,
            const Grid<unsigned>& pieceId)
+{
+    painter.setRenderHint(QPainter::Antialiasing);
+    paintBoard(painter, width, height, variant);
+    paintPieces(painter, width, height, variant, geo, pointState, pieceId);
+}
+
+void paintBoard(QPainter& painter, qreal width, qreal height, Variant variant)
 {
     const QColor boardBase(174, 167, 172);
     const QColor boardLight(199, 191, 197);
@@ -676,89 +778,8 @@ void paint(QPainter& painter, qreal width, qreal height, Variant variant,
     const QColor centerBase(145, 139, 143);
     const QColor centerLight(160, 154, 159);
     const QColor centerDark(124, 119, 123);
-    painter.setRenderHint(QPainter::Antialiasing);
     paintBoard(painter, width, height, variant, boardBase, boardLight,
                boardDark, centerBase, centerLight, centerDark);
-    array<QColor, 3> blue{ {
-        QColor(0, 115, 207), QColor(20, 153, 255), QColor(0, 72, 129)} };
-    array<QColor, 3> green{ {
-        QColor(0, 192, 0), QColor(0, 250, 0), QColor(0, 120, 0)} };
-    array<QColor, 3> orange{ {
-        QColor(240, 146, 23), QColor(255, 187, 103), QColor(157, 94, 11)} };
-    array<QColor, 3> purple{ {
-        QColor(161, 44, 207), QColor(190, 112, 220), QColor(109, 39, 135)} };
-    array<QColor, 3> red{ {
-        QColor(230, 62, 44), QColor(255, 101, 90), QColor(144, 38, 27)} };
-    array<QColor, 3> yellow{ {
-        QColor(245, 195, 32), QColor(255, 219, 88), QColor(170, 133, 22)} };
-    ColorMap<QColor> piecesBase;
-    ColorMap<QColor> piecesLight;
-    ColorMap<QColor> piecesDark;
-    if (variant == Variant::duo)
-    {
-        piecesBase[Color(0)] = purple[0];
-        piecesLight[Color(0)] = purple[1];
-        piecesDark[Color(0)] = purple[2];
-    }
-    else if (variant == Variant::junior)
-    {
-        piecesBase[Color(0)] = green[0];
-        piecesLight[Color(0)] = green[1];
-        piecesDark[Color(0)] = green[2];
-    }
-    else
-    {
-        piecesBase[Color(0)] = blue[0];
-        piecesLight[Color(0)] = blue[1];
-        piecesDark[Color(0)] = blue[2];
-    }
-    if (variant == Variant::duo || variant == Variant::junior)
-    {
-        piecesBase[Color(1)] = orange[0];
-        piecesLight[Color(1)] = orange[1];
-        piecesDark[Color(1)] = orange[2];
-    }
-    else if (get_nu_colors(variant) == 2)
-    {
-        piecesBase[Color(1)] = green[0];
-        piecesLight[Color(1)] = green[1];
-        piecesDark[Color(1)] = green[2];
-    }
-    else
-    {
-        piecesBase[Color(1)] = yellow[0];
-        piecesLight[Color(1)] = yellow[1];
-        piecesDark[Color(1)] = yellow[2];
-    }
-    piecesBase[Color(2)] = red[0];
-    piecesLight[Color(2)] = red[1];
-    piecesDark[Color(2)] = red[2];
-    piecesBase[Color(3)] = green[0];
-    piecesLight[Color(3)] = green[1];
-    piecesDark[Color(3)] = green[2];
-    switch (get_geometry_type(variant))
-    {
-    case GeometryType::classic:
-        paintPiecesClassic(painter, width, height, geo, pointState, piecesBase,
-                           piecesLight, piecesDark);
-        break;
-    case GeometryType::trigon:
-        paintPiecesTrigon(painter, width, height, geo, pointState, piecesBase,
-                          piecesLight, piecesDark);
-        break;
-    case GeometryType::nexos:
-        paintPiecesNexos(painter, width, height, geo, pointState, pieceId,
-                         piecesBase, piecesLight, piecesDark);
-        break;
-    case GeometryType::callisto:
-        paintPiecesCallisto(painter, width, height, geo, pointState, pieceId,
-                            piecesBase, piecesLight, piecesDark);
-        break;
-    case GeometryType::gembloq:
-        paintPiecesGembloQ(painter, width, height, geo, pointState, piecesBase,
-                           piecesLight, piecesDark);
-        break;
-    }
 }
 
 void paintBoard(QPainter& painter, qreal width, qreal height, Variant variant,
@@ -844,6 +865,52 @@ void paintJunctionT(QPainter& painter, qreal x, qreal y, qreal width,
     painter.fillRect(QRectF(x, y + dy, width, height - 2 * dy), base);
 }
 
+void paintPieceElement(QPainter& painter, Variant variant,
+                       unsigned pointType, Color c, qreal gridWidth,
+                       qreal gridHeight)
+{
+    ColorMap<QColor> base;
+    ColorMap<QColor> light;
+    ColorMap<QColor> dark;
+    getPieceColors(variant, base, light, dark);
+    paintElement(painter, get_geometry_type(variant), pointType, gridWidth,
+                 gridHeight, base[c], light[c], dark[c]);
+}
+
+void paintPieces(QPainter& painter, qreal width, qreal height,
+                 Variant variant, const Geometry& geo,
+                 const Grid<PointState>& pointState,
+                 const Grid<unsigned>& pieceId)
+{
+    ColorMap<QColor> piecesBase;
+    ColorMap<QColor> piecesLight;
+    ColorMap<QColor> piecesDark;
+    getPieceColors(variant, piecesBase, piecesLight, piecesDark);
+    switch (get_geometry_type(variant))
+    {
+    case GeometryType::classic:
+        paintPiecesClassic(painter, width, height, geo, pointState, piecesBase,
+                           piecesLight, piecesDark);
+        break;
+    case GeometryType::trigon:
+        paintPiecesTrigon(painter, width, height, geo, pointState, piecesBase,
+                          piecesLight, piecesDark);
+        break;
+    case GeometryType::nexos:
+        paintPiecesNexos(painter, width, height, geo, pointState, pieceId,
+                         piecesBase, piecesLight, piecesDark);
+        break;
+    case GeometryType::callisto:
+        paintPiecesCallisto(painter, width, height, geo, pointState, pieceId,
+                            piecesBase, piecesLight, piecesDark);
+        break;
+    case GeometryType::gembloq:
+        paintPiecesGembloQ(painter, width, height, geo, pointState, piecesBase,
+                           piecesLight, piecesDark);
+        break;
+    }
+}
+
 void paintQuarterSquare(QPainter& painter, qreal x, qreal y, qreal width,
                         qreal height, const QColor& base, const QColor& light)
 {
@@ -8,6 +8,7 @@
 #define LIBPENTOBI_PAINT_H
 
 #include <QtGlobal>
+#include "libpentobi_base/Color.h"
 #include "libpentobi_base/Grid.h"
 #include "libpentobi_base/PointState.h"
 #include "libpentobi_base/Variant.h"
@@ -17,6 +18,7 @@ class QPainter;
 
 namespace libpentobi_paint {
 
+using libpentobi_base::Color;
 using libpentobi_base::Grid;
 using libpentobi_base::Geometry;
 using libpentobi_base::PointState;
@@ -37,6 +39,10 @@ void paint(QPainter& painter, qreal width, qreal height, Variant variant,
            const Geometry& geo, const Grid<PointState>& pointState,
            const Grid<unsigned>& pieceId);
 
+/** Paint empty board with the default colors used by paint(). */
+void paintBoard(QPainter& painter, qreal width, qreal height,
+                Variant variant);
+
 /** Paint empty board. */
 void paintBoard(QPainter& painter, qreal width, qreal height, Variant variant,
                 const QColor& base, const QColor& light, const QColor& dark,
@@ -59,6 +65,28 @@ void paintJunctionStraight(QPainter& painter, qreal x, qreal y, qreal width,
 void paintJunctionT(QPainter& painter, qreal x, qreal y, qreal width,
                     qreal height, const QColor& base);
 
+/** Paint the piece element of a point with the default colors used by
+    paint().
+    Only for geometries, in which the look of an element does not depend on
+    the neighboring points (Classic, Trigon, GembloQ). The element is painted
+    relative to the origin of the point's grid cell, it can extend beyond the
+    cell (e.g. in Trigon and GembloQ).
+    @param painter
+    @param variant
+    @param pointType The point type (Geometry::get_point_type())
+    @param c The color of the piece.
+    @param gridWidth The width of a grid cell as in paint().
+    @param gridHeight The height of a grid cell as in paint(). */
+void paintPieceElement(QPainter& painter, Variant variant,
+                       unsigned pointType, Color c, qreal gridWidth,
+                       qreal gridHeight);
+
+/** Paint the pieces as in paint() without the board. */
+void paintPieces(QPainter& painter, qreal width, qreal height,
+                 Variant variant, const Geometry& geo,
+                 const Grid<PointState>& pointState,
+                 const Grid<unsigned>& pieceId);
+
 void paintQuarterSquare(QPainter& painter, qreal x, qreal y, qreal width,
                         qreal height, const QColor& base, const QColor& light);
 
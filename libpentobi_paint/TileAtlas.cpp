@@ -0,0 +1,161 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_paint/TileAtlas.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "TileAtlas.h"
+
+#include <cmath>
+#include <QPainter>
+
+using namespace std;
+using libpentobi_base::GeometryType;
+using libpentobi_base::Point;
+
+namespace libpentobi_paint {
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+/** Get the board size in units of grid cells as used in paint(). */
+void getGridSize(Variant variant, const Geometry& geo, qreal& nuColumns,
+                 qreal& nuRows)
+{
+    nuColumns = geo.get_width();
+    nuRows = geo.get_height();
+    switch (get_geometry_type(variant))
+    {
+    case GeometryType::trigon:
+        nuColumns += 1;
+        break;
+    case GeometryType::nexos:
+        nuColumns -= 0.5;
+        nuRows -= 0.5;
+        break;
+    default:
+        break;
+    }
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+TileAtlas::TileAtlas() = default;
+
+TileAtlas::~TileAtlas() = default; // Non-inline to avoid GCC -Winline warning
+
+void TileAtlas::init(Variant variant, const Geometry& geo, int gridWidth,
+                     int gridHeight)
+{
+    m_isInitialized = true;
+    m_variant = variant;
+    m_gridWidth = gridWidth;
+    m_gridHeight = gridHeight;
+    qreal nuColumns;
+    qreal nuRows;
+    getGridSize(variant, geo, nuColumns, nuRows);
+    m_width = static_cast<int>(ceil(nuColumns * gridWidth));
+    m_height = static_cast<int>(ceil(nuRows * gridHeight));
+    m_board = QImage(m_width, m_height, QImage::Format_ARGB32_Premultiplied);
+    m_board.fill(Qt::transparent);
+    {
+        QPainter painter(&m_board);
+        painter.setRenderHint(QPainter::Antialiasing);
+        paintBoard(painter, nuColumns * gridWidth, nuRows * gridHeight,
+                   variant);
+    }
+    auto geometryType = get_geometry_type(variant);
+    m_hasTiles = (geometryType != GeometryType::nexos
+                  && geometryType != GeometryType::callisto);
+    if (! m_hasTiles)
+    {
+        m_tiles = QImage();
+        return;
+    }
+    // The elements in Trigon and GembloQ extend beyond their grid cell by
+    // less than the maximum cell dimension in each direction.
+    auto size = max(gridWidth, gridHeight);
+    m_margin = size + 1;
+    m_tileSize = 3 * size + 2;
+    unsigned nuPointTypes = 1;
+    for (Point p : geo)
+        nuPointTypes = max(nuPointTypes, geo.get_point_type(p) + 1);
+    auto nuColors = get_nu_colors(variant);
+    m_tiles = QImage(static_cast<int>(nuPointTypes) * m_tileSize,
+                     static_cast<int>(nuColors) * m_tileSize,
+                     QImage::Format_ARGB32_Premultiplied);
+    m_tiles.fill(Qt::transparent);
+    QPainter painter(&m_tiles);
+    painter.setRenderHint(QPainter::Antialiasing);
+    for (unsigned i = 0; i < nuPointTypes; ++i)
+        for (Color::IntType j = 0; j < nuColors; ++j)
+        {
+            painter.save();
+            painter.translate(static_cast<int>(i) * m_tileSize + m_margin,
+                              j * m_tileSize + m_margin);
+            paintPieceElement(painter, variant, i, Color(j), gridWidth,
+                              gridHeight);
+            painter.restore();
+        }
+}
+
+void TileAtlas::paint(QPainter& painter, qreal width, qreal height,
+                      Variant variant, const Geometry& geo,
+                      const Grid<PointState>& pointState,
+                      const Grid<unsigned>& pieceId)
+{
+    qreal nuColumns;
+    qreal nuRows;
+    getGridSize(variant, geo, nuColumns, nuRows);
+    auto gridWidth = static_cast<int>(width / nuColumns);
+    auto gridHeight = static_cast<int>(height / nuRows);
+    // Nexos elements are positioned at half grid cells
+    if (get_geometry_type(variant) == GeometryType::nexos)
+    {
+        gridWidth -= gridWidth % 2;
+        gridHeight -= gridHeight % 2;
+    }
+    if (gridWidth <= 0 || gridHeight <= 0)
+    {
+        // Too small for whole pixels
+        libpentobi_paint::paint(painter, width, height, variant, geo,
+                                pointState, pieceId);
+        return;
+    }
+    if (! m_isInitialized || variant != m_variant
+            || gridWidth != m_gridWidth || gridHeight != m_gridHeight)
+        init(variant, geo, gridWidth, gridHeight);
+    painter.save();
+    painter.translate(static_cast<int>((width - m_width) / 2),
+                      static_cast<int>((height - m_height) / 2));
+    painter.drawImage(0, 0, m_board);
+    if (m_hasTiles)
+        for (Point p : geo)
+        {
+            if (pointState[p].is_empty())
+                continue;
+            auto c = pointState[p].to_color();
+            painter.drawImage(
+                        static_cast<int>(geo.get_x(p)) * m_gridWidth
+                        - m_margin,
+                        static_cast<int>(geo.get_y(p)) * m_gridHeight
+                        - m_margin,
+                        m_tiles,
+                        static_cast<int>(geo.get_point_type(p)) * m_tileSize,
+                        c.to_int() * m_tileSize, m_tileSize, m_tileSize);
+        }
+    else
+    {
+        painter.setRenderHint(QPainter::Antialiasing);
+        paintPieces(painter, nuColumns * m_gridWidth, nuRows * m_gridHeight,
+                    variant, geo, pointState, pieceId);
+    }
+    painter.restore();
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_paint
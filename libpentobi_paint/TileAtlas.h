@@ -0,0 +1,83 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_paint/TileAtlas.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBPENTOBI_PAINT_TILE_ATLAS_H
+#define LIBPENTOBI_PAINT_TILE_ATLAS_H
+
+#include <QImage>
+#include "Paint.h"
+
+namespace libpentobi_paint {
+
+//-----------------------------------------------------------------------------
+
+/** Paints boards like paint() using cached pre-rendered images.
+    The empty board and the piece element of each combination of point type
+    and color are rendered once for a game variant and size and then copied
+    to the target. This is much faster than painting each element with
+    QPainter paths if many positions of the same size are painted (e.g. in the
+    thumbnailer). In Nexos and Callisto, the look of a piece element depends
+    on the neighboring points, there the pieces are still painted with paths.
+
+    The grid cells are rounded down to whole pixels, such that the images can
+    be copied without interpolation, so the board can be slightly smaller
+    than the requested size. It is centered in the requested area. The
+    painter should not be scaled.
+
+    An instance of this class must not be used in multiple threads at the
+    same time. */
+class TileAtlas
+{
+public:
+    TileAtlas();
+
+    ~TileAtlas();
+
+    /** Paint the board and pieces.
+        Same arguments as in paint(). Updates the cached images if the
+        variant or size changed. */
+    void paint(QPainter& painter, qreal width, qreal height, Variant variant,
+               const Geometry& geo, const Grid<PointState>& pointState,
+               const Grid<unsigned>& pieceId);
+
+private:
+    bool m_isInitialized = false;
+
+    Variant m_variant;
+
+    int m_gridWidth;
+
+    int m_gridHeight;
+
+    /** The size of the board in pixels. */
+    int m_width;
+
+    int m_height;
+
+    /** Offset of the cell's origin inside its tile. */
+    int m_margin;
+
+    /** Width and height of a tile. */
+    int m_tileSize;
+
+    /** Use the tiles for the pieces. */
+    bool m_hasTiles;
+
+    QImage m_board;
+
+    /** The piece elements with the point types as columns and the colors
+        as rows. */
+    QImage m_tiles;
+
+    void init(Variant variant, const Geometry& geo, int gridWidth,
+              int gridHeight);
+};
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_paint
+
+#endif // LIBPENTOBI_PAINT_TILE_ATLAS_H
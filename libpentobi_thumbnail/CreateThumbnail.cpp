@@ -7,14 +7,16 @@
 #include "CreateThumbnail.h"
 
 #include <QPainter>
-#include "libboardgame_base/TreeReader.h"
+#include "libboardgame_base/MappedFile.h"
+#include "libboardgame_base/Reader.h"
 #include "libpentobi_base/NodeUtil.h"
-#include "libpentobi_paint/Paint.h"
+#include "libpentobi_paint/TileAtlas.h"
 
 using namespace std;
+using libboardgame_base::MappedFile;
+using libboardgame_base::Reader;
 using libboardgame_base::SgfError;
 using libboardgame_base::SgfNode;
-using libboardgame_base::TreeReader;
 using libpentobi_base::Color;
 using libpentobi_base::Geometry;
 using libpentobi_base::Grid;
@@ -23,12 +25,13 @@ using libpentobi_base::PieceSet;
 using libpentobi_base::Point;
 using libpentobi_base::PointState;
 using libpentobi_base::Variant;
+using libpentobi_paint::TileAtlas;
 
 //-----------------------------------------------------------------------------
 
 namespace {
 
-/** Helper function for getFinalPosition() */
+/** Helper function for FinalPositionReader */
 void handleSetup(const char* id, Color c, const SgfNode& node,
                  const Geometry& geo, Grid<PointState>& pointState,
                  Grid<unsigned>& pieceId, unsigned& currentPieceId)
@@ -58,7 +61,7 @@ void handleSetup(const char* id, Color c, const SgfNode& node,
     }
 }
 
-/** Helper function for getFinalPosition() */
+/** Helper function for FinalPositionReader */
 void handleSetupEmpty(const SgfNode& node, const Geometry& geo,
                       Grid<PointState>& pointState, Grid<unsigned>& pieceId)
 {
@@ -86,54 +89,110 @@ void handleSetupEmpty(const SgfNode& node, const Geometry& geo,
     }
 }
 
-/** Get the board state of the final position of the main variation.
-    Avoids constructing an instance of a Tree or Game, which would do a costly
+/** Reader for the board state of the final position of the main variation.
+    Handles the nodes while reading without constructing a tree and avoids
+    constructing an instance of a Tree or Game, which would do a costly
     initialization of BoardConst and slow down the thumbnailer
     unnecessarily. */
-bool getFinalPosition(const SgfNode& root, Variant& variant,
-                      const Geometry*& geo, Grid<PointState>& pointState,
-                      Grid<unsigned>& pieceId)
+class FinalPositionReader
+    : public Reader
 {
-    if (! parse_variant(root.get_property("GM", ""), variant))
-        return false;
-    geo = &get_geometry(variant);
-    pointState.fill(PointState::empty(), *geo);
-    auto pieceSet = get_piece_set(variant);
-    if (pieceSet == PieceSet::nexos || pieceSet == PieceSet::callisto)
-        pieceId.fill(0, *geo);
-    auto node = &root;
-    unsigned id = 0;
-    do
+public:
+    Variant variant = Variant::classic; // Init to avoid compiler warning
+
+    const Geometry* geo = nullptr;
+
+    Grid<PointState> pointState;
+
+    Grid<unsigned> pieceId;
+
+    FinalPositionReader();
+
+    void on_begin_node(bool is_root) override;
+
+    void on_end_node() override;
+
+    void on_property(const string& id, const vector<string>& values) override;
+
+    /** Check if the game variant of the tree is known. */
+    bool isValid() const { return geo != nullptr; }
+
+private:
+    bool m_isRoot;
+
+    /** The root contained a setup, the remaining nodes are ignored. */
+    bool m_isDone = false;
+
+    unsigned m_id = 0;
+
+    /** The current node.
+        Reused for each node of the main variation. */
+    unique_ptr<SgfNode> m_node;
+};
+
+FinalPositionReader::FinalPositionReader()
+{
+    set_read_only_main_variation(true);
+}
+
+void FinalPositionReader::on_begin_node(bool is_root)
+{
+    m_isRoot = is_root;
+    m_node = make_unique<SgfNode>();
+}
+
+void FinalPositionReader::on_end_node()
+{
+    auto& node = *m_node;
+    if (m_isRoot)
     {
-        if (libpentobi_base::has_setup(*node))
+        if (! parse_variant(node.get_property("GM", ""), variant))
+            m_isDone = true;
+        else
         {
-            handleSetup("AB", Color(0), *node, *geo, pointState, pieceId, id);
-            handleSetup("AW", Color(1), *node, *geo, pointState, pieceId, id);
-            handleSetup("A1", Color(0), *node, *geo, pointState, pieceId, id);
-            handleSetup("A2", Color(1), *node, *geo, pointState, pieceId, id);
-            handleSetup("A3", Color(2), *node, *geo, pointState, pieceId, id);
-            handleSetup("A4", Color(3), *node, *geo, pointState, pieceId, id);
-            handleSetupEmpty(*node, *geo, pointState, pieceId);
-            if (node == &root)
-                // If the file starts with a setup (e.g. a puzzle), we use this
-                // position for the thumbnail.
-                break;
+            geo = &get_geometry(variant);
+            pointState.fill(PointState::empty(), *geo);
+            auto pieceSet = get_piece_set(variant);
+            if (pieceSet == PieceSet::nexos || pieceSet == PieceSet::callisto)
+                pieceId.fill(0, *geo);
         }
-        Color c;
-        MovePoints points;
-        if (libpentobi_base::get_move(*node, variant, c, points))
+    }
+    if (m_isDone)
+        return;
+    if (libpentobi_base::has_setup(node))
+    {
+        handleSetup("AB", Color(0), node, *geo, pointState, pieceId, m_id);
+        handleSetup("AW", Color(1), node, *geo, pointState, pieceId, m_id);
+        handleSetup("A1", Color(0), node, *geo, pointState, pieceId, m_id);
+        handleSetup("A2", Color(1), node, *geo, pointState, pieceId, m_id);
+        handleSetup("A3", Color(2), node, *geo, pointState, pieceId, m_id);
+        handleSetup("A4", Color(3), node, *geo, pointState, pieceId, m_id);
+        handleSetupEmpty(node, *geo, pointState, pieceId);
+        if (m_isRoot)
         {
-            ++id;
-            for (Point p : points)
-            {
-                pointState[p] = PointState(c);
-                pieceId[p] = id;
-            }
+            // If the file starts with a setup (e.g. a puzzle), we use this
+            // position for the thumbnail.
+            m_isDone = true;
+            return;
+        }
+    }
+    Color c;
+    MovePoints points;
+    if (libpentobi_base::get_move(node, variant, c, points))
+    {
+        ++m_id;
+        for (Point p : points)
+        {
+            pointState[p] = PointState(c);
+            pieceId[p] = m_id;
         }
-        node = node->get_first_child_or_null();
     }
-    while (node != nullptr);
-    return true;
+}
+
+void FinalPositionReader::on_property(const string& id,
+                                      const vector<string>& values)
+{
+    m_node->set_property(id, values);
 }
 
 } // namespace
@@ -141,20 +200,33 @@ bool getFinalPosition(const SgfNode& root, Variant& variant,
 //-----------------------------------------------------------------------------
 
 bool createThumbnail(const QString& path, int width, int height, QImage& image)
+{
+    try
+    {
+        MappedFile file(path.toLocal8Bit().constData());
+        return createThumbnail(file.begin(), file.end(), width, height,
+                               image);
+    }
+    catch (const MappedFile::Error&)
+    {
+        image.fill(Qt::transparent);
+        return false;
+    }
+}
+
+bool createThumbnail(const char* begin, const char* end, int width,
+                     int height, QImage& image)
 {
     try
     {
         image.fill(Qt::transparent);
-        TreeReader reader;
-        reader.set_read_only_main_variation(true);
-        reader.read(path.toLocal8Bit().constData());
-        auto variant = Variant::classic; // Init to avoid compiler warning
-        const Geometry* geo;
-        Grid<PointState> pointState;
-        Grid<unsigned> pieceId;
-        if (! getFinalPosition(reader.get_tree(), variant, geo, pointState,
-                               pieceId))
+        FinalPositionReader reader;
+        auto pos = begin;
+        reader.read(pos, end, false);
+        if (! reader.isValid())
             return false;
+        auto variant = reader.variant;
+        auto geo = reader.geo;
         qreal ratio;
         if (get_piece_set(variant) == PieceSet::trigon)
             ratio = geo->get_height() * 1.732 / geo->get_width();
@@ -165,17 +237,20 @@ bool createThumbnail(const QString& path, int width, int height, QImage& image)
         QPainter painter(&image);
         if (! painter.isActive())
             return false;
-        painter.translate(QPointF((width - paintWidth) / 2,
-                                  (height - paintHeight) / 2));
-        libpentobi_paint::paint(painter, paintWidth, paintHeight, variant,
-                                *geo, pointState, pieceId);
+        painter.translate(static_cast<int>((width - paintWidth) / 2),
+                          static_cast<int>((height - paintHeight) / 2));
+        // The atlas is reused if many thumbnails of the same size are
+        // created in a thread (e.g. in the batch mode of the thumbnailer)
+        thread_local TileAtlas atlas;
+        atlas.paint(painter, paintWidth, paintHeight, variant, *geo,
+                    reader.pointState, reader.pieceId);
         return true;
     }
     catch (const SgfError&)
     {
         return false;
     }
-    catch (const TreeReader::ReadError&)
+    catch (const Reader::ReadError&)
     {
         return false;
     }
@@ -15,6 +15,13 @@ class QString;
 bool createThumbnail(const QString& path, int width, int height,
                      QImage& image);
 
+/** Create a thumbnail from the content of a game file in memory.
+    Only the main variation is read, no game tree is constructed and the
+    geometries are created with thread-safe functions, so this function can
+    be called in parallel from different threads. */
+bool createThumbnail(const char* begin, const char* end, int width,
+                     int height, QImage& image);
+
 //-----------------------------------------------------------------------------
 
 #endif // LIBPENTOBI_THUMBNAIL_CREATE_THUMBNAIL_H
@@ -14,13 +14,15 @@
 #include <QGuiApplication>
 #include <QDebug>
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
 #include <QSettings>
+#include <QStandardPaths>
 #include <QTextCodec>
 #include "AndroidUtils.h"
+#include "libboardgame_base/SgfJournal.h"
 #include "libboardgame_base/SgfUtil.h"
 #include "libboardgame_base/TreeReader.h"
-#include "libpentobi_base/MoveMarker.h"
 #include "libpentobi_base/NodeUtil.h"
 #include "libpentobi_base/PentobiTreeWriter.h"
 #include "libpentobi_base/TreeUtil.h"
@@ -149,6 +151,7 @@ GameModel::GameModel(QObject* parent)
       m_nuColors(getBoard().get_nu_colors()),
       m_nuPlayers(getBoard().get_nu_players())
 {
+    m_game.set_journal(&m_journal);
     loadRecentFiles();
     initGame(m_game.get_variant());
     createPieceModels();
@@ -229,9 +232,51 @@ void GameModel::autoSave()
     settings.setValue(QStringLiteral("variant"),
                       to_string_id(m_game.get_variant()));
     if (! m_file.isEmpty() && ! m_isModified)
+    {
         settings.remove(QStringLiteral("autosave"));
+        removeAutoSaveJournal();
+        m_journal.invalidate();
+    }
     else
-        settings.setValue(QStringLiteral("autosave"), getSgf());
+    {
+        // Append the modifications since the last autosave to the journal
+        // file if possible, saving the whole tree after each move is slow
+        // for large trees. A new snapshot is saved if the journal is
+        // invalid, if another instance saved since the last autosave, or if
+        // the journal becomes larger than the snapshot.
+        auto& records = m_journal.get_records();
+        auto size = static_cast<qint64>(records.size());
+        bool isAppended = false;
+        if (m_journal.is_valid()
+                && settings.value(QStringLiteral("autosaveDate")).toDateTime()
+                   == m_autosaveDate
+                && m_autosaveJournalSize + size
+                   <= max(m_autosaveSnapshotSize, qint64(100000)))
+        {
+            if (size == 0)
+                isAppended = true;
+            else
+            {
+                QFile file(getAutoSaveJournalFile());
+                if (file.open(QIODevice::Append)
+                        && file.write(records.c_str(), size) == size)
+                {
+                    m_autosaveJournalSize += size;
+                    isAppended = true;
+                }
+            }
+        }
+        if (isAppended)
+            m_journal.clear_records();
+        else
+        {
+            auto sgf = getSgf();
+            settings.setValue(QStringLiteral("autosave"), sgf);
+            removeAutoSaveJournal();
+            m_autosaveSnapshotSize = sgf.size();
+            m_journal.clear();
+        }
+    }
     settings.setValue(QStringLiteral("file"), m_file);
     settings.setValue(QStringLiteral("fileDate"), m_fileDate);
     settings.setValue(QStringLiteral("isModified"), m_isModified);
@@ -278,7 +323,7 @@ bool GameModel::checkAutosaveModifiedOutside()
     return m_autosaveDate.isValid() && autosaveDate.isValid()
             && m_autosaveDate != autosaveDate
             && settings.value(QStringLiteral("isModified")).toBool()
-            && settings.value(QStringLiteral("autosave")).toByteArray() != getSgf();
+            && readAutoSave(settings) != getSgf();
 }
 
 bool GameModel::checkFileExists(const QString& file)
@@ -725,6 +770,12 @@ QString GameModel::getResultMessage()
     return tr("Game ends in a tie between all players.");
 }
 
+QString GameModel::getAutoSaveJournalFile()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+            + QStringLiteral("/autosave.journal");
+}
+
 QByteArray GameModel::getSgf() const
 {
     auto& tree = m_game.get_tree();
@@ -917,9 +968,14 @@ bool GameModel::loadAutoSave()
     }
     else
     {
-        if (! openByteArray(
-                    settings.value(QStringLiteral("autosave")).toByteArray()))
+        if (! openByteArray(readAutoSave(settings)))
             return false;
+        // Continue the journal of the loaded autosave
+        auto snapshot =
+                settings.value(QStringLiteral("autosave")).toByteArray();
+        m_autosaveSnapshotSize = snapshot.size();
+        m_autosaveJournalSize = QFileInfo(getAutoSaveJournalFile()).size();
+        m_journal.clear();
         m_fileDate = settings.value(QStringLiteral("fileDate")).toDateTime();
         m_autosaveDate =
                 settings.value(QStringLiteral("autosaveDate")).toDateTime();
@@ -1187,10 +1243,9 @@ void GameModel::prepareFindMove()
         m_legalMoves = make_unique<MoveList>();
     if (m_legalMoves->empty())
     {
-        if (! m_marker)
-            m_marker = make_unique<MoveMarker>();
-        bd.gen_moves(c, *m_marker, *m_legalMoves);
-        m_marker->clear(*m_legalMoves);
+        m_legalMoveTracker.update(bd);
+        for (Move mv : m_legalMoveTracker.get_moves(c))
+            m_legalMoves->push_back(mv);
         sort(m_legalMoves->begin(), m_legalMoves->end(),
              [&](Move mv1, Move mv2) {
                  return getHeuristic(bd, mv1) > getHeuristic(bd, mv2);
@@ -1267,6 +1322,51 @@ PieceModel* GameModel::previousPiece(PieceModel* currentPickedPiece)
     return findUnplayedPieceModel(c, Piece(i));
 }
 
+/** Get the autosaved game as written by getSgf().
+    The game is the snapshot in the settings with the journal file applied.
+    If the journal file does not match the snapshot, only the snapshot is
+    returned. */
+QByteArray GameModel::readAutoSave(const QSettings& settings) const
+{
+    auto snapshot = settings.value(QStringLiteral("autosave")).toByteArray();
+    QFile file(getAutoSaveJournalFile());
+    if (! file.open(QIODevice::ReadOnly))
+        return snapshot;
+    auto records = file.readAll();
+    if (records.isEmpty())
+        return snapshot;
+    try
+    {
+        istringstream in(snapshot.constData());
+        TreeReader reader;
+        reader.read(in);
+        auto root = reader.get_tree_transfer_ownership();
+        PentobiTree tree(root);
+        SgfJournal::replay(tree, string(records.constData(),
+                                        static_cast<size_t>(records.size())));
+        ostringstream s;
+        PentobiTreeWriter writer(s, tree);
+        writer.set_indent(-1);
+        writer.write();
+        return QByteArray(s.str().c_str());
+    }
+    catch (const runtime_error& e)
+    {
+        qWarning() << "GameModel: invalid autosave journal:" << e.what();
+        return snapshot;
+    }
+}
+
+void GameModel::removeAutoSaveJournal()
+{
+    auto file = getAutoSaveJournalFile();
+    if (QFileInfo::exists(file))
+        QFile::remove(file);
+    else
+        QDir().mkpath(QFileInfo(file).absolutePath());
+    m_autosaveJournalSize = 0;
+}
+
 void GameModel::restoreAutoSaveLocation()
 {
     QSettings settings;
@@ -1770,6 +1870,8 @@ void GameModel::updatePositionInfo()
 void GameModel::updateProperties()
 {
     auto& bd = getBoard();
+    m_legalMoveTracker.update(bd);
+    auto& tracker = m_legalMoveTracker;
     auto& geo = bd.get_geometry();
     auto& tree = m_game.get_tree();
     bool isGembloQ = (bd.get_piece_set() == PieceSet::gembloq);
@@ -1779,20 +1881,24 @@ void GameModel::updateProperties()
     set(m_points1, bd.get_points(Color(1)), &GameModel::points1Changed);
     set(m_bonus0, bd.get_bonus(Color(0)), &GameModel::bonus0Changed);
     set(m_bonus1, bd.get_bonus(Color(1)), &GameModel::bonus1Changed);
-    set(m_hasMoves0, bd.has_moves(Color(0)), &GameModel::hasMoves0Changed);
-    set(m_hasMoves1, bd.has_moves(Color(1)), &GameModel::hasMoves1Changed);
+    set(m_hasMoves0, tracker.has_moves(Color(0)),
+        &GameModel::hasMoves0Changed);
+    set(m_hasMoves1, tracker.has_moves(Color(1)),
+        &GameModel::hasMoves1Changed);
     bool isFirstPieceAny = false;
     if (m_nuColors > 2)
     {
         set(m_points2, bd.get_points(Color(2)), &GameModel::points2Changed);
         set(m_bonus2, bd.get_bonus(Color(2)), &GameModel::bonus2Changed);
-        set(m_hasMoves2, bd.has_moves(Color(2)), &GameModel::hasMoves2Changed);
+        set(m_hasMoves2, tracker.has_moves(Color(2)),
+            &GameModel::hasMoves2Changed);
     }
     if (m_nuColors > 3)
     {
         set(m_points3, bd.get_points(Color(3)), &GameModel::points3Changed);
         set(m_bonus3, bd.get_bonus(Color(3)), &GameModel::bonus3Changed);
-        set(m_hasMoves3, bd.has_moves(Color(3)), &GameModel::hasMoves3Changed);
+        set(m_hasMoves3, tracker.has_moves(Color(3)),
+            &GameModel::hasMoves3Changed);
     }
     m_tmpPoints.clear();
     if (bd.is_first_piece(Color(0)))
@@ -1877,7 +1983,7 @@ void GameModel::updateProperties()
     updatePositionInfo();
     bool isGameOver = true;
     for (Color c : bd.get_colors())
-        if (bd.has_moves(c))
+        if (tracker.has_moves(c))
         {
             isGameOver = false;
             break;
@@ -1888,7 +1994,11 @@ void GameModel::updateProperties()
     updateIsModified();
     updatePieces();
     set(m_comment, decode(m_game.get_comment()), &GameModel::commentChanged);
-    set(m_toPlay, m_isGameOver ? 0u : bd.get_effective_to_play().to_int(),
+    auto toPlay = bd.get_to_play();
+    if (! m_isGameOver)
+        while (! tracker.has_moves(toPlay))
+            toPlay = bd.get_next(toPlay);
+    set(m_toPlay, m_isGameOver ? 0u : toPlay.to_int(),
         &GameModel::toPlayChanged);
     set(m_altPlayer,
         bd.get_variant() == Variant::classic_3 ? bd.get_alt_player() : 0u,
@@ -11,18 +11,21 @@
 #include <QUrl>
 #include "PieceModel.h"
 #include "libpentobi_base/Game.h"
+#include "libpentobi_base/LegalMoveTracker.h"
 
+class QSettings;
 class QTextCodec;
 
 using namespace std;
+using libboardgame_base::SgfJournal;
 using libboardgame_base::SgfNode;
 using libpentobi_base::ColorMap;
 using libpentobi_base::ColorMove;
 using libpentobi_base::Board;
 using libpentobi_base::Game;
+using libpentobi_base::LegalMoveTracker;
 using libpentobi_base::Move;
 using libpentobi_base::MoveList;
-using libpentobi_base::MoveMarker;
 using libpentobi_base::ScoreType;
 using libpentobi_base::Variant;
 
@@ -536,6 +539,15 @@ private:
 
     QDateTime m_autosaveDate;
 
+    /** Modifications of the game tree since the last autosave. */
+    SgfJournal m_journal;
+
+    /** Size of the autosave snapshot in the settings. */
+    qint64 m_autosaveSnapshotSize = 0;
+
+    /** Size of the autosave journal file. */
+    qint64 m_autosaveJournalSize = 0;
+
     unsigned m_nuColors;
 
     unsigned m_nuPlayers;
@@ -614,13 +626,15 @@ private:
 
     QTextCodec* m_textCodec;
 
+    /** Moves of all colors in the current position.
+        Updated incrementally when the position changes. */
+    LegalMoveTracker m_legalMoveTracker;
+
+    /** Moves of the color to play sorted for findMoveNext(). */
     unique_ptr<MoveList> m_legalMoves;
 
     unsigned m_legalMoveIndex;
 
-    /** Local variable reused for efficiency. */
-    unique_ptr<MoveMarker> m_marker;
-
 
     void addRecentFile(const QString& file);
 
@@ -645,6 +659,12 @@ private:
 
     ColorMove getMoveAt(const QPoint& pos) const;
 
+    static QString getAutoSaveJournalFile();
+
+    QByteArray readAutoSave(const QSettings& settings) const;
+
+    void removeAutoSaveJournal();
+
     void initGame(Variant variant);
 
     void initGameVariant(Variant variant);
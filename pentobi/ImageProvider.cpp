@@ -7,6 +7,7 @@
 #include "ImageProvider.h"
 
 #include <QPainter>
+#include <QPixmapCache>
 #include "libpentobi_paint/Paint.h"
 
 using namespace std;
@@ -31,12 +32,30 @@ QPixmap ImageProvider::requestPixmap(const QString& id, QSize* size,
     QPixmap pixmap(width, height);
     if (requestedSize.width() <= 0 || requestedSize.height() <= 0)
         return pixmap;
+    // The same images are requested many times with the same size (e.g. the
+    // piece elements of all pieces of a color), so we keep the rendered
+    // images in the global pixmap cache, which is only used in the GUI
+    // thread like this function.
+    auto key = QStringLiteral("pentobi/%1/%2x%3").arg(id).arg(width)
+            .arg(height);
+    if (QPixmapCache::find(key, &pixmap))
+        return pixmap;
     pixmap.fill(Qt::transparent);
-    QPainter painter(&pixmap);
-    painter.setRenderHint(QPainter::Antialiasing);
+    {
+        QPainter painter(&pixmap);
+        painter.setRenderHint(QPainter::Antialiasing);
+        paintImage(painter, id, width, height);
+    }
+    QPixmapCache::insert(key, pixmap);
+    return pixmap;
+}
+
+void ImageProvider::paintImage(QPainter& painter, const QString& id,
+                               int width, int height)
+{
     auto splitRef = id.splitRef(QStringLiteral("/"));
     if (splitRef.empty())
-        return pixmap;
+        return;
     auto name = splitRef[0];
     if (name == "board" && splitRef.size() == 8)
     {
@@ -85,7 +104,6 @@ QPixmap ImageProvider::requestPixmap(const QString& id, QSize* size,
         else if (name == "triangle-down")
             paintTriangleDown(painter, 0, 0, width, height, base, light, dark);
     }
-    return pixmap;
 }
 
 //-----------------------------------------------------------------------------
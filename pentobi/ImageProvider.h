@@ -9,6 +9,8 @@
 
 #include <QQuickImageProvider>
 
+class QPainter;
+
 //-----------------------------------------------------------------------------
 
 class ImageProvider
@@ -19,6 +21,10 @@ public:
 
     QPixmap requestPixmap(const QString& id, QSize* size,
                           const QSize& requestedSize) override;
+
+private:
+    static void paintImage(QPainter& painter, const QString& id, int width,
+                           int height);
 };
 
 //-----------------------------------------------------------------------------
@@ -5,8 +5,10 @@
 //-----------------------------------------------------------------------------
 
 #include <QApplication>
+#include <QDir>
 #include <QIcon>
 #include <QQuickStyle>
+#include <QStandardPaths>
 #include <QtQml>
 #include <QTranslator>
 #include "AnalyzeGameModel.h"
@@ -17,6 +19,7 @@
 #include "RatingModel.h"
 #include "SyncSettings.h"
 #include "libboardgame_base/Log.h"
+#include "libpentobi_base/BoardConst.h"
 
 #ifndef Q_OS_ANDROID
 #include <QCommandLineParser>
@@ -245,6 +248,12 @@ int main(int argc, char *argv[])
     QCoreApplication::setApplicationVersion(QStringLiteral(VERSION));
 #endif
     QGuiApplication app(argc, argv);
+    // Share the precomputed move tables between starts and running instances
+    auto cacheDir =
+            QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (! cacheDir.isEmpty() && QDir().mkpath(cacheDir))
+        libpentobi_base::BoardConst::set_cache_dir(
+                    cacheDir.toLocal8Bit().constData());
 #ifndef PENTOBI_OPEN_HELP_EXTERNALLY
     QtWebView::initialize();
 #endif
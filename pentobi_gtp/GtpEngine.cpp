@@ -14,7 +14,11 @@ using libboardgame_base::Writer;
 using libboardgame_gtp::Failure;
 using libpentobi_base::Board;
 using libpentobi_base::get_color_id;
+using libpentobi_base::Move;
+using libpentobi_base::ScoreType;
+using libpentobi_mcts::EndgameSolver;
 using libpentobi_mcts::Float;
+using libpentobi_mcts::Weights;
 
 //-----------------------------------------------------------------------------
 
@@ -25,22 +29,55 @@ GtpEngine::GtpEngine(
 {
     create_player(variant, level, books_dir, nu_threads);
     get_mcts_player().set_use_book(use_book);
+    add("clear_weights", &GtpEngine::cmd_clear_weights);
     add("get_value", &GtpEngine::cmd_get_value);
+    add("load_weights", &GtpEngine::cmd_load_weights);
     add("name", &GtpEngine::cmd_name);
     add("param", &GtpEngine::cmd_param);
     add("move_values", &GtpEngine::cmd_move_values);
     add("save_tree", &GtpEngine::cmd_save_tree);
+    add("save_weights", &GtpEngine::cmd_save_weights);
     add("selfplay", &GtpEngine::cmd_selfplay);
+    add("solve", &GtpEngine::cmd_solve);
     add("version", &GtpEngine::cmd_version);
 }
 
 GtpEngine::~GtpEngine() = default; // Non-inline to avoid GCC -Winline warning
 
+void GtpEngine::cmd_clear_weights()
+{
+    get_search().clear_weights();
+}
+
 void GtpEngine::cmd_get_value(Response& response)
 {
+    auto& player = get_mcts_player();
+    if (player.was_solved())
+    {
+        auto score = player.get_solved_score();
+        if (score > 0)
+            response << 1;
+        else if (score < 0)
+            response << 0;
+        else
+            response << Search::SearchParamConst::tie_value;
+        return;
+    }
     response << get_search().get_tree().get_root().get_value();
 }
 
+void GtpEngine::cmd_load_weights(Arguments args)
+{
+    try
+    {
+        load_weights(args.get<string>());
+    }
+    catch (const Weights::ReadError& e)
+    {
+        throw Failure(e.what());
+    }
+}
+
 void GtpEngine::cmd_move_values(Response& response)
 {
     auto children = get_search().get_tree().get_root_children();
@@ -74,6 +111,30 @@ void GtpEngine::cmd_save_tree(Arguments args)
     libpentobi_mcts::dump_tree(out, search);
 }
 
+void GtpEngine::cmd_save_weights(Arguments args)
+{
+    ofstream out(args.get<string>());
+    if (! out)
+        throw Failure("could not create file");
+    get_search().get_weights(get_board().get_variant()).write(out);
+}
+
+void GtpEngine::cmd_solve(Response& response)
+{
+    auto& bd = get_board();
+    auto& solver = get_mcts_player().get_solver();
+    if (! EndgameSolver::is_supported(bd.get_variant()))
+        throw Failure("game variant not supported");
+    auto c = bd.get_effective_to_play();
+    Move mv;
+    ScoreType score;
+    if (! solver.solve(bd, c, mv, score))
+        throw Failure("maximum number of nodes exceeded");
+    response << score;
+    if (! mv.is_null())
+        response << ' ' << bd.to_string(mv, false);
+}
+
 /** Let the engine play a number of games against itself.
     This is more efficient than using twogtp if selfplay games are needed
     because it has lower memory requirements (only one engine needed), process
@@ -127,6 +188,10 @@ void GtpEngine::cmd_param(Arguments args, Response& response)
             << "rave_parent_max " << s.get_rave_parent_max() << '\n'
             << "rave_weight " << s.get_rave_weight() << '\n'
             << "reuse_subtree " << s.get_reuse_subtree() << '\n'
+            << "solve_regions " << s.get_solve_regions() << '\n'
+            << "solver_max_legal_moves "
+            << p.get_solver().get_max_legal_moves() << '\n'
+            << "solver_max_nodes " << p.get_solver().get_max_nodes() << '\n'
             << "use_book " << p.get_use_book() << '\n';
     else
     {
@@ -146,6 +211,12 @@ void GtpEngine::cmd_param(Arguments args, Response& response)
             s.set_rave_weight(args.get<Float>(1));
         else if (name == "reuse_subtree")
             s.set_reuse_subtree(args.get<bool>(1));
+        else if (name == "solve_regions")
+            s.set_solve_regions(args.get<bool>(1));
+        else if (name == "solver_max_legal_moves")
+            p.get_solver().set_max_legal_moves(args.get<unsigned>(1));
+        else if (name == "solver_max_nodes")
+            p.get_solver().set_max_nodes(args.get<size_t>(1));
         else if (name == "use_book")
             p.set_use_book(args.get<bool>(1));
         else
@@ -197,6 +268,12 @@ Search& GtpEngine::get_search()
     return get_mcts_player().get_search();
 }
 
+void GtpEngine::load_weights(const string& file)
+{
+    get_search().set_weights(
+                Weights::read(file, get_board().get_variant()));
+}
+
 void GtpEngine::use_cpu_time(bool enable)
 {
     get_mcts_player().use_cpu_time(enable);
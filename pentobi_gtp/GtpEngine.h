@@ -30,16 +30,26 @@ public:
 
     ~GtpEngine() override;
 
+    void cmd_clear_weights();
     void cmd_param(Arguments args, Response& response);
     void cmd_get_value(Response& response);
+    void cmd_load_weights(Arguments args);
     void cmd_move_values(Response& response);
     void cmd_name(Response& response);
     void cmd_selfplay(Arguments args);
     void cmd_save_tree(Arguments args);
+    void cmd_solve(Response& response);
+    void cmd_save_weights(Arguments args);
     void cmd_version(Response& response);
 
     Player& get_mcts_player();
 
+    /** Load weights for the move priors and playout gammas.
+        If the file contains no game variant, the weights are used for the
+        game variant of the current board.
+        @throws libpentobi_mcts::Weights::ReadError */
+    void load_weights(const string& file);
+
     /** @see Player::use_cpu_time() */
     void use_cpu_time(bool enable);
 
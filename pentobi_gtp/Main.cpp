@@ -16,6 +16,7 @@ using libboardgame_base::RandomGenerator;
 using libboardgame_gtp::Failure;
 using libpentobi_base::parse_variant_id;
 using libpentobi_base::Board;
+using libpentobi_base::BoardConst;
 using libpentobi_base::Variant;
 using libpentobi_mcts::Player;
 
@@ -50,6 +51,7 @@ int main(int argc, char** argv)
     {
         vector<string> specs = {
             "book:",
+            "cachedir:",
             "config|c:",
             "color",
             "cputime",
@@ -62,7 +64,8 @@ int main(int argc, char** argv)
             "seed|r:",
             "showboard",
             "threads:",
-            "version|v"
+            "version|v",
+            "weights:"
         };
         Options opt(argc, argv, specs);
         if (opt.contains("help"))
@@ -70,6 +73,7 @@ int main(int argc, char** argv)
             cout <<
                 "Usage: pentobi_gtp [options] [input files]\n"
                 "--book       load an external book file\n"
+                "--cachedir   directory for caching precomputed move tables\n"
                 "--config,-c  set GTP config file\n"
                 "--color      colorize text output of boards\n"
                 "--cputime    use CPU time\n"
@@ -84,7 +88,8 @@ int main(int argc, char** argv)
                 "--noresign   disable resign\n"
                 "--quiet,-q   do not print logging messages\n"
                 "--threads    number of threads in the search\n"
-                "--version,-v print version and exit\n";
+                "--version,-v print version and exit\n"
+                "--weights    load move prior and playout weights\n";
             return 0;
         }
         if (opt.contains("version"))
@@ -109,6 +114,8 @@ int main(int argc, char** argv)
         if (opt.contains("seed"))
             RandomGenerator::set_global_seed(
                         opt.get<RandomGenerator::ResultType>("seed"));
+        if (opt.contains("cachedir"))
+            BoardConst::set_cache_dir(opt.get("cachedir"));
         string variant_string = opt.get("game", "classic");
         Variant variant;
         if (! parse_variant_id(variant_string, variant))
@@ -127,9 +134,20 @@ int main(int argc, char** argv)
         string book_file = opt.get("book", "");
         if (! book_file.empty())
         {
-            ifstream in(book_file);
-            engine.get_mcts_player().load_book(in);
+            string extension = libpentobi_base::CompiledBook::file_extension;
+            if (book_file.size() > extension.size()
+                    && book_file.compare(book_file.size() - extension.size(),
+                                         extension.size(), extension) == 0)
+                engine.get_mcts_player().load_compiled_book(book_file);
+            else
+            {
+                ifstream in(book_file);
+                engine.get_mcts_player().load_book(in);
+            }
         }
+        string weights_file = opt.get("weights", "");
+        if (! weights_file.empty())
+            engine.load_weights(weights_file);
         string config_file = opt.get("config", "");
         if (! config_file.empty())
         {
@@ -4,19 +4,153 @@
     @copyright GNU General Public License version 3 or later */
 //-----------------------------------------------------------------------------
 
+#include <atomic>
 #include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 #include <QCommandLineParser>
 #include <QCoreApplication>
+#include <QCryptographicHash>
 #include <QImage>
+#include <QImageReader>
 #include <QImageWriter>
 #include <QLocale>
 #include <QLibraryInfo>
 #include <QString>
 #include <QTranslator>
 #include "libboardgame_base/Log.h"
+#include "libboardgame_base/MappedFile.h"
 #include "libpentobi_thumbnail/CreateThumbnail.h"
 
 using namespace std;
+using libboardgame_base::MappedFile;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+/** Key of the text in the PNG file that stores the hash of the input file. */
+const auto hashKey = QStringLiteral("Pentobi-Hash");
+
+struct Job
+{
+    QString input;
+
+    QString output;
+};
+
+/** Create a thumbnail in batch mode.
+    The output file is not written again if it contains the hash of the
+    content of the input file and of the image size, which was stored as a
+    text in the PNG file when the thumbnail was created.
+    @return false if the thumbnail creation failed, the error message is
+    returned in error */
+bool createBatchThumbnail(const Job& job, int size, bool& skipped,
+                          QString& error)
+{
+    skipped = false;
+    try
+    {
+        MappedFile file(job.input.toLocal8Bit().constData());
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        hash.addData(file.begin(),
+                     static_cast<int>(file.end() - file.begin()));
+        auto hashValue = QString::fromLatin1(hash.result().toHex())
+                + QLatin1Char(':') + QString::number(size);
+        if (QImageReader(job.output, "png").text(hashKey) == hashValue)
+        {
+            skipped = true;
+            return true;
+        }
+        QImage image(size, size, QImage::Format_ARGB32);
+        if (! createThumbnail(file.begin(), file.end(), size, size, image))
+        {
+            error = QCoreApplication::translate(
+                        "main", "Thumbnail creation failed");
+            return false;
+        }
+        QImageWriter writer(job.output, "png");
+        writer.setText(hashKey, hashValue);
+        if (! writer.write(image))
+        {
+            error = writer.errorString();
+            return false;
+        }
+        return true;
+    }
+    catch (const exception& e)
+    {
+        error = QString::fromLocal8Bit(e.what());
+        return false;
+    }
+}
+
+/** Create thumbnails for a list of files in parallel.
+    @return false if the creation of any thumbnail failed. */
+bool runBatch(const vector<Job>& jobs, int size, unsigned nuThreads)
+{
+    atomic<size_t> nextJob(0);
+    atomic<unsigned> nuSkipped(0);
+    bool success = true;
+    mutex errorMutex;
+    auto worker = [&]
+    {
+        while (true)
+        {
+            auto i = nextJob.fetch_add(1);
+            if (i >= jobs.size())
+                return;
+            bool skipped;
+            QString error;
+            if (! createBatchThumbnail(jobs[i], size, skipped, error))
+            {
+                lock_guard<mutex> lock(errorMutex);
+                cerr << jobs[i].input.toLocal8Bit().constData() << ": "
+                     << error.toLocal8Bit().constData() << '\n';
+                success = false;
+            }
+            else if (skipped)
+                ++nuSkipped;
+        }
+    };
+    vector<thread> threads;
+    for (unsigned i = 1; i < nuThreads && i < jobs.size(); ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& t : threads)
+        t.join();
+    LIBBOARDGAME_LOG("Files: ", jobs.size(), ", unchanged: ",
+                     nuSkipped.load());
+    return success;
+}
+
+/** Read the jobs for the batch mode from standard input.
+    Each line contains the input and output file separated by a tab
+    character. */
+void readJobs(vector<Job>& jobs)
+{
+    string line;
+    while (getline(cin, line))
+    {
+        if (! line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty())
+            continue;
+        auto pos = line.find('\t');
+        if (pos == string::npos)
+            throw QCoreApplication::translate(
+                    "main", "Invalid input line: %1")
+                .arg(QString::fromLocal8Bit(line.c_str()));
+        auto input = line.substr(0, pos);
+        auto output = line.substr(pos + 1);
+        jobs.push_back({QString::fromLocal8Bit(input.c_str()),
+                        QString::fromLocal8Bit(output.c_str())});
+    }
+}
+
+} // namespace
 
 //-----------------------------------------------------------------------------
 
@@ -55,6 +189,30 @@ int main(int argc, char* argv[])
                     QCoreApplication::translate("main", "size"),
                     QStringLiteral("128"));
         parser.addOption(optionSize);
+        QCommandLineOption optionBatch(
+                    QStringList() << QStringLiteral("b")
+                    << QStringLiteral("batch"),
+                    //: Description for command line option --batch
+                    QCoreApplication::translate(
+                        "main",
+                        "Create thumbnails for multiple pairs of input and"
+                        " output files given as arguments or, if no"
+                        " arguments are given, as lines with tab-separated"
+                        " input and output file on standard input. Files"
+                        " whose thumbnail is up to date are skipped."));
+        parser.addOption(optionBatch);
+        QCommandLineOption optionThreads(
+                    QStringList() << QStringLiteral("t")
+                    << QStringLiteral("threads"),
+                    //: Description for command line option --threads
+                    QCoreApplication::translate(
+                        "main",
+                        "Use <threads> threads in batch mode (0 means the"
+                        " number of hardware threads)."),
+                    //: Value name for command line option --threads
+                    QCoreApplication::translate("main", "threads"),
+                    QStringLiteral("0"));
+        parser.addOption(optionThreads);
         parser.addHelpOption();
         parser.addVersionOption();
         parser.addPositionalArgument(
@@ -77,6 +235,24 @@ int main(int argc, char* argv[])
         int size = parser.value(optionSize).toInt(&ok);
         if (! ok || size <= 0)
             throw QCoreApplication::translate("main", "Invalid image size");
+        if (parser.isSet(optionBatch))
+        {
+            auto nuThreads = parser.value(optionThreads).toUInt(&ok);
+            if (! ok)
+                throw QCoreApplication::translate(
+                        "main", "Invalid number of threads");
+            if (nuThreads == 0)
+                nuThreads = max(thread::hardware_concurrency(), 1u);
+            if (args.size() % 2 != 0)
+                throw QCoreApplication::translate(
+                        "main", "Need pairs of input and output files");
+            vector<Job> jobs;
+            for (int i = 0; i < args.size(); i += 2)
+                jobs.push_back({args.at(i), args.at(i + 1)});
+            if (jobs.empty())
+                readJobs(jobs);
+            return runBatch(jobs, size, nuThreads) ? 0 : 1;
+        }
         if (args.size() > 2)
             throw QCoreApplication::translate("main", "Too many arguments");
         if (args.size() < 2)